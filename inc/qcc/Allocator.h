@@ -0,0 +1,249 @@
+/**
+ * @file
+ *
+ * Allocation of reference counted objects and string storage.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#ifndef _QCC_ALLOCATOR_H
+#define _QCC_ALLOCATOR_H
+
+#include <qcc/platform.h>
+
+#include <qcc/atomic.h>
+
+#include <Status.h>
+
+namespace qcc {
+
+/**
+ * An Allocator provides the memory for ManagedObj contexts and the heap
+ * storage of qcc::String.
+ *
+ * By default these come from a pool that keeps freed blocks in lists by size
+ * class (multiples of 16 bytes up to 256 bytes, then of 64 bytes up to 1024
+ * bytes) and hands them out again, which keeps the many small, short lived
+ * allocations of a long running process from fragmenting the heap.  Each
+ * thread normally works on its own cache of free blocks without contending
+ * with other threads; caches that get too full pass blocks back to a shared
+ * list.  Larger blocks go straight to malloc.  The pool carves its blocks
+ * from chunks that are never freed, so memory it has once held is reused but
+ * never returned to the system, even when every block is free again.
+ *
+ * An application can install its own allocator with SetCurrent().  Every block
+ * remembers which allocator it came from and is returned to it, so an
+ * allocator can be installed at any time but must outlive all of its blocks.
+ */
+class Allocator {
+  public:
+
+    /** Most allocators that can be installed over the life of the process, including the pool */
+    static const uint16_t MAX_ALLOCATORS = 16;
+
+    /** Destructor */
+    virtual ~Allocator() { }
+
+    /**
+     * Allocate memory aligned for any type.
+     *
+     * @param size  Number of bytes.
+     * @return  The memory or NULL if none is available.
+     */
+    virtual void* Allocate(size_t size) = 0;
+
+    /**
+     * Free memory returned by Allocate().
+     *
+     * @param mem   The memory.
+     * @param size  The size that was passed to Allocate().
+     */
+    virtual void Free(void* mem, size_t size) = 0;
+
+    /**
+     * Install the allocator used for new objects and strings.
+     *
+     * @param allocator  The allocator or NULL to go back to the pool.
+     * @return
+     *      - ER_OK on success.
+     *      - ER_FAIL if MAX_ALLOCATORS different allocators have already been installed.
+     */
+    static QStatus SetCurrent(Allocator* allocator);
+
+    /**
+     * Get the allocator used for new objects and strings.
+     *
+     * @return  The allocator.
+     */
+    static Allocator& GetCurrent();
+
+    /**
+     * Get the default pool allocator.
+     *
+     * @return  The pool.
+     */
+    static Allocator& GetPool();
+
+    /**
+     * @internal
+     * Allocate from the current allocator.
+     *
+     * @param size       Number of bytes.
+     * @param allocator  Returns the allocator to pass to FreeBlock().
+     * @return  The memory.
+     */
+    static void* AllocateBlock(size_t size, uint16_t& allocator);
+
+    /**
+     * @internal
+     * Free a block from AllocateBlock().
+     *
+     * @param mem        The memory.
+     * @param size       The size that was allocated.
+     * @param allocator  The allocator returned by AllocateBlock().
+     */
+    static void FreeBlock(void* mem, size_t size, uint16_t allocator);
+};
+
+/**
+ * Counts of the live objects of one type and the memory allocated for them.
+ * ManagedObj keeps one of these for every managed type and String keeps one
+ * for its heap storage.  The counts are registered in a list the first time
+ * they are used so the types that dominate memory can be found at runtime.
+ *
+ * The counts are spread over several stripes, each on its own cache line,
+ * and summed when read.  A thread picks a stripe from the address of its
+ * stack, as the pool picks its caches, so threads allocating the same type
+ * do not contend on one cache line.
+ *
+ * AllocStats objects are constant initialized and never destroyed, so
+ * allocations during static construction are counted too.  The members are
+ * public only to allow that; use the accessors.
+ */
+struct AllocStats {
+    /** Number of stripes the counts are spread over */
+    static const size_t NUM_STRIPES = 8;
+
+    /** The counts changed by the threads that map to one stripe */
+    struct Stripe {
+        volatile size_t liveBytes;      /**< Bytes allocated less bytes freed */
+        volatile int32_t liveObjects;   /**< Objects allocated less objects freed */
+        char pad[QCC_CACHE_LINE_SIZE - sizeof(size_t) - sizeof(int32_t)];
+    };
+
+    const char* name;               /**< Name of the type */
+    size_t objectSize;              /**< Bytes allocated per object or 0 if that varies */
+    volatile int32_t registered;    /**< Non-zero once in the list */
+    AllocStats* next;               /**< Next in the list */
+    Stripe stripes[NUM_STRIPES];    /**< The counts */
+
+    /**
+     * Count an allocation.
+     *
+     * @param bytes     Bytes allocated.
+     * @param typeName  Name to register under when first used.  A function
+     *                  signature generated by the compiler for a template
+     *                  member is shortened to the template argument.
+     */
+    void Add(size_t bytes, const char* typeName)
+    {
+        if (!AtomicLoad(&registered, MEMORY_ORDER_ACQUIRE)) {
+            Register(typeName);
+        }
+        Stripe& stripe = GetStripe();
+        AtomicFetchAdd(&stripe.liveObjects, static_cast<int32_t>(1), MEMORY_ORDER_RELAXED);
+        AtomicFetchAdd(&stripe.liveBytes, bytes, MEMORY_ORDER_RELAXED);
+    }
+
+    /**
+     * Count a free.
+     *
+     * @param bytes  Bytes freed.
+     */
+    void Remove(size_t bytes)
+    {
+        Stripe& stripe = GetStripe();
+        AtomicFetchAdd(&stripe.liveObjects, static_cast<int32_t>(-1), MEMORY_ORDER_RELAXED);
+        AtomicFetchAdd(&stripe.liveBytes, static_cast<size_t>(0) - bytes, MEMORY_ORDER_RELAXED);
+    }
+
+    /**
+     * Get the name of the type.
+     *
+     * @return  The name.
+     */
+    const char* GetName() const { return name; }
+
+    /**
+     * Get the number of objects currently allocated.  Objects allocated or
+     * freed by other threads while the stripes are summed may or may not be
+     * included.
+     *
+     * @return  The number of objects.
+     */
+    int32_t GetLiveObjects() const
+    {
+        int32_t total = 0;
+        for (size_t i = 0; i < NUM_STRIPES; ++i) {
+            total += AtomicLoad(&stripes[i].liveObjects, MEMORY_ORDER_RELAXED);
+        }
+        return total;
+    }
+
+    /**
+     * Get the number of bytes currently allocated, including the bookkeeping
+     * stored with each object.
+     *
+     * @return  The number of bytes.
+     */
+    size_t GetLiveBytes() const
+    {
+        size_t total = 0;
+        for (size_t i = 0; i < NUM_STRIPES; ++i) {
+            total += AtomicLoad(&stripes[i].liveBytes, MEMORY_ORDER_RELAXED);
+        }
+        return total;
+    }
+
+    /**
+     * Get the next registered counts.
+     *
+     * @return  The next counts or NULL at the end of the list.
+     */
+    const AllocStats* GetNext() const { return next; }
+
+    /**
+     * Get the first registered counts.  Entries are only ever added to the
+     * front of the list so it can be walked while other threads allocate.
+     *
+     * @return  The first counts or NULL if nothing has been allocated.
+     */
+    static const AllocStats* GetFirst();
+
+  private:
+    void Register(const char* typeName);
+
+    /** Pick the stripe for the calling thread from the address of its stack */
+    Stripe& GetStripe()
+    {
+        uint32_t page = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(&page) >> 12);
+        return stripes[((page * 0x9E3779B9U) >> 16) % NUM_STRIPES];
+    }
+};
+
+}
+
+#endif
@@ -34,6 +34,11 @@ namespace qcc {
  * BufferedSink is an Sink wrapper that attempts to write fixed size blocks
  * to an underyling (wrapped) Sink. It is typically used by Sinks which are
  * slow or otherwise sensitive to small chunk writes.
+ *
+ * Chunks are pushed from an internal buffer that is refilled as soon as the
+ * push returns, so the wrapped sink must not hold on to pushed buffers.  The
+ * BufferedSink tells the sink so with Sink::SetBufferReuse(); a SocketStream
+ * refuses or suspends zero copy sends while it is wrapped.
  */
 class BufferedSink : public Sink {
   public:
@@ -81,7 +86,9 @@ class BufferedSink : public Sink {
     QStatus DisableWriteBuffer() { Flush(); isBuffered = false; return ER_OK; }
 
     /**
-     * Flush any buffered write.
+     * Flush any buffered write.  If the underlying sink was corked while
+     * full chunks were written (see Sink::Cork()) it is uncorked once
+     * everything has been pushed.
      *
      * @return ER_OK if successful.
      */
@@ -92,7 +99,7 @@ class BufferedSink : public Sink {
     /**
      * Copy constructor is private and does nothing
      */
-    BufferedSink(const BufferedSink& other) : sink(other.sink), event(other.event), minChunk(other.minChunk), buf(NULL), wrPtr(NULL) { }
+    BufferedSink(const BufferedSink& other) : sink(other.sink), event(other.event), minChunk(other.minChunk), buf(NULL), wrPtr(NULL), isCorked(false) { sink.SetBufferReuse(true); }
 
     /**
      * Assigment operator is private and does nothing
@@ -106,6 +113,7 @@ class BufferedSink : public Sink {
     uint8_t* wrPtr;             /**< Pointer to next write position in buf */
     size_t completeIdx;         /**< Number of bytes already sent from buf */
     bool isBuffered;            /**< true iff write buffering is enabled */
+    bool isCorked;              /**< true iff the sink was corked by this BufferedSink */
 };
 
 }
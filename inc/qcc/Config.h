@@ -28,6 +28,8 @@
 
 #include <qcc/Mutex.h>
 #include <qcc/String.h>
+#include <qcc/StringMapKey.h>
+#include <qcc/StringRef.h>
 #include <qcc/StringUtil.h>
 
 /** @internal */
@@ -62,7 +64,7 @@ class Config {
     }
 
   private:
-    std::map<qcc::String, qcc::String> nameValuePairs;     /**< Key/value pairs from config file */
+    std::map<qcc::StringMapKey, qcc::String> nameValuePairs;     /**< Key/value pairs from config file */
 
     /**
      * Default constructor is private to ensure singleton useage.
@@ -79,11 +81,11 @@ class Config {
      * @param defaultValue   Default value used if key is not found in config file.
      * @return Value associated with key or defaultValue if no such entry exists.
      */
-    qcc::String GetValue(const char* key, const char* defaultValue = NULL) const {
+    qcc::String GetValue(const qcc::StringRef& key, const char* defaultValue = NULL) const {
         qcc::String value = (defaultValue ? defaultValue : "");
-        std::map<qcc::String, qcc::String>::const_iterator it;
+        std::map<qcc::StringMapKey, qcc::String>::const_iterator it;
 
-        it = nameValuePairs.find(key);
+        it = nameValuePairs.find(qcc::StringMapKey(key));
         if (nameValuePairs.end() != it) {
             value = it->second;
         }
@@ -98,11 +100,11 @@ class Config {
      * @param defaultValue    Default value used if key is not found (or is unparsable) in config file.
      * @return  Value associated with key or default value if not found.
      */
-    uint32_t GetValueNumeric(qcc::String key, uint32_t defaultValue = 0) const {
+    uint32_t GetValueNumeric(const qcc::StringRef& key, uint32_t defaultValue = 0) const {
         uint32_t valNumeric = defaultValue;
-        std::map<qcc::String, qcc::String>::const_iterator it;
+        std::map<qcc::StringMapKey, qcc::String>::const_iterator it;
 
-        it = nameValuePairs.find(key);
+        it = nameValuePairs.find(qcc::StringMapKey(key));
         if (nameValuePairs.end() != it) {
             valNumeric = StringToU32(it->second, 10, defaultValue);
         }
@@ -31,6 +31,7 @@
 #include <qcc/KeyBlob.h>
 #include <qcc/Stream.h>
 #include <qcc/String.h>
+#include <qcc/StringBuilder.h>
 #include <qcc/StringUtil.h>
 
 
@@ -995,10 +996,12 @@ class Crypto_ASN1 {
         if (!syntax) {
             return ER_FAIL;
         }
+        qcc::StringBuilder builder;
         va_list argp;
         va_start(argp, syntax);
-        QStatus status = EncodeV(syntax, asn, &argp);
+        QStatus status = EncodeV(syntax, builder, &argp);
         va_end(argp);
+        builder.AppendTo(asn);
         return status;
     }
 
@@ -1046,15 +1049,18 @@ class Crypto_ASN1 {
 
     static QStatus DecodeV(const char*& syntax, const uint8_t* asn, size_t asnLen, va_list* argpIn);
 
-    static QStatus EncodeV(const char*& syntax, qcc::String& asn, va_list* argpIn);
+    static QStatus EncodeV(const char*& syntax, qcc::StringBuilder& asn, va_list* argpIn);
 
     static qcc::String DecodeOID(const uint8_t* p, size_t len);
 
-    static QStatus EncodeOID(qcc::String& asn, const qcc::String& oid);
+    static QStatus EncodeOID(qcc::StringBuilder& asn, const qcc::String& oid);
 
     static bool DecodeLen(const uint8_t*& p, const uint8_t* eod, size_t& l);
 
-    static void EncodeLen(qcc::String& asn, size_t l);
+    static void EncodeLen(qcc::StringBuilder& asn, size_t l);
+
+    /* Insert the length of everything after start in front of it */
+    static void InsertLen(qcc::StringBuilder& asn, size_t start);
 };
 
 /**
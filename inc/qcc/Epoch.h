@@ -0,0 +1,188 @@
+/**
+ * @file
+ *
+ * Epoch based reclamation for data structures with lock-free readers.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#ifndef _QCC_EPOCH_H
+#define _QCC_EPOCH_H
+
+#include <qcc/platform.h>
+#include <qcc/atomic.h>
+
+namespace qcc {
+
+/**
+ * Epoch based reclamation.
+ *
+ * Readers bracket their accesses to a shared structure with Enter() and
+ * Exit(), usually through a ScopedEpoch.  A writer that unlinks an object
+ * passes it to Retire() instead of deleting it.  The object is deleted once
+ * every reader that might still hold a pointer to it has left.
+ *
+ * There is a single global epoch counter.  A reader records the epoch it
+ * entered in; the counter only advances when every current reader has seen
+ * the current epoch, and objects retired in epoch E are deleted once the
+ * counter reaches E + 2.  Entering and leaving cost one atomic operation each
+ * on a slot that is private to the reader in the common case.
+ *
+ * Reader sections must be short and must not block: a reader that stays
+ * inside holds back reclamation for everybody.  Reader sections may nest.
+ * Retire() may be called from inside a reader section but Synchronize() must
+ * not be.
+ */
+class Epoch {
+  public:
+
+    /**
+     * Function that deletes a retired object.
+     *
+     * @param object  The object passed to Retire().
+     */
+    typedef void (*Deleter)(void* object);
+
+    /**
+     * Start a reader section.
+     *
+     * @return  A handle to pass to Exit().
+     */
+    static uint32_t Enter();
+
+    /**
+     * End a reader section.
+     *
+     * @param handle  The value returned by the matching Enter().
+     */
+    static void Exit(uint32_t handle);
+
+    /**
+     * Delete an object once no reader can be using it.  The object must
+     * already be unreachable for new readers.
+     *
+     * @param object   The object.
+     * @param deleter  Function that deletes it.
+     */
+    static void Retire(void* object, Deleter deleter);
+
+    /**
+     * Delete an object with operator delete once no reader can be using it.
+     *
+     * @param object  The object.
+     */
+    template <typename T>
+    static void Retire(T* object) { Retire(object, &DeleteObject<T>); }
+
+    /**
+     * Wait until every reader section that was active when this was called has
+     * ended, then delete everything retired before the call.
+     */
+    static void Synchronize();
+
+    /**
+     * Advance the epoch if possible and delete the retired objects that are
+     * safe to delete.  Retire() calls this every so often.
+     *
+     * @return  The number of objects deleted.
+     */
+    static size_t Reclaim();
+
+    /**
+     * The number of retired objects that have not been deleted yet.
+     *
+     * @return  The number of objects waiting for deletion.
+     */
+    static size_t Pending();
+
+  private:
+    template <typename T>
+    static void DeleteObject(void* object) { delete static_cast<T*>(object); }
+};
+
+/**
+ * A reader section that lasts for the lifetime of this object.
+ */
+class ScopedEpoch {
+  public:
+    ScopedEpoch() : handle(Epoch::Enter()) { }
+
+    ~ScopedEpoch() { Epoch::Exit(handle); }
+
+  private:
+    ScopedEpoch(const ScopedEpoch& other);
+    ScopedEpoch& operator=(const ScopedEpoch& other);
+
+    uint32_t handle;
+};
+
+/**
+ * A pointer to a read-mostly object that is replaced rather than modified
+ * (read-copy-update).
+ *
+ * Readers call Get() inside a ScopedEpoch and may use the result until the
+ * ScopedEpoch ends, without taking any locks.  A writer makes a modified copy
+ * and installs it with Publish(); the old version is retired.  Writers must be
+ * serialized with respect to each other by the caller.
+ *
+ * The RcuPtr owns the current version and deletes it when destroyed, which
+ * must not happen while readers may still be using it.
+ */
+template <typename T>
+class RcuPtr {
+  public:
+
+    /**
+     * Constructor
+     *
+     * @param initial  Initial version, or NULL.  Ownership is taken.
+     */
+    RcuPtr(T* initial = NULL) : current(initial) { }
+
+    /** Destructor */
+    ~RcuPtr() { delete current.Load(MEMORY_ORDER_RELAXED); }
+
+    /**
+     * The current version.  Only valid until the enclosing reader section
+     * ends.
+     *
+     * @return  The current version.
+     */
+    const T* Get() const { return current.Load(MEMORY_ORDER_ACQUIRE); }
+
+    /**
+     * Install a new version and retire the old one.
+     *
+     * @param newVersion  The new version, or NULL.  Ownership is taken.
+     */
+    void Publish(T* newVersion)
+    {
+        T* oldVersion = current.Exchange(newVersion, MEMORY_ORDER_ACQ_REL);
+        if (oldVersion) {
+            Epoch::Retire(oldVersion);
+        }
+    }
+
+  private:
+    RcuPtr(const RcuPtr& other);
+    RcuPtr& operator=(const RcuPtr& other);
+
+    Atomic<T*> current;
+};
+
+}
+
+#endif
@@ -0,0 +1,61 @@
+/**
+ * @file
+ *
+ * Define a fast, non-recursive mutex.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#ifndef _QCC_FASTMUTEX_H
+#define _QCC_FASTMUTEX_H
+
+#include <qcc/platform.h>
+
+#if defined(QCC_OS_GROUP_POSIX)
+#include <qcc/posix/FastMutex.h>
+#elif defined(QCC_OS_GROUP_WINDOWS) || defined(QCC_OS_GROUP_WINRT)
+#include <qcc/windows/FastMutex.h>
+#else
+#error No OS GROUP defined.
+#endif
+
+namespace qcc {
+
+/**
+ * An implementation of a scoped lock for a FastMutex.
+ */
+class ScopedFastMutexLock {
+  public:
+
+    /**
+     * Constructor
+     *
+     * @param lock The lock we want to manage
+     */
+    ScopedFastMutexLock(FastMutex& lock) : lock(lock) { lock.Lock(); }
+
+    ~ScopedFastMutexLock() { lock.Unlock(); }
+
+  private:
+    ScopedFastMutexLock(const ScopedFastMutexLock& other);
+    ScopedFastMutexLock& operator=(const ScopedFastMutexLock& other);
+
+    FastMutex& lock;
+};
+
+}
+
+#endif
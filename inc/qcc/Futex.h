@@ -0,0 +1,144 @@
+/**
+ * @file
+ *
+ * Wait for a 32 bit word in memory to change.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#ifndef _QCC_FUTEX_H
+#define _QCC_FUTEX_H
+
+#include <qcc/platform.h>
+#include <qcc/atomic.h>
+#include <qcc/Event.h>
+
+#include <Status.h>
+
+namespace qcc {
+
+/**
+ * Sleep until a 32 bit word in memory changes.
+ *
+ * On Linux and Android this is a thin wrapper around the futex system call.
+ * Elsewhere it is emulated with a small table of condition variables hashed by
+ * address.  Either way no kernel object has to be created per word.
+ *
+ * Wakeups may be spurious, so callers always re-check their condition.
+ */
+class Futex {
+  public:
+
+    /**
+     * Sleep as long as *addr holds expected.
+     *
+     * @param addr      Address of the word.
+     * @param expected  Value *addr is expected to hold.  Returns immediately
+     *                  if it holds anything else.
+     * @param maxMs     Maximum time to sleep in milliseconds.
+     * @return  ER_OK if woken (possibly spuriously) or *addr did not hold
+     *          expected, ER_TIMEOUT if maxMs expired.
+     */
+    static QStatus Wait(volatile int32_t* addr, int32_t expected, uint32_t maxMs = Event::WAIT_FOREVER);
+
+    /**
+     * Wake threads sleeping in Wait() on addr.  Change *addr first.
+     *
+     * @param addr   Address of the word.
+     * @param count  Maximum number of threads to wake.
+     */
+    static void Wake(volatile int32_t* addr, uint32_t count = 1);
+};
+
+/**
+ * Lets threads sleep until a condition that is checked without a lock may
+ * have become true.  Waiters do:
+ *
+ * @code
+ *     while (!condition) {
+ *         int32_t key = ec.PrepareWait();
+ *         if (condition) {
+ *             ec.CancelWait();
+ *             break;
+ *         }
+ *         ec.Wait(key, maxMs);
+ *     }
+ * @endcode
+ *
+ * and whoever makes the condition true calls Notify() afterwards.  Notify() is
+ * a fence and a load when nobody is waiting.
+ */
+class EventCount {
+  public:
+
+    EventCount() : sequence(0), waiters(0) { }
+
+    /**
+     * Announce that the calling thread is about to wait.  Must be followed by
+     * a re-check of the condition and either CancelWait() or Wait().
+     *
+     * @return  The key to pass to Wait().
+     */
+    int32_t PrepareWait()
+    {
+        AtomicFetchAdd(&waiters, static_cast<int32_t>(1));
+        return AtomicLoad(&sequence);
+    }
+
+    /**
+     * Withdraw a PrepareWait() because the condition became true.
+     */
+    void CancelWait() { AtomicFetchAdd(&waiters, static_cast<int32_t>(-1)); }
+
+    /**
+     * Sleep unless there was a Notify() since PrepareWait() returned key.
+     *
+     * @param key    The value returned by PrepareWait().
+     * @param maxMs  Maximum time to sleep in milliseconds.
+     * @return  ER_OK or ER_TIMEOUT.
+     */
+    QStatus Wait(int32_t key, uint32_t maxMs = Event::WAIT_FOREVER)
+    {
+        QStatus status = Futex::Wait(&sequence, key, maxMs);
+        AtomicFetchAdd(&waiters, static_cast<int32_t>(-1));
+        return status;
+    }
+
+    /**
+     * Wake waiting threads, if there are any.
+     *
+     * @param count  Maximum number of threads to wake.
+     */
+    void Notify(uint32_t count = 1)
+    {
+        AtomicFence(MEMORY_ORDER_SEQ_CST);
+        if (AtomicLoad(&waiters, MEMORY_ORDER_RELAXED) != 0) {
+            AtomicFetchAdd(&sequence, static_cast<int32_t>(1));
+            Futex::Wake(&sequence, count);
+        }
+    }
+
+  private:
+    EventCount(const EventCount& other);
+    EventCount& operator=(const EventCount& other);
+
+    volatile int32_t sequence;
+    volatile int32_t waiters;
+};
+
+}
+
+#endif
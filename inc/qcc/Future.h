@@ -0,0 +1,394 @@
+/**
+ * @file
+ *
+ * Future and Promise result handles for work that completes on another thread
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#ifndef _QCC_FUTURE_H
+#define _QCC_FUTURE_H
+
+#include <vector>
+
+#include <qcc/platform.h>
+#include <qcc/Event.h>
+#include <qcc/Mutex.h>
+#include <qcc/Ptr.h>
+#include <qcc/time.h>
+
+#include <Status.h>
+
+namespace qcc {
+
+/**
+ * The state shared between a Promise and the Futures obtained from it.
+ *
+ * A state completes exactly once, either with a status of ER_OK (in which
+ * case the derived class holds a value) or with an error status.  The Event
+ * that waiters sleep on is only created if someone actually has to wait, so
+ * work that is done before anybody asks for its result never costs an event.
+ */
+class _FutureStateBase : public RefCountBase {
+  public:
+
+    _FutureStateBase();
+
+    virtual ~_FutureStateBase();
+
+    /**
+     * Wait for the state to complete.
+     *
+     * @param maxMs   Max number of milliseconds to wait or Event::WAIT_FOREVER.
+     * @return
+     *      - The completion status if the state completed.
+     *      - #ER_TIMEOUT if it did not complete in time.
+     *      - Any other error returned by Event::Wait() if the calling thread
+     *        was stopped or alerted.
+     */
+    QStatus Wait(uint32_t maxMs);
+
+    /**
+     * @return true iff the state has completed.
+     */
+    bool IsReady();
+
+    /**
+     * Complete the state.  Only the first call has any effect.
+     *
+     * @param status  The completion status.
+     * @return true iff this call completed the state.
+     */
+    bool Complete(QStatus status);
+
+    /**
+     * Ask for a dependent state to be told when this one completes.  If this
+     * state has already completed, the dependent is told immediately.
+     *
+     * @param dependent  The state to notify by calling DependencyComplete().
+     */
+    void AddDependent(Ptr<_FutureStateBase> dependent);
+
+  protected:
+
+    /**
+     * Called when a state that this one depends on completes.
+     *
+     * @param status  The completion status of that state.
+     */
+    virtual void DependencyComplete(QStatus status) { }
+
+    /**
+     * Complete the state with m_lock held.  This lets derived classes store a
+     * value and complete in one go.  m_lock is released on return.
+     *
+     * @param status  The completion status.
+     * @return true iff this call completed the state.
+     */
+    bool CompleteAndUnlock(QStatus status);
+
+    /**
+     * @return true iff the state has completed.  Called with m_lock held.
+     */
+    bool IsReadyLocked() const { return m_ready; }
+
+    /**
+     * Lock protecting the state.
+     */
+    Mutex m_lock;
+
+  private:
+    _FutureStateBase(const _FutureStateBase& other);
+    _FutureStateBase& operator=(const _FutureStateBase& other);
+
+    bool m_ready;
+    QStatus m_status;
+    Event* m_event;
+    std::vector<Ptr<_FutureStateBase> > m_dependents;
+};
+
+/**
+ * The typed state shared between a Promise<T> and its Future<T>s.
+ */
+template <typename T>
+class _FutureState : public _FutureStateBase {
+  public:
+    _FutureState() : m_value() { }
+
+    /**
+     * Store a value and complete with ER_OK.
+     *
+     * @return true iff the state had not already completed.
+     */
+    bool SetValue(const T& value)
+    {
+        m_lock.Lock();
+        if (IsReadyLocked()) {
+            m_lock.Unlock();
+            return false;
+        }
+        m_value = value;
+        return CompleteAndUnlock(ER_OK);
+    }
+
+    /**
+     * The stored value.  Only meaningful once the state completed with ER_OK.
+     */
+    const T& GetValue() const { return m_value; }
+
+  protected:
+    T m_value;
+};
+
+template <typename T>
+class Promise;
+
+/**
+ * The consumer side of a result that is produced on another thread.
+ *
+ * Futures are cheap to copy; all copies refer to the same result.  A default
+ * constructed Future refers to no result at all and is never ready.
+ */
+template <typename T>
+class Future {
+  public:
+
+    /**
+     * Construct an invalid Future.
+     */
+    Future() { }
+
+    /**
+     * @return true iff this Future refers to a result.
+     */
+    bool IsValid() const { return m_state.Peek() != NULL; }
+
+    /**
+     * @return true iff the result is available (or has failed).
+     */
+    bool IsReady() const { return m_state.Peek() && m_state->IsReady(); }
+
+    /**
+     * Wait for the result to become available.
+     *
+     * @param maxMs   Max number of milliseconds to wait or Event::WAIT_FOREVER.
+     * @return
+     *      - #ER_OK if the result is available.
+     *      - The error status the producer failed with.
+     *      - #ER_TIMEOUT if the result was not available in time.
+     *      - #ER_FAIL if this Future is not valid.
+     *      - Any other error returned by Event::Wait().
+     */
+    QStatus Wait(uint32_t maxMs = Event::WAIT_FOREVER) const
+    {
+        return m_state.Peek() ? m_state->Wait(maxMs) : ER_FAIL;
+    }
+
+    /**
+     * Wait for the result to become available and get it.
+     *
+     * @param value   Returns the result if the return value is ER_OK.
+     * @param maxMs   Max number of milliseconds to wait or Event::WAIT_FOREVER.
+     * @return  As for Wait().
+     */
+    QStatus Get(T& value, uint32_t maxMs = Event::WAIT_FOREVER) const
+    {
+        QStatus status = Wait(maxMs);
+        if (status == ER_OK) {
+            value = m_state->GetValue();
+        }
+        return status;
+    }
+
+    /**
+     * Get the shared state.  For use by the combinators below.
+     */
+    Ptr<_FutureState<T> > GetState() const { return m_state; }
+
+    /**
+     * Wrap an existing shared state.  For use by Promise and the combinators.
+     */
+    explicit Future(Ptr<_FutureState<T> > state) : m_state(state) { }
+
+  private:
+    Ptr<_FutureState<T> > m_state;
+};
+
+/**
+ * The producer side of a result that is produced on another thread.
+ *
+ * A Promise is completed once, by SetValue() or SetError().  Copies of a
+ * Promise refer to the same result.
+ */
+template <typename T>
+class Promise {
+  public:
+
+    /**
+     * Construct a Promise with a new, incomplete, result.
+     */
+    Promise() : m_state(new _FutureState<T>()) { }
+
+    /**
+     * Get a Future which is completed when this Promise is.
+     */
+    Future<T> GetFuture() const { return Future<T>(m_state); }
+
+    /**
+     * Make the result available.
+     *
+     * @return true iff the result had not already been completed.
+     */
+    bool SetValue(const T& value) { return m_state->SetValue(value); }
+
+    /**
+     * Fail the result.
+     *
+     * @param status  The error to report to waiters.
+     * @return true iff the result had not already been completed.
+     */
+    bool SetError(QStatus status) { return m_state->Complete(status); }
+
+    /**
+     * @return true iff the result has been completed.
+     */
+    bool IsReady() const { return m_state->IsReady(); }
+
+  private:
+    Ptr<_FutureState<T> > m_state;
+};
+
+/**
+ * Wait for every one of a set of Futures to become ready.
+ *
+ * @param futures The Futures to wait for.
+ * @param maxMs   Max number of milliseconds to wait overall or Event::WAIT_FOREVER.
+ * @return
+ *      - #ER_OK if all of the results are available.
+ *      - Otherwise the first error (in vector order) reported by a Future.
+ */
+template <typename T>
+QStatus WaitAll(const std::vector<Future<T> >& futures, uint32_t maxMs = Event::WAIT_FOREVER)
+{
+    QStatus status = ER_OK;
+    uint64_t startTime = GetTimestamp64();
+    for (size_t i = 0; i < futures.size(); ++i) {
+        uint32_t waitMs = Event::WAIT_FOREVER;
+        if (maxMs != Event::WAIT_FOREVER) {
+            uint64_t elapsed = GetTimestamp64() - startTime;
+            waitMs = (elapsed < maxMs) ? (maxMs - static_cast<uint32_t>(elapsed)) : 0;
+        }
+        QStatus fStatus = futures[i].Wait(waitMs);
+        if (fStatus == ER_TIMEOUT) {
+            return fStatus;
+        }
+        status = (status == ER_OK) ? fStatus : status;
+    }
+    return status;
+}
+
+/**
+ * The state behind the Future returned by WhenAll().
+ */
+template <typename T>
+class _WhenAllState : public _FutureState<std::vector<T> > {
+  public:
+    _WhenAllState(const std::vector<Future<T> >& futures) : m_futures(futures), m_outstanding(futures.size() + 1), m_status(ER_OK) { }
+
+    /**
+     * Start listening for the constituent Futures.  The extra count taken in
+     * the constructor is released here so that we cannot complete part way
+     * through.
+     */
+    void Arm(Ptr<_FutureStateBase> self)
+    {
+        for (size_t i = 0; i < m_futures.size(); ++i) {
+            if (m_futures[i].IsValid()) {
+                m_futures[i].GetState()->AddDependent(self);
+            } else {
+                DependencyComplete(ER_FAIL);
+            }
+        }
+        DependencyComplete(ER_OK);
+    }
+
+  protected:
+    virtual void DependencyComplete(QStatus status)
+    {
+        this->m_lock.Lock();
+        if (status != ER_OK && m_status == ER_OK) {
+            m_status = status;
+        }
+        if (--m_outstanding != 0) {
+            this->m_lock.Unlock();
+            return;
+        }
+        /*
+         * The constituents held us as a dependent while they were
+         * outstanding, which made a reference cycle with m_futures.  Take the
+         * futures out as soon as the last one is in so that the cycle is gone
+         * however completing us turns out.
+         */
+        std::vector<Future<T> > futures;
+        futures.swap(m_futures);
+        QStatus result = m_status;
+        this->m_lock.Unlock();
+
+        if (result == ER_OK) {
+            std::vector<T> values;
+            values.reserve(futures.size());
+            for (size_t i = 0; i < futures.size(); ++i) {
+                values.push_back(futures[i].GetState()->GetValue());
+            }
+            this->SetValue(values);
+        } else {
+            this->Complete(result);
+        }
+    }
+
+  private:
+    std::vector<Future<T> > m_futures;
+    size_t m_outstanding;
+    QStatus m_status;
+};
+
+/**
+ * Combine a set of Futures into a single Future which becomes ready when all
+ * of them are.  Unlike WaitAll() this does not block.
+ *
+ * The combined state and the constituents keep each other alive until the
+ * last of them completes, so a constituent that is never completed leaks
+ * them all.  Once they have all completed the constituents are released and
+ * only the combined results are kept.
+ *
+ * @param futures The Futures to combine.
+ * @return A Future for the results of all of the Futures, in order.  If any
+ *         of them fails, the combined Future fails with the first error
+ *         reported.
+ */
+template <typename T>
+Future<std::vector<T> > WhenAll(const std::vector<Future<T> >& futures)
+{
+    _WhenAllState<T>* state = new _WhenAllState<T>(futures);
+    Ptr<_FutureState<std::vector<T> > > ptr(state);
+    state->Arm(Ptr<_FutureStateBase>(state));
+    return Future<std::vector<T> >(ptr);
+}
+
+} // namespace qcc
+
+#endif
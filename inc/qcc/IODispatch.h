@@ -25,6 +25,7 @@
 #include <qcc/platform.h>
 
 #include <qcc/Stream.h>
+#include <qcc/atomic.h>
 #include <qcc/Timer.h>
 #include <Status.h>
 #include <map>
@@ -191,7 +192,14 @@ struct IODispatchEntry {
 
 class IODispatch : public Thread, public AlarmListener {
   public:
-    IODispatch(const char* name, uint32_t concurrency);
+    /**
+     * Constructor
+     *
+     * @param name         Name for the dispatcher and its timer threads.
+     * @param concurrency  Number of timer threads used to dispatch callbacks.
+     * @param attributes   Attributes for the dispatcher and timer threads (stack size, CPU affinity, scheduling policy).
+     */
+    IODispatch(const char* name, uint32_t concurrency, const ThreadAttributes& attributes = ThreadAttributes());
     ~IODispatch();
 
     /**
@@ -316,14 +324,14 @@ class IODispatch : public Thread, public AlarmListener {
     Timer timer;                                /* The timer used to add and process callbacks */
     Mutex lock;                                 /* Lock for mutual exclusion of dispatchEntries */
     std::map<Stream*, IODispatchEntry> dispatchEntries; /* map holding details of various streams registered with this IODispatch */
-    bool reload;                                /* Flag used for synchronization of various methods with the Run thread */
-    bool isRunning;                             /* Whether the run thread is still running. */
+    Atomic<bool> reload;                        /* Flag used for synchronization of various methods with the Run thread */
+    Atomic<bool> isRunning;                     /* Whether the run thread is still running. */
     int32_t numAlarmsInProgress;                /* Number of alarms currently in progress. */
     /* Whether the main loop is in an event wait.
      * This is used to ensure that a source/sink event is not deleted while the main thread
      * is waiting on it.
      */
-    bool crit;
+    Atomic<bool> crit;
 };
 
 
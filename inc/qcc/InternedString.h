@@ -0,0 +1,159 @@
+/**
+ * @file
+ *
+ * Shared, process wide storage for frequently repeated names.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#ifndef _QCC_INTERNEDSTRING_H
+#define _QCC_INTERNEDSTRING_H
+
+#include <qcc/platform.h>
+
+#include <qcc/String.h>
+#include <qcc/StringRef.h>
+#include <qcc/STLContainer.h>
+
+namespace qcc {
+
+/** @internal Storage for one interned string */
+struct InternedStringEntry;
+
+/**
+ * An InternedString is a handle to the single shared copy of a string held in
+ * a global table.  Interning the same characters twice gives the same handle,
+ * so equality is a pointer comparison and the hash is computed only once.
+ *
+ * The table is split into shards with their own locks for inserting; looking
+ * up a string that is already interned takes no locks.  Interned strings are
+ * never freed, so this is meant for names drawn from a limited vocabulary
+ * such as interface and member names or module tags.
+ */
+class InternedString {
+  public:
+
+    /**
+     * Construct the empty string.
+     */
+    InternedString() : entry(NULL) { }
+
+    /**
+     * Intern a string.
+     *
+     * @param str  The characters to intern.
+     */
+    explicit InternedString(const qcc::StringRef& str);
+
+    /**
+     * Intern a string.
+     *
+     * @param str  The string to intern.
+     */
+    explicit InternedString(const qcc::String& str);
+
+    /**
+     * Intern a nul terminated string.
+     *
+     * @param str  The string to intern.
+     */
+    explicit InternedString(const char* str);
+
+    /**
+     * Get the handle for a string if it has already been interned, without
+     * adding it to the table.
+     *
+     * @param str  The characters to look up.
+     * @return  The handle, or the empty string if str is not interned.
+     */
+    static InternedString Lookup(const qcc::StringRef& str);
+
+    /**
+     * Get the number of strings in the table.
+     *
+     * @return  The number of interned strings.
+     */
+    static size_t Count();
+
+    /**
+     * Get the interned string.  Copies of it share its storage.
+     *
+     * @return  The string.
+     */
+    const qcc::String& str() const;
+
+    /**
+     * Get the interned string as a nul terminated C string.
+     *
+     * @return  The characters.
+     */
+    const char* c_str() const { return str().c_str(); }
+
+    /**
+     * Get the length of the string.
+     *
+     * @return  The number of characters.
+     */
+    size_t size() const { return str().size(); }
+
+    /**
+     * Return true if this is the empty string.
+     *
+     * @return true iff empty.
+     */
+    bool empty() const { return entry == NULL; }
+
+    /**
+     * Get the hash of the string, the same as StringRef::hash() computes.
+     *
+     * @return  The hash.
+     */
+    size_t hash() const;
+
+    /**
+     * Equality, a pointer comparison.
+     */
+    bool operator==(const InternedString& other) const { return entry == other.entry; }
+
+    /**
+     * Inequality, a pointer comparison.
+     */
+    bool operator!=(const InternedString& other) const { return entry != other.entry; }
+
+    /**
+     * Lexicographical ordering of the strings, so that ordered containers keep
+     * the same order as they would with qcc::String.
+     */
+    bool operator<(const InternedString& other) const { return (entry != other.entry) && (str() < other.str()); }
+
+  private:
+    const InternedStringEntry* entry;
+};
+
+}
+
+_BEGIN_NAMESPACE_CONTAINER_FOR_HASH
+/**
+ * Functor to compute a hash for InternedString suitable for use with
+ * std::tr1::unordered_map, std::unordered_set, std::hash_map, std::hash_set.
+ */
+template <>
+struct tr1::hash<qcc::InternedString> {
+    inline size_t operator()(const qcc::InternedString& s) const { return s.hash(); }
+};
+_END_NAMESPACE_CONTAINER_FOR_HASH
+
+#endif
@@ -0,0 +1,126 @@
+/**
+ * @file
+ *
+ * A group of listening sockets sharing one address and port.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#ifndef _QCC_LISTENERGROUP_H
+#define _QCC_LISTENERGROUP_H
+
+#include <qcc/platform.h>
+
+#include <vector>
+
+#include <qcc/IPAddress.h>
+#include <qcc/Socket.h>
+#include <qcc/SocketStream.h>
+#include <qcc/SocketTypes.h>
+
+#include <Status.h>
+
+namespace qcc {
+
+/**
+ * A ListenerGroup is a set of listening sockets bound with SetReusePort() to
+ * the same address and port.  The kernel spreads incoming connections across
+ * them, so each can be served by its own thread or IODispatch without the
+ * threads sharing one accept queue and its lock.
+ *
+ * Each listener is a non-blocking SocketStream.  Either pass it to
+ * IODispatch::StartStream() and call AcceptMany() on its socket from the read
+ * callback, or wait on its source event from a dedicated thread.
+ *
+ * With CPU steering (Linux only, see SetReusePortCpuSteering()) a connection
+ * goes to listener (CPU % count) where CPU is the one that received it, so the
+ * thread serving listener i should be pinned to CPU i with ThreadAttributes.
+ * Without it the kernel hashes the connection's addresses.
+ *
+ * Load is only spread on platforms where SO_REUSEPORT balances connections
+ * (Linux 3.9 and later); elsewhere use a group of one.
+ */
+class ListenerGroup {
+  public:
+
+    /** Construct an empty group */
+    ListenerGroup() : port(0) { }
+
+    /** Destructor closes the listeners */
+    ~ListenerGroup() { Close(); }
+
+    /**
+     * Open, bind and listen on the sockets of the group.
+     *
+     * @param family       Address family.
+     * @param addr         IP Address to listen on (maybe 0.0.0.0 or ::).
+     * @param localPort    IP Port to listen on, or 0 for one chosen by the system.
+     * @param count        Number of listeners.
+     * @param backlog      Number of pending connections to queue on each listener.
+     * @param steerByCpu   true to steer connections by the CPU that received them.
+     *                     If that is not supported it is logged and the kernel's
+     *                     default distribution is used.
+     *
+     * @return
+     *      - ER_OK on success.
+     *      - ER_BAD_ARG_4 if count is 0.
+     *      - ER_FAIL if the group is already open.
+     *      - An error from opening, binding or listening on a socket.  No
+     *        listeners are left open.
+     */
+    QStatus Listen(AddressFamily family, const IPAddress& addr, uint16_t localPort, size_t count, int backlog, bool steerByCpu = false);
+
+    /**
+     * Close all the listeners.  They must not be attached to an IODispatch.
+     */
+    void Close();
+
+    /**
+     * Get the number of listeners.
+     *
+     * @return  The number of listeners, 0 if the group is not open.
+     */
+    size_t GetCount() const { return listeners.size(); }
+
+    /**
+     * Get the port the group is listening on.
+     *
+     * @return  The port, useful when Listen() was passed 0.
+     */
+    uint16_t GetPort() const { return port; }
+
+    /**
+     * Get one of the listeners.
+     *
+     * @param index  Index of the listener, less than GetCount().
+     *
+     * @return  The listener.
+     */
+    SocketStream& GetListener(size_t index) { return *listeners[index]; }
+
+  private:
+
+    /* Private copy constructor and assignment operator to prevent copying */
+    ListenerGroup(const ListenerGroup& other);
+    ListenerGroup& operator=(const ListenerGroup& other);
+
+    std::vector<SocketStream*> listeners;   /**< The listening sockets */
+    uint16_t port;                          /**< The port all listeners are bound to */
+};
+
+}
+
+#endif
@@ -0,0 +1,136 @@
+/**
+ * @file
+ *
+ * Per call site lock contention statistics.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#ifndef _QCC_LOCKPROFILER_H
+#define _QCC_LOCKPROFILER_H
+
+#include <qcc/platform.h>
+#include <qcc/String.h>
+
+#include <vector>
+
+namespace qcc {
+
+/**
+ * Collects contention statistics for every Mutex call site that locks with
+ * MUTEX_CONTEXT (i.e. through Mutex::Lock(file, line)).
+ *
+ * Profiling is off by default and can be switched on and off at run time in
+ * both debug and release builds.  While it is off, the cost to Mutex is one
+ * extra test per Lock(file, line).  While it is on, an uncontended Lock() costs
+ * two clock reads and a statistics update; a contended Lock() also times the
+ * wait.
+ *
+ * Hold times are measured from Lock(file, line) to the next Unlock() of the
+ * same Mutex and charged to the call site that locked it.  For recursively
+ * locked Mutexes this is the time to the first Unlock().
+ *
+ * Only the POSIX Mutex feeds the profiler at present.
+ */
+class LockProfiler {
+  public:
+
+    /**
+     * Number of buckets in the wait time histograms.  Bucket 0 counts waits
+     * shorter than 1us, bucket i (0 < i < WAIT_BUCKETS - 1) waits of
+     * [2^(i-1), 2^i) us and the last bucket everything longer.
+     */
+    static const uint32_t WAIT_BUCKETS = 16;
+
+    /**
+     * Statistics for one call site.
+     */
+    struct SiteStats {
+        const char* file;               ///< Source file of the call site.
+        uint32_t line;                  ///< Line of the call site.
+        uint64_t acquisitions;          ///< Number of times the lock was acquired here.
+        uint64_t contentions;           ///< Number of those that had to wait.
+        uint64_t totalWaitNs;           ///< Total time spent waiting.
+        uint64_t maxWaitNs;             ///< Longest wait.
+        uint64_t totalHoldNs;           ///< Total time the lock was held.
+        uint64_t maxHoldNs;             ///< Longest hold.
+        uint64_t waitHistogram[WAIT_BUCKETS]; ///< Distribution of contended waits.
+    };
+
+    /**
+     * Switch profiling on or off.  Statistics gathered so far are kept.
+     *
+     * @param enable  true to start profiling, false to stop.
+     */
+    static void Enable(bool enable) { enabled = enable; }
+
+    /**
+     * @return true iff profiling is on.
+     */
+    static bool IsEnabled() { return enabled; }
+
+    /**
+     * Discard all statistics gathered so far.
+     */
+    static void Reset();
+
+    /**
+     * Get the statistics of all call sites, hottest first.  Call sites are
+     * ranked by total wait time, then by number of contended acquisitions.
+     *
+     * @param stats  Returns the statistics.
+     */
+    static void GetStats(std::vector<SiteStats>& stats);
+
+    /**
+     * Format the statistics of the hottest call sites as a table.
+     *
+     * @param maxSites  Maximum number of call sites to include.
+     * @return The table.
+     */
+    static qcc::String Dump(size_t maxSites = 20);
+
+    /**
+     * @return A monotonic timestamp in nanoseconds.  For use by Mutex.
+     */
+    static uint64_t Now();
+
+    /**
+     * Record an acquisition.  For use by Mutex.
+     *
+     * @param file       Source file of the call site.
+     * @param line       Line of the call site.
+     * @param contended  true iff the lock was not immediately available.
+     * @param waitNs     Time spent waiting if contended.
+     */
+    static void Acquired(const char* file, uint32_t line, bool contended, uint64_t waitNs);
+
+    /**
+     * Record a release.  For use by Mutex.
+     *
+     * @param file    Source file of the call site that acquired the lock.
+     * @param line    Line of the call site that acquired the lock.
+     * @param holdNs  Time the lock was held.
+     */
+    static void Released(const char* file, uint32_t line, uint64_t holdNs);
+
+  private:
+    static volatile bool enabled;
+};
+
+}
+
+#endif
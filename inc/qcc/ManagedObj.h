@@ -36,10 +36,18 @@
 #include <stdlib.h>
 #include <assert.h>
 
+#if defined(QCC_HAS_VARIADIC_TEMPLATES)
+#include <type_traits>
+#include <utility>
+#endif
+
 #include <qcc/atomic.h>
+#include <qcc/Allocator.h>
+#include <qcc/RefCount.h>
 
 namespace qcc {
 
+template <class T, class RefCount> class ManagedObjWeak;
 
 /**
  * ManagedObj manages heap allocation and reference counting for a template parameter type T.
@@ -48,19 +56,52 @@ namespace qcc {
  * underlying heap allocated T's reference count is incremented. Each time a ManagedObj instance
  * is destructed, the underlying T reference count is decremented. When the reference count reaches
  * zero, T itself is deallocated using delete.
+ *
+ * With a C++11 compiler the constructor arguments are forwarded to T's
+ * constructor as they were passed, so temporaries can be moved into T, and
+ * MakeManaged@<T@>(args...) creates a managed object in one expression.
+ * Moving a ManagedObj transfers the reference without touching the count and
+ * leaves the moved-from ManagedObj empty; it may only be assigned to or
+ * destroyed.
+ *
+ * The memory comes from the current qcc::Allocator, which by default is a
+ * pool of small blocks, and the number of live objects of each managed type
+ * is counted (see GetStats()).
+ *
+ * RefCount is the reference count policy.  The default, AtomicRefCount, lets
+ * copies of a ManagedObj be made and released on any thread.  An object that
+ * never leaves the thread that created it can use
+ * ManagedObj@<T, SingleThreadRefCount@>, which copies without locked
+ * instructions and asserts in debug builds if used from another thread.
+ *
+ * ManagedObjWeak@<T@> holds a reference that does not keep T alive.
  */
-template <class T>
+template <class T, class RefCount = AtomicRefCount>
 class ManagedObj {
   private:
 
-    static const uint32_t ManagedCtxMagic = (('M') | ('C' << 8) | (('T' << 16)  + ('X' << 24)));
+    template <class T2, class RefCount2> friend class ManagedObjWeak;
 
+    /*
+     * The context is freed when weakCount reaches zero.  All of the strong
+     * references together hold one weak reference, which is released when T
+     * is destroyed.
+     */
     struct ManagedCtx {
-        ManagedCtx(int32_t refCount) : refCount(refCount), magic(ManagedCtxMagic) { }
-        int32_t refCount;
-        uint32_t magic;
+        ManagedCtx(int32_t refCount, uint16_t allocator) : refCount(refCount), weakCount(1), magic(RefCount::Magic), allocator(allocator), stats(&ManagedObj::stats) { }
+        RefCount refCount;
+        RefCount weakCount;   /**< Number of ManagedObjWeak references plus one while T is alive */
+        uint16_t magic;       /**< Identifies the reference count policy */
+        uint16_t allocator;   /**< Allocator the context came from */
+        AllocStats* stats;    /**< Counts for the type the context was allocated for */
     };
 
+    /** Offset of T from the start of its context */
+    static const size_t Offset = (sizeof(ManagedCtx) + 7) & ~0x07;
+
+    /** Live object counts for T */
+    static AllocStats stats;
+
     ManagedCtx* context;
     T* object;
 
@@ -70,7 +111,7 @@ class ManagedObj {
     typedef T ManagedType;
 
     /** Copy constructor */
-    ManagedObj<T>(const ManagedObj<T>&copyMe)
+    ManagedObj(const ManagedObj&copyMe)
     {
         context = copyMe.context;
         object = copyMe.object;
@@ -78,13 +119,22 @@ class ManagedObj {
     }
 
     /** non-const Copy constructor needed to avoid ambiguity with ManagedObj<T>(A1& arg) constructor */
-    ManagedObj<T>(ManagedObj<T>&copyMe)
+    ManagedObj(ManagedObj&copyMe)
     {
         context = copyMe.context;
         object = copyMe.object;
         IncRef();
     }
 
+#if defined(QCC_HAS_RVALUE_REFERENCES)
+    /** Move constructor, takes over the reference held by other */
+    ManagedObj(ManagedObj&& other) : context(other.context), object(other.object)
+    {
+        other.context = NULL;
+        other.object = NULL;
+    }
+#endif
+
     /**
      * Create a copy of managed object T.
      *
@@ -100,14 +150,12 @@ class ManagedObj {
      * @param other   ManagedObject to make a copy of.
      * @param isDeep  Specify if this is a deep (clone) copy or a normal copy
      */
-    ManagedObj<T>(const ManagedObj<T>&other, bool isDeep)
+    ManagedObj(const ManagedObj&other, bool isDeep)
     {
         if (isDeep) {
             /* Deep copy */
-            const size_t offset = (sizeof(ManagedCtx) + 7) & ~0x07;
-            context = reinterpret_cast<ManagedCtx*>(malloc(offset + sizeof(T)));
-            context = new (context) ManagedCtx(1);
-            object = new ((char*)context + offset)T(*other);
+            context = NewContext();
+            object = new ((char*)context + Offset)T(*other);
         } else {
             /* Normal copy constructor (inc ref) of existing object */
             context = other.context;
@@ -117,12 +165,10 @@ class ManagedObj {
     }
 
     /** Allocate T() on the heap and set it's reference count to 1. */
-    ManagedObj<T>()
+    ManagedObj()
     {
-        const size_t offset = (sizeof(ManagedCtx) + 7) & ~0x07;
-        context = reinterpret_cast<ManagedCtx*>(malloc(offset + sizeof(T)));
-        context = new (context) ManagedCtx(1);
-        object = new ((char*)context + offset)T();
+        context = NewContext();
+        object = new ((char*)context + Offset)T();
     }
 
     /**
@@ -133,10 +179,9 @@ class ManagedObj {
      * @param naked  A unwrapped managed object instance.
      * @returns      The managed object instance re-wrapped in a ManageObj template class
      */
-    static ManagedObj<T> wrap(T* naked)
+    static ManagedObj wrap(T* naked)
     {
-        static const size_t offset = (sizeof(ManagedCtx) + 7) & ~0x07;
-        return ManagedObj<T>((ManagedCtx*)((char*)naked - offset), naked);
+        return ManagedObj((ManagedCtx*)((char*)naked - Offset), naked);
     }
 
     /**
@@ -145,22 +190,37 @@ class ManagedObj {
      * @param other  A managed object instance of a related type.
      * @returns      A managed object cast to the required type
      */
-    template <class T2> static ManagedObj<T> cast(T2& other)
+    template <class T2> static ManagedObj cast(T2& other)
     {
-        static const size_t offset = (sizeof(ManagedCtx) + 7) & ~0x07;
-        return ManagedObj<T>((ManagedCtx*)((char*)other.unwrap() - offset), static_cast<T*>(other.unwrap()));
+        return ManagedObj((ManagedCtx*)((char*)other.unwrap() - Offset), static_cast<T*>(other.unwrap()));
     }
 
+#if defined(QCC_HAS_VARIADIC_TEMPLATES)
+    /**
+     * Allocate T(args...) on the heap and set it's reference count to 1.
+     * The arguments are perfectly forwarded so rvalues are moved into T.
+     *
+     * This does not take part in overload resolution when the first argument
+     * is itself a ManagedObj<T>, so copies and moves use the constructors above.
+     *
+     * @param arg1   First arg to T constructor.
+     * @param args   Remaining args to T constructor.
+     */
+    template <typename A1, typename ... Args, typename = typename std::enable_if<!std::is_base_of<ManagedObj, typename std::decay<A1>::type>::value>::type>
+    ManagedObj(A1 && arg1, Args && ... args)
+    {
+        context = NewContext();
+        object = new ((char*)context + Offset)T(std::forward<A1>(arg1), std::forward<Args>(args) ...);
+    }
+#else
     /**
      * Allocate T(arg1) on the heap and set it's reference count to 1.
      * @param arg1   First arg to T constructor.
      */
-    template <typename A1> ManagedObj<T>(A1 & arg1)
+    template <typename A1> ManagedObj(A1 & arg1)
     {
-        const size_t offset = (sizeof(ManagedCtx) + 7) & ~0x07;
-        context = reinterpret_cast<ManagedCtx*>(malloc(offset + sizeof(T)));
-        context = new (context) ManagedCtx(1);
-        object = new ((char*)context + offset)T(arg1);
+        context = NewContext();
+        object = new ((char*)context + Offset)T(arg1);
     }
 
     /**
@@ -168,12 +228,10 @@ class ManagedObj {
      * @param arg1   First arg to T constructor.
      * @param arg2   Second arg to T constructor.
      */
-    template <typename A1, typename A2> ManagedObj<T>(A1 & arg1, A2 & arg2)
+    template <typename A1, typename A2> ManagedObj(A1 & arg1, A2 & arg2)
     {
-        const size_t offset = (sizeof(ManagedCtx) + 7) & ~0x07;
-        context = reinterpret_cast<ManagedCtx*>(malloc(offset + sizeof(T)));
-        context = new (context) ManagedCtx(1);
-        object = new ((char*)context + offset)T(arg1, arg2);
+        context = NewContext();
+        object = new ((char*)context + Offset)T(arg1, arg2);
     }
 
     /**
@@ -182,12 +240,10 @@ class ManagedObj {
      * @param arg2   Second arg to T constructor.
      * @param arg3   Third arg to T constructor.
      */
-    template <typename A1, typename A2, typename A3> ManagedObj<T>(A1 & arg1, A2 & arg2, A3 & arg3)
+    template <typename A1, typename A2, typename A3> ManagedObj(A1 & arg1, A2 & arg2, A3 & arg3)
     {
-        const size_t offset = (sizeof(ManagedCtx) + 7) & ~0x07;
-        context = reinterpret_cast<ManagedCtx*>(malloc(offset + sizeof(T)));
-        context = new (context) ManagedCtx(1);
-        object = new ((char*)context + offset)T(arg1, arg2, arg3);
+        context = NewContext();
+        object = new ((char*)context + Offset)T(arg1, arg2, arg3);
     }
 
     /**
@@ -197,12 +253,10 @@ class ManagedObj {
      * @param arg3   Third arg to T constructor.
      * @param arg4   Fourth arg to T constructor.
      */
-    template <typename A1, typename A2, typename A3, typename A4> ManagedObj<T>(A1 & arg1, A2 & arg2, A3 & arg3, A4 & arg4)
+    template <typename A1, typename A2, typename A3, typename A4> ManagedObj(A1 & arg1, A2 & arg2, A3 & arg3, A4 & arg4)
     {
-        const size_t offset = (sizeof(ManagedCtx) + 7) & ~0x07;
-        context = reinterpret_cast<ManagedCtx*>(malloc(offset + sizeof(T)));
-        context = new (context) ManagedCtx(1);
-        object = new ((char*)context + offset)T(arg1, arg2, arg3, arg4);
+        context = NewContext();
+        object = new ((char*)context + Offset)T(arg1, arg2, arg3, arg4);
     }
 
     /**
@@ -213,12 +267,10 @@ class ManagedObj {
      * @param arg4   Fourth arg to T constructor.
      * @param arg5   Fifth arg to T constructor.
      */
-    template <typename A1, typename A2, typename A3, typename A4, typename A5> ManagedObj<T>(A1 & arg1, A2 & arg2, A3 & arg3, A4 & arg4, A5 & arg5)
+    template <typename A1, typename A2, typename A3, typename A4, typename A5> ManagedObj(A1 & arg1, A2 & arg2, A3 & arg3, A4 & arg4, A5 & arg5)
     {
-        const size_t offset = (sizeof(ManagedCtx) + 7) & ~0x07;
-        context = reinterpret_cast<ManagedCtx*>(malloc(offset + sizeof(T)));
-        context = new (context) ManagedCtx(1);
-        object = new ((char*)context + offset)T(arg1, arg2, arg3, arg4, arg5);
+        context = NewContext();
+        object = new ((char*)context + Offset)T(arg1, arg2, arg3, arg4, arg5);
     }
 
     /**
@@ -230,12 +282,10 @@ class ManagedObj {
      * @param arg5   Fifth arg to T constructor.
      * @param arg6   Sixth arg to T constructor.
      */
-    template <typename A1, typename A2, typename A3, typename A4, typename A5, typename A6> ManagedObj<T>(A1 & arg1, A2 & arg2, A3 & arg3, A4 & arg4, A5 & arg5, A6 & arg6)
+    template <typename A1, typename A2, typename A3, typename A4, typename A5, typename A6> ManagedObj(A1 & arg1, A2 & arg2, A3 & arg3, A4 & arg4, A5 & arg5, A6 & arg6)
     {
-        const size_t offset = (sizeof(ManagedCtx) + 7) & ~0x07;
-        context = reinterpret_cast<ManagedCtx*>(malloc(offset + sizeof(T)));
-        context = new (context) ManagedCtx(1);
-        object = new ((char*)context + offset)T(arg1, arg2, arg3, arg4, arg5, arg6);
+        context = NewContext();
+        object = new ((char*)context + Offset)T(arg1, arg2, arg3, arg4, arg5, arg6);
     }
 
     /**
@@ -248,12 +298,10 @@ class ManagedObj {
      * @param arg6   Sixth arg to T constructor.
      * @param arg7   Seventh arg to T constructor.
      */
-    template <typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7> ManagedObj<T>(A1 & arg1, A2 & arg2, A3 & arg3, A4 & arg4, A5 & arg5, A6 & arg6, A7 & arg7)
+    template <typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7> ManagedObj(A1 & arg1, A2 & arg2, A3 & arg3, A4 & arg4, A5 & arg5, A6 & arg6, A7 & arg7)
     {
-        const size_t offset = (sizeof(ManagedCtx) + 7) & ~0x07;
-        context = reinterpret_cast<ManagedCtx*>(malloc(offset + sizeof(T)));
-        context = new (context) ManagedCtx(1);
-        object = new ((char*)context + offset)T(arg1, arg2, arg3, arg4, arg5, arg6, arg7);
+        context = NewContext();
+        object = new ((char*)context + Offset)T(arg1, arg2, arg3, arg4, arg5, arg6, arg7);
     }
 
     /**
@@ -267,12 +315,10 @@ class ManagedObj {
      * @param arg7   Seventh arg to T constructor.
      * @param arg8   Eight arg to T constructor.
      */
-    template <typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8> ManagedObj<T>(A1 & arg1, A2 & arg2, A3 & arg3, A4 & arg4, A5 & arg5, A6 & arg6, A7 & arg7, A8 & arg8)
+    template <typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8> ManagedObj(A1 & arg1, A2 & arg2, A3 & arg3, A4 & arg4, A5 & arg5, A6 & arg6, A7 & arg7, A8 & arg8)
     {
-        const size_t offset = (sizeof(ManagedCtx) + 7) & ~0x07;
-        context = reinterpret_cast<ManagedCtx*>(malloc(offset + sizeof(T)));
-        context = new (context) ManagedCtx(1);
-        object = new ((char*)context + offset)T(arg1, arg2, arg3, arg4, arg5, arg6, arg7, arg8);
+        context = NewContext();
+        object = new ((char*)context + Offset)T(arg1, arg2, arg3, arg4, arg5, arg6, arg7, arg8);
     }
 
     /**
@@ -287,12 +333,10 @@ class ManagedObj {
      * @param arg8   Eight arg to T constructor.
      * @param arg9   Ninth arg to T constructor.
      */
-    template <typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9> ManagedObj<T>(A1 & arg1, A2 & arg2, A3 & arg3, A4 & arg4, A5 & arg5, A6 & arg6, A7 & arg7, A8 & arg8, A9 & arg9)
+    template <typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9> ManagedObj(A1 & arg1, A2 & arg2, A3 & arg3, A4 & arg4, A5 & arg5, A6 & arg6, A7 & arg7, A8 & arg8, A9 & arg9)
     {
-        const size_t offset = (sizeof(ManagedCtx) + 7) & ~0x07;
-        context = reinterpret_cast<ManagedCtx*>(malloc(offset + sizeof(T)));
-        context = new (context) ManagedCtx(1);
-        object = new ((char*)context + offset)T(arg1, arg2, arg3, arg4, arg5, arg6, arg7, arg8, arg9);
+        context = NewContext();
+        object = new ((char*)context + Offset)T(arg1, arg2, arg3, arg4, arg5, arg6, arg7, arg8, arg9);
     }
 
     /**
@@ -308,19 +352,18 @@ class ManagedObj {
      * @param arg9   Ninth arg to T constructor.
      * @param arg10  Tenth arg to T constructor.
      */
-    template <typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10> ManagedObj<T>(A1 & arg1, A2 & arg2, A3 & arg3, A4 & arg4, A5 & arg5, A6 & arg6, A7 & arg7, A8 & arg8, A9 & arg9, A10 & arg10)
+    template <typename A1, typename A2, typename A3, typename A4, typename A5, typename A6, typename A7, typename A8, typename A9, typename A10> ManagedObj(A1 & arg1, A2 & arg2, A3 & arg3, A4 & arg4, A5 & arg5, A6 & arg6, A7 & arg7, A8 & arg8, A9 & arg9, A10 & arg10)
     {
-        const size_t offset = (sizeof(ManagedCtx) + 7) & ~0x07;
-        context = reinterpret_cast<ManagedCtx*>(malloc(offset + sizeof(T)));
-        context = new (context) ManagedCtx(1);
-        object = new ((char*)context + offset)T(arg1, arg2, arg3, arg4, arg5, arg6, arg7, arg8, arg9, arg10);
+        context = NewContext();
+        object = new ((char*)context + Offset)T(arg1, arg2, arg3, arg4, arg5, arg6, arg7, arg8, arg9, arg10);
     }
+#endif
 
     /**
      * ManagedObj destructor.
      * Decrement T's reference count and deallocate if zero.
      */
-    ~ManagedObj<T>()
+    ~ManagedObj()
     {
         DecRef();
     }
@@ -330,7 +373,7 @@ class ManagedObj {
      * @param assignFromMe   ManagedObj<T> to copy from.
      * @return reference to this MangedObj<T>.
      */
-    ManagedObj<T>& operator=(const ManagedObj<T>& assignFromMe)
+    ManagedObj& operator=(const ManagedObj& assignFromMe)
     {
         /* Decrement ref of current context */
         DecRef();
@@ -345,12 +388,32 @@ class ManagedObj {
         return *this;
     }
 
+#if defined(QCC_HAS_RVALUE_REFERENCES)
+    /**
+     * Move a ManagedObj<T> into an existing ManagedObj<T>, taking over its
+     * reference without changing the reference count.
+     * @param other   ManagedObj<T> to move from. It is left empty.
+     * @return reference to this MangedObj<T>.
+     */
+    ManagedObj& operator=(ManagedObj&& other)
+    {
+        if (&other != this) {
+            DecRef();
+            context = other.context;
+            object = other.object;
+            other.context = NULL;
+            other.object = NULL;
+        }
+        return *this;
+    }
+#endif
+
     /**
      * Equality for managed objects is whatever equality means for @<T@>
      * @param other  The other managed object to compare.
      * @return  true if the managed objects are equal.
      */
-    bool operator==(const ManagedObj<T>& other) const { return (object == other.object) || (*object == *other.object); }
+    bool operator==(const ManagedObj& other) const { return (object == other.object) || (*object == *other.object); }
 
     /**
      * Returns true if the two managed objects managed the same object. This is a more strict
@@ -359,21 +422,21 @@ class ManagedObj {
      * @param other  The other managed object to compare.
      * @return  true if the managed objects refer to the same underlying object.
      */
-    template <class T2> bool iden(const ManagedObj<T2>& other) const { return ((ptrdiff_t)object == (ptrdiff_t)other.unwrap()); }
+    template <class T2, class RefCount2> bool iden(const ManagedObj<T2, RefCount2>& other) const { return ((ptrdiff_t)object == (ptrdiff_t)other.unwrap()); }
 
     /**
      * Inequality for managed objects is whatever inequality means for @<T@>
      * @param other  The other managed object to compare.
      * @return  true if the managed objects are equal.
      */
-    bool operator!=(const ManagedObj<T>& other) const { return !(*this == other); }
+    bool operator!=(const ManagedObj& other) const { return !(*this == other); }
 
     /**
      * Less-than for managed objects is whatever less-than means for @<T@>
      * @param other  The other managed object to compare.
      * @return  true if the managed objects are equal.
      */
-    bool operator<(const ManagedObj<T>& other) const { return (object != other.object) && (*object < *other.object); }
+    bool operator<(const ManagedObj& other) const { return (object != other.object) && (*object < *other.object); }
 
     /**
      * Get a reference to T.
@@ -412,18 +475,30 @@ class ManagedObj {
     /** Increment the ref count */
     void IncRef()
     {
-        IncrementAndFetch(&context->refCount);
+        if (context) {
+            context->refCount.Increment();
+        }
     }
 
     /** Decrement the ref count and deallocate if necessary. */
     void DecRef()
     {
-        uint32_t refs = DecrementAndFetch(&context->refCount);
+        /* A moved-from ManagedObj holds no reference */
+        if (!context) {
+            return;
+        }
+        int32_t refs = context->refCount.Decrement();
         if (0 == refs) {
             /* Call the overriden destructor */
             object->~T();
-            context->ManagedCtx::~ManagedCtx();
-            free(context);
+            /*
+             * With no strong references left no new weak references can be
+             * made, so if there are none now the context can be freed without
+             * touching the weak count.
+             */
+            if ((context->weakCount.Get() == 1) || (context->weakCount.Decrement() == 0)) {
+                FreeContext(context);
+            }
             context = NULL;
         }
     }
@@ -431,17 +506,209 @@ class ManagedObj {
     /**
      * Get the reference count
      */
-    int32_t GetRefCount() const { return context ? context->refCount : 0; }
+    int32_t GetRefCount() const { return context ? context->refCount.Get() : 0; }
+
+    /**
+     * Get the number of live ManagedObj<T> objects and the memory they use.
+     *
+     * @return  The counts for T.
+     */
+    static const AllocStats& GetStats() { return stats; }
 
   private:
 
-    ManagedObj<T>(ManagedCtx * context, T * object) : context(context), object(object)
+    /** Free a context once there are no references of either kind */
+    static void FreeContext(ManagedCtx* ctx)
+    {
+        /* The context may have been allocated for a type derived from T */
+        AllocStats* ctxStats = ctx->stats;
+        uint16_t allocator = ctx->allocator;
+        ctx->ManagedCtx::~ManagedCtx();
+        ctxStats->Remove(ctxStats->objectSize);
+        Allocator::FreeBlock(ctx, ctxStats->objectSize, allocator);
+    }
+
+    /** Allocate a context with room for T after it */
+    static ManagedCtx* NewContext()
+    {
+        uint16_t allocator;
+        void* mem = Allocator::AllocateBlock(stats.objectSize, allocator);
+        stats.Add(stats.objectSize, TypeName());
+        return new (mem) ManagedCtx(1, allocator);
+    }
+
+    /** Name used for T in the list of counts */
+    static const char* TypeName()
+    {
+#if defined(__GNUC__)
+        return __PRETTY_FUNCTION__;
+#elif defined(_MSC_VER)
+        return __FUNCSIG__;
+#else
+        return "ManagedObj";
+#endif
+    }
+
+    ManagedObj(ManagedCtx * context, T * object) : context(context), object(object)
     {
-        assert(context->magic == ManagedCtxMagic);
+        assert(context->magic == RefCount::Magic);
         IncRef();
     }
+
+    /** Take over a reference that has already been counted, or make an empty ManagedObj */
+    ManagedObj(ManagedCtx * context, T * object, bool addRef) : context(context), object(object)
+    {
+        if (addRef) {
+            IncRef();
+        }
+    }
 };
 
+/**
+ * A weak reference to a ManagedObj@<T@>.  It does not keep T alive: T is
+ * destroyed as soon as the last ManagedObj referencing it goes away, so
+ * observers and listeners that point back at their owner do not hold it in
+ * memory or form reference cycles.  lock() gets a ManagedObj for T if it
+ * still exists.
+ *
+ * Only the small context block that T lived in is kept until the last weak
+ * reference is released; any memory T owned is freed when T is destroyed.
+ */
+template <class T, class RefCount = AtomicRefCount>
+class ManagedObjWeak {
+  public:
+
+    /** Construct a weak reference to nothing */
+    ManagedObjWeak() : context(NULL), object(NULL) { }
+
+    /**
+     * Construct a weak reference to the object of a ManagedObj.
+     *
+     * @param strong  The ManagedObj.
+     */
+    ManagedObjWeak(const ManagedObj<T, RefCount>& strong) : context(strong.context), object(strong.object)
+    {
+        IncWeak();
+    }
+
+    /** Copy constructor */
+    ManagedObjWeak(const ManagedObjWeak& other) : context(other.context), object(other.object)
+    {
+        IncWeak();
+    }
+
+    /** Destructor */
+    ~ManagedObjWeak()
+    {
+        DecWeak();
+    }
+
+    /**
+     * Assign another weak reference.
+     *
+     * @param other  The weak reference to copy.
+     * @return  Reference to this weak reference.
+     */
+    ManagedObjWeak& operator=(const ManagedObjWeak& other)
+    {
+        if (&other != this) {
+            DecWeak();
+            context = other.context;
+            object = other.object;
+            IncWeak();
+        }
+        return *this;
+    }
+
+    /**
+     * Make this a weak reference to the object of a ManagedObj.
+     *
+     * @param strong  The ManagedObj.
+     * @return  Reference to this weak reference.
+     */
+    ManagedObjWeak& operator=(const ManagedObj<T, RefCount>& strong)
+    {
+        if (strong.context != context) {
+            DecWeak();
+            context = strong.context;
+            object = strong.object;
+            IncWeak();
+        }
+        return *this;
+    }
+
+    /**
+     * Get a strong reference to the object if it still exists.
+     *
+     * @return  A ManagedObj for the object, or an empty ManagedObj (with a
+     *          reference count of 0 and unwrap() returning NULL) if the object
+     *          has been destroyed.
+     */
+    ManagedObj<T, RefCount> lock() const
+    {
+        typedef typename ManagedObj<T, RefCount>::ManagedCtx StrongCtx;
+        if (context && context->refCount.TryIncrement()) {
+            return ManagedObj<T, RefCount>(context, object, false);
+        }
+        return ManagedObj<T, RefCount>(static_cast<StrongCtx*>(NULL), static_cast<T*>(NULL), false);
+    }
+
+    /**
+     * Find out if the object has been destroyed.  The answer may be out of
+     * date by the time it is used if other threads hold references; use lock()
+     * to get the object.
+     *
+     * @return  true if there is no object.
+     */
+    bool expired() const { return !context || (context->refCount.Get() == 0); }
+
+    /**
+     * Drop the reference, leaving a weak reference to nothing.
+     */
+    void reset()
+    {
+        DecWeak();
+        context = NULL;
+        object = NULL;
+    }
+
+  private:
+
+    typename ManagedObj<T, RefCount>::ManagedCtx* context;
+    T* object;
+
+    void IncWeak()
+    {
+        if (context) {
+            context->weakCount.Increment();
+        }
+    }
+
+    void DecWeak()
+    {
+        if (context && (context->weakCount.Decrement() == 0)) {
+            ManagedObj<T, RefCount>::FreeContext(context);
+        }
+    }
+};
+
+template <class T, class RefCount>
+AllocStats ManagedObj<T, RefCount>::stats = { NULL, ManagedObj<T, RefCount>::Offset + sizeof(T), 0, NULL };
+
+#if defined(QCC_HAS_VARIADIC_TEMPLATES)
+/**
+ * Allocate a managed T constructed from the given arguments, which are
+ * forwarded to T's constructor.
+ *
+ * @param args   Args to T constructor.
+ * @return  The new managed object with a reference count of 1.
+ */
+template <class T, class RefCount = AtomicRefCount, typename ... Args>
+inline ManagedObj<T, RefCount> MakeManaged(Args && ... args)
+{
+    return ManagedObj<T, RefCount>(std::forward<Args>(args) ...);
+}
+#endif
 
 }
 
@@ -0,0 +1,285 @@
+/**
+ * @file
+ *
+ * Bounded lock-free queue for any number of producers and consumers.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#ifndef _QCC_MPMCQUEUE_H
+#define _QCC_MPMCQUEUE_H
+
+#include <qcc/platform.h>
+#include <qcc/atomic.h>
+#include <qcc/Futex.h>
+#include <qcc/time.h>
+
+#include <Status.h>
+
+namespace qcc {
+
+/**
+ * A bounded first-in first-out queue that any number of threads may push to
+ * and pop from concurrently without taking a lock.
+ *
+ * This is Dmitry Vyukov's bounded MPMC queue.  Each slot carries a sequence
+ * number that tells producers and consumers whose turn it is, so a push or a
+ * pop is one compare-and-exchange on a shared index plus uncontended accesses
+ * to the slot.  The two indices live on separate cache lines.
+ *
+ * TryPush() and TryPop() never block.  Push() and Pop() spin briefly and then
+ * sleep on an EventCount until the queue is no longer full or empty.  Threads
+ * that only use TryPush() and TryPop() pay one fence and one load per call
+ * for the sleepers' benefit.
+ *
+ * T must be default constructible and assignable.  A popped slot is reset to
+ * T() so that it does not keep a reference alive.
+ */
+template <typename T>
+class MpmcQueue {
+  public:
+
+    /**
+     * Constructor
+     *
+     * @param capacity  Maximum number of queued items.  Rounded up to a power
+     *                  of two no smaller than 2.
+     */
+    MpmcQueue(size_t capacity) : cells(NULL), mask(0), enqueuePos(0), dequeuePos(0)
+    {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        mask = size - 1;
+        cells = new Cell[size];
+        for (size_t i = 0; i < size; ++i) {
+            cells[i].sequence.Store(i, MEMORY_ORDER_RELAXED);
+        }
+    }
+
+    /** Destructor */
+    ~MpmcQueue() { delete [] cells; }
+
+    /**
+     * Queue an item if there is room.
+     *
+     * @param item  Item to queue.
+     * @return  true if the item was queued, false if the queue was full.
+     */
+    bool TryPush(const T& item)
+    {
+        if (!Enqueue(item)) {
+            return false;
+        }
+        notEmpty.Notify();
+        return true;
+    }
+
+    /**
+     * Dequeue the oldest item if there is one.
+     *
+     * @param item  Returns the item.
+     * @return  true if an item was dequeued, false if the queue was empty.
+     */
+    bool TryPop(T& item)
+    {
+        if (!Dequeue(item)) {
+            return false;
+        }
+        notFull.Notify();
+        return true;
+    }
+
+    /**
+     * Queue an item, waiting for room if the queue is full.
+     *
+     * @param item   Item to queue.
+     * @param maxMs  Maximum time to wait in milliseconds.
+     * @return  ER_OK or ER_TIMEOUT.
+     */
+    QStatus Push(const T& item, uint32_t maxMs = Event::WAIT_FOREVER)
+    {
+        uint64_t deadline = Deadline(maxMs);
+        for (uint32_t spin = 0; spin < SPINS; ++spin) {
+            if (TryPush(item)) {
+                return ER_OK;
+            }
+        }
+        while (true) {
+            int32_t key = notFull.PrepareWait();
+            if (Enqueue(item)) {
+                notFull.CancelWait();
+                notEmpty.Notify();
+                return ER_OK;
+            }
+            if (notFull.Wait(key, Remaining(deadline)) == ER_TIMEOUT) {
+                return TryPush(item) ? ER_OK : ER_TIMEOUT;
+            }
+            if (TryPush(item)) {
+                return ER_OK;
+            }
+        }
+    }
+
+    /**
+     * Dequeue the oldest item, waiting for one if the queue is empty.
+     *
+     * @param item   Returns the item.
+     * @param maxMs  Maximum time to wait in milliseconds.
+     * @return  ER_OK or ER_TIMEOUT.
+     */
+    QStatus Pop(T& item, uint32_t maxMs = Event::WAIT_FOREVER)
+    {
+        uint64_t deadline = Deadline(maxMs);
+        for (uint32_t spin = 0; spin < SPINS; ++spin) {
+            if (TryPop(item)) {
+                return ER_OK;
+            }
+        }
+        while (true) {
+            int32_t key = notEmpty.PrepareWait();
+            if (Dequeue(item)) {
+                notEmpty.CancelWait();
+                notFull.Notify();
+                return ER_OK;
+            }
+            if (notEmpty.Wait(key, Remaining(deadline)) == ER_TIMEOUT) {
+                return TryPop(item) ? ER_OK : ER_TIMEOUT;
+            }
+            if (TryPop(item)) {
+                return ER_OK;
+            }
+        }
+    }
+
+    /**
+     * The number of items the queue can hold.
+     *
+     * @return  The capacity.
+     */
+    size_t Capacity() const { return mask + 1; }
+
+    /**
+     * The number of queued items.  Only a snapshot when other threads are
+     * using the queue.
+     *
+     * @return  The number of queued items.
+     */
+    size_t Size() const
+    {
+        size_t head = dequeuePos.Load(MEMORY_ORDER_RELAXED);
+        size_t tail = enqueuePos.Load(MEMORY_ORDER_RELAXED);
+        return (tail > head) ? (tail - head) : 0;
+    }
+
+  private:
+    MpmcQueue(const MpmcQueue& other);
+    MpmcQueue& operator=(const MpmcQueue& other);
+
+    /** Number of non-blocking attempts Push() and Pop() make before sleeping */
+    static const uint32_t SPINS = 64;
+
+    struct Cell {
+        Atomic<size_t> sequence;
+        T data;
+    };
+
+    bool Enqueue(const T& item)
+    {
+        size_t pos = enqueuePos.Load(MEMORY_ORDER_RELAXED);
+        while (true) {
+            Cell& cell = cells[pos & mask];
+            size_t seq = cell.sequence.Load(MEMORY_ORDER_ACQUIRE);
+            ptrdiff_t diff = static_cast<ptrdiff_t>(seq) - static_cast<ptrdiff_t>(pos);
+            if (diff == 0) {
+                /* The slot is free; claim it */
+                if (enqueuePos.CompareExchange(pos, pos + 1, MEMORY_ORDER_RELAXED)) {
+                    cell.data = item;
+                    cell.sequence.Store(pos + 1, MEMORY_ORDER_RELEASE);
+                    return true;
+                }
+            } else if (diff < 0) {
+                /* The slot still holds an item from the previous lap */
+                return false;
+            } else {
+                /* Another producer got here first */
+                pos = enqueuePos.Load(MEMORY_ORDER_RELAXED);
+            }
+        }
+    }
+
+    bool Dequeue(T& item)
+    {
+        size_t pos = dequeuePos.Load(MEMORY_ORDER_RELAXED);
+        while (true) {
+            Cell& cell = cells[pos & mask];
+            size_t seq = cell.sequence.Load(MEMORY_ORDER_ACQUIRE);
+            ptrdiff_t diff = static_cast<ptrdiff_t>(seq) - static_cast<ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                /* The slot holds an item; claim it */
+                if (dequeuePos.CompareExchange(pos, pos + 1, MEMORY_ORDER_RELAXED)) {
+                    item = cell.data;
+                    cell.data = T();
+                    cell.sequence.Store(pos + mask + 1, MEMORY_ORDER_RELEASE);
+                    return true;
+                }
+            } else if (diff < 0) {
+                /* Nothing has been pushed into the slot yet */
+                return false;
+            } else {
+                /* Another consumer got here first */
+                pos = dequeuePos.Load(MEMORY_ORDER_RELAXED);
+            }
+        }
+    }
+
+    static uint64_t Deadline(uint32_t maxMs)
+    {
+        return (maxMs == Event::WAIT_FOREVER) ? 0 : GetTimestamp64() + maxMs;
+    }
+
+    static uint32_t Remaining(uint64_t deadline)
+    {
+        if (deadline == 0) {
+            return Event::WAIT_FOREVER;
+        }
+        uint64_t now = GetTimestamp64();
+        return (now < deadline) ? static_cast<uint32_t>(deadline - now) : 0;
+    }
+
+    Cell* cells;
+    size_t mask;
+
+    /*
+     * Producers write enqueuePos and consumers write dequeuePos.  The padding
+     * keeps each on its own cache line, away from cells and mask which are
+     * only read.
+     */
+    char pad0[QCC_CACHE_LINE_SIZE];
+    Atomic<size_t> enqueuePos;
+    char pad1[QCC_CACHE_LINE_SIZE - sizeof(Atomic<size_t>)];
+    Atomic<size_t> dequeuePos;
+    char pad2[QCC_CACHE_LINE_SIZE - sizeof(Atomic<size_t>)];
+    EventCount notEmpty;
+    char pad3[QCC_CACHE_LINE_SIZE - sizeof(EventCount)];
+    EventCount notFull;
+    char pad4[QCC_CACHE_LINE_SIZE - sizeof(EventCount)];
+};
+
+}
+
+#endif
@@ -0,0 +1,306 @@
+/**
+ * @file
+ *
+ * Data-parallel loops executed on a ThreadPool
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#ifndef _QCC_PARALLEL_H
+#define _QCC_PARALLEL_H
+
+#include <vector>
+
+#include <qcc/platform.h>
+#include <qcc/atomic.h>
+#include <qcc/Event.h>
+#include <qcc/Ptr.h>
+#include <qcc/ThreadPool.h>
+
+namespace qcc {
+
+/**
+ * The bookkeeping for one parallel loop.
+ *
+ * The range [begin, end) is cut into fixed size chunks which are claimed, in
+ * order, with an atomic counter by whichever thread gets there first: the
+ * thread that started the loop and any helpers it managed to put on the
+ * thread pool.  The loop is over once every chunk has been completed.
+ *
+ * This lives on the heap and is reference counted since a helper may only get
+ * to run after the loop is over, in which case it finds no chunks left and
+ * goes away without touching anything else.
+ */
+class _ParallelLoop : public RefCountBase {
+  public:
+
+    /**
+     * @param begin      First index of the range.
+     * @param end        One past the last index of the range.
+     * @param grain      Minimum number of indices per chunk or 0 to choose one.
+     * @param concurrency Number of threads that may work on the loop.
+     */
+    _ParallelLoop(size_t begin, size_t end, size_t grain, uint32_t concurrency);
+
+    /**
+     * Claim the next chunk.
+     *
+     * @param chunk   Returns the index of the claimed chunk.
+     * @param first   Returns the first index of the chunk.
+     * @param last    Returns one past the last index of the chunk.
+     * @return false if there are no chunks left.
+     */
+    bool Claim(uint32_t& chunk, size_t& first, size_t& last)
+    {
+        int32_t c = IncrementAndFetch(&m_next) - 1;
+        if (c >= m_numChunks) {
+            return false;
+        }
+        chunk = static_cast<uint32_t>(c);
+        first = m_begin + chunk * m_grain;
+        last = (m_end - first > m_grain) ? first + m_grain : m_end;
+        return true;
+    }
+
+    /**
+     * Mark a claimed chunk as completed.
+     */
+    void Complete()
+    {
+        if (IncrementAndFetch(&m_completed) == m_numChunks) {
+            m_done.SetEvent();
+        }
+    }
+
+    /**
+     * Wait until every chunk has been completed.  Called by the thread that
+     * started the loop once it cannot claim any more chunks.
+     */
+    void Wait();
+
+    /**
+     * @return The number of chunks the range was cut into.
+     */
+    uint32_t GetNumChunks() const { return static_cast<uint32_t>(m_numChunks); }
+
+    /**
+     * @return The number of helpers worth putting on the thread pool.
+     */
+    uint32_t GetNumHelpers() const { return m_numHelpers; }
+
+  private:
+    size_t m_begin;
+    size_t m_end;
+    size_t m_grain;
+    int32_t m_numChunks;
+    uint32_t m_numHelpers;
+    volatile int32_t m_next;
+    volatile int32_t m_completed;
+    Event m_done;
+};
+
+/**
+ * Claim and run chunks of a parallel loop until there are none left.
+ */
+template <typename Body>
+void _RunChunks(_ParallelLoop& loop, Body& body)
+{
+    uint32_t chunk;
+    size_t first;
+    size_t last;
+    while (loop.Claim(chunk, first, last)) {
+        body(chunk, first, last);
+        loop.Complete();
+    }
+}
+
+/**
+ * A Runnable that helps with a parallel loop on a ThreadPool thread.
+ */
+template <typename Body>
+class _ParallelHelper : public Runnable {
+  public:
+    _ParallelHelper(Ptr<_ParallelLoop> loop, Body* body) : m_loop(loop), m_body(body) { }
+
+    void Run(void)
+    {
+        /*
+         * m_body lives on the stack of the thread that started the loop.  It
+         * stays valid for as long as there are chunks that we can claim.
+         */
+        _RunChunks(*m_loop, *m_body);
+    }
+
+  private:
+    Ptr<_ParallelLoop> m_loop;
+    Body* m_body;
+};
+
+/**
+ * Run a parallel loop: put helpers on the pool and join in on this thread.
+ */
+template <typename Body>
+void _RunParallel(ThreadPool& pool, Ptr<_ParallelLoop> loop, Body& body)
+{
+    /*
+     * Helpers are queued without blocking.  If the pool cannot take them we
+     * simply do more of the work ourselves.
+     */
+    uint32_t numHelpers = loop->GetNumHelpers();
+    for (uint32_t i = 0; i < numHelpers; ++i) {
+        Ptr<Runnable> helper(new _ParallelHelper<Body>(loop, &body));
+        if (pool.Execute(helper) != ER_OK) {
+            break;
+        }
+    }
+    _RunChunks(*loop, body);
+    loop->Wait();
+}
+
+/**
+ * The loop body used by ParallelFor().
+ */
+template <typename Function>
+class _ParallelForBody {
+  public:
+    _ParallelForBody(Function& fn) : m_fn(fn) { }
+
+    void operator()(uint32_t chunk, size_t first, size_t last)
+    {
+        for (size_t i = first; i < last; ++i) {
+            m_fn(i);
+        }
+    }
+
+  private:
+    Function& m_fn;
+};
+
+/**
+ * The result of one chunk of a ParallelReduce().  Each is padded to a cache
+ * line of its own; a plain std::vector<T> would pack neighbouring results
+ * into one word for T = bool, where concurrent writes lose each other, and
+ * into one cache line for small types.
+ */
+template <typename T>
+struct _ParallelPartial {
+    _ParallelPartial(const T& value) : value(value) { }
+    T value;
+    char pad[QCC_CACHE_LINE_SIZE];
+};
+
+/**
+ * The loop body used by ParallelReduce().  Each chunk is reduced into its own
+ * slot so that the final result does not depend on which thread ran which
+ * chunk.
+ */
+template <typename T, typename MapFunction, typename CombineFunction>
+class _ParallelReduceBody {
+  public:
+    _ParallelReduceBody(std::vector<_ParallelPartial<T> >& partials, const T& identity, MapFunction& map, CombineFunction& combine)
+        : m_partials(partials), m_identity(identity), m_map(map), m_combine(combine) { }
+
+    void operator()(uint32_t chunk, size_t first, size_t last)
+    {
+        T acc = m_identity;
+        for (size_t i = first; i < last; ++i) {
+            acc = m_combine(acc, m_map(i));
+        }
+        m_partials[chunk].value = acc;
+    }
+
+  private:
+    std::vector<_ParallelPartial<T> >& m_partials;
+    const T& m_identity;
+    MapFunction& m_map;
+    CombineFunction& m_combine;
+};
+
+/**
+ * Call a function for every index of a range, spreading the work over the
+ * threads of a ThreadPool.
+ *
+ * The range is cut into chunks of at least grain indices.  The calling thread
+ * works on the loop too and ParallelFor() only returns once fn has been called
+ * for every index.  Because the caller joins in, it is safe to call this from
+ * a Runnable that is itself running on the pool, and it still makes progress
+ * if the pool is fully busy.
+ *
+ * @param pool    The thread pool to borrow threads from.
+ * @param begin   First index of the range.
+ * @param end     One past the last index of the range.
+ * @param grain   Minimum number of indices handed to a thread at a time or 0
+ *                to have one chosen based on the size of the range and the
+ *                concurrency of the pool.  Use a larger grain when fn is
+ *                cheap.
+ * @param fn      A function or function object called as fn(i).  It is called
+ *                concurrently from several threads.
+ */
+template <typename Function>
+void ParallelFor(ThreadPool& pool, size_t begin, size_t end, size_t grain, Function fn)
+{
+    if (end <= begin) {
+        return;
+    }
+    Ptr<_ParallelLoop> loop(new _ParallelLoop(begin, end, grain, pool.GetConcurrency()));
+    _ParallelForBody<Function> body(fn);
+    _RunParallel(pool, loop, body);
+}
+
+/**
+ * Reduce a range of indices to a single value, spreading the work over the
+ * threads of a ThreadPool.
+ *
+ * Every chunk of the range is reduced as combine(...combine(combine(identity,
+ * map(first)), map(first + 1))..., map(last - 1)) and the results of the chunks
+ * are then combined in index order on the calling thread.  As long as combine
+ * is associative the result is the same as that of a serial loop and does not
+ * vary from run to run.
+ *
+ * @param pool      The thread pool to borrow threads from.
+ * @param begin     First index of the range.
+ * @param end       One past the last index of the range.
+ * @param grain     Minimum number of indices handed to a thread at a time or 0
+ *                  to have one chosen.
+ * @param identity  The identity value of combine.
+ * @param map       A function or function object called as map(i), returning
+ *                  a T.  It is called concurrently from several threads.
+ * @param combine   A function or function object called as combine(a, b)
+ *                  returning a T.
+ * @return The reduced value, or identity if the range is empty.
+ */
+template <typename T, typename MapFunction, typename CombineFunction>
+T ParallelReduce(ThreadPool& pool, size_t begin, size_t end, size_t grain, const T& identity, MapFunction map, CombineFunction combine)
+{
+    if (end <= begin) {
+        return identity;
+    }
+    Ptr<_ParallelLoop> loop(new _ParallelLoop(begin, end, grain, pool.GetConcurrency()));
+    std::vector<_ParallelPartial<T> > partials(loop->GetNumChunks(), _ParallelPartial<T>(identity));
+    _ParallelReduceBody<T, MapFunction, CombineFunction> body(partials, identity, map, combine);
+    _RunParallel(pool, loop, body);
+
+    T result = identity;
+    for (size_t i = 0; i < partials.size(); ++i) {
+        result = combine(result, partials[i].value);
+    }
+    return result;
+}
+
+} // namespace qcc
+
+#endif
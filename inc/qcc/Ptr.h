@@ -23,6 +23,7 @@
 #define _QCC_PTR_H
 
 #include <qcc/atomic.h>
+#include <qcc/RefCount.h>
 
 namespace qcc {
 
@@ -45,6 +46,12 @@ class Ptr {
      */
     Ptr(T* p);
 
+    /**
+     * Copy constructor.  The object pointed to by other, if any, has its
+     * reference count incremented.
+     */
+    Ptr(const Ptr<T>& other);
+
     /**
      * A conversion constructor to allow for casting between Ptr types.
      */
@@ -73,19 +80,19 @@ class Ptr {
     /**
      * The point operator, which is the heart of a smart pointer class.
      */
-    T* operator->();
+    T* operator->() const;
 
     /**
      * The dereference operator, which allows getting a reference to the Ptr
      * type.
      */
-    T& operator*();
+    T& operator*() const;
 
     /**
      * Get the underlying object pointer.  You must never delete this pointer
      * yourself.
      */
-    T* Peek();
+    T* Peek() const;
 
   private:
     /**
@@ -107,6 +114,20 @@ Ptr<T>::Ptr(T* p) : ptr(p)
     }
 }
 
+/**
+ * The copy constructor proper.  Without it the compiler would supply a
+ * memberwise copy (which does not touch the reference count) whenever a Ptr
+ * is copied from a const Ptr of exactly the same type.
+ */
+template <typename T>
+Ptr<T>::Ptr(const Ptr<T>& other)
+    : ptr(other.ptr)
+{
+    if (ptr) {
+        ptr->IncRef();
+    }
+}
+
 /**
  * A copy constructor that allows for cast operations.
  *
@@ -218,19 +239,19 @@ Ptr<T>& Ptr<T>::operator=(Ptr const& other)
 }
 
 template <typename T>
-T* Ptr<T>::operator->()
+T* Ptr<T>::operator->() const
 {
     return ptr;
 }
 
 template <typename T>
-T& Ptr<T>::operator*()
+T& Ptr<T>::operator*() const
 {
     return *ptr;
 }
 
 template <typename T>
-T* Ptr<T>::Peek(void)
+T* Ptr<T>::Peek(void) const
 {
     return ptr;
 }
@@ -322,6 +343,33 @@ class RefCountBase {
     volatile mutable int32_t refCount;
 };
 
+/**
+ * A base class for objects held by Ptr that are only ever referenced from
+ * the thread that created them.  The count is a plain integer, and debug
+ * builds assert if it is changed from another thread.
+ */
+class SingleThreadRefCountBase {
+  public:
+
+    SingleThreadRefCountBase() : refCount(0) { }
+    virtual ~SingleThreadRefCountBase() { }
+
+    void IncRef(void)
+    {
+        refCount.Increment();
+    }
+
+    void DecRef(void)
+    {
+        if (refCount.Decrement() == 0) {
+            delete this;
+        }
+    }
+
+  private:
+    SingleThreadRefCount refCount;
+};
+
 } // namespace qcc
 
 #endif // _QCC_PTR_H
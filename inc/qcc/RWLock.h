@@ -0,0 +1,83 @@
+/**
+ * @file
+ *
+ * Define a reader/writer lock.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#ifndef _QCC_RWLOCK_H
+#define _QCC_RWLOCK_H
+
+#include <qcc/platform.h>
+
+#if defined(QCC_OS_GROUP_POSIX)
+#include <qcc/posix/RWLock.h>
+#elif defined(QCC_OS_GROUP_WINDOWS) || defined(QCC_OS_GROUP_WINRT)
+#include <qcc/windows/RWLock.h>
+#else
+#error No OS GROUP defined.
+#endif
+
+namespace qcc {
+
+/**
+ * An implementation of a scoped shared (read) lock for an RWLock.
+ */
+class ScopedReadLock {
+  public:
+
+    /**
+     * Constructor
+     *
+     * @param lock The lock we want to manage
+     */
+    ScopedReadLock(RWLock& lock) : lock(lock) { lock.ReadLock(); }
+
+    ~ScopedReadLock() { lock.ReadUnlock(); }
+
+  private:
+    ScopedReadLock(const ScopedReadLock& other);
+    ScopedReadLock& operator=(const ScopedReadLock& other);
+
+    RWLock& lock;
+};
+
+/**
+ * An implementation of a scoped exclusive (write) lock for an RWLock.
+ */
+class ScopedWriteLock {
+  public:
+
+    /**
+     * Constructor
+     *
+     * @param lock The lock we want to manage
+     */
+    ScopedWriteLock(RWLock& lock) : lock(lock) { lock.WriteLock(); }
+
+    ~ScopedWriteLock() { lock.WriteUnlock(); }
+
+  private:
+    ScopedWriteLock(const ScopedWriteLock& other);
+    ScopedWriteLock& operator=(const ScopedWriteLock& other);
+
+    RWLock& lock;
+};
+
+}
+
+#endif
@@ -0,0 +1,165 @@
+/**
+ * @file
+ *
+ * Reference count policies for ManagedObj and Ptr.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#ifndef _QCC_REFCOUNT_H
+#define _QCC_REFCOUNT_H
+
+#include <qcc/platform.h>
+
+#include <assert.h>
+
+#include <qcc/atomic.h>
+
+namespace qcc {
+
+/**
+ * A reference count that may be changed from any thread.  This is the
+ * default for ManagedObj and is what RefCountBase uses.
+ */
+class AtomicRefCount {
+  public:
+
+    /** Tag stored with a ManagedObj context to identify the policy */
+    static const uint16_t Magic = (('M') | ('C' << 8));
+
+    /**
+     * Construct a count.
+     *
+     * @param count  The initial count.
+     */
+    AtomicRefCount(int32_t count) : count(count) { }
+
+    /** Increment the count */
+    void Increment() { IncrementAndFetch(&count); }
+
+    /**
+     * Decrement the count.
+     *
+     * @return  The new count.
+     */
+    int32_t Decrement() { return DecrementAndFetch(&count); }
+
+    /**
+     * Increment the count unless it is zero.
+     *
+     * @return  true if the count was incremented.
+     */
+    bool TryIncrement()
+    {
+        int32_t expected = AtomicLoad(&count, MEMORY_ORDER_RELAXED);
+        while (expected != 0) {
+            if (AtomicCompareExchange(&count, expected, expected + 1, MEMORY_ORDER_ACQUIRE)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Get the count.
+     *
+     * @return  The count.
+     */
+    int32_t Get() const { return count; }
+
+  private:
+    volatile int32_t count;
+};
+
+/**
+ * A reference count that is a plain integer, for objects that are created,
+ * copied and released by one thread only, such as per-connection parse state.
+ * Copying a reference is a plain increment rather than a locked instruction.
+ *
+ * The thread that creates the count is always recorded, so the layout does
+ * not depend on NDEBUG, and in debug builds every change from another thread
+ * fails an assertion.
+ */
+class SingleThreadRefCount {
+  public:
+
+    /** Tag stored with a ManagedObj context to identify the policy */
+    static const uint16_t Magic = (('M') | ('S' << 8));
+
+    /**
+     * Construct a count owned by the calling thread.
+     *
+     * @param count  The initial count.
+     */
+    SingleThreadRefCount(int32_t count) : count(count), owner(CurrentThread()) { }
+
+    /** Increment the count */
+    void Increment()
+    {
+        CheckOwner();
+        ++count;
+    }
+
+    /**
+     * Decrement the count.
+     *
+     * @return  The new count.
+     */
+    int32_t Decrement()
+    {
+        CheckOwner();
+        return --count;
+    }
+
+    /**
+     * Increment the count unless it is zero.
+     *
+     * @return  true if the count was incremented.
+     */
+    bool TryIncrement()
+    {
+        CheckOwner();
+        if (count == 0) {
+            return false;
+        }
+        ++count;
+        return true;
+    }
+
+    /**
+     * Get the count.
+     *
+     * @return  The count.
+     */
+    int32_t Get() const { return count; }
+
+  private:
+    int32_t count;
+    uintptr_t owner;
+
+    /** Identify the calling thread */
+    static uintptr_t CurrentThread();
+
+#if !defined(NDEBUG)
+    void CheckOwner() const { assert((owner == CurrentThread()) && "single threaded reference used from another thread"); }
+#else
+    void CheckOwner() const { }
+#endif
+};
+
+}
+
+#endif
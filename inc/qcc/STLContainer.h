@@ -127,11 +127,19 @@ using namespace std::tr1;
 #define _BEGIN_NAMESPACE_CONTAINER_FOR_HASH namespace __gnu_cxx {
 #define _END_NAMESPACE_CONTAINER_FOR_HASH }
 
-#define std::tr1::unordered_map hash_map
+#define unordered_map hash_map
 #define unordered_multimap hash_multimap
 #define unordered_set hash_set
 #define unordered_multiset hash_multiset
 
+namespace __gnu_cxx {
+/*
+ * Hash functor specializations are written as tr1::hash<T>; make that name
+ * refer to __gnu_cxx::hash<T>.
+ */
+namespace tr1 = ::__gnu_cxx;
+}
+
 namespace std {
 /*
  * Map everything in the __gnu_cxx namespace to the std namespace.
@@ -154,6 +154,36 @@ QStatus Accept(SocketFd sockfd, IPAddress& remoteAddr, uint16_t& remotePort, Soc
  */
 QStatus Accept(SocketFd sockfd, SocketFd& newSockfd);
 
+/**
+ * A connection accepted by AcceptMany().
+ */
+struct AcceptedSocket {
+    SocketFd sockfd;        /**< New socket descriptor for the connection */
+    IPAddress addr;         /**< IP Address of remote host */
+    uint16_t port;          /**< IP Port on remote host */
+
+    AcceptedSocket() : sockfd(INVALID_SOCKET_FD), port(0) { }
+};
+
+/**
+ * Accept all pending connections, up to maxCount, in one call.  This is meant
+ * for a non-blocking listening socket that was reported readable: it accepts
+ * until the queue is empty rather than returning to the event loop after each
+ * connection.  The new sockets are non-blocking and close-on-exec; on Linux
+ * each one takes a single accept4() call.
+ *
+ * @param sockfd        Non-blocking listening socket descriptor.
+ * @param maxCount      Number of entries in results.
+ * @param results       OUT: The accepted connections.
+ * @param accepted      OUT: Number of entries of results filled in.
+ *
+ * @return
+ *      - ER_OK if at least one connection was accepted.
+ *      - ER_WOULDBLOCK if there were no pending connections.
+ *      - ER_OS_ERROR if no connection was accepted because of an error.
+ */
+QStatus AcceptMany(SocketFd sockfd, size_t maxCount, AcceptedSocket* results, size_t& accepted);
+
 /**
  * Shutdown a connection.
  *
@@ -163,6 +193,16 @@ QStatus Accept(SocketFd sockfd, SocketFd& newSockfd);
  */
 QStatus Shutdown(SocketFd sockfd);
 
+/**
+ * Shutdown the sending side of a connection.  Data already queued is still
+ * sent and followed by the end of stream; receiving is not affected.
+ *
+ * @param sockfd        Socket descriptor.
+ *
+ * @return  Indication of success of failure.
+ */
+QStatus ShutdownSend(SocketFd sockfd);
+
 /**
  * Close a socket descriptor.  This releases the bound port number.
  *
@@ -241,6 +281,83 @@ QStatus Recv(SocketFd sockfd, void* buf, size_t len, size_t& received);
 QStatus RecvFrom(SocketFd sockfd, IPAddress& remoteAddr, uint16_t& remotePort,
                  void* buf, size_t len, size_t& received);
 
+/**
+ * A datagram sent by SendToBatch() or received by RecvFromBatch().
+ */
+struct Datagram {
+    void* buf;              /**< The data to send, or where to store received data */
+    size_t len;             /**< Number of octets to send, or OUT: number of octets received */
+    size_t size;            /**< Size of buf when receiving, not used when sending */
+    IPAddress addr;         /**< IP Address of the remote host, OUT when receiving */
+    uint16_t port;          /**< IP Port on the remote host, OUT when receiving */
+
+    /**
+     * When sending, if non-zero and less than len, buf holds several datagrams
+     * of segmentSize octets each (the last may be shorter) for the same
+     * destination.  On Linux the kernel splits them (UDP_SEGMENT), otherwise
+     * they are sent one at a time.
+     *
+     * OUT when receiving: if UDP_GRO is enabled with SetUdpGro() and the
+     * kernel coalesced several datagrams into buf, the size of each of them
+     * (the last may be shorter); otherwise 0.
+     */
+    uint16_t segmentSize;
+
+    Datagram() : buf(NULL), len(0), size(0), port(0), segmentSize(0) { }
+};
+
+/**
+ * Send several datagrams with as few system calls as possible (one sendmmsg()
+ * per 32 datagrams on Linux).  Each datagram may have its own destination.
+ *
+ * @param sockfd        Socket descriptor.
+ * @param datagrams     The datagrams to send.
+ * @param count         Number of datagrams.
+ * @param sent          OUT: Number of datagrams sent, from the start of the array.
+ *
+ * @return
+ *      - ER_OK if at least one datagram was sent.  sent may be less than count
+ *        if the socket is non-blocking or an error stopped the batch; the
+ *        error is reported by the next call.
+ *      - ER_WOULDBLOCK if the socket is non-blocking and nothing could be sent.
+ *      - ER_OS_ERROR if nothing was sent because of an error.
+ */
+QStatus SendToBatch(SocketFd sockfd, Datagram* datagrams, size_t count, size_t& sent);
+
+/**
+ * Receive several datagrams with as few system calls as possible (recvmmsg()
+ * on Linux).  This blocks, unless the socket is non-blocking, until one
+ * datagram is available and then returns it along with any others that have
+ * already arrived.
+ *
+ * @param sockfd        Socket descriptor.
+ * @param datagrams     Where to store the datagrams; buf and size must be set.
+ * @param count         Number of datagrams.
+ * @param received      OUT: Number of datagrams received, from the start of the array.
+ *
+ * @return
+ *      - ER_OK if at least one datagram was received.
+ *      - ER_WOULDBLOCK if the socket is non-blocking and nothing was available.
+ *      - ER_OS_ERROR on any other error.
+ */
+QStatus RecvFromBatch(SocketFd sockfd, Datagram* datagrams, size_t count, size_t& received);
+
+/**
+ * Allow the kernel to coalesce datagrams from the same sender into a single
+ * receive (UDP_GRO).  The size of the datagrams is reported in
+ * Datagram::segmentSize by RecvFromBatch().  Only RecvFromBatch() reports
+ * this, so do not enable it on sockets that are read with RecvFrom().
+ *
+ * @param sockfd  The socket descriptor identifying the resource.
+ * @param gro     Set to true to enable coalescing.
+ *
+ * @return
+ *      - ER_OK if successful.
+ *      - ER_NOT_IMPLEMENTED if the platform does not support it.
+ *      - ER_OS_ERROR if the kernel does not support it.
+ */
+QStatus SetUdpGro(SocketFd sockfd, bool gro);
+
 /**
  * Receive a buffer of data from a remote host on a socket and any file descriptors accompanying the
  * data.  This call will block until data is available, the socket is closed.
@@ -273,6 +390,84 @@ QStatus RecvWithFds(SocketFd sockfd, void* buf, size_t len, size_t& received, So
  */
 QStatus SendWithFds(SocketFd sockfd, const void* buf, size_t len, size_t& sent, SocketFd* fdList, size_t numFds, uint32_t pid);
 
+/**
+ * Allow a TCP socket to send without copying the data (SO_ZEROCOPY, Linux
+ * 4.14 and later).  See SendZeroCopy().
+ *
+ * @param sockfd  Socket descriptor.
+ * @param enable  true to allow zero copy sends.
+ *
+ * @return
+ *      - ER_OK if successful.
+ *      - ER_NOT_IMPLEMENTED if the platform or kernel does not support it.
+ *      - ER_OS_ERROR on other failures.
+ */
+QStatus SetZeroCopy(SocketFd sockfd, bool enable);
+
+/**
+ * Send a buffer of data on a socket enabled with SetZeroCopy() without
+ * copying it into the kernel (MSG_ZEROCOPY).  The kernel sends straight from
+ * the pages of buf, so the sent octets must not be changed until
+ * GetZeroCopyCompletion() reports this send complete.  Sends are numbered
+ * from 0 in the order they are made, counting only calls that sent data with
+ * zeroCopied set.
+ *
+ * If the kernel is out of memory for tracking zero copy sends (ENOBUFS) the
+ * data is sent by copying instead.
+ *
+ * @param sockfd      Socket descriptor.
+ * @param buf         Pointer to the buffer containing the data to send.
+ * @param len         Number of octets in the buffer to be sent.
+ * @param sent        OUT: Number of octets sent.
+ * @param zeroCopied  OUT: true if the data was sent without copying and will be
+ *                    reported by GetZeroCopyCompletion().
+ *
+ * @return  Indication of success of failure.
+ */
+QStatus SendZeroCopy(SocketFd sockfd, const void* buf, size_t len, size_t& sent, bool& zeroCopied);
+
+/**
+ * Get the next completion of zero copy sends from the error queue of a
+ * socket.  Completions report a range of sends whose buffers the kernel no
+ * longer uses.  The socket's events are signaled while completions are queued.
+ *
+ * @param sockfd  Socket descriptor.
+ * @param first   OUT: Number of the first completed send.
+ * @param last    OUT: Number of the last completed send (may be less than first if the numbers wrapped).
+ * @param copied  OUT: true if the kernel copied the data after all, as it does
+ *                for loopback and devices that cannot send from user memory.
+ *
+ * @return
+ *      - ER_OK if a completion was returned.
+ *      - ER_WOULDBLOCK if none are queued.
+ *      - ER_NOT_IMPLEMENTED if the platform does not support zero copy sends.
+ *      - ER_OS_ERROR on failure.
+ */
+QStatus GetZeroCopyCompletion(SocketFd sockfd, uint32_t& first, uint32_t& last, bool& copied);
+
+/**
+ * Wait for zero copy completions to be queued on the error queue of a socket.
+ * Unlike waiting on the socket's events this does not return because data is
+ * available to read.  A pending socket error also ends the wait and is
+ * cleared.
+ *
+ * The hangup and error returns persist, so waiting again returns at once;
+ * callers should stop waiting once the completions already queued have been
+ * read.
+ *
+ * @param sockfd   Socket descriptor.
+ * @param timeout  Maximum time to wait in milliseconds.
+ *
+ * @return
+ *      - ER_OK if completions are queued.
+ *      - ER_TIMEOUT if none were queued within timeout.
+ *      - ER_SOCK_OTHER_END_CLOSED if the connection is closed in both
+ *        directions or was reset.
+ *      - ER_NOT_IMPLEMENTED if the platform does not support zero copy sends.
+ *      - ER_OS_ERROR on any other socket error or failure.
+ */
+QStatus WaitForZeroCopyCompletion(SocketFd sockfd, uint32_t timeout);
+
 /**
  * Set a socket to blocking or not blocking.
  *
@@ -289,6 +484,71 @@ QStatus SetBlocking(SocketFd sockfd, bool blocking);
  */
 QStatus SetNagle(SocketFd sockfd, bool useNagle);
 
+/**
+ * A tuning profile for a TCP socket, applied with SetSocketOptions() or when a
+ * SocketStream is created.  A transport keeps one profile for its connections
+ * so latency and throughput can be tuned per transport type.  Fields left at
+ * their default values leave the system defaults alone.
+ */
+struct SocketOptions {
+    uint32_t sendBufferSize;        /**< Send buffer size in bytes (SO_SNDBUF) or 0 */
+    uint32_t receiveBufferSize;     /**< Receive buffer size in bytes (SO_RCVBUF) or 0 */
+    bool noDelay;                   /**< true to send small segments without waiting (TCP_NODELAY) */
+    uint32_t keepAliveIdle;         /**< Idle seconds before keepalive probes start or 0 for no keepalive */
+    uint32_t keepAliveInterval;     /**< Seconds between keepalive probes or 0 */
+    uint32_t keepAliveCount;        /**< Unanswered keepalive probes before the connection is dropped or 0 */
+    uint32_t busyPoll;              /**< Microseconds to busy poll the device for received data (SO_BUSY_POLL, Linux) or 0 */
+    uint32_t notSentLowat;          /**< Unsent bytes above which the socket is not writable (TCP_NOTSENT_LOWAT) or 0 */
+
+    /**
+     * true to let a BufferedSink over a SocketStream cork the socket while it
+     * writes a batch and uncork it on Flush(), so a message that spans several
+     * buffers goes out in full sized segments and its tail is not delayed.
+     * See SetCork().
+     */
+    bool corkBufferedWrites;
+
+    SocketOptions() :
+        sendBufferSize(0),
+        receiveBufferSize(0),
+        noDelay(false),
+        keepAliveIdle(0),
+        keepAliveInterval(0),
+        keepAliveCount(0),
+        busyPoll(0),
+        notSentLowat(0),
+        corkBufferedWrites(false)
+    { }
+};
+
+/**
+ * Apply a tuning profile to a TCP socket, for example one just returned by
+ * Accept().  Every option is attempted even if an earlier one fails.  Options
+ * the platform does not have are skipped.
+ *
+ * @param sockfd    Socket descriptor.
+ * @param options   The profile.
+ *
+ * @return
+ *      - ER_OK if all options that the platform supports were applied.
+ *      - ER_OS_ERROR if any of them failed.
+ */
+QStatus SetSocketOptions(SocketFd sockfd, const SocketOptions& options);
+
+/**
+ * Cork or uncork a TCP socket (TCP_CORK on Linux, TCP_NOPUSH on Darwin).  While
+ * corked only full sized segments are sent; uncorking sends what is left.
+ *
+ * @param sockfd    Socket descriptor.
+ * @param cork      true to cork, false to uncork.
+ *
+ * @return
+ *      - ER_OK on success.
+ *      - ER_NOT_IMPLEMENTED if not supported on this platform.
+ *      - ER_OS_ERROR on failure.
+ */
+QStatus SetCork(SocketFd sockfd, bool cork);
+
 /**
  * @brief Allow a service to bind to a TCP endpoint which is in the TIME_WAIT
  * state.
@@ -329,6 +589,30 @@ QStatus SetReuseAddress(SocketFd sockfd, bool reuse);
  */
 QStatus SetReusePort(SocketFd sockfd, bool reuse);
 
+/**
+ * @brief Steer connections among a group of SO_REUSEPORT sockets by CPU.
+ *
+ * By default the kernel picks one of the sockets bound to the same address and
+ * port with SetReusePort() by hashing the connection's addresses.  This
+ * attaches a classic BPF program (SO_ATTACH_REUSEPORT_CBPF) that instead picks
+ * the socket whose index is the number of the CPU that received the
+ * connection, modulo numSockets.  The index of a socket is the order in which
+ * it joined the group, so open, bind and listen on the sockets in order before
+ * calling this on any one of them.  Handling socket i on a thread that runs on
+ * CPU i then keeps each connection on the CPU its packets arrive on.
+ *
+ * Only available on Linux.
+ *
+ * @param sockfd      Any socket of the group.
+ * @param numSockets  Number of sockets in the group.
+ *
+ * @return
+ *      - ER_OK on success.
+ *      - ER_NOT_IMPLEMENTED if not supported on this platform.
+ *      - ER_OS_ERROR if the kernel refused the program.
+ */
+QStatus SetReusePortCpuSteering(SocketFd sockfd, uint32_t numSockets);
+
 /**
  * Ask a UDP-based socket to join the specified multicast group.
  *
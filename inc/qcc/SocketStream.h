@@ -35,6 +35,28 @@
 
 namespace qcc {
 
+/**
+ * Receives the buffers of zero copy sends back from a SocketStream once the
+ * kernel no longer uses them.  See SocketStream::EnableZeroCopy().
+ */
+class ZeroCopyListener {
+  public:
+    virtual ~ZeroCopyListener() { }
+
+    /**
+     * Called when a buffer passed to SocketStream::PushBytes() may be changed
+     * or freed again.  This is called from whichever thread is pushing to or
+     * pulling from the stream, or calls ProcessZeroCopyCompletions(), and must
+     * not push to the stream itself.
+     *
+     * @param buf     The buffer that was pushed.
+     * @param len     The number of octets of buf that were sent.
+     * @param copied  true if the kernel copied the data after all, in which
+     *                case zero copy is only overhead for this connection.
+     */
+    virtual void BufferReleased(const void* buf, size_t len, bool copied) = 0;
+};
+
 /**
  * SocketStream is an implementation of Source and Sink for use with Sockets.
  */
@@ -56,6 +78,24 @@ class SocketStream : public Stream {
      */
     SocketStream(AddressFamily family, SocketType type);
 
+    /**
+     * Create a SocketStream from an existing socket, for example one returned
+     * by Accept(), and apply a tuning profile to it.
+     *
+     * @param sock      socket handle.
+     * @param options   Tuning profile.  Options that cannot be applied are logged.
+     */
+    SocketStream(SocketFd sock, const SocketOptions& options);
+
+    /**
+     * Create a SocketStream and apply a tuning profile to it.
+     *
+     * @param family    Socket family.
+     * @param type      Socket type.
+     * @param options   Tuning profile.  Options that cannot be applied are logged.
+     */
+    SocketStream(AddressFamily family, SocketType type, const SocketOptions& options);
+
     /**
      * Copy-constructor
      *
@@ -143,6 +183,87 @@ class SocketStream : public Stream {
      */
     QStatus PushBytesAndFds(const void* buf, size_t numBytes, size_t& numSent, SocketFd* fdList, size_t numFds, uint32_t pid = -1);
 
+    /**
+     * Send large pushes without copying them into the kernel (MSG_ZEROCOPY,
+     * Linux only).  Pushes of at least threshold octets are sent from the
+     * caller's buffer, which must then stay unchanged until it is returned to
+     * listener->BufferReleased(); smaller pushes are copied as usual and their
+     * buffer may be reused as soon as PushBytes() returns.
+     *
+     * This changes the Sink::PushBytes() contract, so it is refused while a
+     * BufferedSink (or any wrapper that calls Sink::SetBufferReuse()) wraps the
+     * stream, and pushes are copied again if one is attached later.
+     *
+     * Completions are collected whenever the stream is pushed to or pulled
+     * from, or by calling ProcessZeroCopyCompletions().  Below a few tens of
+     * kilobytes, and on loopback where the kernel copies anyway, zero copy
+     * costs more than it saves; DEFAULT_ZERO_COPY_THRESHOLD is a reasonable
+     * starting point for real network devices.
+     *
+     * The destructor shuts down sending and waits up to closeTimeout for the
+     * outstanding sends to complete, or until the connection is closed or
+     * reset and no more completions arrive.  Buffers of sends still
+     * outstanding after that are never returned to the listener, since the
+     * kernel may still be sending from them; they must be leaked.
+     *
+     * The kernel numbers zero copy sends per socket and the stream matches
+     * completions by counting its own sends.  Nothing else, such as a copy of
+     * the stream, which shares the socket through a duplicated descriptor, may
+     * send with MSG_ZEROCOPY on the same socket or read its error queue.
+     *
+     * @param threshold     Smallest push to send without copying.
+     * @param listener      Receives the buffers back.
+     * @param closeTimeout  Longest time in ms the destructor waits for outstanding sends.
+     *
+     * @return
+     *      - ER_OK if zero copy sends were enabled.
+     *      - ER_NOT_IMPLEMENTED if the platform or kernel does not support them.
+     *      - ER_FAIL if zero copy is already enabled or a wrapper reuses pushed buffers.
+     */
+    QStatus EnableZeroCopy(size_t threshold, ZeroCopyListener* listener, uint32_t closeTimeout = DEFAULT_ZERO_COPY_CLOSE_TIMEOUT);
+
+    /**
+     * Return the buffers of completed zero copy sends to the listener.
+     *
+     * @return ER_OK if successful.
+     */
+    QStatus ProcessZeroCopyCompletions();
+
+    /**
+     * Get the number of zero copy sends whose buffers have not been released.
+     *
+     * @return  The number of pending sends.
+     */
+    size_t GetZeroCopyPending();
+
+    /** Suggested threshold for EnableZeroCopy() */
+    static const size_t DEFAULT_ZERO_COPY_THRESHOLD = 64 * 1024;
+
+    /** Default time in ms the destructor waits for outstanding zero copy sends */
+    static const uint32_t DEFAULT_ZERO_COPY_CLOSE_TIMEOUT = 2000;
+
+    /**
+     * Count wrappers that reuse pushed buffers (see Sink::SetBufferReuse()).
+     *
+     * @param reused   true when a wrapper attaches, false when it detaches.
+     */
+    void SetBufferReuse(bool reused);
+
+    /**
+     * Cork the socket if the tuning profile it was created with has
+     * corkBufferedWrites set.
+     *
+     * @return ER_OK if the socket was corked, ER_NOT_IMPLEMENTED otherwise.
+     */
+    QStatus Cork();
+
+    /**
+     * Uncork the socket if Cork() corked it.
+     *
+     * @return ER_OK if successful.
+     */
+    QStatus Uncork();
+
     /**
      * Get the Event indicating that data is available.
      *
@@ -196,7 +317,17 @@ class SocketStream : public Stream {
     Event* sourceEvent;              /**< Event signaled when data is available */
     Event* sinkEvent;                /**< Event signaled when sink can accept data */
     bool isDetached;                 /**< Detached socket streams do not shutdown the underlying socket when closing */
+    bool corkWrites;                 /**< Cork() and Uncork() change the socket */
     uint32_t sendTimeout;            /**< Send timeout */
+
+  private:
+
+    /** Wait a bounded time for outstanding zero copy sends before the socket is closed */
+    void DrainZeroCopySends();
+
+    struct ZeroCopySends;
+    ZeroCopySends* zeroCopy;         /**< Zero copy sends in progress or NULL if not enabled */
+    int32_t bufferReusers;           /**< Number of attached wrappers that reuse pushed buffers */
 };
 
 }
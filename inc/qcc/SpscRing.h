@@ -0,0 +1,248 @@
+/**
+ * @file
+ *
+ * Bounded lock-free ring buffer for one producer and one consumer.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#ifndef _QCC_SPSCRING_H
+#define _QCC_SPSCRING_H
+
+#include <qcc/platform.h>
+#include <qcc/atomic.h>
+#include <qcc/Futex.h>
+#include <qcc/time.h>
+
+#include <Status.h>
+
+namespace qcc {
+
+/**
+ * A bounded first-in first-out ring buffer with exactly one producer thread
+ * and one consumer thread.
+ *
+ * The producer only writes the tail index and the consumer only writes the
+ * head index, so neither side needs a read-modify-write operation.  Each side
+ * also keeps a private copy of the other side's index and only re-reads the
+ * shared one when the copy says the ring is full or empty, which keeps the
+ * cache lines from bouncing between the two threads on every call.
+ *
+ * TryPush() and TryPop() never block.  Push() and Pop() spin briefly and then
+ * sleep on an EventCount until the ring is no longer full or empty.
+ *
+ * T must be default constructible and assignable.  A popped slot is reset to
+ * T() so that it does not keep a reference alive.
+ */
+template <typename T>
+class SpscRing {
+  public:
+
+    /**
+     * Constructor
+     *
+     * @param capacity  Maximum number of queued items.  Rounded up to a power
+     *                  of two no smaller than 2.
+     */
+    SpscRing(size_t capacity) : slots(NULL), mask(0), tail(0), cachedHead(0), head(0), cachedTail(0)
+    {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        mask = size - 1;
+        slots = new T[size];
+    }
+
+    /** Destructor */
+    ~SpscRing() { delete [] slots; }
+
+    /**
+     * Queue an item if there is room.  Only call from the producer thread.
+     *
+     * @param item  Item to queue.
+     * @return  true if the item was queued, false if the ring was full.
+     */
+    bool TryPush(const T& item)
+    {
+        if (!Enqueue(item)) {
+            return false;
+        }
+        notEmpty.Notify();
+        return true;
+    }
+
+    /**
+     * Dequeue the oldest item if there is one.  Only call from the consumer
+     * thread.
+     *
+     * @param item  Returns the item.
+     * @return  true if an item was dequeued, false if the ring was empty.
+     */
+    bool TryPop(T& item)
+    {
+        if (!Dequeue(item)) {
+            return false;
+        }
+        notFull.Notify();
+        return true;
+    }
+
+    /**
+     * Queue an item, waiting for room if the ring is full.  Only call from the
+     * producer thread.
+     *
+     * @param item   Item to queue.
+     * @param maxMs  Maximum time to wait in milliseconds.
+     * @return  ER_OK or ER_TIMEOUT.
+     */
+    QStatus Push(const T& item, uint32_t maxMs = Event::WAIT_FOREVER)
+    {
+        uint64_t deadline = (maxMs == Event::WAIT_FOREVER) ? 0 : GetTimestamp64() + maxMs;
+        for (uint32_t spin = 0; spin < SPINS; ++spin) {
+            if (TryPush(item)) {
+                return ER_OK;
+            }
+        }
+        while (true) {
+            int32_t key = notFull.PrepareWait();
+            if (Enqueue(item)) {
+                notFull.CancelWait();
+                notEmpty.Notify();
+                return ER_OK;
+            }
+            if (notFull.Wait(key, Remaining(deadline)) == ER_TIMEOUT) {
+                return TryPush(item) ? ER_OK : ER_TIMEOUT;
+            }
+        }
+    }
+
+    /**
+     * Dequeue the oldest item, waiting for one if the ring is empty.  Only
+     * call from the consumer thread.
+     *
+     * @param item   Returns the item.
+     * @param maxMs  Maximum time to wait in milliseconds.
+     * @return  ER_OK or ER_TIMEOUT.
+     */
+    QStatus Pop(T& item, uint32_t maxMs = Event::WAIT_FOREVER)
+    {
+        uint64_t deadline = (maxMs == Event::WAIT_FOREVER) ? 0 : GetTimestamp64() + maxMs;
+        for (uint32_t spin = 0; spin < SPINS; ++spin) {
+            if (TryPop(item)) {
+                return ER_OK;
+            }
+        }
+        while (true) {
+            int32_t key = notEmpty.PrepareWait();
+            if (Dequeue(item)) {
+                notEmpty.CancelWait();
+                notFull.Notify();
+                return ER_OK;
+            }
+            if (notEmpty.Wait(key, Remaining(deadline)) == ER_TIMEOUT) {
+                return TryPop(item) ? ER_OK : ER_TIMEOUT;
+            }
+        }
+    }
+
+    /**
+     * The number of items the ring can hold.
+     *
+     * @return  The capacity.
+     */
+    size_t Capacity() const { return mask + 1; }
+
+    /**
+     * The number of queued items.  Only a snapshot when the other thread is
+     * using the ring.
+     *
+     * @return  The number of queued items.
+     */
+    size_t Size() const { return tail.Load(MEMORY_ORDER_ACQUIRE) - head.Load(MEMORY_ORDER_ACQUIRE); }
+
+  private:
+    SpscRing(const SpscRing& other);
+    SpscRing& operator=(const SpscRing& other);
+
+    /** Number of non-blocking attempts Push() and Pop() make before sleeping */
+    static const uint32_t SPINS = 64;
+
+    bool Enqueue(const T& item)
+    {
+        size_t pos = tail.Load(MEMORY_ORDER_RELAXED);
+        if (pos - cachedHead > mask) {
+            cachedHead = head.Load(MEMORY_ORDER_ACQUIRE);
+            if (pos - cachedHead > mask) {
+                return false;
+            }
+        }
+        slots[pos & mask] = item;
+        tail.Store(pos + 1, MEMORY_ORDER_RELEASE);
+        return true;
+    }
+
+    bool Dequeue(T& item)
+    {
+        size_t pos = head.Load(MEMORY_ORDER_RELAXED);
+        if (pos == cachedTail) {
+            cachedTail = tail.Load(MEMORY_ORDER_ACQUIRE);
+            if (pos == cachedTail) {
+                return false;
+            }
+        }
+        item = slots[pos & mask];
+        slots[pos & mask] = T();
+        head.Store(pos + 1, MEMORY_ORDER_RELEASE);
+        return true;
+    }
+
+    static uint32_t Remaining(uint64_t deadline)
+    {
+        if (deadline == 0) {
+            return Event::WAIT_FOREVER;
+        }
+        uint64_t now = GetTimestamp64();
+        return (now < deadline) ? static_cast<uint32_t>(deadline - now) : 0;
+    }
+
+    T* slots;
+    size_t mask;
+
+    /*
+     * The producer's line: the index it writes and its copy of head.
+     */
+    char pad0[QCC_CACHE_LINE_SIZE];
+    Atomic<size_t> tail;
+    size_t cachedHead;
+    char pad1[QCC_CACHE_LINE_SIZE - sizeof(Atomic<size_t>) - sizeof(size_t)];
+
+    /*
+     * The consumer's line: the index it writes and its copy of tail.
+     */
+    Atomic<size_t> head;
+    size_t cachedTail;
+    char pad2[QCC_CACHE_LINE_SIZE - sizeof(Atomic<size_t>) - sizeof(size_t)];
+
+    EventCount notEmpty;
+    char pad3[QCC_CACHE_LINE_SIZE - sizeof(EventCount)];
+    EventCount notFull;
+    char pad4[QCC_CACHE_LINE_SIZE - sizeof(EventCount)];
+};
+
+}
+
+#endif
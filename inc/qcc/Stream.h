@@ -171,12 +171,38 @@ class Sink {
      */
     virtual QStatus Flush() { return ER_OK; }
 
+    /**
+     * Hold back partially filled packets until Uncork().  Used by BufferedSink
+     * around the batches it writes.
+     *
+     * @return ER_OK if the sink was corked, ER_NOT_IMPLEMENTED if it does not cork.
+     */
+    virtual QStatus Cork() { return ER_NOT_IMPLEMENTED; }
+
+    /**
+     * Send anything held back since Cork().
+     *
+     * @return ER_OK if successful.
+     */
+    virtual QStatus Uncork() { return ER_OK; }
+
     /**
      * Set the send timeout for this sink.
      *
      * @param sendTimeout   Send timeout in ms.
      */
     virtual void SetSendTimeout(uint32_t sendTimeout) { }
+
+    /**
+     * Tell the sink that a wrapper overwrites the buffers it pushes as soon as
+     * PushBytes() returns, as BufferedSink does with its chunk buffer.  Called
+     * with true when the wrapper starts using the sink and with false when it
+     * stops.  While any such wrapper is attached the sink must not use a
+     * pushed buffer after PushBytes() returns; see SocketStream::EnableZeroCopy().
+     *
+     * @param reused   true when a wrapper attaches, false when it detaches.
+     */
+    virtual void SetBufferReuse(bool reused) { }
 };
 
 /**
@@ -29,10 +29,21 @@
 namespace qcc {
 
 /**
- * String is a heap-allocated array of bytes whose life-cycle is managed
- * through reference counting. When all references to a qcc::String instance
- * go out of scope or are deleted, then the underlying heap-allocated storage
- * is freed.
+ * String is an array of bytes. Short strings (up to InlineCapacity bytes) are
+ * stored inside the String object itself and are copied on copy. Longer
+ * strings are heap-allocated and their life-cycle is managed through reference
+ * counting: copies share the storage until one of them is modified. When all
+ * references to the heap-allocated storage go out of scope or are deleted,
+ * then it is freed.
+ *
+ * When the compiler supports rvalue references String also has a move
+ * constructor and move assignment operator which transfer the storage without
+ * touching the reference count.
+ *
+ * Binary compatibility: the inline buffer makes sizeof(String) 48 bytes on
+ * 64 bit targets, and 40 bytes on 32 bit targets, where it used to be two
+ * pointers. Code that embeds a String (directly or through a class or
+ * container) must be recompiled against this header.
  */
 class String {
   public:
@@ -90,6 +101,35 @@ class String {
     /** Assignment operator */
     String& operator=(const String& assignFromMe);
 
+#if defined(QCC_HAS_RVALUE_REFERENCES)
+    /*
+     * The move operations are inline so that a library built without C++11
+     * can be used by C++11 code and vice versa.
+     */
+
+    /**
+     * Move Constructor
+     *
+     * @param str   String to move from. It is left empty.
+     */
+    String(String&& str) { MoveFrom(str); }
+
+    /**
+     * Move assignment operator
+     *
+     * @param str   String to move from. It is left empty.
+     * @return  Reference to this string.
+     */
+    String& operator=(String&& str)
+    {
+        if (&str != this) {
+            DecRef(context);
+            MoveFrom(str);
+        }
+        return *this;
+    }
+#endif
+
     /**
      * Assign a value to a string
      *
@@ -163,8 +203,15 @@ class String {
      * this value is not zero then there are other copies of the string that were also cleared.
      * If this happens it was most likely due to a coding error.
      *
+     * Strings of up to InlineCapacity bytes are stored inside the String object and copied by
+     * value, so for them this clears only this instance: every copy made earlier still holds the
+     * secret, and the count returned is zero. A string holding key material must therefore either
+     * never be copied or have each of its copies cleared with secure_clear() as well. Moving a
+     * String also copies inline contents, leaving them in the moved-from object until it is
+     * overwritten.
+     *
      * @return  The number of other string instances that were cleared as a side-effect of clearing
-     *          this string.
+     *          this string. Always zero for a string stored inline.
      */
     size_t secure_clear();
 
@@ -462,26 +509,59 @@ class String {
      */
     static const String& Empty;
 
+    /**
+     * Longest string that is stored inside the String object rather than on
+     * the heap.
+     */
+    static const size_t InlineCapacity = 19;
+
   private:
 
+    /* Writes directly into the storage of a String it then hands over */
+    friend class StringBuilder;
+
     static const size_t MinCapacity = 16;
 
     typedef struct {
-        int32_t refCount;        /**< The reference count of the context */
+        int32_t refCount;        /**< The reference count of the context, always 1 for the inline context */
         uint32_t offset;         /**< The offset of the end of the string */
         uint32_t capacity;       /**< The size of the string buffer */
         char c_str[MinCapacity]; /**< The buffer holding the actual character string */
     } ManagedCtx;
 
+    /**
+     * Points to nullContext, to inlineCtx.ctx, or to a heap-allocated context
+     * that may be shared with other strings.
+     */
     ManagedCtx* context;
 
+    /** Storage for a short string */
+    union {
+        ManagedCtx ctx;
+        char storage[sizeof(ManagedCtx) - MinCapacity + InlineCapacity + 1];
+    } inlineCtx;
+
     static ManagedCtx nullContext;
 
+    bool IsInline() const { return context == &inlineCtx.ctx; }
+
     void IncRef();
 
     void DecRef(ManagedCtx* context);
 
     void NewContext(const char* str, size_t strLen, size_t sizeHint);
+
+    void CopyFrom(const String& other);
+
+    void MoveFrom(String& other)
+    {
+        if (other.IsInline()) {
+            CopyFrom(other);
+        } else {
+            context = other.context;
+        }
+        other.context = &nullContext;
+    }
 };
 
 }
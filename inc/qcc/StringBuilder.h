@@ -0,0 +1,313 @@
+/**
+ * @file
+ *
+ * Incremental construction of strings.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#ifndef _QCC_STRINGBUILDER_H
+#define _QCC_STRINGBUILDER_H
+
+#include <qcc/platform.h>
+
+#include <stdarg.h>
+#include <string.h>
+
+#include <qcc/String.h>
+#include <qcc/StringRef.h>
+
+namespace qcc {
+
+/**
+ * A StringBuilder collects the pieces of a string that is built up by many
+ * small appends, such as generated XML or a log line.
+ *
+ * The first StackCapacity bytes are kept in a buffer inside the builder, so a
+ * StringBuilder on the stack produces short strings without touching the
+ * heap.  Longer strings are written straight into the storage of a qcc::String
+ * that doubles in size as it fills, and ToString() hands that storage over
+ * without copying it.  Numbers are formatted in place rather than through
+ * temporary strings.
+ *
+ * A StringBuilder cannot be copied.
+ */
+class StringBuilder {
+  public:
+
+    /** Number of bytes held inside the builder before moving to the heap */
+    static const size_t StackCapacity = 256;
+
+    /**
+     * Construct an empty builder.
+     */
+    StringBuilder() : buf(stack), len(0), cap(StackCapacity) { }
+
+    /**
+     * Construct an empty builder.
+     *
+     * @param sizeHint  Expected length of the final string.  If it does not fit
+     *                  in the inline buffer the heap storage is allocated now.
+     */
+    explicit StringBuilder(size_t sizeHint) : buf(stack), len(0), cap(StackCapacity)
+    {
+        if (sizeHint > cap) {
+            Grow(sizeHint);
+        }
+    }
+
+    /**
+     * Append a character.
+     *
+     * @param c  The character to append.
+     * @return  Reference to this builder.
+     */
+    StringBuilder& append(char c)
+    {
+        if (len == cap) {
+            Grow(1);
+        }
+        buf[len++] = c;
+        return *this;
+    }
+
+    /**
+     * Append n copies of a character.
+     *
+     * @param n  Number of characters to append.
+     * @param c  The character to append.
+     * @return  Reference to this builder.
+     */
+    StringBuilder& append(size_t n, char c)
+    {
+        ::memset(Reserve(n), c, n);
+        len += n;
+        return *this;
+    }
+
+    /**
+     * Append an array of characters.
+     *
+     * @param str     The characters to append.
+     * @param strLen  Number of characters to append.
+     * @return  Reference to this builder.
+     */
+    StringBuilder& append(const char* str, size_t strLen)
+    {
+        ::memcpy(Reserve(strLen), str, strLen);
+        len += strLen;
+        return *this;
+    }
+
+    /**
+     * Append a string.
+     *
+     * @param str  The string to append.
+     * @return  Reference to this builder.
+     */
+    StringBuilder& append(const qcc::StringRef& str) { return append(str.data(), str.size()); }
+
+    /**
+     * Insert characters, moving the ones after pos along to make room.  This
+     * is for filling in a short header, such as a length, once the size of
+     * what follows it is known.
+     *
+     * @param pos     Where to insert, no more than size().
+     * @param str     The characters to insert.
+     * @param strLen  Number of characters to insert.
+     * @return  Reference to this builder.
+     */
+    StringBuilder& insert(size_t pos, const char* str, size_t strLen)
+    {
+        char* at = Reserve(strLen) - len + pos;
+        ::memmove(at + strLen, at, len - pos);
+        ::memcpy(at, str, strLen);
+        len += strLen;
+        return *this;
+    }
+
+    /**
+     * Append printf style formatted text.
+     *
+     * @param fmt  The format string.
+     * @return  Reference to this builder.
+     */
+    StringBuilder& appendf(const char* fmt, ...);
+
+    /**
+     * Append printf style formatted text.
+     *
+     * @param fmt   The format string.
+     * @param args  The arguments.
+     * @return  Reference to this builder.
+     */
+    StringBuilder& vappendf(const char* fmt, va_list args);
+
+    /**
+     * Append bytes as hex digits, in the same form as BytesToHexString.
+     *
+     * @param bytes      The bytes to append.
+     * @param numBytes   Number of bytes.
+     * @param toLower    Use lower case hex digits.
+     * @param separator  Character to put between bytes or nul for none.
+     * @return  Reference to this builder.
+     */
+    StringBuilder& appendHex(const uint8_t* bytes, size_t numBytes, bool toLower = false, char separator = 0);
+
+    /**
+     * Append an unsigned number, in the same form as U32ToString.
+     *
+     * @param num    The number.
+     * @param base   Base between 2 and 16.
+     * @param width  Minimum number of characters, padded on the left with fill.
+     * @param fill   Character used to pad to width.
+     * @return  Reference to this builder.
+     */
+    StringBuilder& appendU32(uint32_t num, unsigned int base = 10, size_t width = 1, char fill = ' ') { return appendU64(num, base, width, fill); }
+
+    /**
+     * Append a signed number, in the same form as I32ToString.
+     *
+     * @param num    The number.
+     * @param base   Base between 2 and 16.
+     * @param width  Minimum number of characters including the sign, padded with fill after the sign.
+     * @param fill   Character used to pad to width.
+     * @return  Reference to this builder.
+     */
+    StringBuilder& appendI32(int32_t num, unsigned int base = 10, size_t width = 1, char fill = ' ') { return appendI64(num, base, width, fill); }
+
+    /**
+     * Append an unsigned number, in the same form as U64ToString.
+     *
+     * @param num    The number.
+     * @param base   Base between 2 and 16.
+     * @param width  Minimum number of characters, padded on the left with fill.
+     * @param fill   Character used to pad to width.
+     * @return  Reference to this builder.
+     */
+    StringBuilder& appendU64(uint64_t num, unsigned int base = 10, size_t width = 1, char fill = ' ');
+
+    /**
+     * Append a signed number, in the same form as I64ToString.
+     *
+     * @param num    The number.
+     * @param base   Base between 2 and 16.
+     * @param width  Minimum number of characters including the sign, padded with fill after the sign.
+     * @param fill   Character used to pad to width.
+     * @return  Reference to this builder.
+     */
+    StringBuilder& appendI64(int64_t num, unsigned int base = 10, size_t width = 1, char fill = ' ');
+
+    /**
+     * Append fill characters until the string is at least column characters long.
+     *
+     * @param column  The length to pad to.
+     * @param fill    The character to pad with.
+     * @return  Reference to this builder.
+     */
+    StringBuilder& padTo(size_t column, char fill = ' ') { return (len < column) ? append(column - len, fill) : *this; }
+
+    /**
+     * Get space to write at least n characters at the end of the string.  The
+     * characters become part of the string when they are committed.
+     *
+     * @param n  Number of characters that will be written.
+     * @return  Where to write the characters.
+     */
+    char* Reserve(size_t n)
+    {
+        if (n > cap - len) {
+            Grow(n);
+        }
+        return buf + len;
+    }
+
+    /**
+     * Add characters written to the space returned by Reserve() to the string.
+     *
+     * @param n  Number of characters written, no more than were reserved.
+     */
+    void Commit(size_t n) { len += n; }
+
+    /**
+     * Get the characters appended so far.  They are not nul terminated.
+     *
+     * @return  The characters.
+     */
+    const char* data() const { return buf; }
+
+    /**
+     * Get the number of characters appended so far.
+     *
+     * @return  The length of the string.
+     */
+    size_t size() const { return len; }
+
+    /**
+     * Return true if nothing has been appended.
+     *
+     * @return true iff empty.
+     */
+    bool empty() const { return len == 0; }
+
+    /**
+     * Discard the characters, keeping any heap storage for reuse.
+     */
+    void clear() { len = 0; }
+
+    /**
+     * Get the characters appended so far.
+     *
+     * @return  A reference to the characters, valid until the next append.
+     */
+    qcc::StringRef Ref() const { return qcc::StringRef(buf, len); }
+
+    /**
+     * Hand over the string to a qcc::String and empty the builder.  If the
+     * string has moved to the heap its storage becomes the String's storage
+     * without being copied.
+     *
+     * @return  The string.
+     */
+    qcc::String ToString();
+
+    /**
+     * Append the string to a qcc::String and empty the builder.  If str is
+     * empty this is the same as assigning ToString() to it.
+     *
+     * @param str  The String to append to.
+     */
+    void AppendTo(qcc::String& str);
+
+  private:
+
+    /* Private, a builder is not copied */
+    StringBuilder(const StringBuilder& other);
+    StringBuilder& operator=(const StringBuilder& other);
+
+    /** Make room for at least n more characters */
+    void Grow(size_t n);
+
+    char* buf;                    /**< Either stack or the storage of heap */
+    size_t len;                   /**< Number of characters in buf */
+    size_t cap;                   /**< Number of characters buf can hold, not counting a terminating nul */
+    qcc::String heap;             /**< Storage for strings that outgrow stack */
+    char stack[StackCapacity + 1];
+};
+
+}
+
+#endif
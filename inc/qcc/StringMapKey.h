@@ -25,6 +25,7 @@
 
 #include <qcc/Util.h>
 #include <qcc/String.h>
+#include <qcc/StringRef.h>
 #include <string.h>
 
 #include <qcc/STLContainer.h>
@@ -46,7 +47,7 @@ class StringMapKey {
      *
      * @param key   String whose value will be copied into StringMapKey
      */
-    StringMapKey(const qcc::String& key) : charPtr(NULL), str(key) { }
+    StringMapKey(const qcc::String& key) : charPtr(NULL), len(key.size()), str(key) { }
 
     /**
      * Create an unbacked version of the StringMapKey
@@ -58,7 +59,17 @@ class StringMapKey {
      * @param key   char* whose value (but not contents) will be stored
      *              in the StringMapKey.
      */
-    StringMapKey(const char* key) : charPtr(key), str() { }
+    StringMapKey(const char* key) : charPtr(key), len(::strlen(key)), str() { }
+
+    /**
+     * Create an unbacked version of the StringMapKey from a StringRef.
+     * The characters referred to must remain valid for the life of the
+     * StringMapKey. They need not be nul terminated so c_str() must not be
+     * used on such a key; use Ref() instead.
+     *
+     * @param key   Reference to the characters of the key.
+     */
+    StringMapKey(const qcc::StringRef& key) : charPtr(key.data()), len(key.size()), str() { }
 
     /**
      * Get a char* representation of this StringKeyMap
@@ -72,27 +83,35 @@ class StringMapKey {
      *
      * @return true iff StringMapKey is empty.
      */
-    inline bool empty() const { return charPtr ? charPtr[0] == '\0' : str.empty(); }
+    inline bool empty() const { return len == 0; }
 
     /**
      * Return the size of the contained string.
      *
      * @return size of the contained string.
      */
-    inline size_t size() const { return charPtr ? strlen(charPtr) : str.size(); }
+    inline size_t size() const { return len; }
+
+    /**
+     * Get a StringRef referring to the characters of this StringMapKey
+     *
+     * @return  StringRef for the key
+     */
+    inline qcc::StringRef Ref() const { return qcc::StringRef(charPtr ? charPtr : str.data(), len); }
 
     /**
      * Less than operation
      */
-    inline bool operator<(const StringMapKey& other) const { return ::strcmp(c_str(), other.c_str()) < 0; }
+    inline bool operator<(const StringMapKey& other) const { return Ref() < other.Ref(); }
 
     /**
      * Equals operation
      */
-    inline bool operator==(const StringMapKey& other) const { return ::strcmp(c_str(), other.c_str()) == 0; }
+    inline bool operator==(const StringMapKey& other) const { return Ref() == other.Ref(); }
 
   private:
     const char* charPtr;
+    size_t len;
     qcc::String str;
 };
 
@@ -107,7 +126,7 @@ namespace std {
  */
 template <>
 struct less<qcc::StringMapKey> {
-    inline bool operator()(const qcc::StringMapKey& a, const qcc::StringMapKey& b) const { return ::strcmp(a.c_str(), b.c_str()) < 0; }
+    inline bool operator()(const qcc::StringMapKey& a, const qcc::StringMapKey& b) const { return a < b; }
 };
 }  // End of std namespace
 
@@ -120,7 +139,7 @@ _BEGIN_NAMESPACE_CONTAINER_FOR_HASH
  */
 template <>
 struct tr1::hash<qcc::StringMapKey> {
-    inline size_t operator()(const qcc::StringMapKey& k) const { return qcc::hash_string(k.c_str()); }
+    inline size_t operator()(const qcc::StringMapKey& k) const { return k.Ref().hash(); }
 };
 _END_NAMESPACE_CONTAINER_FOR_HASH
 
@@ -0,0 +1,253 @@
+/**
+ * @file
+ *
+ * Non-owning reference to a sequence of characters.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#ifndef _QCC_STRINGREF_H
+#define _QCC_STRINGREF_H
+
+#include <qcc/platform.h>
+
+#include <string.h>
+
+#include <qcc/String.h>
+#include <qcc/StringSearch.h>
+#include <qcc/STLContainer.h>
+
+namespace qcc {
+
+/**
+ * StringRef is a pointer and a length referring to characters owned by
+ * somebody else, typically a qcc::String or a string literal. It can be
+ * constructed implicitly from either, so a function that takes a StringRef
+ * accepts both without creating a temporary String.
+ *
+ * The referenced characters are not necessarily nul terminated and must
+ * outlive the StringRef.
+ */
+class StringRef {
+  public:
+
+    /** String index constant indicating "past the end" */
+    static const size_t npos = static_cast<size_t>(-1);
+
+    /** const StringRef iterator type */
+    typedef const char* const_iterator;
+
+    /**
+     * Construct an empty reference.
+     */
+    StringRef() : str(""), len(0) { }
+
+    /**
+     * Refer to a nul terminated string.
+     *
+     * @param str  The string, or NULL for an empty reference.
+     */
+    StringRef(const char* str) : str(str ? str : ""), len(str ? ::strlen(str) : 0) { }
+
+    /**
+     * Refer to len characters starting at str.
+     *
+     * @param str  The first character.
+     * @param len  Number of characters.
+     */
+    StringRef(const char* str, size_t len) : str(str), len(len) { }
+
+    /**
+     * Refer to the contents of a String. The reference is invalidated by
+     * anything that modifies or destroys the String.
+     *
+     * @param str  The String.
+     */
+    StringRef(const qcc::String& str) : str(str.data()), len(str.size()) { }
+
+    /**
+     * Get a pointer to the characters. They are not necessarily nul terminated.
+     *
+     * @return  Pointer to the first character.
+     */
+    const char* data() const { return str; }
+
+    /**
+     * Get the number of characters.
+     *
+     * @return  The number of characters.
+     */
+    size_t size() const { return len; }
+
+    /**
+     * Get the number of characters.
+     *
+     * @return  The number of characters.
+     */
+    size_t length() const { return len; }
+
+    /**
+     * Return true if the reference has no characters.
+     *
+     * @return true iff empty.
+     */
+    bool empty() const { return len == 0; }
+
+    /**
+     * Get an iterator to the first character.
+     *
+     * @return  Iterator to the first character.
+     */
+    const_iterator begin() const { return str; }
+
+    /**
+     * Get an iterator to one past the last character.
+     *
+     * @return  Iterator to one past the last character.
+     */
+    const_iterator end() const { return str + len; }
+
+    /**
+     * Get the character at a given position. No range checking is done.
+     *
+     * @param pos  Position of the character.
+     * @return  The character at pos.
+     */
+    char operator[](size_t pos) const { return str[pos]; }
+
+    /**
+     * Compare with another sequence of characters.
+     *
+     * @param other  Characters to compare with.
+     * @return  &lt;0, 0 or &gt;0 if this is less than, equal to or greater than other.
+     */
+    int compare(const StringRef& other) const
+    {
+        int ret = ::memcmp(str, other.str, (len < other.len) ? len : other.len);
+        if (ret == 0) {
+            ret = (len < other.len) ? -1 : ((len > other.len) ? 1 : 0);
+        }
+        return ret;
+    }
+
+    /**
+     * Find the first occurrence of a character.
+     *
+     * @param c    Character to find.
+     * @param pos  Position to start searching at.
+     * @return  Position of the character or npos if not found.
+     */
+    size_t find(char c, size_t pos = 0) const
+    {
+        if (pos >= len) {
+            return npos;
+        }
+        const char* p = static_cast<const char*>(::memchr(str + pos, c, len - pos));
+        return p ? static_cast<size_t>(p - str) : npos;
+    }
+
+    /**
+     * Find the first occurrence of a sequence of characters.
+     *
+     * @param s    Characters to find.
+     * @param pos  Position to start searching at.
+     * @return  Position of the first occurrence or npos if not found.
+     */
+    size_t find(const StringRef& s, size_t pos = 0) const
+    {
+        if (pos > len) {
+            return npos;
+        }
+        const char* p = StringSearch::Find(str + pos, len - pos, s.str, s.len);
+        return p ? static_cast<size_t>(p - str) : npos;
+    }
+
+    /**
+     * Return true if this starts with the given characters.
+     *
+     * @param prefix  The prefix.
+     * @return  true iff this starts with prefix.
+     */
+    bool starts_with(const StringRef& prefix) const
+    {
+        return (prefix.len <= len) && (::memcmp(str, prefix.str, prefix.len) == 0);
+    }
+
+    /**
+     * Refer to part of this reference.
+     *
+     * @param pos  Position of the first character.
+     * @param n    Maximum number of characters.
+     * @return  Reference to the characters.
+     */
+    StringRef substr(size_t pos = 0, size_t n = npos) const
+    {
+        if (pos > len) {
+            pos = len;
+        }
+        return StringRef(str + pos, ((len - pos) < n) ? (len - pos) : n);
+    }
+
+    /**
+     * Copy the characters into a String.
+     *
+     * @return  A String holding a copy of the characters.
+     */
+    qcc::String ToString() const { return len ? qcc::String(str, len) : qcc::String(); }
+
+    /**
+     * Compute a hash of the characters. This is the same hash qcc::hash_string
+     * computes for a nul terminated string.
+     *
+     * @return  The hash.
+     */
+    size_t hash() const
+    {
+        unsigned long h = 0;
+        for (size_t i = 0; i < len; ++i) {
+            h = 5 * h + str[i];
+        }
+        return size_t(h);
+    }
+
+  private:
+    const char* str;
+    size_t len;
+};
+
+/** Equality of two character sequences */
+inline bool operator==(const StringRef& a, const StringRef& b) { return (a.size() == b.size()) && (::memcmp(a.data(), b.data(), a.size()) == 0); }
+
+/** Inequality of two character sequences */
+inline bool operator!=(const StringRef& a, const StringRef& b) { return !(a == b); }
+
+/** Lexicographical ordering of two character sequences */
+inline bool operator<(const StringRef& a, const StringRef& b) { return a.compare(b) < 0; }
+
+}
+
+_BEGIN_NAMESPACE_CONTAINER_FOR_HASH
+/**
+ * Functor to compute a hash for StringRef suitable for use with
+ * std::tr1::unordered_map, std::unordered_set, std::hash_map, std::hash_set.
+ */
+template <>
+struct tr1::hash<qcc::StringRef> {
+    inline size_t operator()(const qcc::StringRef& s) const { return s.hash(); }
+};
+_END_NAMESPACE_CONTAINER_FOR_HASH
+
+#endif
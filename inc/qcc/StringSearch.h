@@ -0,0 +1,141 @@
+/**
+ * @file
+ *
+ * Vectorized search and comparison primitives used by qcc::String.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#ifndef _QCC_STRINGSEARCH_H
+#define _QCC_STRINGSEARCH_H
+
+#include <qcc/platform.h>
+
+#include <string.h>
+
+namespace qcc {
+
+/**
+ * Search and comparison over explicit-length character arrays.
+ *
+ * Each operation has a portable implementation and, on x86, SSE2 and AVX2
+ * implementations.  The best one the processor supports is picked the first
+ * time any of them is used, except that searches for characters not in a set
+ * always use the portable version, which is faster for them.  None of them
+ * read outside the ranges passed in.
+ */
+class StringSearch {
+  public:
+
+    /** Instruction set used by the implementations */
+    typedef enum {
+        SCALAR = 0,     /**< Portable C++ */
+        SSE2 = 1,       /**< 16 bytes at a time */
+        AVX2 = 2        /**< 32 bytes at a time */
+    } Level;
+
+    /**
+     * Get the instruction set currently in use.
+     *
+     * @return  The level in use.
+     */
+    static Level GetLevel();
+
+    /**
+     * Select the instruction set to use.  Intended for tests and benchmarks;
+     * levels the processor does not support are lowered to the best one it
+     * does.
+     *
+     * @param level  The level to use.
+     * @return  The level actually in use.
+     */
+    static Level SetLevel(Level level);
+
+    /**
+     * Find the first occurrence of a pattern.
+     *
+     * @param str     Characters to search.
+     * @param len     Number of characters in str.
+     * @param pat     Pattern to find.
+     * @param patLen  Number of characters in pat.
+     * @return  Pointer to the first occurrence in str, str if patLen is 0 or
+     *          NULL if not found.
+     */
+    static const char* Find(const char* str, size_t len, const char* pat, size_t patLen);
+
+    /**
+     * Find the first character that is (or is not) in a set.
+     *
+     * @param str     Characters to search.
+     * @param len     Number of characters in str.
+     * @param set     Set of characters.
+     * @param setLen  Number of characters in set.
+     * @param inSet   true to find a character in set, false to find one not in set.
+     * @return  Index of the character or len if there is none.
+     */
+    static size_t FindFirstOf(const char* str, size_t len, const char* set, size_t setLen, bool inSet = true);
+
+    /**
+     * Find the last character that is (or is not) in a set.
+     *
+     * @param str     Characters to search.
+     * @param len     Number of characters in str.
+     * @param set     Set of characters.
+     * @param setLen  Number of characters in set.
+     * @param inSet   true to find a character in set, false to find one not in set.
+     * @return  Index of the character or len if there is none.
+     */
+    static size_t FindLastOf(const char* str, size_t len, const char* set, size_t setLen, bool inSet = true);
+
+    /**
+     * Find the first position at which two arrays differ.
+     *
+     * @param a    First array.
+     * @param b    Second array.
+     * @param len  Number of characters to compare.
+     * @return  Index of the first difference or len if the arrays are equal.
+     */
+    static size_t Mismatch(const char* a, const char* b, size_t len);
+
+    /**
+     * Compare two arrays of the same length.  This is memcmp(), which the C
+     * library already vectorizes and which beats Mismatch() when the index of
+     * the difference is not needed.
+     *
+     * @param a    First array.
+     * @param b    Second array.
+     * @param len  Number of characters to compare.
+     * @return  &lt;0, 0 or &gt;0 in the manner of memcmp.
+     */
+    static int Compare(const char* a, const char* b, size_t len)
+    {
+        return ::memcmp(a, b, len);
+    }
+
+    /**
+     * Test two arrays of the same length for equality with memcmp().
+     *
+     * @param a    First array.
+     * @param b    Second array.
+     * @param len  Number of characters to compare.
+     * @return  true if the arrays are equal.
+     */
+    static bool Equal(const char* a, const char* b, size_t len) { return ::memcmp(a, b, len) == 0; }
+};
+
+}
+
+#endif
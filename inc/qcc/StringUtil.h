@@ -29,6 +29,7 @@
 
 #include <qcc/platform.h>
 #include <qcc/String.h>
+#include <qcc/StringRef.h>
 
 namespace qcc {
 
@@ -53,7 +54,7 @@ qcc::String BytesToHexString(const uint8_t* inBytes, size_t len, bool toLower =
  * @param separator  Separator to expect between each byte
  * @return Number of bytes written
  */
-size_t HexStringToBytes(const qcc::String& hex, uint8_t* outBytes, size_t len, char separator = 0);
+size_t HexStringToBytes(const qcc::StringRef& hex, uint8_t* outBytes, size_t len, char separator = 0);
 
 
 /**
@@ -63,7 +64,7 @@ size_t HexStringToBytes(const qcc::String& hex, uint8_t* outBytes, size_t len, c
  * @param separator  Separator to expect between each byte
  * @return A string containing the converted bytes or an empty string if the conversion failed.
  */
-qcc::String HexStringToByteString(const qcc::String& hex, char separator = 0);
+qcc::String HexStringToByteString(const qcc::StringRef& hex, char separator = 0);
 
 
 /**
@@ -126,7 +127,7 @@ qcc::String I64ToString(int64_t num, unsigned int base = 10, size_t width = 1, c
  * @param base      Base (radix) representation of inStr. 0 indicates autodetect according to C nomenclature. Defaults to 0. (Must be between 0 and 16).
  * @param badValue  Value returned if string (up to EOS or first whitespace character) is not parsable as a number.
  */
-uint32_t StringToU32(const qcc::String& inStr, unsigned int base = 0, uint32_t badValue = 0);
+uint32_t StringToU32(const qcc::StringRef& inStr, unsigned int base = 0, uint32_t badValue = 0);
 
 
 /**
@@ -136,7 +137,7 @@ uint32_t StringToU32(const qcc::String& inStr, unsigned int base = 0, uint32_t b
  * @param base      Base (radix) representation of inStr. 0 indicates autodetect according to C nomenclature. Defaults to 0. (Must be between 0 and 16).
  * @param badValue  Value returned if string (up to EOS or first whitespace character) is not parsable as a number.
  */
-int32_t StringToI32(const qcc::String& inStr, unsigned int base = 0, int32_t badValue = 0);
+int32_t StringToI32(const qcc::StringRef& inStr, unsigned int base = 0, int32_t badValue = 0);
 
 
 /**
@@ -146,7 +147,7 @@ int32_t StringToI32(const qcc::String& inStr, unsigned int base = 0, int32_t bad
  * @param base      Base (radix) representation of inStr. 0 indicates autodetect according to C nomenclature. Defaults to 0. (Must be between 0 and 16).
  * @param badValue  Value returned if string (up to EOS or first whitespace character) is not parsable as a number.
  */
-uint64_t StringToU64(const qcc::String& inStr, unsigned int base = 0, uint64_t badValue = 0);
+uint64_t StringToU64(const qcc::StringRef& inStr, unsigned int base = 0, uint64_t badValue = 0);
 
 
 /**
@@ -156,7 +157,7 @@ uint64_t StringToU64(const qcc::String& inStr, unsigned int base = 0, uint64_t b
  * @param base      Base (radix) representation of inStr. 0 indicates autodetect according to C nomenclature. Defaults to 0. (Must be between 0 and 16).
  * @param badValue  Value returned if string (up to EOS or first whitespace character) is not parsable as a number.
  */
-int64_t StringToI64(const qcc::String& inStr, unsigned int base = 0, int64_t badValue = 0);
+int64_t StringToI64(const qcc::StringRef& inStr, unsigned int base = 0, int64_t badValue = 0);
 
 
 /**
@@ -164,7 +165,7 @@ int64_t StringToI64(const qcc::String& inStr, unsigned int base = 0, int64_t bad
  *
  * @param inStr     String representation of number.
  */
-double StringToDouble(const qcc::String& inStr);
+double StringToDouble(const qcc::StringRef& inStr);
 
 
 /**
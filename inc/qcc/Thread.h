@@ -31,6 +31,7 @@
 
 #include <set>
 #include <map>
+#include <vector>
 
 #if defined(QCC_OS_GROUP_POSIX)
 #include <qcc/posix/Thread.h>
@@ -77,6 +78,49 @@ class ThreadListener {
     virtual void ThreadExit(Thread* thread) = 0;
 };
 
+/**
+ * Attributes controlling how the OS thread behind a Thread is created and
+ * where it is allowed to run.  Attributes must be set before the thread is
+ * started.
+ *
+ * The stack size is honored on POSIX and Windows.  CPU affinity and NUMA node
+ * are only applied on Linux and Android; the scheduling policy is applied on
+ * all POSIX platforms.  Attributes that cannot be applied (for example because
+ * the process lacks permission to use a real-time policy) are logged and the
+ * thread runs anyway.
+ */
+class ThreadAttributes {
+  public:
+
+    /**
+     * Scheduling policies.
+     */
+    typedef enum {
+        SCHEDULE_DEFAULT,       /**< The normal time-sharing policy */
+        SCHEDULE_FIFO,          /**< Real-time first-in first-out (SCHED_FIFO) */
+        SCHEDULE_ROUND_ROBIN    /**< Real-time round robin (SCHED_RR) */
+    } SchedulingPolicy;
+
+    /**
+     * Construct a set of attributes that gives the default behavior.
+     */
+    ThreadAttributes() : stackSize(0), numaNode(-1), policy(SCHEDULE_DEFAULT), priority(0) { }
+
+    /**
+     * @return true iff these are the default attributes.
+     */
+    bool IsDefault() const
+    {
+        return (stackSize == 0) && cpus.empty() && (numaNode < 0) && (policy == SCHEDULE_DEFAULT);
+    }
+
+    uint32_t stackSize;             ///< Stack size in bytes or 0 for the default.
+    std::vector<uint32_t> cpus;     ///< CPUs the thread may run on or empty for any.
+    int32_t numaNode;               ///< Run on the CPUs of this NUMA node (if cpus is empty) or -1 for any.
+    SchedulingPolicy policy;        ///< Scheduling policy.
+    int32_t priority;               ///< Priority for the real-time policies.
+};
+
 class ThreadListInitializer;
 
 /**
@@ -229,6 +273,33 @@ class Thread {
      */
     const char* GetName(void) const { return funcName; }
 
+    /**
+     * Set the attributes used when the thread is next started.
+     *
+     * @param attributes  The thread attributes.
+     * @return
+     *      - #ER_OK if successful.
+     *      - #ER_EXTERNAL_THREAD if this is an external thread.
+     *      - #ER_THREAD_RUNNING if the thread has already been started.
+     */
+    QStatus SetAttributes(const ThreadAttributes& attributes)
+    {
+        if (isExternal) {
+            return ER_EXTERNAL_THREAD;
+        } else if (IsRunning()) {
+            return ER_THREAD_RUNNING;
+        }
+        this->attributes = attributes;
+        return ER_OK;
+    }
+
+    /**
+     * Get the attributes used when the thread is started.
+     *
+     * @return The thread attributes.
+     */
+    const ThreadAttributes& GetAttributes(void) const { return attributes; }
+
     /**
      * Return underlying thread handle.
      *
@@ -314,6 +385,7 @@ class Thread {
     bool isExternal;                ///< If true, Thread is external (i.e. lifecycle not managed by Thread obj)
     void* platformContext;          ///< Context data specific to platform implementation
     uint32_t alertCode;             ///< Context passed from alerter to alertee
+    ThreadAttributes attributes;    ///< Attributes applied when the thread is started
 
     typedef std::set<ThreadListener*> ThreadListeners;
     ThreadListeners auxListeners;
@@ -1,7 +1,7 @@
 /**
  * @file
  *
- * Simple ThreadPool using Timers and Alarms
+ * ThreadPool built on a bounded work queue and a fixed set of worker threads
  */
 
 /******************************************************************************
@@ -23,15 +23,19 @@
 #ifndef _QCC_THREADPOOL_H
 #define _QCC_THREADPOOL_H
 
-#include <map>
+#include <vector>
 
-#include <qcc/Timer.h>
+#include <qcc/Thread.h>
 #include <qcc/Event.h>
+#include <qcc/Mutex.h>
 #include <qcc/Ptr.h>
+#include <qcc/atomic.h>
+#include <qcc/Future.h>
 
 namespace qcc {
 
 class ThreadPool;
+class ThreadPoolWorker;
 
 /**
  * A class in the spirit of the Java Runnable object that is used to define an
@@ -53,18 +57,18 @@ class ThreadPool;
  * enclosed type.  Since we need the cast behavior, we use the Ptr intrusive
  * smart pointer class to manage our runnable closures.
  */
-class Runnable : public qcc::RefCountBase, public qcc::AlarmListener {
+class Runnable : public qcc::RefCountBase {
   public:
 
     /**
      * Construct a Runnable object suitable for use by a ThreadPool
      */
-    Runnable() : m_threadpool(NULL) { }
+    Runnable() { }
 
     /**
      * Destroy a Runnable object.
      */
-    virtual ~Runnable() { m_threadpool = NULL; }
+    virtual ~Runnable() { }
 
     /**
      * This method is called by the ThreadPool when the Runnable object is
@@ -73,42 +77,59 @@ class Runnable : public qcc::RefCountBase, public qcc::AlarmListener {
      * called.
      */
     virtual void Run(void) { };
+};
+
+/**
+ * A Runnable which produces a result, in the spirit of the Java Callable and
+ * FutureTask objects.
+ *
+ * Inherit from Callable and provide a Call() method.  Hand the Callable to a
+ * ThreadPool as for any other Runnable and use GetFuture() to wait for the
+ * result.  If the thread pool discards the Callable without running it (for
+ * example because the pool was stopped), the Future fails with
+ * #ER_THREADPOOL_STOPPING rather than leaving its waiters hanging.
+ */
+template <typename T>
+class Callable : public Runnable {
+  public:
+
+    /**
+     * Destroy a Callable, failing its result if it never ran.
+     */
+    virtual ~Callable()
+    {
+        m_promise.SetError(ER_THREADPOOL_STOPPING);
+    }
 
-  private:
     /**
-     * ThreadPool must be a friend in order to make AlarmTriggered an accessible
-     * base class method of a user's Runnable, and to allow the ThreadPool to
-     * set a pointer to itself here to allow for notifications.
+     * Get a Future for the result of Call().
      */
-    friend class ThreadPool;
+    Future<T> GetFuture() const { return m_promise.GetFuture(); }
 
     /**
-     * AlarmTriggered is the method that is called to dispatch an alarm.
-     * Our Run() methods are driven by alarm expirations that happen to
-     * always occur immediately.
+     * Compute the result.  Called on one of the threads of the thread pool.
      *
-     * Note that the enclosing runnable object is automatically deleted
-     * afte the Run method is executed.
+     * @param result  Returns the result if ER_OK is returned.
+     * @return ER_OK or an error which is reported through the Future.
      */
-    virtual void AlarmTriggered(const Alarm& alarm, QStatus reason);
+    virtual QStatus Call(T& result) = 0;
 
     /**
-     * Private method used by the thread pool to tell this object how to contact
-     * the thread pool when the reference to the runnable closure is no longer
-     * needed.
+     * Run Call() and complete the Future.
      */
-    void SetThreadPool(ThreadPool* threadpool)
+    virtual void Run(void)
     {
-        m_threadpool = threadpool;
+        T result;
+        QStatus status = Call(result);
+        if (status == ER_OK) {
+            m_promise.SetValue(result);
+        } else {
+            m_promise.SetError(status);
+        }
     }
 
-    /**
-     * A reference back to the thread pool that causes the run method to be
-     * called.  We need this reference so the thread pool can hook a "done"
-     * event since it would otherwise be unaware of the execution of the
-     * runderlying timer alarm callback that it arranged to be called.
-     */
-    ThreadPool* m_threadpool;
+  private:
+    Promise<T> m_promise;
 };
 
 /**
@@ -118,6 +139,22 @@ class Runnable : public qcc::RefCountBase, public qcc::AlarmListener {
  *
  * In order to ask a ThreadPool to execute a task, one must inherit from the
  * Runnable class and provide a Run() method.
+ *
+ * Tasks handed to Execute() are placed on a bounded first-in first-out work
+ * queue.  A fixed set of worker threads pull tasks directly off of that queue
+ * and run them.  When the queue is full, Execute() fails immediately with
+ * #ER_THREADPOOL_EXHAUSTED while ExecuteBlocking() and
+ * WaitForAvailableThread() put the caller to sleep until a worker frees up a
+ * slot.  This is how backpressure is applied to whatever is producing work.
+ *
+ * A ThreadPool may optionally be created in work-stealing mode.  In this mode
+ * every worker also owns a double-ended queue of its own.  Tasks submitted by
+ * a Runnable that is executing on one of the pool's workers go onto the
+ * bottom of that worker's deque, where the worker picks them up again (last
+ * in first out) without touching the lock of the shared work queue.  Workers
+ * that run out of work steal the oldest tasks from the top of the other
+ * workers' deques.  This suits workloads in which most of the work is fanned
+ * out by the pool's own threads.
  */
 class ThreadPool {
   public:
@@ -126,8 +163,16 @@ class ThreadPool {
      *
      * @param name     The name of the thread pool (used in logging).
      * @param poolsize The number of threads available in the pool.
+     * @param backlog  The maximum number of Runnable tasks that may be queued
+     *                 waiting for a thread, or 0 to use poolsize.  In
+     *                 work-stealing mode this is also the capacity of each
+     *                 worker's own deque (rounded up to a power of two).
+     * @param workStealing  If true, give each worker its own deque and let idle
+     *                      workers steal from the others.
+     * @param attributes   Attributes for the worker threads (stack size, CPU affinity, scheduling policy).
      */
-    ThreadPool(const char* name, uint32_t poolsize);
+    ThreadPool(const char* name, uint32_t poolsize, uint32_t backlog = 0, bool workStealing = false,
+               const ThreadAttributes& attributes = ThreadAttributes());
 
     /**
      * Destroy a thread pool.
@@ -135,15 +180,17 @@ class ThreadPool {
     virtual ~ThreadPool();
 
     /**
-     * Request that we cancel all of our dispatched threads.
+     * Request that we cancel all of our dispatched threads.  Runnable tasks
+     * which are still waiting on the work queue are discarded when the pool
+     * is joined.
      */
     QStatus Stop();
 
     /**
-     * Wait for all of the threads in our associated timer to exit.  Once
-     * this happens, it is safe for us to finish tearing down our object.
-     * Note that this call can block or a time limited only by the execution
-     * time of the threads dispatched.
+     * Wait for all of our worker threads to exit.  Once this happens, it is
+     * safe for us to finish tearing down our object.  Note that this call can
+     * block for a time limited only by the execution time of the Runnable
+     * tasks that are currently executing.
      */
     QStatus Join();
 
@@ -161,6 +208,27 @@ class ThreadPool {
         return m_poolsize;
     }
 
+    /**
+     * Determine the capacity of the work queue.
+     *
+     * @return The maximum number of Runnable tasks that may be waiting for a
+     *         thread at any one time.
+     */
+    uint32_t GetBacklog(void)
+    {
+        return m_backlog;
+    }
+
+    /**
+     * Determine whether the thread pool is running in work-stealing mode.
+     *
+     * @return true iff each worker has its own deque of tasks.
+     */
+    bool IsWorkStealing(void)
+    {
+        return m_workStealing;
+    }
+
     /**
      * Determine how many Runnable tasks are pending on the thread pool.
      *
@@ -186,7 +254,12 @@ class ThreadPool {
      * needed, so it takes responsibility for managing the memory of the runnable
      * when Execute is called.
      *
-     * Each call to Execute must provide a pointer to a unique Runnable
+     * This call never blocks.  If the work queue is full the Runnable is not
+     * accepted.
+     *
+     * In work-stealing mode a Runnable that is submitted from one of the
+     * threads of this pool is placed on that thread's own deque.  The shared
+     * work queue is only used if that deque is full.
      *
      * @param runnable A Ptr (smart pointer) to a Runnable Object providing the
      *                 Run() method which one of the threads in this thread pool
@@ -194,10 +267,75 @@ class ThreadPool {
      *
      * @return
      *      - #ER_OK if the execute request was successful
-     *      - #ER_THREADPOOL_EXHAUSTED if the thread pool has previously reached its specified concurrency.
+     *      - #ER_THREADPOOL_EXHAUSTED if the work queue of the thread pool is full.
+     *      - #ER_THREADPOOL_STOPPING if the thread pool is stopping.
      */
     QStatus Execute(Ptr<Runnable> runnable);
 
+    /**
+     * Execute a Runnable task on one of the threads of the thread pool,
+     * blocking the caller while the work queue is full.
+     *
+     * @param runnable A Ptr (smart pointer) to a Runnable Object providing the
+     *                 Run() method.
+     * @param maxMs    Max number of milliseconds to wait for room on the work
+     *                 queue or Event::WAIT_FOREVER to wait forever.
+     *
+     * @return
+     *      - #ER_OK if the execute request was successful
+     *      - #ER_TIMEOUT if no room became available on the work queue in time.
+     *      - #ER_THREADPOOL_STOPPING if the thread pool is stopping.
+     *      - Any error returned by Event::Wait() if the calling thread was
+     *        stopped or alerted.
+     */
+    QStatus ExecuteBlocking(Ptr<Runnable> runnable, uint32_t maxMs = Event::WAIT_FOREVER);
+
+    /**
+     * Execute a batch of Runnable tasks.
+     *
+     * The Runnables are queued in order, taking the lock of the work queue and
+     * waking the workers once for the whole batch rather than once per task.
+     * If the work queue does not have room for all of them, the caller is put
+     * to sleep as in ExecuteBlocking() until the rest fit.  In work-stealing
+     * mode, a batch submitted from one of the threads of this pool goes onto
+     * that thread's own deque as far as there is room.
+     *
+     * @param runnables The Runnables to execute.
+     * @param maxMs     Max number of milliseconds to wait for room on the work
+     *                  queue or Event::WAIT_FOREVER to wait forever.
+     * @param queued    If not NULL, returns the number of Runnables (from the
+     *                  front of the batch) that were accepted.  This is only
+     *                  interesting if an error is returned.
+     *
+     * @return
+     *      - #ER_OK if all of the Runnables were accepted
+     *      - #ER_TIMEOUT if room for the rest did not become available in time.
+     *      - #ER_THREADPOOL_STOPPING if the thread pool is stopping.
+     *      - Any error returned by Event::Wait() if the calling thread was
+     *        stopped or alerted.
+     */
+    QStatus ExecuteBatch(const std::vector<Ptr<Runnable> >& runnables, uint32_t maxMs = Event::WAIT_FOREVER, uint32_t* queued = NULL);
+
+    /**
+     * Spawn a subtask from a Runnable which is executing on this thread pool.
+     *
+     * In work-stealing mode the subtask goes onto the calling worker's own
+     * deque, otherwise it goes onto the shared work queue.  A subtask is never
+     * refused for lack of room: if there is none, the subtask is run right
+     * away on the calling thread.  When called from a thread that does not
+     * belong to this pool, Spawn() behaves exactly like Execute().
+     *
+     * @param runnable A Ptr (smart pointer) to a Runnable Object providing the
+     *                 Run() method.
+     *
+     * @return
+     *      - #ER_OK if the subtask was queued or has been run
+     *      - #ER_THREADPOOL_EXHAUSTED if the work queue is full and the caller
+     *        is not one of the threads of this pool.
+     *      - #ER_THREADPOOL_STOPPING if the thread pool is stopping.
+     */
+    QStatus Spawn(Ptr<Runnable> runnable);
+
     /**
      * Wait for a thread to become available for use.
      *
@@ -205,7 +343,8 @@ class ThreadPool {
      * drives the execution of our threads will ultimately be network traffic,
      * we need to be able to apply backpressure to the network to avoid
      * exhausting all available resources.  We do this by providing a method which
-     * allows a caller to put itself to sleep until a thread beomes available.
+     * allows a caller to put itself to sleep until the work queue has room for
+     * another Runnable.
      *
      * If the caller thread happens to be the thread that is reading messages off
      * of the network, it will put itself to sleep.  This will stop the network
@@ -220,12 +359,9 @@ class ThreadPool {
 
   private:
     /**
-     * Runnable must be a friend in order to call back and tell us that it has
-     * finished executing.  Since this affects the memory management contract
-     * between the Runnable and ThreadPool objects, we don't let anyone else
-     * but Runnable make this call.
+     * The worker threads pull Runnable tasks directly off of our work queue.
      */
-    friend class Runnable;
+    friend class ThreadPoolWorker;
 
     /**
      * Assignment operator is private - ThreadPools cannot be assigned.
@@ -237,6 +373,45 @@ class ThreadPool {
      */
     ThreadPool(const ThreadPool& other);
 
+    /**
+     * Find the worker of this pool that corresponds to the calling thread.
+     *
+     * @return The worker or NULL if the caller is not one of our threads.
+     */
+    ThreadPoolWorker* GetCurrentWorker();
+
+    /**
+     * Place a Runnable on the deque of a worker.  The caller must call
+     * WakeIdle() once it is done pushing.
+     *
+     * @return true iff there was room on the deque.
+     */
+    bool PushLocal(ThreadPoolWorker* worker, const Ptr<Runnable>& runnable);
+
+    /**
+     * Wake up the idle workers, if there are any, so that they can steal
+     * work that was pushed onto a deque.
+     */
+    void WakeIdle();
+
+    /**
+     * Wait, with m_lock held, until there is room on the work queue.  The lock
+     * is held again when this method returns.
+     */
+    QStatus WaitForRoom(uint32_t maxMs);
+
+    /**
+     * Place a Runnable on the tail of the work queue.  Called with m_lock held
+     * and only when there is room on the queue.
+     */
+    void Enqueue(const Ptr<Runnable>& runnable);
+
+    /**
+     * Take the Runnable at the head of the work queue.  Called by a worker with
+     * m_lock held and only when the queue is not empty.
+     */
+    Ptr<Runnable> Dequeue();
+
     /**
      * A flag to remind if the thread pool is stopping or stopped.
      */
@@ -248,42 +423,67 @@ class ThreadPool {
     qcc::Mutex m_lock;
 
     /**
-     * An event to allow callers to wait until a thread becomes available
-     * in the pool.
+     * An event that is set whenever the work queue is not empty.  Idle
+     * workers sleep on this event.
      */
-    qcc::Event m_event;
+    qcc::Event m_workEvent;
 
     /**
-     * The maximum number of concurrent threads executing in this thread pool.
+     * An event that is set whenever the work queue is not full.  Callers
+     * waiting for room on the queue sleep on this event.
+     */
+    qcc::Event m_roomEvent;
+
+    /**
+     * The number of worker threads in this thread pool.
      */
     uint32_t m_poolsize;
 
     /**
-     * We need to hold a reference to an underlying Runnable object while we
-     * wait for its Run() method to be executed.  The Runnable object acts as a
-     * closure that a user will use to keep required variables.  When the Run()
-     * method is done executing, we release the reference to the runnable managed
-     * object by deleting the corresponding entry in the closure map.
+     * The capacity of the work queue.
+     */
+    uint32_t m_backlog;
+
+    /**
+     * The work queue itself.  This is a ring buffer of m_backlog slots which
+     * is allocated once, so queueing a Runnable never allocates.  A queued
+     * slot holds the reference that keeps the Runnable closure alive until a
+     * worker takes it.
+     */
+    std::vector<Ptr<Runnable> > m_queue;
+
+    /**
+     * Index of the slot at the head of the work queue.
+     */
+    uint32_t m_head;
+
+    /**
+     * Number of Runnable tasks waiting on the work queue.
+     */
+    uint32_t m_pending;
+
+    /**
+     * Number of Runnable tasks currently executing on worker threads.  This
+     * is maintained with atomic operations rather than under m_lock.
+     */
+    volatile int32_t m_running;
+
+    /**
+     * True if the workers each have their own deque of tasks.
      */
-    typedef std::map<Runnable*, Ptr<Runnable> > RunnableEntry;
-    RunnableEntry m_closures;
+    bool m_workStealing;
 
     /**
-     * When the AlarmTriggered callback of the AlarmListener base class of the
-     * Runnable is called by the Timer, it will call the user's Run() function
-     * and then call back here to let us know that it has finished executing.
-     * That tells us that we can clean up any resources we may be holding.  That
-     * just means releasing our reference to the Ptr that holds the ulitmate
-     * reference to the runnable.  If we can't find a closure, we have screwed
-     * up massively and we should just die.
+     * Number of workers in work-stealing mode that are about to go to sleep
+     * on m_workEvent.  A worker pushing onto its own deque only needs to set
+     * m_workEvent if this is non-zero.
      */
-    void Release(Runnable* runnable);
+    volatile int32_t m_idle;
 
     /**
-     * The timer that actually does all of the work of dispatching threads and
-     * essentially doing all of the work of the thread pool.
+     * The threads that actually run the queued Runnable tasks.
      */
-    qcc::Timer m_dispatcher;
+    std::vector<ThreadPoolWorker*> m_workers;
 };
 
 } // namespace qcc
@@ -175,8 +175,10 @@ class Timer : public OSTimer, public ThreadListener {
      * @param concurency         Dispatch up to this number of alarms concurently (using multiple threads).
      * @param prevenReentrancy   Prevent re-entrant call of AlarmTriggered.
      * @param maxAlarms          Maximum number of outstanding alarms allowed before blocking calls to AddAlarm or 0 for infinite.
+     * @param attributes         Attributes for the timer threads (stack size, CPU affinity, scheduling policy).
      */
-    Timer(const char* name, bool expireOnExit = false, uint32_t concurency = 1, bool preventReentrancy = false, uint32_t maxAlarms = 0);
+    Timer(const char* name, bool expireOnExit = false, uint32_t concurency = 1, bool preventReentrancy = false, uint32_t maxAlarms = 0,
+          const ThreadAttributes& attributes = ThreadAttributes());
 
     /**
      * Destructor.
@@ -332,13 +334,14 @@ class Timer : public OSTimer, public ThreadListener {
     Alarm* currentAlarm;
     bool expireOnExit;
     std::vector<TimerThread*> timerThreads;
-    bool isRunning;
+    Atomic<bool> isRunning;
     int32_t controllerIdx;
     qcc::Timespec yieldControllerTime;
     bool preventReentrancy;
     Mutex reentrancyLock;
     qcc::String nameStr;
     const uint32_t maxAlarms;
+    const ThreadAttributes threadAttributes;
 };
 
 }
@@ -31,6 +31,8 @@
 #include <vector>
 
 #include <qcc/String.h>
+#include <qcc/StringBuilder.h>
+#include <qcc/StringRef.h>
 #include <qcc/BufferedSource.h>
 #include <qcc/Stream.h>
 
@@ -76,6 +78,14 @@ class XmlElement {
      */
     qcc::String Generate(qcc::String* outStr = NULL) const;
 
+    /**
+     * Append an XML fragment of this XmlElement including any children to a
+     * StringBuilder.
+     *
+     * @param outStr  The builder to append to.
+     */
+    void Generate(StringBuilder& outStr) const;
+
     /**
      * Get the element name
      *
@@ -108,14 +118,7 @@ class XmlElement {
      *
      * @param attName   Name of attribute
      */
-    const qcc::String& GetAttribute(const char* attName) const;
-
-    /**
-     * Get an attribute with a given name or empty string if it doesn't exist.
-     *
-     * @param attName   Name of attribute
-     */
-    const qcc::String& GetAttribute(const qcc::String& attName) const;
+    const qcc::String& GetAttribute(const qcc::StringRef& attName) const;
 
     /**
      * Add an Xml Attribute
@@ -136,7 +139,7 @@ class XmlElement {
      * @param name   XML child elements name to search for.
      * @return  A vector containing the matching elements.
      */
-    std::vector<const XmlElement*> GetChildren(const qcc::String& name) const;
+    std::vector<const XmlElement*> GetChildren(const qcc::StringRef& name) const;
 
     /**
      * Get the child element with a given name if it exists.
@@ -144,7 +147,7 @@ class XmlElement {
      * @param name   XML child element name to search for.
      * @return  Pointer to XML child element or NULL if not found.
      */
-    const XmlElement* GetChild(const qcc::String& name) const;
+    const XmlElement* GetChild(const qcc::StringRef& name) const;
 
     /**
      * Add a child XmlElement.
@@ -194,7 +197,7 @@ class XmlElement {
      *
      * @param path   The path to elements in the XML tree.
      */
-    std::vector<const XmlElement*> GetPath(const qcc::String& path) const;
+    std::vector<const XmlElement*> GetPath(const qcc::StringRef& path) const;
 
   private:
     qcc::String name;                                /**< Element name */
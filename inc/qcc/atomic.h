@@ -26,6 +26,32 @@
 
 #include <qcc/platform.h>
 
+#include <stddef.h>
+
+/**
+ * Size of a cache line on the targets we care about.  Variables written by
+ * different threads should be at least this far apart to avoid false sharing.
+ */
+#define QCC_CACHE_LINE_SIZE 64
+
+namespace qcc {
+
+/**
+ * Memory ordering constraints for atomic operations.  These have the same
+ * meaning as the C++11 std::memory_order values.  Platforms that cannot
+ * express an ordering use a stronger one.
+ */
+typedef enum {
+    MEMORY_ORDER_RELAXED,   ///< No ordering, only atomicity
+    MEMORY_ORDER_CONSUME,   ///< Treated as MEMORY_ORDER_ACQUIRE
+    MEMORY_ORDER_ACQUIRE,   ///< Later accesses are not moved before this one
+    MEMORY_ORDER_RELEASE,   ///< Earlier accesses are not moved after this one
+    MEMORY_ORDER_ACQ_REL,   ///< Both MEMORY_ORDER_ACQUIRE and MEMORY_ORDER_RELEASE
+    MEMORY_ORDER_SEQ_CST    ///< A single total order over all such operations
+} MemoryOrder;
+
+}
+
 #if defined(QCC_OS_GROUP_POSIX)
 #include <qcc/posix/atomic.h>
 #elif defined(QCC_OS_GROUP_WINDOWS)
@@ -36,4 +62,174 @@
 #error No OS GROUP defined.
 #endif
 
+namespace qcc {
+
+/**
+ * An integer or pointer variable accessed atomically.  This is a subset of
+ * C++11 std::atomic for toolchains that do not have it.  T must be a 32 or
+ * 64 bit integer type; see the specializations for pointers and bool.
+ *
+ * Every operation takes an optional memory order which defaults to
+ * MEMORY_ORDER_SEQ_CST.
+ */
+template <typename T>
+class Atomic {
+  public:
+
+    /**
+     * Constructor
+     *
+     * @param value  Initial value.
+     */
+    Atomic(T value = T()) : value(value) { }
+
+    /**
+     * Read the value.
+     *
+     * @param order  Memory ordering constraint.
+     * @return  The value.
+     */
+    T Load(MemoryOrder order = MEMORY_ORDER_SEQ_CST) const { return AtomicLoad(&value, order); }
+
+    /**
+     * Replace the value.
+     *
+     * @param newValue  Value to store.
+     * @param order     Memory ordering constraint.
+     */
+    void Store(T newValue, MemoryOrder order = MEMORY_ORDER_SEQ_CST) { AtomicStore(&value, newValue, order); }
+
+    /**
+     * Replace the value and return the previous one.
+     *
+     * @param newValue  Value to store.
+     * @param order     Memory ordering constraint.
+     * @return  The previous value.
+     */
+    T Exchange(T newValue, MemoryOrder order = MEMORY_ORDER_SEQ_CST) { return AtomicExchange(&value, newValue, order); }
+
+    /**
+     * Replace the value if it currently is equal to expected.
+     *
+     * @param expected  The expected value.  Updated with the current value
+     *                  if the exchange did not happen.
+     * @param desired   Value to store.
+     * @param order     Memory ordering constraint.
+     * @return  true iff the value was replaced.
+     */
+    bool CompareExchange(T& expected, T desired, MemoryOrder order = MEMORY_ORDER_SEQ_CST) { return AtomicCompareExchange(&value, expected, desired, order); }
+
+    /**
+     * Add to the value.
+     *
+     * @param delta  Value to add.
+     * @param order  Memory ordering constraint.
+     * @return  The previous value.
+     */
+    T FetchAdd(T delta, MemoryOrder order = MEMORY_ORDER_SEQ_CST) { return AtomicFetchAdd(&value, delta, order); }
+
+    /**
+     * Subtract from the value.
+     *
+     * @param delta  Value to subtract.
+     * @param order  Memory ordering constraint.
+     * @return  The previous value.
+     */
+    T FetchSub(T delta, MemoryOrder order = MEMORY_ORDER_SEQ_CST) { return AtomicFetchAdd(&value, static_cast<T>(T() - delta), order); }
+
+    /** Same as Load() */
+    operator T() const { return Load(); }
+
+    /** Same as Store() */
+    Atomic& operator=(T newValue) { Store(newValue); return *this; }
+
+    /** Pre-increment, returns the new value */
+    T operator++() { return FetchAdd(1) + 1; }
+
+    /** Pre-decrement, returns the new value */
+    T operator--() { return FetchSub(1) - 1; }
+
+  private:
+    Atomic(const Atomic& other);
+    Atomic& operator=(const Atomic& other);
+
+    volatile T value;
+};
+
+/**
+ * Atomic pointer.  FetchAdd and FetchSub step in units of the pointed-to
+ * type like ordinary pointer arithmetic.
+ */
+template <typename T>
+class Atomic<T*> {
+  public:
+    Atomic(T* value = NULL) : value(value) { }
+
+    T* Load(MemoryOrder order = MEMORY_ORDER_SEQ_CST) const { return AtomicLoad(&value, order); }
+
+    void Store(T* newValue, MemoryOrder order = MEMORY_ORDER_SEQ_CST) { AtomicStore(&value, newValue, order); }
+
+    T* Exchange(T* newValue, MemoryOrder order = MEMORY_ORDER_SEQ_CST) { return AtomicExchange(&value, newValue, order); }
+
+    bool CompareExchange(T*& expected, T* desired, MemoryOrder order = MEMORY_ORDER_SEQ_CST) { return AtomicCompareExchange(&value, expected, desired, order); }
+
+    T* FetchAdd(ptrdiff_t delta, MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+    {
+        T* expected = Load(MEMORY_ORDER_RELAXED);
+        while (!CompareExchange(expected, expected + delta, order)) {
+        }
+        return expected;
+    }
+
+    T* FetchSub(ptrdiff_t delta, MemoryOrder order = MEMORY_ORDER_SEQ_CST) { return FetchAdd(-delta, order); }
+
+    operator T*() const { return Load(); }
+
+    Atomic& operator=(T* newValue) { Store(newValue); return *this; }
+
+    T* operator->() const { return Load(); }
+
+  private:
+    Atomic(const Atomic& other);
+    Atomic& operator=(const Atomic& other);
+
+    T* volatile value;
+};
+
+/**
+ * Atomic flag.  Stored as an int32_t since not every platform can operate
+ * atomically on a single byte.
+ */
+template <>
+class Atomic<bool> {
+  public:
+    Atomic(bool value = false) : value(value ? 1 : 0) { }
+
+    bool Load(MemoryOrder order = MEMORY_ORDER_SEQ_CST) const { return AtomicLoad(&value, order) != 0; }
+
+    void Store(bool newValue, MemoryOrder order = MEMORY_ORDER_SEQ_CST) { AtomicStore(&value, static_cast<int32_t>(newValue ? 1 : 0), order); }
+
+    bool Exchange(bool newValue, MemoryOrder order = MEMORY_ORDER_SEQ_CST) { return AtomicExchange(&value, static_cast<int32_t>(newValue ? 1 : 0), order) != 0; }
+
+    bool CompareExchange(bool& expected, bool desired, MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+    {
+        int32_t current = expected ? 1 : 0;
+        bool exchanged = AtomicCompareExchange(&value, current, static_cast<int32_t>(desired ? 1 : 0), order);
+        expected = (current != 0);
+        return exchanged;
+    }
+
+    operator bool() const { return Load(); }
+
+    Atomic& operator=(bool newValue) { Store(newValue); return *this; }
+
+  private:
+    Atomic(const Atomic& other);
+    Atomic& operator=(const Atomic& other);
+
+    volatile int32_t value;
+};
+
+}
+
 #endif
@@ -80,6 +80,22 @@
 
 #endif /* Compiler type */
 
+/*
+ * Defined when the compiler supports C++11 rvalue references so that classes
+ * can provide move constructors and move assignment operators.
+ */
+#if defined(__cplusplus) && ((__cplusplus >= 201100L) || defined(__GXX_EXPERIMENTAL_CXX0X__) || (defined(_MSC_VER) && (_MSC_VER >= 1600)))
+#define QCC_HAS_RVALUE_REFERENCES
+#endif
+
+/*
+ * Defined when the compiler supports C++11 variadic templates so that
+ * factories can forward any number of arguments.
+ */
+#if defined(__cplusplus) && ((__cplusplus >= 201100L) || defined(__GXX_EXPERIMENTAL_CXX0X__) || (defined(_MSC_VER) && (_MSC_VER >= 1800)))
+#define QCC_HAS_VARIADIC_TEMPLATES
+#endif
+
 /** Boolean type for C */
 typedef int32_t QCC_BOOL;
 /** Boolean logic true for QCC_BOOL type*/
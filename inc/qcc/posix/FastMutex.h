@@ -0,0 +1,158 @@
+/**
+ * @file
+ *
+ * Define a fast, non-recursive mutex for POSIX platforms.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#ifndef _OS_QCC_FASTMUTEX_H
+#define _OS_QCC_FASTMUTEX_H
+
+#include <qcc/platform.h>
+
+#include <pthread.h>
+
+#include <qcc/atomic.h>
+
+#include <Status.h>
+
+#if defined(QCC_OS_LINUX) || defined(QCC_OS_ANDROID)
+/** @internal FastMutex is built directly on futexes */
+#define QCC_FASTMUTEX_FUTEX
+#endif
+
+namespace qcc {
+
+/**
+ * A mutex for short critical sections that does not support recursive
+ * locking.
+ *
+ * Unlike Mutex, a thread that already holds a FastMutex must not lock it
+ * again.  In exchange, an uncontended Lock() and Unlock() are a single atomic
+ * operation each.  When the mutex is contended, Lock() spins for a while
+ * before going to sleep.  The spin count adapts to how long the mutex has
+ * typically been held.
+ *
+ * On Linux and Android it is built on futexes.  On other POSIX platforms it
+ * is a non-recursive pthread mutex.
+ */
+class FastMutex {
+  public:
+
+    /**
+     * Construct an unlocked mutex.
+     */
+    FastMutex() { Init(); }
+
+    /**
+     * The destructor will destroy the underlying mutex.
+     */
+    ~FastMutex();
+
+    /**
+     * Acquires the mutex, blocking until it is available.
+     *
+     * @return  ER_OK
+     */
+    QStatus Lock()
+    {
+#ifdef QCC_FASTMUTEX_FUTEX
+        if (!CompareAndExchange(&state, 0, 1)) {
+            LockSlow();
+        }
+        return ER_OK;
+#else
+        return (pthread_mutex_lock(&mutex) == 0) ? ER_OK : ER_OS_ERROR;
+#endif
+    }
+
+    /**
+     * Acquires the mutex.  The file and line are accepted so that FastMutex
+     * can be used with MUTEX_CONTEXT, but they are not recorded.
+     *
+     * @return  ER_OK
+     */
+    QStatus Lock(const char* file, uint32_t line) { return Lock(); }
+
+    /**
+     * Releases the mutex.  Must be called by the thread that locked it.
+     *
+     * @return  ER_OK
+     */
+    QStatus Unlock()
+    {
+#ifdef QCC_FASTMUTEX_FUTEX
+        if (DecrementAndFetch(&state) != 0) {
+            UnlockSlow();
+        }
+        return ER_OK;
+#else
+        return (pthread_mutex_unlock(&mutex) == 0) ? ER_OK : ER_OS_ERROR;
+#endif
+    }
+
+    /**
+     * Releases the mutex.
+     *
+     * @return  ER_OK
+     */
+    QStatus Unlock(const char* file, uint32_t line) { return Unlock(); }
+
+    /**
+     * Attempt to acquire the mutex without blocking.
+     *
+     * @return  True if the mutex was acquired.
+     */
+    bool TryLock()
+    {
+#ifdef QCC_FASTMUTEX_FUTEX
+        return CompareAndExchange(&state, 0, 1);
+#else
+        return pthread_mutex_trylock(&mutex) == 0;
+#endif
+    }
+
+    /**
+     * FastMutex copy constructor creates a new mutex.
+     */
+    FastMutex(const FastMutex& other) { Init(); }
+
+    /**
+     * FastMutex assignment operator.
+     */
+    FastMutex& operator=(const FastMutex& other) { return *this; }
+
+  private:
+    void Init();
+
+#ifdef QCC_FASTMUTEX_FUTEX
+    void LockSlow();
+    void UnlockSlow();
+
+    /** 0: unlocked, 1: locked, 2: locked and there may be waiters */
+    volatile int32_t state;
+
+    /** Running estimate of how many spins it takes to get the mutex */
+    int32_t spins;
+#else
+    pthread_mutex_t mutex;
+#endif
+};
+
+}
+
+#endif
@@ -34,11 +34,11 @@
 
 namespace qcc {
 
-#ifndef NDEBUG
+/**
+ * Pass the call site to Mutex::Lock() and Mutex::Unlock().  This is done in
+ * release builds too so that LockProfiler can attribute contention.
+ */
 #define MUTEX_CONTEXT __FILE__, __LINE__
-#else
-#define MUTEX_CONTEXT
-#endif
 
 /**
  * The Linux implementation of a Mutex abstraction class.
@@ -100,8 +100,10 @@ class Mutex {
     pthread_mutex_t mutex;  ///< The Linux mutex implementation uses pthread mutex's.
     bool isInitialized;     ///< true iff mutex was successfully initialized.
     void Init();            ///< Initialize underlying OS mutex
-    const char* file;
-    uint32_t line;
+    QStatus Release();      ///< Release the mutex, accounting for the hold time
+    const char* file;       ///< File of the call site holding the mutex (if known)
+    uint32_t line;          ///< Line of the call site holding the mutex
+    uint64_t holdStart;     ///< LockProfiler timestamp of the acquisition or 0
 };
 
 } /* namespace */
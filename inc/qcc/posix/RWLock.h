@@ -0,0 +1,119 @@
+/**
+ * @file
+ *
+ * Define a reader/writer lock for POSIX platforms.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#ifndef _OS_QCC_RWLOCK_H
+#define _OS_QCC_RWLOCK_H
+
+#include <qcc/platform.h>
+
+#include <pthread.h>
+
+#include <Status.h>
+
+namespace qcc {
+
+/**
+ * A lock that can be held by any number of readers or by one writer.
+ *
+ * Use it for read-mostly data where readers would otherwise serialize on a
+ * Mutex.  It is not recursive: a thread that holds the lock in either mode
+ * must not lock it again.  Where the platform allows it, waiting writers are
+ * preferred over new readers so that a steady stream of readers cannot starve
+ * them.
+ */
+class RWLock {
+  public:
+
+    /**
+     * Construct an unlocked reader/writer lock.
+     */
+    RWLock() { Init(); }
+
+    /**
+     * The destructor will destroy the underlying lock.
+     */
+    ~RWLock();
+
+    /**
+     * Acquire the lock shared with other readers.
+     *
+     * @return  ER_OK if the lock was acquired, ER_OS_ERROR if the underlying
+     *          OS reports an error.
+     */
+    QStatus ReadLock() { return (pthread_rwlock_rdlock(&lock) == 0) ? ER_OK : ER_OS_ERROR; }
+
+    /**
+     * Release a shared lock.
+     *
+     * @return  ER_OK if the lock was released, ER_OS_ERROR if the underlying
+     *          OS reports an error.
+     */
+    QStatus ReadUnlock() { return (pthread_rwlock_unlock(&lock) == 0) ? ER_OK : ER_OS_ERROR; }
+
+    /**
+     * Acquire the lock exclusively.
+     *
+     * @return  ER_OK if the lock was acquired, ER_OS_ERROR if the underlying
+     *          OS reports an error.
+     */
+    QStatus WriteLock() { return (pthread_rwlock_wrlock(&lock) == 0) ? ER_OK : ER_OS_ERROR; }
+
+    /**
+     * Release an exclusive lock.
+     *
+     * @return  ER_OK if the lock was released, ER_OS_ERROR if the underlying
+     *          OS reports an error.
+     */
+    QStatus WriteUnlock() { return (pthread_rwlock_unlock(&lock) == 0) ? ER_OK : ER_OS_ERROR; }
+
+    /**
+     * Attempt to acquire a shared lock without blocking.
+     *
+     * @return  True if the lock was acquired.
+     */
+    bool TryReadLock() { return pthread_rwlock_tryrdlock(&lock) == 0; }
+
+    /**
+     * Attempt to acquire an exclusive lock without blocking.
+     *
+     * @return  True if the lock was acquired.
+     */
+    bool TryWriteLock() { return pthread_rwlock_trywrlock(&lock) == 0; }
+
+    /**
+     * RWLock copy constructor creates a new lock.
+     */
+    RWLock(const RWLock& other) { Init(); }
+
+    /**
+     * RWLock assignment operator.
+     */
+    RWLock& operator=(const RWLock& other) { return *this; }
+
+  private:
+    void Init();
+
+    pthread_rwlock_t lock;
+};
+
+}
+
+#endif
@@ -72,6 +72,21 @@ inline int32_t DecrementAndFetch(volatile int32_t* mem)
     return __atomic_dec(mem) - 1;
 }
 
+/**
+ * Atomically replace the value of an int32_t if it currently holds an
+ * expected value.  This is a full memory barrier.
+ *
+ * @param mem            Pointer to int32_t to be updated.
+ * @param expectedValue  Value *mem must hold for the update to happen.
+ * @param newValue       Value to store in *mem.
+ * @return  true iff *mem held expectedValue and was replaced with newValue.
+ */
+inline bool CompareAndExchange(volatile int32_t* mem, int32_t expectedValue, int32_t newValue)
+{
+    /* Android's __atomic_cmpxchg returns 0 if the exchange happened */
+    return __atomic_cmpxchg(expectedValue, newValue, mem) == 0;
+}
+
 #elif defined(QCC_OS_LINUX)
 
 /**
@@ -94,6 +109,19 @@ inline int32_t DecrementAndFetch(volatile int32_t* mem) {
     return __sync_sub_and_fetch(mem, 1);
 }
 
+/**
+ * Atomically replace the value of an int32_t if it currently holds an
+ * expected value.  This is a full memory barrier.
+ *
+ * @param mem            Pointer to int32_t to be updated.
+ * @param expectedValue  Value *mem must hold for the update to happen.
+ * @param newValue       Value to store in *mem.
+ * @return  true iff *mem held expectedValue and was replaced with newValue.
+ */
+inline bool CompareAndExchange(volatile int32_t* mem, int32_t expectedValue, int32_t newValue) {
+    return __sync_bool_compare_and_swap(mem, expectedValue, newValue);
+}
+
 #elif defined(QCC_OS_DARWIN)
 
 /**
@@ -116,6 +144,19 @@ inline int32_t DecrementAndFetch(volatile int32_t* mem) {
     return OSAtomicDecrement32(mem);
 }
 
+/**
+ * Atomically replace the value of an int32_t if it currently holds an
+ * expected value.  This is a full memory barrier.
+ *
+ * @param mem            Pointer to int32_t to be updated.
+ * @param expectedValue  Value *mem must hold for the update to happen.
+ * @param newValue       Value to store in *mem.
+ * @return  true iff *mem held expectedValue and was replaced with newValue.
+ */
+inline bool CompareAndExchange(volatile int32_t* mem, int32_t expectedValue, int32_t newValue) {
+    return OSAtomicCompareAndSwap32Barrier(expectedValue, newValue, mem);
+}
+
 #else
 
 /**
@@ -134,6 +175,337 @@ int32_t IncrementAndFetch(volatile int32_t* mem);
  */
 int32_t DecrementAndFetch(volatile int32_t* mem);
 
+/**
+ * Atomically replace the value of an int32_t if it currently holds an
+ * expected value.  This is a full memory barrier.
+ *
+ * @param mem            Pointer to int32_t to be updated.
+ * @param expectedValue  Value *mem must hold for the update to happen.
+ * @param newValue       Value to store in *mem.
+ * @return  true iff *mem held expectedValue and was replaced with newValue.
+ */
+bool CompareAndExchange(volatile int32_t* mem, int32_t expectedValue, int32_t newValue);
+
+#endif
+
+/*
+ * Building blocks for qcc::Atomic<T>.  T must be a 32 or 64 bit integer or a
+ * pointer.  Use Atomic<T> rather than calling these directly unless the
+ * variable has to be statically initialized.
+ */
+
+#if defined(__ATOMIC_SEQ_CST)
+
+/*
+ * GCC 4.7 and later and clang have the __atomic builtins which take the
+ * memory order as an argument.  The order has to be a constant for the
+ * builtins to honor it, hence the switches.
+ */
+
+/**
+ * Atomically load a value.
+ *
+ * @param mem    Pointer to the value.
+ * @param order  Memory ordering constraint (relaxed, consume, acquire or seq_cst).
+ * @return  The value.
+ */
+template <typename T>
+inline T AtomicLoad(const volatile T* mem, MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+{
+    switch (order) {
+    case MEMORY_ORDER_RELAXED:
+        return __atomic_load_n(mem, __ATOMIC_RELAXED);
+
+    case MEMORY_ORDER_CONSUME:
+    case MEMORY_ORDER_ACQUIRE:
+    case MEMORY_ORDER_ACQ_REL:
+        return __atomic_load_n(mem, __ATOMIC_ACQUIRE);
+
+    default:
+        return __atomic_load_n(mem, __ATOMIC_SEQ_CST);
+    }
+}
+
+/**
+ * Atomically store a value.
+ *
+ * @param mem    Pointer to the value.
+ * @param value  Value to store.
+ * @param order  Memory ordering constraint (relaxed, release or seq_cst).
+ */
+template <typename T>
+inline void AtomicStore(volatile T* mem, T value, MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+{
+    switch (order) {
+    case MEMORY_ORDER_RELAXED:
+        __atomic_store_n(mem, value, __ATOMIC_RELAXED);
+        break;
+
+    case MEMORY_ORDER_RELEASE:
+    case MEMORY_ORDER_ACQ_REL:
+        __atomic_store_n(mem, value, __ATOMIC_RELEASE);
+        break;
+
+    default:
+        __atomic_store_n(mem, value, __ATOMIC_SEQ_CST);
+        break;
+    }
+}
+
+/**
+ * Atomically replace a value.
+ *
+ * @param mem    Pointer to the value.
+ * @param value  Value to store.
+ * @param order  Memory ordering constraint.
+ * @return  The previous value.
+ */
+template <typename T>
+inline T AtomicExchange(volatile T* mem, T value, MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+{
+    switch (order) {
+    case MEMORY_ORDER_RELAXED:
+        return __atomic_exchange_n(mem, value, __ATOMIC_RELAXED);
+
+    case MEMORY_ORDER_CONSUME:
+    case MEMORY_ORDER_ACQUIRE:
+        return __atomic_exchange_n(mem, value, __ATOMIC_ACQUIRE);
+
+    case MEMORY_ORDER_RELEASE:
+        return __atomic_exchange_n(mem, value, __ATOMIC_RELEASE);
+
+    case MEMORY_ORDER_ACQ_REL:
+        return __atomic_exchange_n(mem, value, __ATOMIC_ACQ_REL);
+
+    default:
+        return __atomic_exchange_n(mem, value, __ATOMIC_SEQ_CST);
+    }
+}
+
+/**
+ * Atomically replace a value if it currently holds an expected value.
+ *
+ * @param mem       Pointer to the value.
+ * @param expected  The expected value.  Returns the current value if the
+ *                  exchange did not happen.
+ * @param desired   Value to store.
+ * @param order     Memory ordering constraint.
+ * @return  true iff *mem held expected and was replaced with desired.
+ */
+template <typename T>
+inline bool AtomicCompareExchange(volatile T* mem, T& expected, T desired, MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+{
+    switch (order) {
+    case MEMORY_ORDER_RELAXED:
+        return __atomic_compare_exchange_n(mem, &expected, desired, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+
+    case MEMORY_ORDER_CONSUME:
+    case MEMORY_ORDER_ACQUIRE:
+        return __atomic_compare_exchange_n(mem, &expected, desired, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE);
+
+    case MEMORY_ORDER_RELEASE:
+        return __atomic_compare_exchange_n(mem, &expected, desired, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+
+    case MEMORY_ORDER_ACQ_REL:
+        return __atomic_compare_exchange_n(mem, &expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+
+    default:
+        return __atomic_compare_exchange_n(mem, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+    }
+}
+
+/**
+ * Atomically add to an integer.
+ *
+ * @param mem    Pointer to the integer.
+ * @param delta  Value to add.
+ * @param order  Memory ordering constraint.
+ * @return  The previous value.
+ */
+template <typename T>
+inline T AtomicFetchAdd(volatile T* mem, T delta, MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+{
+    switch (order) {
+    case MEMORY_ORDER_RELAXED:
+        return __atomic_fetch_add(mem, delta, __ATOMIC_RELAXED);
+
+    case MEMORY_ORDER_CONSUME:
+    case MEMORY_ORDER_ACQUIRE:
+        return __atomic_fetch_add(mem, delta, __ATOMIC_ACQUIRE);
+
+    case MEMORY_ORDER_RELEASE:
+        return __atomic_fetch_add(mem, delta, __ATOMIC_RELEASE);
+
+    case MEMORY_ORDER_ACQ_REL:
+        return __atomic_fetch_add(mem, delta, __ATOMIC_ACQ_REL);
+
+    default:
+        return __atomic_fetch_add(mem, delta, __ATOMIC_SEQ_CST);
+    }
+}
+
+/**
+ * Order memory accesses around this point without accessing memory.
+ *
+ * @param order  Memory ordering constraint.
+ */
+inline void AtomicFence(MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+{
+    switch (order) {
+    case MEMORY_ORDER_RELAXED:
+        break;
+
+    case MEMORY_ORDER_CONSUME:
+    case MEMORY_ORDER_ACQUIRE:
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        break;
+
+    case MEMORY_ORDER_RELEASE:
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        break;
+
+    case MEMORY_ORDER_ACQ_REL:
+        __atomic_thread_fence(__ATOMIC_ACQ_REL);
+        break;
+
+    default:
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        break;
+    }
+}
+
+#elif defined(QCC_OS_ANDROID) || defined(QCC_OS_LINUX) || defined(QCC_OS_DARWIN)
+
+/*
+ * Older GCCs only have the __sync builtins, which are all full barriers.
+ * Relaxed operations are simply stronger than they need to be.
+ */
+
+template <typename T>
+inline T AtomicLoad(const volatile T* mem, MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+{
+    if (order == MEMORY_ORDER_SEQ_CST) {
+        __sync_synchronize();
+    }
+    T value = *mem;
+    if (order != MEMORY_ORDER_RELAXED) {
+        __sync_synchronize();
+    }
+    return value;
+}
+
+template <typename T>
+inline void AtomicStore(volatile T* mem, T value, MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+{
+    if (order != MEMORY_ORDER_RELAXED) {
+        __sync_synchronize();
+    }
+    *mem = value;
+    if (order == MEMORY_ORDER_SEQ_CST) {
+        __sync_synchronize();
+    }
+}
+
+template <typename T>
+inline bool AtomicCompareExchange(volatile T* mem, T& expected, T desired, MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+{
+    T previous = __sync_val_compare_and_swap(mem, expected, desired);
+    if (previous == expected) {
+        return true;
+    }
+    expected = previous;
+    return false;
+}
+
+template <typename T>
+inline T AtomicExchange(volatile T* mem, T value, MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+{
+    T previous = *mem;
+    while (!AtomicCompareExchange(mem, previous, value)) {
+    }
+    return previous;
+}
+
+template <typename T>
+inline T AtomicFetchAdd(volatile T* mem, T delta, MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+{
+    return __sync_fetch_and_add(mem, delta);
+}
+
+inline void AtomicFence(MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+{
+    if (order != MEMORY_ORDER_RELAXED) {
+        __sync_synchronize();
+    }
+}
+
+#else
+
+/*
+ * No atomic builtins.  Serialize everything on a lock in atomic.cc.
+ */
+void AtomicLockAcquire();
+void AtomicLockRelease();
+
+template <typename T>
+inline T AtomicLoad(const volatile T* mem, MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+{
+    AtomicLockAcquire();
+    T value = *mem;
+    AtomicLockRelease();
+    return value;
+}
+
+template <typename T>
+inline void AtomicStore(volatile T* mem, T value, MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+{
+    AtomicLockAcquire();
+    *mem = value;
+    AtomicLockRelease();
+}
+
+template <typename T>
+inline T AtomicExchange(volatile T* mem, T value, MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+{
+    AtomicLockAcquire();
+    T previous = *mem;
+    *mem = value;
+    AtomicLockRelease();
+    return previous;
+}
+
+template <typename T>
+inline bool AtomicCompareExchange(volatile T* mem, T& expected, T desired, MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+{
+    AtomicLockAcquire();
+    bool exchanged = (*mem == expected);
+    if (exchanged) {
+        *mem = desired;
+    } else {
+        expected = *mem;
+    }
+    AtomicLockRelease();
+    return exchanged;
+}
+
+template <typename T>
+inline T AtomicFetchAdd(volatile T* mem, T delta, MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+{
+    AtomicLockAcquire();
+    T previous = *mem;
+    *mem = previous + delta;
+    AtomicLockRelease();
+    return previous;
+}
+
+inline void AtomicFence(MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+{
+    if (order != MEMORY_ORDER_RELAXED) {
+        AtomicLockAcquire();
+        AtomicLockRelease();
+    }
+}
+
 #endif
 
 }
@@ -0,0 +1,97 @@
+/**
+ * @file
+ *
+ * Define a fast, non-recursive mutex for Windows platforms.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#ifndef _OS_QCC_FASTMUTEX_H
+#define _OS_QCC_FASTMUTEX_H
+
+#include <qcc/platform.h>
+
+#include <windows.h>
+
+#include <Status.h>
+
+namespace qcc {
+
+/**
+ * A mutex for short critical sections that does not support recursive
+ * locking.  On Windows this is a slim reader/writer lock used in exclusive
+ * mode, which spins briefly before blocking.
+ */
+class FastMutex {
+  public:
+
+    /**
+     * Construct an unlocked mutex.
+     */
+    FastMutex() { InitializeSRWLock(&lock); }
+
+    /**
+     * Acquires the mutex, blocking until it is available.
+     *
+     * @return  ER_OK
+     */
+    QStatus Lock() { AcquireSRWLockExclusive(&lock); return ER_OK; }
+
+    /**
+     * Acquires the mutex.  The file and line are not recorded.
+     *
+     * @return  ER_OK
+     */
+    QStatus Lock(const char* file, uint32_t line) { return Lock(); }
+
+    /**
+     * Releases the mutex.  Must be called by the thread that locked it.
+     *
+     * @return  ER_OK
+     */
+    QStatus Unlock() { ReleaseSRWLockExclusive(&lock); return ER_OK; }
+
+    /**
+     * Releases the mutex.
+     *
+     * @return  ER_OK
+     */
+    QStatus Unlock(const char* file, uint32_t line) { return Unlock(); }
+
+    /**
+     * Attempt to acquire the mutex without blocking.
+     *
+     * @return  True if the mutex was acquired.
+     */
+    bool TryLock() { return TryAcquireSRWLockExclusive(&lock) != 0; }
+
+    /**
+     * FastMutex copy constructor creates a new mutex.
+     */
+    FastMutex(const FastMutex& other) { InitializeSRWLock(&lock); }
+
+    /**
+     * FastMutex assignment operator.
+     */
+    FastMutex& operator=(const FastMutex& other) { return *this; }
+
+  private:
+    SRWLOCK lock;
+};
+
+}
+
+#endif
@@ -0,0 +1,103 @@
+/**
+ * @file
+ *
+ * Define a reader/writer lock for Windows platforms.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#ifndef _OS_QCC_RWLOCK_H
+#define _OS_QCC_RWLOCK_H
+
+#include <qcc/platform.h>
+
+#include <windows.h>
+
+#include <Status.h>
+
+namespace qcc {
+
+/**
+ * A lock that can be held by any number of readers or by one writer.  On
+ * Windows this is a slim reader/writer lock.  It is not recursive.
+ */
+class RWLock {
+  public:
+
+    /**
+     * Construct an unlocked reader/writer lock.
+     */
+    RWLock() { InitializeSRWLock(&lock); }
+
+    /**
+     * Acquire the lock shared with other readers.
+     *
+     * @return  ER_OK
+     */
+    QStatus ReadLock() { AcquireSRWLockShared(&lock); return ER_OK; }
+
+    /**
+     * Release a shared lock.
+     *
+     * @return  ER_OK
+     */
+    QStatus ReadUnlock() { ReleaseSRWLockShared(&lock); return ER_OK; }
+
+    /**
+     * Acquire the lock exclusively.
+     *
+     * @return  ER_OK
+     */
+    QStatus WriteLock() { AcquireSRWLockExclusive(&lock); return ER_OK; }
+
+    /**
+     * Release an exclusive lock.
+     *
+     * @return  ER_OK
+     */
+    QStatus WriteUnlock() { ReleaseSRWLockExclusive(&lock); return ER_OK; }
+
+    /**
+     * Attempt to acquire a shared lock without blocking.
+     *
+     * @return  True if the lock was acquired.
+     */
+    bool TryReadLock() { return TryAcquireSRWLockShared(&lock) != 0; }
+
+    /**
+     * Attempt to acquire an exclusive lock without blocking.
+     *
+     * @return  True if the lock was acquired.
+     */
+    bool TryWriteLock() { return TryAcquireSRWLockExclusive(&lock) != 0; }
+
+    /**
+     * RWLock copy constructor creates a new lock.
+     */
+    RWLock(const RWLock& other) { InitializeSRWLock(&lock); }
+
+    /**
+     * RWLock assignment operator.
+     */
+    RWLock& operator=(const RWLock& other) { return *this; }
+
+  private:
+    SRWLOCK lock;
+};
+
+}
+
+#endif
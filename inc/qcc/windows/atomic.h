@@ -48,6 +48,161 @@ inline int32_t DecrementAndFetch(volatile int32_t* mem) {
     return InterlockedDecrement(reinterpret_cast<volatile long*>(mem));
 }
 
+/**
+ * Atomically replace the value of an int32_t if it currently holds an
+ * expected value.  This is a full memory barrier.
+ *
+ * @param mem            Pointer to int32_t to be updated.
+ * @param expectedValue  Value *mem must hold for the update to happen.
+ * @param newValue       Value to store in *mem.
+ * @return  true iff *mem held expectedValue and was replaced with newValue.
+ */
+inline bool CompareAndExchange(volatile int32_t* mem, int32_t expectedValue, int32_t newValue) {
+    return InterlockedCompareExchange(reinterpret_cast<volatile long*>(mem), newValue, expectedValue) == expectedValue;
+}
+
+/*
+ * Building blocks for qcc::Atomic<T>.  T must be a 32 or 64 bit integer or a
+ * pointer.  The Interlocked functions are full barriers so the memory order
+ * only matters for plain loads and stores.
+ */
+
+/**
+ * @internal
+ * Interlocked functions for each operand size.
+ */
+template <size_t N> struct _InterlockedOps;
+
+template <> struct _InterlockedOps<4> {
+    typedef LONG Type;
+    static Type Exchange(volatile void* mem, Type value) { return InterlockedExchange(reinterpret_cast<volatile LONG*>(mem), value); }
+    static Type CompareExchange(volatile void* mem, Type desired, Type expected) { return InterlockedCompareExchange(reinterpret_cast<volatile LONG*>(mem), desired, expected); }
+    static Type ExchangeAdd(volatile void* mem, Type delta) { return InterlockedExchangeAdd(reinterpret_cast<volatile LONG*>(mem), delta); }
+};
+
+template <> struct _InterlockedOps<8> {
+    typedef LONGLONG Type;
+    static Type Exchange(volatile void* mem, Type value) { return InterlockedExchange64(reinterpret_cast<volatile LONGLONG*>(mem), value); }
+    static Type CompareExchange(volatile void* mem, Type desired, Type expected) { return InterlockedCompareExchange64(reinterpret_cast<volatile LONGLONG*>(mem), desired, expected); }
+    static Type ExchangeAdd(volatile void* mem, Type delta) { return InterlockedExchangeAdd64(reinterpret_cast<volatile LONGLONG*>(mem), delta); }
+};
+
+/**
+ * @internal
+ * Reinterpret an integer or pointer as the Interlocked operand type of the
+ * same size and back.
+ */
+template <typename T>
+inline typename _InterlockedOps<sizeof(T)>::Type _ToInterlocked(T value)
+{
+    union { T t; typename _InterlockedOps<sizeof(T)>::Type i; } u;
+    u.t = value;
+    return u.i;
+}
+
+template <typename T>
+inline T _FromInterlocked(typename _InterlockedOps<sizeof(T)>::Type value)
+{
+    union { T t; typename _InterlockedOps<sizeof(T)>::Type i; } u;
+    u.i = value;
+    return u.t;
+}
+
+/**
+ * Atomically load a value.
+ *
+ * @param mem    Pointer to the value.
+ * @param order  Memory ordering constraint.
+ * @return  The value.
+ */
+template <typename T>
+inline T AtomicLoad(const volatile T* mem, MemoryOrder order = MEMORY_ORDER_SEQ_CST) {
+    if (order == MEMORY_ORDER_SEQ_CST) {
+        MemoryBarrier();
+    }
+    T value = *mem;
+    if (order != MEMORY_ORDER_RELAXED) {
+        MemoryBarrier();
+    }
+    return value;
+}
+
+/**
+ * Atomically store a value.
+ *
+ * @param mem    Pointer to the value.
+ * @param value  Value to store.
+ * @param order  Memory ordering constraint.
+ */
+template <typename T>
+inline void AtomicStore(volatile T* mem, T value, MemoryOrder order = MEMORY_ORDER_SEQ_CST) {
+    if (order == MEMORY_ORDER_SEQ_CST) {
+        _InterlockedOps<sizeof(T)>::Exchange(mem, _ToInterlocked(value));
+        return;
+    }
+    if (order != MEMORY_ORDER_RELAXED) {
+        MemoryBarrier();
+    }
+    *mem = value;
+}
+
+/**
+ * Atomically replace a value.
+ *
+ * @param mem    Pointer to the value.
+ * @param value  Value to store.
+ * @param order  Memory ordering constraint.
+ * @return  The previous value.
+ */
+template <typename T>
+inline T AtomicExchange(volatile T* mem, T value, MemoryOrder order = MEMORY_ORDER_SEQ_CST) {
+    return _FromInterlocked<T>(_InterlockedOps<sizeof(T)>::Exchange(mem, _ToInterlocked(value)));
+}
+
+/**
+ * Atomically replace a value if it currently holds an expected value.
+ *
+ * @param mem       Pointer to the value.
+ * @param expected  The expected value.  Returns the current value if the
+ *                  exchange did not happen.
+ * @param desired   Value to store.
+ * @param order     Memory ordering constraint.
+ * @return  true iff *mem held expected and was replaced with desired.
+ */
+template <typename T>
+inline bool AtomicCompareExchange(volatile T* mem, T& expected, T desired, MemoryOrder order = MEMORY_ORDER_SEQ_CST) {
+    typename _InterlockedOps<sizeof(T)>::Type previous = _InterlockedOps<sizeof(T)>::CompareExchange(mem, _ToInterlocked(desired), _ToInterlocked(expected));
+    if (previous == _ToInterlocked(expected)) {
+        return true;
+    }
+    expected = _FromInterlocked<T>(previous);
+    return false;
+}
+
+/**
+ * Atomically add to an integer.
+ *
+ * @param mem    Pointer to the integer.
+ * @param delta  Value to add.
+ * @param order  Memory ordering constraint.
+ * @return  The previous value.
+ */
+template <typename T>
+inline T AtomicFetchAdd(volatile T* mem, T delta, MemoryOrder order = MEMORY_ORDER_SEQ_CST) {
+    return _FromInterlocked<T>(_InterlockedOps<sizeof(T)>::ExchangeAdd(mem, _ToInterlocked(delta)));
+}
+
+/**
+ * Order memory accesses around this point without accessing memory.
+ *
+ * @param order  Memory ordering constraint.
+ */
+inline void AtomicFence(MemoryOrder order = MEMORY_ORDER_SEQ_CST) {
+    if (order != MEMORY_ORDER_RELAXED) {
+        MemoryBarrier();
+    }
+}
+
 }
 
 #endif
@@ -0,0 +1,141 @@
+/**
+ * @file
+ *
+ * Fast, non-recursive mutex for POSIX platforms.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <qcc/FastMutex.h>
+
+#ifdef QCC_FASTMUTEX_FUTEX
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <Status.h>
+
+/** @internal */
+#define QCC_MODULE "MUTEX"
+
+/** Upper bound on the number of times Lock() spins before sleeping */
+#define MAX_SPINS 100
+
+using namespace qcc;
+
+#ifdef QCC_FASTMUTEX_FUTEX
+
+static inline void CpuRelax()
+{
+#if defined(__i386__) || defined(__x86_64__)
+    __asm__ __volatile__ ("pause" ::: "memory");
+#endif
+}
+
+static inline int32_t Exchange(volatile int32_t* mem, int32_t newValue)
+{
+    int32_t oldValue;
+    do {
+        oldValue = *mem;
+    } while (!CompareAndExchange(mem, oldValue, newValue));
+    return oldValue;
+}
+
+static inline void FutexWait(volatile int32_t* addr, int32_t value)
+{
+    syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, value, NULL, NULL, 0);
+}
+
+static inline void FutexWake(volatile int32_t* addr, int32_t count)
+{
+    syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+}
+
+void FastMutex::Init()
+{
+    state = 0;
+    spins = 0;
+}
+
+FastMutex::~FastMutex()
+{
+}
+
+void FastMutex::LockSlow()
+{
+    /*
+     * Spin for up to twice as long as it has typically taken to get the
+     * mutex in the past.  The estimate is not protected; it is only a hint.
+     */
+    int32_t maxSpins = spins * 2 + 10;
+    if (maxSpins > MAX_SPINS) {
+        maxSpins = MAX_SPINS;
+    }
+    int32_t count = 0;
+    while (count < maxSpins) {
+        if ((state == 0) && CompareAndExchange(&state, 0, 1)) {
+            spins += (count - spins) / 8;
+            return;
+        }
+        CpuRelax();
+        ++count;
+    }
+    spins += (count - spins) / 8;
+
+    /*
+     * Sleep.  Marking the mutex as possibly having waiters (2) makes the
+     * holder wake somebody up on Unlock().  A thread that takes the mutex this
+     * way keeps the mark since it cannot know if it was the last waiter.
+     */
+    int32_t c = Exchange(&state, 2);
+    while (c != 0) {
+        FutexWait(&state, 2);
+        c = Exchange(&state, 2);
+    }
+}
+
+void FastMutex::UnlockSlow()
+{
+    state = 0;
+    FutexWake(&state, 1);
+}
+
+#else
+
+void FastMutex::Init()
+{
+    int ret = pthread_mutex_init(&mutex, NULL);
+    if (ret != 0) {
+        fflush(stdout);
+        // Can't use ER_LogError() since it uses mutexs under the hood.
+        printf("***** FastMutex initialization failure: %d - %s\n", ret, strerror(ret));
+    }
+}
+
+FastMutex::~FastMutex()
+{
+    pthread_mutex_destroy(&mutex);
+}
+
+#endif
@@ -0,0 +1,133 @@
+/**
+ * @file
+ *
+ * Futex wait and wake for POSIX
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/time.h>
+
+#include <qcc/Futex.h>
+
+#if defined(QCC_OS_LINUX) || defined(QCC_OS_ANDROID)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <Status.h>
+
+/** @internal */
+#define QCC_MODULE "FUTEX"
+
+namespace qcc {
+
+#if defined(QCC_OS_LINUX) || defined(QCC_OS_ANDROID)
+
+QStatus Futex::Wait(volatile int32_t* addr, int32_t expected, uint32_t maxMs)
+{
+    struct timespec timeout;
+    struct timespec* pTimeout = NULL;
+    if (maxMs != Event::WAIT_FOREVER) {
+        timeout.tv_sec = maxMs / 1000;
+        timeout.tv_nsec = (maxMs % 1000) * 1000000;
+        pTimeout = &timeout;
+    }
+    if (syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, expected, pTimeout, NULL, 0) == -1) {
+        if (errno == ETIMEDOUT) {
+            return ER_TIMEOUT;
+        }
+    }
+    return ER_OK;
+}
+
+void Futex::Wake(volatile int32_t* addr, uint32_t count)
+{
+    syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+}
+
+#else
+
+/*
+ * Addresses are hashed onto a fixed set of condition variables.  Unrelated
+ * addresses may share a bucket so Wake() has to wake everybody in it.
+ */
+#define NUM_BUCKETS 64
+
+struct FutexBucket {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+};
+
+static FutexBucket* GetBucket(volatile int32_t* addr)
+{
+    static FutexBucket buckets[NUM_BUCKETS];
+    static pthread_once_t once = PTHREAD_ONCE_INIT;
+    struct Init {
+        static void Buckets()
+        {
+            for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+                pthread_mutex_init(&buckets[i].mutex, NULL);
+                pthread_cond_init(&buckets[i].cond, NULL);
+            }
+        }
+    };
+    pthread_once(&once, Init::Buckets);
+    return &buckets[(reinterpret_cast<uintptr_t>(addr) >> 2) % NUM_BUCKETS];
+}
+
+QStatus Futex::Wait(volatile int32_t* addr, int32_t expected, uint32_t maxMs)
+{
+    FutexBucket* bucket = GetBucket(addr);
+    QStatus status = ER_OK;
+
+    pthread_mutex_lock(&bucket->mutex);
+    if (*addr == expected) {
+        if (maxMs == Event::WAIT_FOREVER) {
+            pthread_cond_wait(&bucket->cond, &bucket->mutex);
+        } else {
+            struct timeval now;
+            gettimeofday(&now, NULL);
+            struct timespec deadline;
+            uint64_t nsec = static_cast<uint64_t>(now.tv_usec) * 1000 + static_cast<uint64_t>(maxMs % 1000) * 1000000;
+            deadline.tv_sec = now.tv_sec + maxMs / 1000 + nsec / 1000000000;
+            deadline.tv_nsec = nsec % 1000000000;
+            if (pthread_cond_timedwait(&bucket->cond, &bucket->mutex, &deadline) == ETIMEDOUT) {
+                status = ER_TIMEOUT;
+            }
+        }
+    }
+    pthread_mutex_unlock(&bucket->mutex);
+    return status;
+}
+
+void Futex::Wake(volatile int32_t* addr, uint32_t count)
+{
+    FutexBucket* bucket = GetBucket(addr);
+    pthread_mutex_lock(&bucket->mutex);
+    pthread_cond_broadcast(&bucket->cond);
+    pthread_mutex_unlock(&bucket->mutex);
+}
+
+#endif
+
+}
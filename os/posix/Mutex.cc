@@ -29,6 +29,7 @@
 #include <qcc/Thread.h>
 #include <qcc/Mutex.h>
 #include <qcc/Debug.h>
+#include <qcc/LockProfiler.h>
 
 #include <Status.h>
 
@@ -63,6 +64,7 @@ void Mutex::Init()
     isInitialized = true;
     file = NULL;
     line = -1;
+    holdStart = 0;
 
 cleanup:
     // Don't need the attribute once it has been assigned to a mutex.
@@ -104,17 +106,23 @@ QStatus Mutex::Lock()
 
 QStatus Mutex::Lock(const char* file, uint32_t line)
 {
+    bool profiling = LockProfiler::IsEnabled();
 #ifdef NDEBUG
-    return Lock();
-#else
+    if (!profiling) {
+        return Lock();
+    }
+#endif
     if (!isInitialized) {
         return ER_INIT_FAILED;
     }
 
-    QStatus status;
-    if (TryLock()) {
-        status = ER_OK;
-    } else {
+    QStatus status = ER_OK;
+    uint64_t waitStart = 0;
+    bool contended = !TryLock();
+    if (contended) {
+        if (profiling) {
+            waitStart = LockProfiler::Now();
+        }
         status = Lock();
         if (status == ER_OK) {
             QCC_DbgPrintf(("Lock Acquired %s:%d", file, line));
@@ -123,18 +131,30 @@ QStatus Mutex::Lock(const char* file, uint32_t line)
         }
     }
     if (status == ER_OK) {
+        uint64_t now = 0;
+        if (profiling) {
+            now = LockProfiler::Now();
+            LockProfiler::Acquired(file, line, contended, contended ? now - waitStart : 0);
+        }
         this->file = reinterpret_cast<const char*>(file);
         this->line = line;
+        this->holdStart = now;
     }
     return status;
-#endif
 }
 
-QStatus Mutex::Unlock()
+QStatus Mutex::Release()
 {
-    if (!isInitialized) {
-        return ER_INIT_FAILED;
-    }
+    /*
+     * The call site has to be read and cleared before the mutex is released
+     * since the next owner sets its own.
+     */
+    const char* lockFile = file;
+    uint32_t lockLine = line;
+    uint64_t lockTime = holdStart;
+    file = NULL;
+    line = -1;
+    holdStart = 0;
 
     int ret = pthread_mutex_unlock(&mutex);
     if (ret != 0) {
@@ -144,30 +164,32 @@ QStatus Mutex::Unlock()
         assert(false);
         return ER_OS_ERROR;
     }
-    this->file = NULL;
-    this->line = -1;
+    if (lockTime) {
+        LockProfiler::Released(lockFile, lockLine, LockProfiler::Now() - lockTime);
+    }
     return ER_OK;
 }
 
+QStatus Mutex::Unlock()
+{
+    if (!isInitialized) {
+        return ER_INIT_FAILED;
+    }
+    return Release();
+}
+
 QStatus Mutex::Unlock(const char* file, uint32_t line)
 {
-#ifdef NDEBUG
-    return Unlock();
-#else
     if (!isInitialized) {
         return ER_INIT_FAILED;
     }
-    int ret = pthread_mutex_unlock(&mutex);
-    if (ret != 0) {
-        fflush(stdout);
-        printf("***** Mutex unlock failure: %s:%d %d - %s\n", file, line, ret, strerror(ret));
-        assert(false);
-        return ER_OS_ERROR;
+    QStatus status = Release();
+#ifndef NDEBUG
+    if (status != ER_OK) {
+        printf("***** Mutex unlock failure at %s:%d\n", file, line);
     }
-    this->file = NULL;
-    this->line = -1;
-    return ER_OK;
 #endif
+    return status;
 }
 
 bool Mutex::TryLock(void)
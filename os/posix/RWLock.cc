@@ -0,0 +1,57 @@
+/**
+ * @file
+ *
+ * Reader/writer lock for POSIX platforms.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <qcc/RWLock.h>
+
+#include <Status.h>
+
+/** @internal */
+#define QCC_MODULE "MUTEX"
+
+using namespace qcc;
+
+void RWLock::Init()
+{
+    pthread_rwlockattr_t attr;
+    pthread_rwlockattr_init(&attr);
+#if defined(QCC_OS_LINUX) && defined(__GLIBC__)
+    /* glibc prefers readers by default, which lets readers starve writers */
+    pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+    int ret = pthread_rwlock_init(&lock, &attr);
+    if (ret != 0) {
+        fflush(stdout);
+        // Can't use ER_LogError() since it uses mutexs under the hood.
+        printf("***** RWLock initialization failure: %d - %s\n", ret, strerror(ret));
+    }
+    pthread_rwlockattr_destroy(&attr);
+}
+
+RWLock::~RWLock()
+{
+    pthread_rwlock_destroy(&lock);
+}
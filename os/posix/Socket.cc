@@ -36,6 +36,13 @@
 #include <sys/un.h>
 #include <sys/ioctl.h>
 #include <unistd.h>
+
+#if defined(QCC_OS_LINUX)
+#include <linux/errqueue.h>
+#include <linux/filter.h>
+#include <netinet/udp.h>
+#include <poll.h>
+#endif
 #if defined(QCC_OS_DARWIN)
 #include <sys/ucred.h>
 #endif
@@ -153,6 +160,27 @@ QStatus GetSockAddr(const sockaddr_storage* addrBuf, socklen_t addrSize,
     return status;
 }
 
+/*
+ * Convert a socket address to an IPAddress without going through
+ * getnameinfo() and a string, which costs more than receiving a small
+ * datagram.
+ */
+static void SockAddrToIPAddress(const struct sockaddr_storage* addrBuf, IPAddress& addr, uint16_t& port)
+{
+    if (addrBuf->ss_family == AF_INET) {
+        const struct sockaddr_in* sa = reinterpret_cast<const struct sockaddr_in*>(addrBuf);
+        addr = IPAddress(reinterpret_cast<const uint8_t*>(&sa->sin_addr.s_addr), IPAddress::IPv4_SIZE);
+        port = ntohs(sa->sin_port);
+    } else if (addrBuf->ss_family == AF_INET6) {
+        const struct sockaddr_in6* sa = reinterpret_cast<const struct sockaddr_in6*>(addrBuf);
+        addr = IPAddress(sa->sin6_addr.s6_addr, IPAddress::IPv6_SIZE);
+        port = ntohs(sa->sin6_port);
+    } else {
+        addr = IPAddress();
+        port = 0;
+    }
+}
+
 uint32_t GetLastError()
 {
     return errno;
@@ -326,6 +354,35 @@ QStatus Listen(SocketFd sockfd, int backlog)
 }
 
 
+/*
+ * Accept one connection and make it non-blocking and close-on-exec.  On Linux
+ * accept4() does all of that in one system call.  Returns -1 with errno set on
+ * failure.
+ */
+static int AcceptNonBlocking(SocketFd sockfd, struct sockaddr_storage* addr, socklen_t* addrLen)
+{
+#if defined(QCC_OS_LINUX)
+    return accept4(static_cast<int>(sockfd), reinterpret_cast<struct sockaddr*>(addr), addrLen, SOCK_NONBLOCK | SOCK_CLOEXEC);
+#else
+    int fd = accept(static_cast<int>(sockfd), reinterpret_cast<struct sockaddr*>(addr), addrLen);
+    if (fd != -1) {
+        int flags = fcntl(fd, F_GETFL, 0);
+        if ((fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1) || (fcntl(fd, F_SETFD, FD_CLOEXEC) == -1)) {
+            int err = errno;
+            QCC_LogError(ER_OS_ERROR, ("Accept fcntl (newSockfd = %u): %d - %s", fd, errno, strerror(errno)));
+            /* better to close and error out than to leave in unexpected state */
+            close(fd);
+            errno = err;
+            return -1;
+        }
+#if defined(QCC_OS_DARWIN)
+        DisableSigPipe(fd);
+#endif
+    }
+    return fd;
+#endif
+}
+
 QStatus Accept(SocketFd sockfd, IPAddress& remoteAddr, uint16_t& remotePort, SocketFd& newSockfd)
 {
     QStatus status = ER_OK;
@@ -335,7 +392,7 @@ QStatus Accept(SocketFd sockfd, IPAddress& remoteAddr, uint16_t& remotePort, Soc
 
     QCC_DbgTrace(("Accept(sockfd = %d, remoteAddr = <>, remotePort = <>)", sockfd));
 
-    ret = accept(static_cast<int>(sockfd), reinterpret_cast<struct sockaddr*>(&addr), &addrLen);
+    ret = AcceptNonBlocking(sockfd, &addr, &addrLen);
     if (ret == -1) {
         if (errno == EWOULDBLOCK) {
             status = ER_WOULDBLOCK;
@@ -344,37 +401,43 @@ QStatus Accept(SocketFd sockfd, IPAddress& remoteAddr, uint16_t& remotePort, Soc
             QCC_LogError(status, ("Accept (sockfd = %u): %d - %s", sockfd, errno, strerror(errno)));
         }
     } else {
-        if (addr.ss_family == AF_INET) {
-            struct sockaddr_in* sa = reinterpret_cast<struct sockaddr_in*>(&addr);
-            uint8_t* portBuf = reinterpret_cast<uint8_t*>(&sa->sin_port);
-            remoteAddr = IPAddress(reinterpret_cast<uint8_t*>(&sa->sin_addr.s_addr),
-                                   IPAddress::IPv4_SIZE);
-            remotePort = (static_cast<uint16_t>(portBuf[0]) << 8) | static_cast<uint16_t>(portBuf[1]);
-        } else if (addr.ss_family == AF_INET6) {
-            struct sockaddr_in6* sa = reinterpret_cast<struct sockaddr_in6*>(&addr);
-            uint8_t* portBuf = reinterpret_cast<uint8_t*>(&sa->sin6_port);
-            remoteAddr = IPAddress(reinterpret_cast<uint8_t*>(&sa->sin6_addr.s6_addr),
-                                   IPAddress::IPv6_SIZE);
-            remotePort = (static_cast<uint16_t>(portBuf[0]) << 8) | static_cast<uint16_t>(portBuf[1]);
-        } else {
-            remotePort = 0;
-        }
+        SockAddrToIPAddress(&addr, remoteAddr, remotePort);
         newSockfd = static_cast<SocketFd>(ret);
-#if defined(QCC_OS_DARWIN)
-        DisableSigPipe(newSockfd);
-#endif
         QCC_DbgPrintf(("New socket FD: %d", newSockfd));
+    }
+    return status;
+}
+
+
+QStatus AcceptMany(SocketFd sockfd, size_t maxCount, AcceptedSocket* results, size_t& accepted)
+{
+    QStatus status = ER_OK;
 
-        int flags = fcntl(newSockfd, F_GETFL, 0);
-        ret = fcntl(newSockfd, F_SETFL, flags | O_NONBLOCK);
+    QCC_DbgTrace(("AcceptMany(sockfd = %d, maxCount = %lu, results = <>, accepted = <>)", sockfd, static_cast<unsigned long>(maxCount)));
 
+    accepted = 0;
+    while (accepted < maxCount) {
+        struct sockaddr_storage addr;
+        socklen_t addrLen = sizeof(addr);
+        int ret = AcceptNonBlocking(sockfd, &addr, &addrLen);
         if (ret == -1) {
-            status = ER_OS_ERROR;
-            QCC_LogError(status, ("Accept fcntl (newSockfd = %u) to O_NONBLOCK: %d - %s", newSockfd, errno, strerror(errno)));
-            /* better to close and error out than to leave in unexpected state */
-            qcc::Close(newSockfd);
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+                status = accepted ? ER_OK : ER_WOULDBLOCK;
+            } else if ((errno == ECONNABORTED) || (errno == EINTR)) {
+                /* The client gave up before it was accepted, move on to the next */
+                continue;
+            } else {
+                /* For example out of file descriptors, report it if there is nothing else to report */
+                QCC_LogError(ER_OS_ERROR, ("AcceptMany (sockfd = %u): %d - %s", sockfd, errno, strerror(errno)));
+                status = accepted ? ER_OK : ER_OS_ERROR;
+            }
+            break;
         }
+        AcceptedSocket& result = results[accepted++];
+        result.sockfd = static_cast<SocketFd>(ret);
+        SockAddrToIPAddress(&addr, result.addr, result.port);
     }
+    QCC_DbgPrintf(("Accepted %lu connections", static_cast<unsigned long>(accepted)));
     return status;
 }
 
@@ -402,6 +465,21 @@ QStatus Shutdown(SocketFd sockfd)
     return status;
 }
 
+QStatus ShutdownSend(SocketFd sockfd)
+{
+    QStatus status = ER_OK;
+    int ret;
+
+    QCC_DbgTrace(("ShutdownSend(sockfd = %d)", sockfd));
+
+    ret = shutdown(static_cast<int>(sockfd), SHUT_WR);
+    if (ret != 0) {
+        status = ER_OS_ERROR;
+        QCC_LogError(status, ("ShutdownSend socket (sockfd = %u): %d - %s", sockfd, errno, strerror(errno)));
+    }
+    return status;
+}
+
 
 void Close(SocketFd sockfd)
 {
@@ -575,6 +653,261 @@ QStatus RecvFrom(SocketFd sockfd, IPAddress& remoteAddr, uint16_t& remotePort,
 }
 
 
+/*
+ * Send the segments of a datagram one at a time, for when the kernel cannot
+ * split them.
+ */
+static QStatus SendSegments(SocketFd sockfd, const Datagram& datagram, const struct sockaddr_storage* addr, socklen_t addrLen)
+{
+    const uint8_t* buf = static_cast<const uint8_t*>(datagram.buf);
+    size_t segmentSize = datagram.segmentSize ? datagram.segmentSize : datagram.len;
+    size_t offset = 0;
+    do {
+        size_t len = std::min(segmentSize, datagram.len - offset);
+        ssize_t ret = sendto(static_cast<int>(sockfd), buf + offset, len, MSG_NOSIGNAL,
+                             reinterpret_cast<const struct sockaddr*>(addr), addrLen);
+        if (ret == -1) {
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+                return ER_WOULDBLOCK;
+            }
+            QCC_LogError(ER_OS_ERROR, ("SendToBatch (sockfd = %u  addr = %s  port = %u): %d - %s",
+                                       sockfd, datagram.addr.ToString().c_str(), datagram.port, errno, strerror(errno)));
+            return ER_OS_ERROR;
+        }
+        offset += len;
+    } while (offset < datagram.len);
+    return ER_OK;
+}
+
+#if defined(QCC_OS_LINUX)
+
+#ifndef SOL_UDP
+#define SOL_UDP IPPROTO_UDP
+#endif
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+
+/* Number of datagrams passed to each sendmmsg() or recvmmsg() */
+#define MMSG_BATCH 32
+
+QStatus SendToBatch(SocketFd sockfd, Datagram* datagrams, size_t count, size_t& sent)
+{
+    struct mmsghdr msgs[MMSG_BATCH];
+    struct iovec iovs[MMSG_BATCH];
+    struct sockaddr_storage addrs[MMSG_BATCH];
+    union {
+        char buf[CMSG_SPACE(sizeof(uint16_t))];
+        struct cmsghdr align;
+    } cbufs[MMSG_BATCH];
+
+    QCC_DbgTrace(("SendToBatch(sockfd = %d, datagrams = <>, count = %lu, sent = <>)", sockfd, count));
+
+    sent = 0;
+    while (sent < count) {
+        size_t n = std::min(count - sent, static_cast<size_t>(MMSG_BATCH));
+        memset(msgs, 0, n * sizeof(msgs[0]));
+        for (size_t i = 0; i < n; ++i) {
+            const Datagram& datagram = datagrams[sent + i];
+            assert(datagram.buf != NULL);
+            socklen_t addrLen = sizeof(addrs[i]);
+            QStatus status = MakeSockAddr(datagram.addr, datagram.port, &addrs[i], addrLen);
+            if (status != ER_OK) {
+                return sent ? ER_OK : status;
+            }
+            iovs[i].iov_base = datagram.buf;
+            iovs[i].iov_len = datagram.len;
+            msgs[i].msg_hdr.msg_name = &addrs[i];
+            msgs[i].msg_hdr.msg_namelen = addrLen;
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            if (datagram.segmentSize && (datagram.segmentSize < datagram.len)) {
+                msgs[i].msg_hdr.msg_control = cbufs[i].buf;
+                msgs[i].msg_hdr.msg_controllen = sizeof(cbufs[i].buf);
+                struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msgs[i].msg_hdr);
+                cmsg->cmsg_level = SOL_UDP;
+                cmsg->cmsg_type = UDP_SEGMENT;
+                cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+                memcpy(CMSG_DATA(cmsg), &datagram.segmentSize, sizeof(uint16_t));
+            }
+        }
+
+        int ret = sendmmsg(static_cast<int>(sockfd), msgs, static_cast<unsigned int>(n), MSG_NOSIGNAL);
+        if (ret == -1) {
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+                return sent ? ER_OK : ER_WOULDBLOCK;
+            }
+            const Datagram& datagram = datagrams[sent];
+            if (msgs[0].msg_hdr.msg_control && ((errno == EIO) || (errno == EINVAL) || (errno == ENOPROTOOPT))) {
+                /*
+                 * The kernel or the device cannot segment this datagram (too
+                 * many segments, no checksum offload, or a kernel before 4.18)
+                 * so send the segments separately.
+                 */
+                QStatus status = SendSegments(sockfd, datagram, &addrs[0], msgs[0].msg_hdr.msg_namelen);
+                if (status != ER_OK) {
+                    return sent ? ER_OK : status;
+                }
+                ++sent;
+                continue;
+            }
+            QStatus status = ER_OS_ERROR;
+            QCC_LogError(status, ("SendToBatch (sockfd = %u  addr = %s  port = %u): %d - %s",
+                                  sockfd, datagram.addr.ToString().c_str(), datagram.port, errno, strerror(errno)));
+            return sent ? ER_OK : status;
+        }
+        sent += ret;
+        if (static_cast<size_t>(ret) < n) {
+            break;
+        }
+    }
+    return ER_OK;
+}
+
+QStatus RecvFromBatch(SocketFd sockfd, Datagram* datagrams, size_t count, size_t& received)
+{
+    struct mmsghdr msgs[MMSG_BATCH];
+    struct iovec iovs[MMSG_BATCH];
+    struct sockaddr_storage addrs[MMSG_BATCH];
+    union {
+        char buf[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    } cbufs[MMSG_BATCH];
+
+    QCC_DbgTrace(("RecvFromBatch(sockfd = %d, datagrams = <>, count = %lu, received = <>)", sockfd, count));
+
+    received = 0;
+    while (received < count) {
+        size_t n = std::min(count - received, static_cast<size_t>(MMSG_BATCH));
+        memset(msgs, 0, n * sizeof(msgs[0]));
+        for (size_t i = 0; i < n; ++i) {
+            Datagram& datagram = datagrams[received + i];
+            assert(datagram.buf != NULL);
+            iovs[i].iov_base = datagram.buf;
+            iovs[i].iov_len = datagram.size;
+            msgs[i].msg_hdr.msg_name = &addrs[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            msgs[i].msg_hdr.msg_control = cbufs[i].buf;
+            msgs[i].msg_hdr.msg_controllen = sizeof(cbufs[i].buf);
+        }
+
+        /* Only the first datagram of the first batch is waited for */
+        int flags = received ? MSG_DONTWAIT : MSG_WAITFORONE;
+        int ret = recvmmsg(static_cast<int>(sockfd), msgs, static_cast<unsigned int>(n), flags, NULL);
+        if (ret == -1) {
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+                return received ? ER_OK : ER_WOULDBLOCK;
+            }
+            if (received) {
+                return ER_OK;
+            }
+            QStatus status = ER_OS_ERROR;
+            QCC_DbgHLPrintf(("RecvFromBatch (sockfd = %u): %d - %s", sockfd, errno, strerror(errno)));
+            return status;
+        }
+        for (int i = 0; i < ret; ++i) {
+            Datagram& datagram = datagrams[received + i];
+            datagram.len = msgs[i].msg_len;
+            datagram.segmentSize = 0;
+            SockAddrToIPAddress(&addrs[i], datagram.addr, datagram.port);
+            for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msgs[i].msg_hdr); cmsg != NULL; cmsg = CMSG_NXTHDR(&msgs[i].msg_hdr, cmsg)) {
+                if ((cmsg->cmsg_level == SOL_UDP) && (cmsg->cmsg_type == UDP_GRO)) {
+                    int segmentSize;
+                    memcpy(&segmentSize, CMSG_DATA(cmsg), sizeof(segmentSize));
+                    datagram.segmentSize = static_cast<uint16_t>(segmentSize);
+                }
+            }
+            QCC_DbgRemoteData(datagram.buf, datagram.len);
+        }
+        received += ret;
+        if (static_cast<size_t>(ret) < n) {
+            break;
+        }
+    }
+    return ER_OK;
+}
+
+QStatus SetUdpGro(SocketFd sockfd, bool gro)
+{
+    QStatus status = ER_OK;
+    int arg = gro ? 1 : 0;
+    int r = setsockopt(sockfd, SOL_UDP, UDP_GRO, (void*)&arg, sizeof(arg));
+    if (r != 0) {
+        status = ER_OS_ERROR;
+        QCC_LogError(status, ("Setting UDP_GRO failed: (%d) %s", errno, strerror(errno)));
+    }
+    return status;
+}
+
+#else
+
+/*
+ * Without sendmmsg() and recvmmsg() the datagrams are moved one system call
+ * at a time.
+ */
+QStatus SendToBatch(SocketFd sockfd, Datagram* datagrams, size_t count, size_t& sent)
+{
+    QCC_DbgTrace(("SendToBatch(sockfd = %d, datagrams = <>, count = %lu, sent = <>)", sockfd, count));
+
+    for (sent = 0; sent < count; ++sent) {
+        const Datagram& datagram = datagrams[sent];
+        assert(datagram.buf != NULL);
+        struct sockaddr_storage addr;
+        socklen_t addrLen = sizeof(addr);
+        QStatus status = MakeSockAddr(datagram.addr, datagram.port, &addr, addrLen);
+        if (status == ER_OK) {
+            status = SendSegments(sockfd, datagram, &addr, addrLen);
+        }
+        if (status != ER_OK) {
+            return sent ? ER_OK : status;
+        }
+    }
+    return ER_OK;
+}
+
+QStatus RecvFromBatch(SocketFd sockfd, Datagram* datagrams, size_t count, size_t& received)
+{
+    QCC_DbgTrace(("RecvFromBatch(sockfd = %d, datagrams = <>, count = %lu, received = <>)", sockfd, count));
+
+    for (received = 0; received < count; ++received) {
+        Datagram& datagram = datagrams[received];
+        assert(datagram.buf != NULL);
+        struct sockaddr_storage addr;
+        socklen_t addrLen = sizeof(addr);
+        /* Only the first datagram is waited for */
+        ssize_t ret = recvfrom(static_cast<int>(sockfd), datagram.buf, datagram.size, received ? MSG_DONTWAIT : 0,
+                               reinterpret_cast<struct sockaddr*>(&addr), &addrLen);
+        if (ret == -1) {
+            if (received) {
+                return ER_OK;
+            }
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+                return ER_WOULDBLOCK;
+            }
+            QCC_DbgHLPrintf(("RecvFromBatch (sockfd = %u): %d - %s", sockfd, errno, strerror(errno)));
+            return ER_OS_ERROR;
+        }
+        datagram.len = static_cast<size_t>(ret);
+        datagram.segmentSize = 0;
+        SockAddrToIPAddress(&addr, datagram.addr, datagram.port);
+        QCC_DbgRemoteData(datagram.buf, datagram.len);
+    }
+    return ER_OK;
+}
+
+QStatus SetUdpGro(SocketFd sockfd, bool gro)
+{
+    return ER_NOT_IMPLEMENTED;
+}
+
+#endif
+
+
 QStatus RecvWithFds(SocketFd sockfd, void* buf, size_t len, size_t& received, SocketFd* fdList, size_t maxFds, size_t& recvdFds)
 {
     QStatus status = ER_OK;
@@ -682,6 +1015,162 @@ QStatus SendWithFds(SocketFd sockfd, const void* buf, size_t len, size_t& sent,
     return status;
 }
 
+#if defined(QCC_OS_LINUX)
+
+#ifndef SO_ZEROCOPY
+#define SO_ZEROCOPY 60
+#endif
+#ifndef MSG_ZEROCOPY
+#define MSG_ZEROCOPY 0x4000000
+#endif
+#ifndef SO_EE_ORIGIN_ZEROCOPY
+#define SO_EE_ORIGIN_ZEROCOPY 5
+#endif
+#ifndef SO_EE_CODE_ZEROCOPY_COPIED
+#define SO_EE_CODE_ZEROCOPY_COPIED 1
+#endif
+
+QStatus SetZeroCopy(SocketFd sockfd, bool enable)
+{
+    int arg = enable ? 1 : 0;
+    if (setsockopt(static_cast<int>(sockfd), SOL_SOCKET, SO_ZEROCOPY, &arg, sizeof(arg)) != 0) {
+        if (errno == ENOPROTOOPT) {
+            return ER_NOT_IMPLEMENTED;
+        }
+        QCC_LogError(ER_OS_ERROR, ("Setting SO_ZEROCOPY failed: (%d) %s", errno, strerror(errno)));
+        return ER_OS_ERROR;
+    }
+    return ER_OK;
+}
+
+QStatus SendZeroCopy(SocketFd sockfd, const void* buf, size_t len, size_t& sent, bool& zeroCopied)
+{
+    QStatus status = ER_OK;
+
+    QCC_DbgTrace(("SendZeroCopy(sockfd = %d, *buf = <>, len = %lu, sent = <>)", sockfd, static_cast<unsigned long>(len)));
+    assert(buf != NULL);
+
+    zeroCopied = true;
+    ssize_t ret = send(static_cast<int>(sockfd), buf, len, MSG_NOSIGNAL | MSG_ZEROCOPY);
+    if ((ret == -1) && (errno == ENOBUFS)) {
+        zeroCopied = false;
+        ret = send(static_cast<int>(sockfd), buf, len, MSG_NOSIGNAL);
+    }
+    if (ret == -1) {
+        zeroCopied = false;
+        if (errno == EAGAIN) {
+            status = ER_WOULDBLOCK;
+        } else {
+            status = ER_OS_ERROR;
+            QCC_DbgHLPrintf(("SendZeroCopy (sockfd = %u): %d - %s", sockfd, errno, strerror(errno)));
+        }
+    } else {
+        sent = static_cast<size_t>(ret);
+    }
+    return status;
+}
+
+QStatus GetZeroCopyCompletion(SocketFd sockfd, uint32_t& first, uint32_t& last, bool& copied)
+{
+    while (true) {
+        char cbuf[CMSG_SPACE(sizeof(struct sock_extended_err) + sizeof(struct sockaddr_in6))];
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_control = cbuf;
+        msg.msg_controllen = sizeof(cbuf);
+
+        if (recvmsg(static_cast<int>(sockfd), &msg, MSG_ERRQUEUE | MSG_DONTWAIT) == -1) {
+            if (errno == EAGAIN) {
+                return ER_WOULDBLOCK;
+            }
+            QCC_LogError(ER_OS_ERROR, ("GetZeroCopyCompletion (sockfd = %u): %d - %s", sockfd, errno, strerror(errno)));
+            return ER_OS_ERROR;
+        }
+        for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (((cmsg->cmsg_level == SOL_IP) && (cmsg->cmsg_type == IP_RECVERR)) ||
+                ((cmsg->cmsg_level == SOL_IPV6) && (cmsg->cmsg_type == IPV6_RECVERR))) {
+                const struct sock_extended_err* err = reinterpret_cast<const struct sock_extended_err*>(CMSG_DATA(cmsg));
+                if ((err->ee_errno == 0) && (err->ee_origin == SO_EE_ORIGIN_ZEROCOPY)) {
+                    first = err->ee_info;
+                    last = err->ee_data;
+                    copied = (err->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) != 0;
+                    return ER_OK;
+                }
+            }
+        }
+        /* Something other than a zero copy completion, look at the next one */
+    }
+}
+
+QStatus WaitForZeroCopyCompletion(SocketFd sockfd, uint32_t timeout)
+{
+    /* With no events requested poll() only reports errors and hangups */
+    struct pollfd pfd;
+    pfd.fd = static_cast<int>(sockfd);
+    pfd.events = 0;
+    pfd.revents = 0;
+    int ret;
+    do {
+        ret = poll(&pfd, 1, static_cast<int>(timeout));
+    } while ((ret == -1) && (errno == EINTR));
+    if (ret == -1) {
+        QCC_LogError(ER_OS_ERROR, ("WaitForZeroCopyCompletion (sockfd = %u): %d - %s", sockfd, errno, strerror(errno)));
+        return ER_OS_ERROR;
+    }
+    if (pfd.revents & POLLERR) {
+        /*
+         * POLLERR also reports a pending socket error, which never clears
+         * by reading the error queue.  Reading SO_ERROR clears it.
+         */
+        int err = 0;
+        socklen_t len = sizeof(err);
+        if (getsockopt(static_cast<int>(sockfd), SOL_SOCKET, SO_ERROR, &err, &len) == -1) {
+            QCC_LogError(ER_OS_ERROR, ("WaitForZeroCopyCompletion (sockfd = %u): %d - %s", sockfd, errno, strerror(errno)));
+            return ER_OS_ERROR;
+        }
+        if (err == 0) {
+            return ER_OK;
+        }
+        if ((err == ECONNRESET) || (err == EPIPE)) {
+            return ER_SOCK_OTHER_END_CLOSED;
+        }
+        QCC_LogError(ER_OS_ERROR, ("WaitForZeroCopyCompletion (sockfd = %u): %d - %s", sockfd, err, strerror(err)));
+        return ER_OS_ERROR;
+    }
+    if (pfd.revents & POLLHUP) {
+        return ER_SOCK_OTHER_END_CLOSED;
+    }
+    if (pfd.revents & POLLNVAL) {
+        return ER_OS_ERROR;
+    }
+    return ER_TIMEOUT;
+}
+
+#else
+
+QStatus SetZeroCopy(SocketFd sockfd, bool enable)
+{
+    return ER_NOT_IMPLEMENTED;
+}
+
+QStatus SendZeroCopy(SocketFd sockfd, const void* buf, size_t len, size_t& sent, bool& zeroCopied)
+{
+    zeroCopied = false;
+    return Send(sockfd, buf, len, sent);
+}
+
+QStatus GetZeroCopyCompletion(SocketFd sockfd, uint32_t& first, uint32_t& last, bool& copied)
+{
+    return ER_NOT_IMPLEMENTED;
+}
+
+QStatus WaitForZeroCopyCompletion(SocketFd sockfd, uint32_t timeout)
+{
+    return ER_NOT_IMPLEMENTED;
+}
+
+#endif
+
 QStatus SocketPair(SocketFd(&sockets)[2])
 {
     int ret = socketpair(AF_UNIX, SOCK_STREAM, 0, sockets);
@@ -716,6 +1205,90 @@ QStatus SetNagle(SocketFd sockfd, bool useNagle)
     return status;
 }
 
+#if defined(QCC_OS_LINUX)
+#ifndef SO_BUSY_POLL
+#define SO_BUSY_POLL 46
+#endif
+#ifndef TCP_NOTSENT_LOWAT
+#define TCP_NOTSENT_LOWAT 25
+#endif
+#endif
+
+/*
+ * Set one integer socket option, logging any failure.
+ */
+static QStatus SetIntOption(SocketFd sockfd, int level, int option, const char* name, int value)
+{
+    if (setsockopt(static_cast<int>(sockfd), level, option, &value, sizeof(value)) != 0) {
+        QCC_LogError(ER_OS_ERROR, ("Setting %s to %d failed: (%d) %s", name, value, errno, strerror(errno)));
+        return ER_OS_ERROR;
+    }
+    return ER_OK;
+}
+
+QStatus SetSocketOptions(SocketFd sockfd, const SocketOptions& options)
+{
+    QStatus status = ER_OK;
+
+    QCC_DbgTrace(("SetSocketOptions(sockfd = %d, options = <>)", sockfd));
+
+    if (options.sendBufferSize && (SetIntOption(sockfd, SOL_SOCKET, SO_SNDBUF, "SO_SNDBUF", options.sendBufferSize) != ER_OK)) {
+        status = ER_OS_ERROR;
+    }
+    if (options.receiveBufferSize && (SetIntOption(sockfd, SOL_SOCKET, SO_RCVBUF, "SO_RCVBUF", options.receiveBufferSize) != ER_OK)) {
+        status = ER_OS_ERROR;
+    }
+    if (options.noDelay && (SetIntOption(sockfd, IPPROTO_TCP, TCP_NODELAY, "TCP_NODELAY", 1) != ER_OK)) {
+        status = ER_OS_ERROR;
+    }
+    if (options.keepAliveIdle) {
+        if (SetIntOption(sockfd, SOL_SOCKET, SO_KEEPALIVE, "SO_KEEPALIVE", 1) != ER_OK) {
+            status = ER_OS_ERROR;
+        }
+#if defined(TCP_KEEPIDLE)
+        if (SetIntOption(sockfd, IPPROTO_TCP, TCP_KEEPIDLE, "TCP_KEEPIDLE", options.keepAliveIdle) != ER_OK) {
+            status = ER_OS_ERROR;
+        }
+#elif defined(TCP_KEEPALIVE)
+        if (SetIntOption(sockfd, IPPROTO_TCP, TCP_KEEPALIVE, "TCP_KEEPALIVE", options.keepAliveIdle) != ER_OK) {
+            status = ER_OS_ERROR;
+        }
+#endif
+#if defined(TCP_KEEPINTVL)
+        if (options.keepAliveInterval && (SetIntOption(sockfd, IPPROTO_TCP, TCP_KEEPINTVL, "TCP_KEEPINTVL", options.keepAliveInterval) != ER_OK)) {
+            status = ER_OS_ERROR;
+        }
+#endif
+#if defined(TCP_KEEPCNT)
+        if (options.keepAliveCount && (SetIntOption(sockfd, IPPROTO_TCP, TCP_KEEPCNT, "TCP_KEEPCNT", options.keepAliveCount) != ER_OK)) {
+            status = ER_OS_ERROR;
+        }
+#endif
+    }
+#if defined(SO_BUSY_POLL)
+    if (options.busyPoll && (SetIntOption(sockfd, SOL_SOCKET, SO_BUSY_POLL, "SO_BUSY_POLL", options.busyPoll) != ER_OK)) {
+        status = ER_OS_ERROR;
+    }
+#endif
+#if defined(TCP_NOTSENT_LOWAT)
+    if (options.notSentLowat && (SetIntOption(sockfd, IPPROTO_TCP, TCP_NOTSENT_LOWAT, "TCP_NOTSENT_LOWAT", options.notSentLowat) != ER_OK)) {
+        status = ER_OS_ERROR;
+    }
+#endif
+    return status;
+}
+
+QStatus SetCork(SocketFd sockfd, bool cork)
+{
+#if defined(QCC_OS_LINUX)
+    return SetIntOption(sockfd, IPPROTO_TCP, TCP_CORK, "TCP_CORK", cork ? 1 : 0);
+#elif defined(TCP_NOPUSH)
+    return SetIntOption(sockfd, IPPROTO_TCP, TCP_NOPUSH, "TCP_NOPUSH", cork ? 1 : 0);
+#else
+    return ER_NOT_IMPLEMENTED;
+#endif
+}
+
 QStatus SetReuseAddress(SocketFd sockfd, bool reuse)
 {
     QStatus status = ER_OK;
@@ -754,6 +1327,46 @@ QStatus SetReusePort(SocketFd sockfd, bool reuse)
     return status;
 }
 
+#if defined(QCC_OS_LINUX)
+
+#ifndef SO_ATTACH_REUSEPORT_CBPF
+#define SO_ATTACH_REUSEPORT_CBPF 51
+#endif
+
+QStatus SetReusePortCpuSteering(SocketFd sockfd, uint32_t numSockets)
+{
+    QStatus status = ER_OK;
+
+    QCC_DbgTrace(("SetReusePortCpuSteering(sockfd = %d, numSockets = %u)", sockfd, numSockets));
+
+    if (numSockets == 0) {
+        return ER_BAD_ARG_2;
+    }
+    /* return cpu % numSockets */
+    struct sock_filter code[] = {
+        { BPF_LD | BPF_W | BPF_ABS, 0, 0, static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_CPU) },
+        { BPF_ALU | BPF_MOD | BPF_K, 0, 0, numSockets },
+        { BPF_RET | BPF_A, 0, 0, 0 }
+    };
+    struct sock_fprog prog;
+    prog.len = ArraySize(code);
+    prog.filter = code;
+    if (setsockopt(sockfd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof(prog)) != 0) {
+        status = ER_OS_ERROR;
+        QCC_LogError(status, ("Setting SO_ATTACH_REUSEPORT_CBPF failed: (%d) %s", errno, strerror(errno)));
+    }
+    return status;
+}
+
+#else
+
+QStatus SetReusePortCpuSteering(SocketFd sockfd, uint32_t numSockets)
+{
+    return ER_NOT_IMPLEMENTED;
+}
+
+#endif
+
 #ifndef IPV6_ADD_MEMBERSHIP
 #define IPV6_ADD_MEMBERSHIP IPV6_JOIN_GROUP
 #endif
@@ -25,12 +25,19 @@
 #include <assert.h>
 #include <errno.h>
 #include <pthread.h>
+#include <sched.h>
 #include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include <unistd.h>
 #include <map>
 
+#if defined(QCC_OS_ANDROID)
+#include <sys/prctl.h>
+#endif
+
 #include <qcc/Debug.h>
 #include <qcc/String.h>
 #include <qcc/Mutex.h>
@@ -56,17 +63,56 @@ map<ThreadHandle, Thread*>* Thread::threadList = NULL;
 
 static int threadListCounter = 0;
 
+/*
+ * The Thread object for the calling thread is cached in thread specific
+ * storage so that GetThread() and GetThreadName() do not have to take
+ * threadListLock and search threadList.  threadList is still maintained for
+ * enumeration and for cleaning up external threads.
+ *
+ * External wrapper threads can be deleted by CleanExternalThreads() from any
+ * thread, which cannot clear the cached pointers of other threads.  So for
+ * external wrappers we also cache the value of externalGeneration at the time
+ * the wrapper was cached and ignore the cached pointer once CleanExternalThreads()
+ * has moved the generation on.  Threads started by Thread::Start() cache a
+ * generation of 0 and are always valid while they run.
+ */
+static pthread_key_t currentThreadKey;
+static pthread_key_t currentGenerationKey;
+static volatile int32_t externalGeneration = 1;
+
+static void SetCurrentThread(Thread* thread, int32_t generation)
+{
+    pthread_setspecific(currentThreadKey, thread);
+    pthread_setspecific(currentGenerationKey, reinterpret_cast<void*>(static_cast<intptr_t>(generation)));
+}
+
+static Thread* GetCurrentThread()
+{
+    Thread* thread = reinterpret_cast<Thread*>(pthread_getspecific(currentThreadKey));
+    if (thread) {
+        int32_t generation = static_cast<int32_t>(reinterpret_cast<intptr_t>(pthread_getspecific(currentGenerationKey)));
+        if ((generation != 0) && (generation != externalGeneration)) {
+            thread = NULL;
+        }
+    }
+    return thread;
+}
+
 ThreadListInitializer::ThreadListInitializer()
 {
     if (0 == threadListCounter++) {
         Thread::threadListLock = new Mutex();
         Thread::threadList = new map<ThreadHandle, Thread*>();
+        pthread_key_create(&currentThreadKey, NULL);
+        pthread_key_create(&currentGenerationKey, NULL);
     }
 }
 
 ThreadListInitializer::~ThreadListInitializer()
 {
     if (0 == --threadListCounter) {
+        pthread_key_delete(currentGenerationKey);
+        pthread_key_delete(currentThreadKey);
         delete Thread::threadList;
         delete Thread::threadListLock;
     }
@@ -79,17 +125,9 @@ QStatus Sleep(uint32_t ms) {
 
 Thread* Thread::GetThread()
 {
-    Thread* ret = NULL;
+    Thread* ret = GetCurrentThread();
 
-    /* Find thread on Thread::threadList */
-    threadListLock->Lock();
-    map<ThreadHandle, Thread*>::const_iterator iter = threadList->find(pthread_self());
-    if (iter != threadList->end()) {
-        ret = iter->second;
-    }
-    threadListLock->Unlock();
-
-    /* If the current thread isn't on the list, then create an external (wrapper) thread */
+    /* If the current thread isn't known, then create an external (wrapper) thread */
     if (NULL == ret) {
         ret = new Thread("external", NULL, true);
     }
@@ -99,17 +137,9 @@ Thread* Thread::GetThread()
 
 const char* Thread::GetThreadName()
 {
-    Thread* thread = NULL;
-
-    /* Find thread on Thread::threadList */
-    threadListLock->Lock();
-    map<ThreadHandle, Thread*>::const_iterator iter = threadList->find(pthread_self());
-    if (iter != threadList->end()) {
-        thread = iter->second;
-    }
-    threadListLock->Unlock();
+    Thread* thread = GetCurrentThread();
 
-    /* If the current thread isn't on the list, then don't create an external (wrapper) thread */
+    /* If the current thread isn't known, then don't create an external (wrapper) thread */
     if (thread == NULL) {
         return "external";
     }
@@ -120,6 +150,8 @@ const char* Thread::GetThreadName()
 void Thread::CleanExternalThreads()
 {
     threadListLock->Lock();
+    /* Invalidate the cached wrappers of all threads, including the calling thread */
+    IncrementAndFetch(&externalGeneration);
     map<ThreadHandle, Thread*>::iterator it = threadList->begin();
     while (it != threadList->end()) {
         if (it->second->isExternal) {
@@ -159,6 +191,7 @@ Thread::Thread(qcc::String name, Thread::ThreadFunction func, bool isExternal) :
         assert(func == NULL);
         threadListLock->Lock();
         (*threadList)[handle] = this;
+        SetCurrentThread(this, externalGeneration);
         threadListLock->Unlock();
     }
     QCC_DbgHLPrintf(("Thread::Thread() created %s - %x -- started:%d running:%d joined:%d", funcName, handle, started, running, joined));
@@ -174,6 +207,11 @@ Thread::~Thread(void)
         Join();
     }
 
+    /* Don't leave a dangling cached pointer behind if an external thread deletes its own wrapper */
+    if (pthread_getspecific(currentThreadKey) == this) {
+        SetCurrentThread(NULL, 0);
+    }
+
     /* Keep object alive until waitCount goes to zero */
     while (waitCount) {
         qcc::Sleep(2);
@@ -183,6 +221,101 @@ Thread::~Thread(void)
 }
 
 
+#if defined(QCC_OS_LINUX) || defined(QCC_OS_ANDROID)
+/*
+ * Add the CPUs of a NUMA node, as listed in sysfs (e.g. "0-3,8-11"), to a CPU set.
+ */
+static bool AddNumaNodeCpus(int32_t node, cpu_set_t& set)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        return false;
+    }
+    char list[256];
+    bool found = false;
+    if (fgets(list, sizeof(list), f)) {
+        char* p = list;
+        while (*p >= '0' && *p <= '9') {
+            unsigned long first = strtoul(p, &p, 10);
+            unsigned long last = first;
+            if (*p == '-') {
+                last = strtoul(p + 1, &p, 10);
+            }
+            for (unsigned long cpu = first; (cpu <= last) && (cpu < CPU_SETSIZE); ++cpu) {
+                CPU_SET(cpu, &set);
+                found = true;
+            }
+            if (*p == ',') {
+                ++p;
+            }
+        }
+    }
+    fclose(f);
+    return found;
+}
+#endif
+
+/*
+ * Apply the attributes that have to be set from the new thread itself.
+ */
+static void ApplyAttributes(const char* name, const ThreadAttributes& attributes)
+{
+    /* The kernel limits thread names to 15 characters */
+    char shortName[16];
+    strncpy(shortName, name, sizeof(shortName));
+    shortName[sizeof(shortName) - 1] = '\0';
+#if defined(QCC_OS_ANDROID)
+    prctl(PR_SET_NAME, shortName, 0, 0, 0);
+#elif defined(QCC_OS_LINUX)
+    pthread_setname_np(pthread_self(), shortName);
+#elif defined(QCC_OS_DARWIN)
+    pthread_setname_np(shortName);
+#endif
+
+    if (attributes.IsDefault()) {
+        return;
+    }
+
+#if defined(QCC_OS_LINUX) || defined(QCC_OS_ANDROID)
+    /*
+     * Pinning a thread to the CPUs of a NUMA node also keeps the memory it
+     * touches first on that node.
+     */
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    bool pin = false;
+    if (!attributes.cpus.empty()) {
+        for (size_t i = 0; i < attributes.cpus.size(); ++i) {
+            if (attributes.cpus[i] < CPU_SETSIZE) {
+                CPU_SET(attributes.cpus[i], &set);
+                pin = true;
+            }
+        }
+    } else if (attributes.numaNode >= 0) {
+        pin = AddNumaNodeCpus(attributes.numaNode, set);
+        if (!pin) {
+            QCC_LogError(ER_OS_ERROR, ("Thread %s: NUMA node %d not found", name, attributes.numaNode));
+        }
+    }
+    if (pin && (sched_setaffinity(0, sizeof(set), &set) != 0)) {
+        QCC_LogError(ER_OS_ERROR, ("Thread %s: setting CPU affinity: %s", name, strerror(errno)));
+    }
+#endif
+
+    if (attributes.policy != ThreadAttributes::SCHEDULE_DEFAULT) {
+        struct sched_param param;
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = attributes.priority;
+        int policy = (attributes.policy == ThreadAttributes::SCHEDULE_FIFO) ? SCHED_FIFO : SCHED_RR;
+        int ret = pthread_setschedparam(pthread_self(), policy, &param);
+        if (ret != 0) {
+            QCC_LogError(ER_OS_ERROR, ("Thread %s: setting scheduling policy: %s", name, strerror(ret)));
+        }
+    }
+}
+
 ThreadInternalReturn Thread::RunInternal(void* threadArg)
 {
     Thread* thread(reinterpret_cast<Thread*>(threadArg));
@@ -207,10 +340,13 @@ ThreadInternalReturn Thread::RunInternal(void* threadArg)
     /* Add this Thread to list of running threads */
     threadListLock->Lock();
     (*threadList)[thread->handle] = thread;
+    SetCurrentThread(thread, 0);
     thread->state = RUNNING;
     pthread_sigmask(SIG_UNBLOCK, &newmask, NULL);
     threadListLock->Unlock();
 
+    ApplyAttributes(thread->funcName, thread->attributes);
+
     /* Start the thread if it hasn't been stopped */
     if (!thread->isStopping) {
         QCC_DbgPrintf(("Starting thread: %s", thread->funcName));
@@ -251,6 +387,7 @@ ThreadInternalReturn Thread::RunInternal(void* threadArg)
     threadListLock->Lock();
     threadList->erase(handle);
     threadListLock->Unlock();
+    SetCurrentThread(NULL, 0);
 
     return reinterpret_cast<ThreadInternalReturn>(retVal);
 }
@@ -292,7 +429,7 @@ QStatus Thread::Start(void* arg, ThreadListener* listener)
             status = ER_OS_ERROR;
             QCC_LogError(status, ("Initializing thread attr: %s", strerror(ret)));
         }
-        ret = pthread_attr_setstacksize(&attr, stacksize);
+        ret = pthread_attr_setstacksize(&attr, attributes.stackSize ? attributes.stackSize : stacksize);
         if (ret != 0) {
             status = ER_OS_ERROR;
             QCC_LogError(status, ("Setting stack size: %s", strerror(ret)));
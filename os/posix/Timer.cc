@@ -56,7 +56,9 @@ class TimerThread : public Thread {
         index(index),
         timer(timer),
         currentAlarm(NULL)
-    { }
+    {
+        SetAttributes(timer->threadAttributes);
+    }
 
     virtual ~TimerThread() { }
 
@@ -130,7 +132,8 @@ bool _Alarm::operator==(const _Alarm& other) const
     return (alarmTime == other.alarmTime) && (id == other.id);
 }
 
-Timer::Timer(const char* name, bool expireOnExit, uint32_t concurency, bool preventReentrancy, uint32_t maxAlarms) :
+Timer::Timer(const char* name, bool expireOnExit, uint32_t concurency, bool preventReentrancy, uint32_t maxAlarms,
+             const ThreadAttributes& attributes) :
     OSTimer(this),
     currentAlarm(NULL),
     expireOnExit(expireOnExit),
@@ -139,7 +142,8 @@ Timer::Timer(const char* name, bool expireOnExit, uint32_t concurency, bool prev
     controllerIdx(0),
     preventReentrancy(preventReentrancy),
     nameStr(name),
-    maxAlarms(maxAlarms)
+    maxAlarms(maxAlarms),
+    threadAttributes(attributes)
 {
     /* Timer thread objects will be created when required */
 }
@@ -159,7 +163,7 @@ Timer::~Timer()
 QStatus Timer::Start()
 {
     QStatus status = ER_OK;
-    lock.Lock();
+    lock.Lock(MUTEX_CONTEXT);
     if (!isRunning) {
         controllerIdx = 0;
         isRunning = true;
@@ -175,31 +179,31 @@ QStatus Timer::Start()
                     status = ER_FAIL;
                     break;
                 } else {
-                    lock.Unlock();
+                    lock.Unlock(MUTEX_CONTEXT);
                     Sleep(2);
-                    lock.Lock();
+                    lock.Lock(MUTEX_CONTEXT);
                 }
             }
         }
         isRunning = (status == ER_OK);
     }
-    lock.Unlock();
+    lock.Unlock(MUTEX_CONTEXT);
     return status;
 }
 
 QStatus Timer::Stop()
 {
     QStatus status = ER_OK;
-    lock.Lock();
+    lock.Lock(MUTEX_CONTEXT);
     isRunning = false;
-    lock.Unlock();
+    lock.Unlock(MUTEX_CONTEXT);
     for (size_t i = 0; i < timerThreads.size(); ++i) {
-        lock.Lock();
+        lock.Lock(MUTEX_CONTEXT);
         if (timerThreads[i] != NULL) {
             QStatus tStatus = timerThreads[i]->Stop();
             status = (status == ER_OK) ? tStatus : status;
         }
-        lock.Unlock();
+        lock.Unlock(MUTEX_CONTEXT);
 
     }
     return status;
@@ -208,31 +212,31 @@ QStatus Timer::Stop()
 QStatus Timer::Join()
 {
     QStatus status = ER_OK;
-    lock.Lock();
+    lock.Lock(MUTEX_CONTEXT);
     for (size_t i = 0; i < timerThreads.size(); ++i) {
         if (timerThreads[i] != NULL) {
-            lock.Unlock();
+            lock.Unlock(MUTEX_CONTEXT);
             QStatus tStatus = timerThreads[i]->Join();
-            lock.Lock();
+            lock.Lock(MUTEX_CONTEXT);
             status = (status == ER_OK) ? tStatus : status;
         }
 
 
     }
-    lock.Unlock();
+    lock.Unlock(MUTEX_CONTEXT);
     return status;
 }
 
 QStatus Timer::AddAlarm(const Alarm& alarm)
 {
     QStatus status = ER_OK;
-    lock.Lock();
+    lock.Lock(MUTEX_CONTEXT);
     if (isRunning) {
         /* Don't allow an infinite number of alarms to exist on this timer */
         while (maxAlarms && (alarms.size() >= maxAlarms) && isRunning) {
-            lock.Unlock();
+            lock.Unlock(MUTEX_CONTEXT);
             qcc::Sleep(2);
-            lock.Lock();
+            lock.Lock(MUTEX_CONTEXT);
         }
         /* Ensure timer is still running */
         if (isRunning) {
@@ -254,18 +258,18 @@ QStatus Timer::AddAlarm(const Alarm& alarm)
         status = ER_TIMER_EXITING;
     }
 
-    lock.Unlock();
+    lock.Unlock(MUTEX_CONTEXT);
     return status;
 }
 
 QStatus Timer::AddAlarmNonBlocking(const Alarm& alarm)
 {
     QStatus status = ER_OK;
-    lock.Lock();
+    lock.Lock(MUTEX_CONTEXT);
     if (isRunning) {
         /* Don't allow an infinite number of alarms to exist on this timer */
         if (maxAlarms && (alarms.size() >= maxAlarms)) {
-            lock.Unlock();
+            lock.Unlock(MUTEX_CONTEXT);
             return ER_TIMER_FULL;
         }
 
@@ -283,14 +287,14 @@ QStatus Timer::AddAlarmNonBlocking(const Alarm& alarm)
         status = ER_TIMER_EXITING;
     }
 
-    lock.Unlock();
+    lock.Unlock(MUTEX_CONTEXT);
     return status;
 }
 
 bool Timer::RemoveAlarm(const Alarm& alarm, bool blockIfTriggered)
 {
     bool foundAlarm = false;
-    lock.Lock();
+    lock.Lock(MUTEX_CONTEXT);
     if (isRunning || expireOnExit) {
         if (alarm->periodMs) {
             set<Alarm>::iterator it = alarms.begin();
@@ -320,9 +324,9 @@ bool Timer::RemoveAlarm(const Alarm& alarm, bool blockIfTriggered)
                 }
                 const Alarm* curAlarm = timerThreads[i]->GetCurrentAlarm();
                 while (isRunning && curAlarm && (*curAlarm == alarm)) {
-                    lock.Unlock();
+                    lock.Unlock(MUTEX_CONTEXT);
                     qcc::Sleep(2);
-                    lock.Lock();
+                    lock.Lock(MUTEX_CONTEXT);
                     if (timerThreads[i] == NULL) {
                         break;
                     }
@@ -331,14 +335,14 @@ bool Timer::RemoveAlarm(const Alarm& alarm, bool blockIfTriggered)
             }
         }
     }
-    lock.Unlock();
+    lock.Unlock(MUTEX_CONTEXT);
     return foundAlarm;
 }
 
 QStatus Timer::ReplaceAlarm(const Alarm& origAlarm, const Alarm& newAlarm, bool blockIfTriggered)
 {
     QStatus status = ER_NO_SUCH_ALARM;
-    lock.Lock();
+    lock.Lock(MUTEX_CONTEXT);
     if (isRunning) {
         set<Alarm>::iterator it = alarms.find(origAlarm);
         if (it != alarms.end()) {
@@ -355,9 +359,9 @@ QStatus Timer::ReplaceAlarm(const Alarm& origAlarm, const Alarm& newAlarm, bool
                 }
                 const Alarm* curAlarm = timerThreads[i]->GetCurrentAlarm();
                 while (isRunning && curAlarm && (*curAlarm == origAlarm)) {
-                    lock.Unlock();
+                    lock.Unlock(MUTEX_CONTEXT);
                     qcc::Sleep(2);
-                    lock.Lock();
+                    lock.Lock(MUTEX_CONTEXT);
                     if (timerThreads[i] == NULL) {
                         break;
                     }
@@ -366,14 +370,14 @@ QStatus Timer::ReplaceAlarm(const Alarm& origAlarm, const Alarm& newAlarm, bool
             }
         }
     }
-    lock.Unlock();
+    lock.Unlock(MUTEX_CONTEXT);
     return status;
 }
 
 bool Timer::RemoveAlarm(const AlarmListener& listener, Alarm& alarm)
 {
     bool removedOne = false;
-    lock.Lock();
+    lock.Lock(MUTEX_CONTEXT);
     if (isRunning) {
         for (set<Alarm>::iterator it = alarms.begin(); it != alarms.end(); ++it) {
             if ((*it)->listener == &listener) {
@@ -394,9 +398,9 @@ bool Timer::RemoveAlarm(const AlarmListener& listener, Alarm& alarm)
                 }
                 const Alarm* curAlarm = timerThreads[i]->GetCurrentAlarm();
                 while (isRunning && curAlarm && ((*curAlarm)->listener == &listener)) {
-                    lock.Unlock();
+                    lock.Unlock(MUTEX_CONTEXT);
                     qcc::Sleep(5);
-                    lock.Lock();
+                    lock.Lock(MUTEX_CONTEXT);
                     if (timerThreads[i] == NULL) {
                         break;
                     }
@@ -405,7 +409,7 @@ bool Timer::RemoveAlarm(const AlarmListener& listener, Alarm& alarm)
             }
         }
     }
-    lock.Unlock();
+    lock.Unlock(MUTEX_CONTEXT);
     return removedOne;
 }
 
@@ -419,23 +423,23 @@ void Timer::RemoveAlarmsWithListener(const AlarmListener& listener)
 bool Timer::HasAlarm(const Alarm& alarm)
 {
     bool ret = false;
-    lock.Lock();
+    lock.Lock(MUTEX_CONTEXT);
     if (isRunning) {
         ret = alarms.count(alarm) != 0;
     }
-    lock.Unlock();
+    lock.Unlock(MUTEX_CONTEXT);
     return ret;
 }
 
 QStatus TimerThread::Start(void* arg, ThreadListener* listener)
 {
     QStatus status = ER_OK;
-    timer->lock.Lock();
+    timer->lock.Lock(MUTEX_CONTEXT);
     if (timer->isRunning) {
         state = TimerThread::STARTING;
         status = Thread::Start(arg, listener);
     }
-    timer->lock.Unlock();
+    timer->lock.Unlock(MUTEX_CONTEXT);
     return status;
 }
 
@@ -454,7 +458,7 @@ ThreadReturn STDCALL TimerThread::Run(void* arg)
     /*
      * Enter the main loop with the timer lock held.
      */
-    timer->lock.Lock();
+    timer->lock.Lock(MUTEX_CONTEXT);
 
     while (!IsStopping()) {
         QCC_DbgPrintf(("TimerThread::Run(): Looping."));
@@ -511,9 +515,9 @@ ThreadReturn STDCALL TimerThread::Run(void* arg)
                         if (i != static_cast<size_t>(index) && timer->timerThreads[i] != NULL) {
 
                             while ((timer->timerThreads[i]->state != TimerThread::STOPPED || timer->timerThreads[i]->IsRunning()) && timer->isRunning && status == ER_TIMEOUT && delay > WORKER_IDLE_TIMEOUT_MS) {
-                                timer->lock.Unlock();
+                                timer->lock.Unlock(MUTEX_CONTEXT);
                                 status = Event::Wait(Event::neverSet, WORKER_IDLE_TIMEOUT_MS);
-                                timer->lock.Lock();
+                                timer->lock.Lock(MUTEX_CONTEXT);
                                 GetTimeNow(&now);
                                 delay = topAlarm->alarmTime - now;
                             }
@@ -531,10 +535,10 @@ ThreadReturn STDCALL TimerThread::Run(void* arg)
 
                 }
                 if (status == ER_TIMEOUT) {
-                    timer->lock.Unlock();
+                    timer->lock.Unlock(MUTEX_CONTEXT);
                     Event evt(static_cast<uint32_t>(delay), 0);
                     Event::Wait(evt);
-                    timer->lock.Lock();
+                    timer->lock.Lock(MUTEX_CONTEXT);
                 }
                 stopEvent.ResetEvent();
             } else if (isController || (delay <= 0)) {
@@ -621,9 +625,9 @@ ThreadReturn STDCALL TimerThread::Run(void* arg)
                              */
                             break;
                         }
-                        timer->lock.Unlock();
+                        timer->lock.Unlock(MUTEX_CONTEXT);
                         Sleep(2);
-                        timer->lock.Lock();
+                        timer->lock.Lock(MUTEX_CONTEXT);
                     }
 
 
@@ -677,12 +681,12 @@ ThreadReturn STDCALL TimerThread::Run(void* arg)
 
                 state = RUNNING;
                 stopEvent.ResetEvent();
-                timer->lock.Unlock();
+                timer->lock.Unlock(MUTEX_CONTEXT);
 
                 /* Get the reentrancy lock if necessary */
                 hasTimerLock = timer->preventReentrancy;
                 if (hasTimerLock) {
-                    timer->reentrancyLock.Lock();
+                    timer->reentrancyLock.Lock(MUTEX_CONTEXT);
                 }
 
                 /*
@@ -691,7 +695,7 @@ ThreadReturn STDCALL TimerThread::Run(void* arg)
                  * either case, we are going to handle the alarm at the head of
                  * the list.
                  */
-                timer->lock.Lock();
+                timer->lock.Lock(MUTEX_CONTEXT);
                 /* Make sure the alarm has not been serviced yet.
                  * If it has already been serviced by another thread, just ignore
                  * and go back to the top of the loop.
@@ -701,14 +705,14 @@ ThreadReturn STDCALL TimerThread::Run(void* arg)
                     Alarm top = *it;
                     timer->alarms.erase(it);
                     currentAlarm = &top;
-                    timer->lock.Unlock();
+                    timer->lock.Unlock(MUTEX_CONTEXT);
 
                     QCC_DbgPrintf(("TimerThread::Run(): ******** AlarmTriggered()"));
                     (top->listener->AlarmTriggered)(top, ER_OK);
                     if (hasTimerLock) {
-                        timer->reentrancyLock.Unlock();
+                        timer->reentrancyLock.Unlock(MUTEX_CONTEXT);
                     }
-                    timer->lock.Lock();
+                    timer->lock.Lock(MUTEX_CONTEXT);
                     currentAlarm = NULL;
 
                     if (0 != top->periodMs) {
@@ -721,7 +725,7 @@ ThreadReturn STDCALL TimerThread::Run(void* arg)
                     }
                 } else {
                     if (hasTimerLock) {
-                        timer->reentrancyLock.Unlock();
+                        timer->reentrancyLock.Unlock(MUTEX_CONTEXT);
                     }
                 }
             } else {
@@ -732,9 +736,9 @@ ThreadReturn STDCALL TimerThread::Run(void* arg)
                  */
                 state = IDLE;
                 QCC_DbgPrintf(("TimerThread::Run(): Worker with nothing to do"));
-                timer->lock.Unlock();
+                timer->lock.Unlock(MUTEX_CONTEXT);
                 QStatus status = Event::Wait(Event::neverSet, WORKER_IDLE_TIMEOUT_MS);
-                timer->lock.Lock();
+                timer->lock.Lock(MUTEX_CONTEXT);
                 if (status == ER_TIMEOUT && timer->controllerIdx != -1) {
                     QCC_DbgPrintf(("TimerThread::Run(): Worker with nothing to do stopping"));
                     state = STOPPING;
@@ -763,9 +767,9 @@ ThreadReturn STDCALL TimerThread::Run(void* arg)
                     if (i != static_cast<size_t>(index) && timer->timerThreads[i] != NULL) {
 
                         while ((timer->timerThreads[i]->state != TimerThread::STOPPED || timer->timerThreads[i]->IsRunning()) && timer->isRunning && status == ER_TIMEOUT) {
-                            timer->lock.Unlock();
+                            timer->lock.Unlock(MUTEX_CONTEXT);
                             status = Event::Wait(Event::neverSet, WORKER_IDLE_TIMEOUT_MS);
-                            timer->lock.Lock();
+                            timer->lock.Lock(MUTEX_CONTEXT);
                         }
                         if (status == ER_ALERTED_THREAD || status == ER_STOPPING_THREAD || !timer->isRunning) {
                             break;
@@ -784,17 +788,17 @@ ThreadReturn STDCALL TimerThread::Run(void* arg)
                     /* The controller has successfully deleted objects of all other worker threads.
                      * and has not been alerted/stopped.
                      */
-                    timer->lock.Unlock();
+                    timer->lock.Unlock(MUTEX_CONTEXT);
                     Event::Wait(Event::neverSet);
-                    timer->lock.Lock();
+                    timer->lock.Lock(MUTEX_CONTEXT);
                 }
                 stopEvent.ResetEvent();
             } else {
                 QCC_DbgPrintf(("TimerThread::Run(): non-Controller idling"));
                 state = IDLE;
-                timer->lock.Unlock();
+                timer->lock.Unlock(MUTEX_CONTEXT);
                 QStatus status = Event::Wait(Event::neverSet, WORKER_IDLE_TIMEOUT_MS);
-                timer->lock.Lock();
+                timer->lock.Lock(MUTEX_CONTEXT);
                 if (status == ER_TIMEOUT && timer->controllerIdx != -1) {
                     QCC_DbgPrintf(("TimerThread::Run(): non-Controller stopping"));
                     state = STOPPING;
@@ -809,14 +813,14 @@ ThreadReturn STDCALL TimerThread::Run(void* arg)
      * We entered the main loop with the lock taken, so we need to give it here.
      */
     state = STOPPING;
-    timer->lock.Unlock();
+    timer->lock.Unlock(MUTEX_CONTEXT);
     return (ThreadReturn) 0;
 }
 
 void Timer::ThreadExit(Thread* thread)
 {
     TimerThread* tt = static_cast<TimerThread*>(thread);
-    lock.Lock();
+    lock.Lock(MUTEX_CONTEXT);
     if ((!isRunning) && expireOnExit) {
         /* Call all alarms */
         while (!alarms.empty()) {
@@ -827,21 +831,21 @@ void Timer::ThreadExit(Thread* thread)
             Alarm alarm = *it;
             alarms.erase(it);
             tt->SetCurrentAlarm(&alarm);
-            lock.Unlock();
+            lock.Unlock(MUTEX_CONTEXT);
             tt->hasTimerLock = preventReentrancy;
             if (tt->hasTimerLock) {
-                reentrancyLock.Lock();
+                reentrancyLock.Lock(MUTEX_CONTEXT);
             }
             alarm->listener->AlarmTriggered(alarm, ER_TIMER_EXITING);
             if (tt->hasTimerLock) {
-                reentrancyLock.Unlock();
+                reentrancyLock.Unlock(MUTEX_CONTEXT);
             }
-            lock.Lock();
+            lock.Lock(MUTEX_CONTEXT);
             tt->SetCurrentAlarm(NULL);
         }
     }
     tt->state = TimerThread::STOPPED;
-    lock.Unlock();
+    lock.Unlock(MUTEX_CONTEXT);
     tt->Join();
 }
 
@@ -852,7 +856,7 @@ void Timer::EnableReentrancy()
         TimerThread* tt = static_cast<TimerThread*>(thread);
         if (tt->hasTimerLock) {
             tt->hasTimerLock = false;
-            reentrancyLock.Unlock();
+            reentrancyLock.Unlock(MUTEX_CONTEXT);
         }
     } else {
         QCC_DbgPrintf(("Invalid call to Timer::EnableReentrancy from thread %s; only allowed from %s", Thread::GetThreadName(), nameStr.c_str()));
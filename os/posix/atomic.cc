@@ -46,6 +46,29 @@ int32_t DecrementAndFetch(volatile int32_t* mem)
     return ret;
 }
 
+bool CompareAndExchange(volatile int32_t* mem, int32_t expectedValue, int32_t newValue)
+{
+    bool ret = false;
+
+    pthread_mutex_lock(&atomicLock);
+    if (*mem == expectedValue) {
+        *mem = newValue;
+        ret = true;
+    }
+    pthread_mutex_unlock(&atomicLock);
+    return ret;
+}
+
+void AtomicLockAcquire()
+{
+    pthread_mutex_lock(&atomicLock);
+}
+
+void AtomicLockRelease()
+{
+    pthread_mutex_unlock(&atomicLock);
+}
+
 }
 
 #endif
@@ -0,0 +1,78 @@
+/**
+ * @file
+ *
+ * Futex wait and wake for Windows
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <windows.h>
+
+#include <qcc/Futex.h>
+
+#include <Status.h>
+
+/** @internal */
+#define QCC_MODULE "FUTEX"
+
+/*
+ * Addresses are hashed onto a fixed set of condition variables.  Unrelated
+ * addresses may share a bucket so Wake() has to wake everybody in it.  Zero
+ * is the static initializer for both SRWLOCK and CONDITION_VARIABLE.
+ */
+#define NUM_BUCKETS 64
+
+struct FutexBucket {
+    SRWLOCK lock;
+    CONDITION_VARIABLE cond;
+};
+
+static FutexBucket buckets[NUM_BUCKETS];
+
+static FutexBucket* GetBucket(volatile int32_t* addr)
+{
+    return &buckets[(reinterpret_cast<uintptr_t>(addr) >> 2) % NUM_BUCKETS];
+}
+
+namespace qcc {
+
+QStatus Futex::Wait(volatile int32_t* addr, int32_t expected, uint32_t maxMs)
+{
+    FutexBucket* bucket = GetBucket(addr);
+    QStatus status = ER_OK;
+
+    AcquireSRWLockExclusive(&bucket->lock);
+    if (*addr == expected) {
+        DWORD timeout = (maxMs == Event::WAIT_FOREVER) ? INFINITE : maxMs;
+        if (!SleepConditionVariableSRW(&bucket->cond, &bucket->lock, timeout, 0) && (GetLastError() == ERROR_TIMEOUT)) {
+            status = ER_TIMEOUT;
+        }
+    }
+    ReleaseSRWLockExclusive(&bucket->lock);
+    return status;
+}
+
+void Futex::Wake(volatile int32_t* addr, uint32_t count)
+{
+    FutexBucket* bucket = GetBucket(addr);
+    AcquireSRWLockExclusive(&bucket->lock);
+    WakeAllConditionVariable(&bucket->cond);
+    ReleaseSRWLockExclusive(&bucket->lock);
+}
+
+}
@@ -26,6 +26,7 @@
 #include <Winsock2.h>
 #include <Mswsock.h>
 #include <ws2tcpip.h>
+#include <mstcpip.h>
 
 #include <qcc/IPAddress.h>
 #include <qcc/Socket.h>
@@ -329,6 +330,28 @@ QStatus Accept(SocketFd sockfd, SocketFd& newSockfd)
 }
 
 
+QStatus AcceptMany(SocketFd sockfd, size_t maxCount, AcceptedSocket* results, size_t& accepted)
+{
+    QStatus status = ER_OK;
+
+    QCC_DbgTrace(("AcceptMany(sockfd = %d, maxCount = %lu, results = <>, accepted = <>)", sockfd, static_cast<unsigned long>(maxCount)));
+
+    accepted = 0;
+    while (accepted < maxCount) {
+        AcceptedSocket& result = results[accepted];
+        status = Accept(sockfd, result.addr, result.port, result.sockfd);
+        if (status != ER_OK) {
+            break;
+        }
+        ++accepted;
+    }
+    if (accepted) {
+        status = ER_OK;
+    }
+    return status;
+}
+
+
 QStatus Shutdown(SocketFd sockfd)
 {
     QStatus status = ER_OK;
@@ -353,6 +376,18 @@ QStatus Shutdown(SocketFd sockfd)
     return status;
 }
 
+QStatus ShutdownSend(SocketFd sockfd)
+{
+    QStatus status = ER_OK;
+
+    QCC_DbgHLPrintf(("ShutdownSend(sockfd = %d)", sockfd));
+
+    if (shutdown(static_cast<SOCKET>(sockfd), SD_SEND) == SOCKET_ERROR) {
+        status = ER_OS_ERROR;
+    }
+    return status;
+}
+
 
 void Close(SocketFd sockfd)
 {
@@ -549,6 +584,55 @@ QStatus RecvFrom(SocketFd sockfd, IPAddress& remoteAddr, uint16_t& remotePort,
 }
 
 
+/*
+ * Windows has no equivalent of sendmmsg() and recvmmsg(), so the batch
+ * functions move one datagram per system call.
+ */
+QStatus SendToBatch(SocketFd sockfd, Datagram* datagrams, size_t count, size_t& sent)
+{
+    QCC_DbgTrace(("SendToBatch(sockfd = %d, datagrams = <>, count = %lu, sent = <>)", sockfd, count));
+
+    for (sent = 0; sent < count; ++sent) {
+        Datagram& datagram = datagrams[sent];
+        const uint8_t* buf = static_cast<const uint8_t*>(datagram.buf);
+        size_t segmentSize = datagram.segmentSize ? datagram.segmentSize : datagram.len;
+        size_t offset = 0;
+        do {
+            size_t segmentSent;
+            QStatus status = SendTo(sockfd, datagram.addr, datagram.port, buf + offset, (std::min)(segmentSize, datagram.len - offset), segmentSent);
+            if (status != ER_OK) {
+                return sent ? ER_OK : status;
+            }
+            offset += segmentSent;
+        } while (offset < datagram.len);
+    }
+    return ER_OK;
+}
+
+QStatus RecvFromBatch(SocketFd sockfd, Datagram* datagrams, size_t count, size_t& received)
+{
+    QCC_DbgTrace(("RecvFromBatch(sockfd = %d, datagrams = <>, count = %lu, received = <>)", sockfd, count));
+
+    /* Without a per-call non-blocking flag only one datagram can be received without risking a wait */
+    received = 0;
+    if (count == 0) {
+        return ER_OK;
+    }
+    Datagram& datagram = datagrams[0];
+    datagram.segmentSize = 0;
+    QStatus status = RecvFrom(sockfd, datagram.addr, datagram.port, datagram.buf, datagram.size, datagram.len);
+    if (status == ER_OK) {
+        received = 1;
+    }
+    return status;
+}
+
+QStatus SetUdpGro(SocketFd sockfd, bool gro)
+{
+    return ER_NOT_IMPLEMENTED;
+}
+
+
 int InetPtoN(int af, const char* src, void* dst)
 {
     WinsockCheck();
@@ -822,6 +906,27 @@ socketPairCleanup:
     return status;
 }
 
+QStatus SetZeroCopy(SocketFd sockfd, bool enable)
+{
+    return ER_NOT_IMPLEMENTED;
+}
+
+QStatus SendZeroCopy(SocketFd sockfd, const void* buf, size_t len, size_t& sent, bool& zeroCopied)
+{
+    zeroCopied = false;
+    return Send(sockfd, buf, len, sent);
+}
+
+QStatus GetZeroCopyCompletion(SocketFd sockfd, uint32_t& first, uint32_t& last, bool& copied)
+{
+    return ER_NOT_IMPLEMENTED;
+}
+
+QStatus WaitForZeroCopyCompletion(SocketFd sockfd, uint32_t timeout)
+{
+    return ER_NOT_IMPLEMENTED;
+}
+
 QStatus SetBlocking(SocketFd sockfd, bool blocking)
 {
     QStatus status = ER_OK;
@@ -847,6 +952,53 @@ QStatus SetNagle(SocketFd sockfd, bool useNagle)
     return status;
 }
 
+/*
+ * Set one integer socket option, logging any failure.
+ */
+static QStatus SetIntOption(SocketFd sockfd, int level, int option, const char* name, int value)
+{
+    if (setsockopt(static_cast<SOCKET>(sockfd), level, option, (const char*)&value, sizeof(value)) != 0) {
+        QCC_LogError(ER_OS_ERROR, ("Setting %s to %d failed: %s", name, value, StrError().c_str()));
+        return ER_OS_ERROR;
+    }
+    return ER_OK;
+}
+
+QStatus SetSocketOptions(SocketFd sockfd, const SocketOptions& options)
+{
+    QStatus status = ER_OK;
+
+    QCC_DbgTrace(("SetSocketOptions(sockfd = %d, options = <>)", sockfd));
+
+    if (options.sendBufferSize && (SetIntOption(sockfd, SOL_SOCKET, SO_SNDBUF, "SO_SNDBUF", options.sendBufferSize) != ER_OK)) {
+        status = ER_OS_ERROR;
+    }
+    if (options.receiveBufferSize && (SetIntOption(sockfd, SOL_SOCKET, SO_RCVBUF, "SO_RCVBUF", options.receiveBufferSize) != ER_OK)) {
+        status = ER_OS_ERROR;
+    }
+    if (options.noDelay && (SetIntOption(sockfd, IPPROTO_TCP, TCP_NODELAY, "TCP_NODELAY", 1) != ER_OK)) {
+        status = ER_OS_ERROR;
+    }
+    if (options.keepAliveIdle) {
+        /* Windows sets the idle time and interval together; the probe count is fixed */
+        struct tcp_keepalive keepAlive;
+        DWORD bytes;
+        keepAlive.onoff = 1;
+        keepAlive.keepalivetime = options.keepAliveIdle * 1000;
+        keepAlive.keepaliveinterval = (options.keepAliveInterval ? options.keepAliveInterval : 1) * 1000;
+        if (WSAIoctl(static_cast<SOCKET>(sockfd), SIO_KEEPALIVE_VALS, &keepAlive, sizeof(keepAlive), NULL, 0, &bytes, NULL, NULL) != 0) {
+            status = ER_OS_ERROR;
+            QCC_LogError(status, ("Setting SIO_KEEPALIVE_VALS failed: %s", StrError().c_str()));
+        }
+    }
+    return status;
+}
+
+QStatus SetCork(SocketFd sockfd, bool cork)
+{
+    return ER_NOT_IMPLEMENTED;
+}
+
 QStatus SetReuseAddress(SocketFd sockfd, bool reuse)
 {
     QStatus status = ER_OK;
@@ -877,6 +1029,11 @@ QStatus SetReusePort(SocketFd sockfd, bool reuse)
     return status;
 }
 
+QStatus SetReusePortCpuSteering(SocketFd sockfd, uint32_t numSockets)
+{
+    return ER_NOT_IMPLEMENTED;
+}
+
 void IfConfigByFamily(uint32_t family, std::vector<IfConfigEntry>& entries);
 
 /*
@@ -288,7 +288,7 @@ QStatus Thread::Start(void* arg, ThreadListener* listener)
         this->listener = listener;
 
         state = STARTED;
-        handle = reinterpret_cast<HANDLE>(_beginthreadex(NULL, stacksize, RunInternal, this, 0, &threadId));
+        handle = reinterpret_cast<HANDLE>(_beginthreadex(NULL, attributes.stackSize ? attributes.stackSize : stacksize, RunInternal, this, 0, &threadId));
         if (handle == 0) {
             state = DEAD;
             isStopping = false;
@@ -56,7 +56,9 @@ class TimerThread : public Thread {
         index(index),
         timer(timer),
         currentAlarm(NULL)
-    { }
+    {
+        SetAttributes(timer->threadAttributes);
+    }
 
     virtual ~TimerThread() { }
 
@@ -129,7 +131,8 @@ bool _Alarm::operator==(const _Alarm& other) const
     return (alarmTime == other.alarmTime) && (id == other.id);
 }
 
-Timer::Timer(const char* name, bool expireOnExit, uint32_t concurency, bool preventReentrancy, uint32_t maxAlarms) :
+Timer::Timer(const char* name, bool expireOnExit, uint32_t concurency, bool preventReentrancy, uint32_t maxAlarms,
+             const ThreadAttributes& attributes) :
     currentAlarm(NULL),
     expireOnExit(expireOnExit),
     timerThreads(concurency),
@@ -138,6 +141,7 @@ Timer::Timer(const char* name, bool expireOnExit, uint32_t concurency, bool prev
     preventReentrancy(preventReentrancy),
     nameStr(name),
     maxAlarms(maxAlarms),
+    threadAttributes(attributes),
     OSTimer(this)
 {
     /* Timer thread objects will be created when required */
@@ -110,9 +110,10 @@ void OSAlarm::UpdateComputedTime(Timespec absoluteTime)
     }
 }
 
-Timer::Timer(const char* name, bool expireOnExit, uint32_t concurency, bool preventReentrancy, uint32_t maxAlarms)
+Timer::Timer(const char* name, bool expireOnExit, uint32_t concurency, bool preventReentrancy, uint32_t maxAlarms,
+             const ThreadAttributes& attributes)
     : nameStr(name), expireOnExit(expireOnExit), timerThreads(concurency), isRunning(false), controllerIdx(0),
-    preventReentrancy(preventReentrancy), OSTimer(this), maxAlarms(maxAlarms)
+    preventReentrancy(preventReentrancy), OSTimer(this), maxAlarms(maxAlarms), threadAttributes(attributes)
 {
 }
 
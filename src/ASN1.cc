@@ -149,7 +149,7 @@ QStatus Crypto_ASN1::DecodeBase64(const qcc::String& b64in, qcc::String& bin)
     return status;
 }
 
-QStatus Crypto_ASN1::EncodeV(const char*& syntax, qcc::String& asn, va_list* argpIn)
+QStatus Crypto_ASN1::EncodeV(const char*& syntax, StringBuilder& asn, va_list* argpIn)
 {
     va_list& argp = *argpIn;
 
@@ -161,7 +161,7 @@ QStatus Crypto_ASN1::EncodeV(const char*& syntax, qcc::String& asn, va_list* arg
         switch (*syntax++) {
         case 'i':
         {
-            asn.push_back((char)ASN_INTEGER);
+            asn.append((char)ASN_INTEGER);
             uint32_t v = va_arg(argp, uint32_t);
             if (v) {
                 uint8_t n[5];
@@ -182,8 +182,8 @@ QStatus Crypto_ASN1::EncodeV(const char*& syntax, qcc::String& asn, va_list* arg
                 EncodeLen(asn, len);
                 asn.append((char*)(n + i), len);
             } else {
-                asn.push_back((char)1);
-                asn.push_back((char)0);
+                asn.append((char)1);
+                asn.append((char)0);
             }
         }
         break;
@@ -200,10 +200,10 @@ QStatus Crypto_ASN1::EncodeV(const char*& syntax, qcc::String& asn, va_list* arg
                     ++p;
                     --len;
                 }
-                asn.push_back((char)ASN_INTEGER);
+                asn.append((char)ASN_INTEGER);
                 if (*p & 0x80) {
                     EncodeLen(asn, len + 1);
-                    asn.push_back((char)0);
+                    asn.append((char)0);
                 } else {
                     EncodeLen(asn, len);
                 }
@@ -214,21 +214,20 @@ QStatus Crypto_ASN1::EncodeV(const char*& syntax, qcc::String& asn, va_list* arg
         case 'o':
         {
             val = va_arg(argp, qcc::String*);
-            asn.push_back((char)ASN_OID);
-            qcc::String oid;
-            status = EncodeOID(oid, *val);
+            asn.append((char)ASN_OID);
+            size_t start = asn.size();
+            status = EncodeOID(asn, *val);
             if (status == ER_OK) {
-                EncodeLen(asn, oid.size());
-                asn += oid;
+                InsertLen(asn, start);
             }
         }
         break;
 
         case 'x':
             val = va_arg(argp, qcc::String*);
-            asn.push_back((char)ASN_OCTETS);
+            asn.append((char)ASN_OCTETS);
             EncodeLen(asn, val->size());
-            asn += *val;
+            asn.append(*val);
             break;
 
         case 'b':
@@ -238,12 +237,12 @@ QStatus Crypto_ASN1::EncodeV(const char*& syntax, qcc::String& asn, va_list* arg
             if (bitLen <= (val->size() * 8)) {
                 size_t unusedBits = (8 - bitLen) & 7;
                 size_t len = (bitLen + 7) / 8;
-                asn.push_back((char)ASN_BITS);
+                asn.append((char)ASN_BITS);
                 EncodeLen(asn, len + 1);
-                asn.push_back((char)unusedBits);
+                asn.append((char)unusedBits);
                 asn.append((char*)val->data(), len - 1);
                 // In DER encoding unused bits must be zero
-                asn.push_back((char)(*val)[len - 1] & (0xFF >> unusedBits));
+                asn.append((char)((*val)[len - 1] & (0xFF >> unusedBits)));
             } else {
                 status = ER_FAIL;
             }
@@ -251,71 +250,71 @@ QStatus Crypto_ASN1::EncodeV(const char*& syntax, qcc::String& asn, va_list* arg
         break;
 
         case 'n':
-            asn.push_back((char)ASN_NULL);
-            asn.push_back((char)0);
+            asn.append((char)ASN_NULL);
+            asn.append((char)0);
             break;
 
         case '(':
         {
-            qcc::String seq;
-            status = EncodeV(syntax, seq, argpIn);
+            /* Encode the contents in place and put the length in front of them */
+            asn.append((char)(ASN_SEQ | 0x20));
+            size_t start = asn.size();
+            status = EncodeV(syntax, asn, argpIn);
             if (*syntax++ != ')') {
                 status = ER_FAIL;
             } else if (status == ER_OK) {
-                asn.push_back((char)ASN_SEQ | 0x20);
-                EncodeLen(asn, seq.size());
-                asn += seq;
+                InsertLen(asn, start);
             }
         }
         break;
 
         case '{':
         {
-            qcc::String set;
-            status = EncodeV(syntax, set, argpIn);
+            /* Encode the contents in place and put the length in front of them */
+            asn.append((char)(ASN_SET_OF | 0x20));
+            size_t start = asn.size();
+            status = EncodeV(syntax, asn, argpIn);
             if (*syntax++ != '}') {
                 status = ER_FAIL;
             } else if (status == ER_OK) {
-                asn.push_back((char)ASN_SET_OF | 0x20);
-                EncodeLen(asn, set.size());
-                asn += set;
+                InsertLen(asn, start);
             }
         }
         break;
 
         case 'a':
             val = va_arg(argp, qcc::String*);
-            asn.push_back((char)ASN_ASCII);
+            asn.append((char)ASN_ASCII);
             EncodeLen(asn, val->size());
-            asn += *val;
+            asn.append(*val);
             break;
 
         case 't':
             val = va_arg(argp, qcc::String*);
-            asn.push_back((char)ASN_UTC_TIME);
+            asn.append((char)ASN_UTC_TIME);
             EncodeLen(asn, val->size());
-            asn += *val;
+            asn.append(*val);
             break;
 
         case 'p':
             val = va_arg(argp, qcc::String*);
-            asn.push_back((char)ASN_PRINTABLE);
+            asn.append((char)ASN_PRINTABLE);
             EncodeLen(asn, val->size());
-            asn += *val;
+            asn.append(*val);
             break;
 
         case 'u':
             val = va_arg(argp, qcc::String*);
-            asn.push_back((char)ASN_UTF8);
+            asn.append((char)ASN_UTF8);
             EncodeLen(asn, val->size());
-            asn += *val;
+            asn.append(*val);
             break;
 
         // This is a raw string inserted into the ASN.1 output.
         // It will only decode correctly if the argument is pre-encoded.
         case 'R':
             val = va_arg(argp, qcc::String*);
-            asn += *val;
+            asn.append(*val);
             break;
 
         default:
@@ -559,10 +558,15 @@ bool Crypto_ASN1::DecodeLen(const uint8_t*& p, const uint8_t* eod, size_t& l)
     return (p + l) <= eod;
 }
 
-void Crypto_ASN1::EncodeLen(qcc::String& asn, size_t len)
+/*
+ * Write the encoding of a length to out and return the number of bytes written,
+ * at most 5.
+ */
+static size_t FormatLen(char* out, size_t len)
 {
     if (len < 128) {
-        asn.push_back((char)len);
+        out[0] = (char)len;
+        return 1;
     } else {
         uint8_t v[4];
         //c++0x does not allow implicit typecast from uint32_t to uint8_t
@@ -575,13 +579,26 @@ void Crypto_ASN1::EncodeLen(qcc::String& asn, size_t len)
         while (!v[n]) {
             ++n;
         }
-        asn.push_back((char)((4 - n) | 0x80));
-        asn.append((char*)(v + n), 4 - n);
+        out[0] = (char)((4 - n) | 0x80);
+        memcpy(out + 1, v + n, 4 - n);
+        return 5 - n;
     }
 }
 
+void Crypto_ASN1::EncodeLen(StringBuilder& asn, size_t len)
+{
+    char buf[5];
+    asn.append(buf, FormatLen(buf, len));
+}
+
+void Crypto_ASN1::InsertLen(StringBuilder& asn, size_t start)
+{
+    char buf[5];
+    asn.insert(start, buf, FormatLen(buf, asn.size() - start));
+}
+
 // ASN1 encode an OID in dotted notation (e.g. 1.2.840.113549.1.5.13)
-QStatus Crypto_ASN1::EncodeOID(qcc::String& asn, const qcc::String& oid)
+QStatus Crypto_ASN1::EncodeOID(StringBuilder& asn, const qcc::String& oid)
 {
     QStatus status = ER_OK;
     // First decode oid into an array of integers
@@ -606,7 +623,7 @@ QStatus Crypto_ASN1::EncodeOID(qcc::String& asn, const qcc::String& oid)
         status = ER_FAIL;
     } else {
         // First 2 numbers are packed into a single byte
-        asn.push_back((char)(nums[0] * 40 + nums[1]));
+        asn.append((char)(nums[0] * 40 + nums[1]));
         for (size_t i = 2; i < numNums; ++i) {
             uint32_t v = nums[i];
             // Encode bytes base 128
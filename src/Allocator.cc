@@ -0,0 +1,381 @@
+/**
+ * @file
+ *
+ * Allocation of reference counted objects and string storage.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <qcc/Allocator.h>
+#include <qcc/Thread.h>
+
+#define QCC_MODULE "ALLOC"
+
+/*
+ * Size classes are multiples of SMALL_STEP up to SMALL_LIMIT and multiples of
+ * LARGE_STEP up to POOL_LIMIT.  Anything bigger goes to malloc.
+ */
+#define SMALL_STEP 16
+#define SMALL_LIMIT 256
+#define LARGE_STEP 64
+#define POOL_LIMIT 1024
+#define NUM_CLASSES ((SMALL_LIMIT / SMALL_STEP) + ((POOL_LIMIT - SMALL_LIMIT) / LARGE_STEP))
+
+/* Number of caches that threads spread over */
+#define NUM_CACHES 32
+
+/* A cache passes blocks back to the shared list when it holds more than this many of a class */
+#define MAX_CACHED 64
+
+/* Number of blocks moved at a time between caches and the shared lists */
+#define BATCH 32
+
+/*
+ * Memory checkers cannot see misuse of blocks that are recycled by the pool,
+ * so it gets out of the way when one is in use.
+ */
+#if defined(__SANITIZE_ADDRESS__)
+#define POOL_DISABLED
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define POOL_DISABLED
+#endif
+#endif
+
+namespace qcc {
+
+struct PoolBlock {
+    PoolBlock* next;
+};
+
+/*
+ * A cache is locked by the thread using it, which is uncontended unless two
+ * threads happen to pick the same one.
+ */
+struct PoolCache {
+    volatile int32_t busy;
+    PoolBlock* heads[NUM_CLASSES];
+    uint32_t counts[NUM_CLASSES];
+    char pad[QCC_CACHE_LINE_SIZE];
+};
+
+/* The shared list of free blocks for one size class */
+struct PoolDepot {
+    volatile int32_t lock;
+    PoolBlock* head;
+    size_t count;
+};
+
+/*
+ * All of the state is constant initialized so that strings and managed
+ * objects can be allocated during static construction and destruction.
+ */
+static PoolCache caches[NUM_CACHES];
+static PoolDepot depots[NUM_CLASSES];
+
+static Allocator* volatile allocators[Allocator::MAX_ALLOCATORS];
+static volatile int32_t allocatorsLock = 0;
+static volatile uint32_t currentAllocator = 0;
+
+static AllocStats* volatile firstStats = NULL;
+
+static inline size_t ClassOf(size_t size)
+{
+    if (size <= SMALL_LIMIT) {
+        return (size + SMALL_STEP - 1) / SMALL_STEP - (size ? 1 : 0);
+    } else {
+        return (SMALL_LIMIT / SMALL_STEP) + (size - SMALL_LIMIT - 1) / LARGE_STEP;
+    }
+}
+
+static inline size_t ClassSize(size_t cls)
+{
+    if (cls < (SMALL_LIMIT / SMALL_STEP)) {
+        return (cls + 1) * SMALL_STEP;
+    } else {
+        return SMALL_LIMIT + (cls - (SMALL_LIMIT / SMALL_STEP) + 1) * LARGE_STEP;
+    }
+}
+
+static void SpinLock(volatile int32_t& lock)
+{
+    int32_t expected = 0;
+    while (!AtomicCompareExchange(&lock, expected, static_cast<int32_t>(1), MEMORY_ORDER_ACQUIRE)) {
+        expected = 0;
+        qcc::Sleep(0);
+    }
+}
+
+static void SpinUnlock(volatile int32_t& lock)
+{
+    AtomicStore(&lock, static_cast<int32_t>(0), MEMORY_ORDER_RELEASE);
+}
+
+/*
+ * Pick a cache from the address of the caller's stack, as Epoch does for its
+ * reader slots.  Threads have separate stacks so they usually keep to their
+ * own cache.  Returns NULL if every cache is in use.
+ */
+static PoolCache* LockCache()
+{
+    uint32_t page = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(&page) >> 12);
+    uint32_t i = (page * 0x9E3779B9U) >> 27;
+    for (uint32_t n = 0; n < NUM_CACHES; ++n, i = (i + 1) % NUM_CACHES) {
+        int32_t expected = 0;
+        if ((AtomicLoad(&caches[i].busy, MEMORY_ORDER_RELAXED) == 0) &&
+            AtomicCompareExchange(&caches[i].busy, expected, static_cast<int32_t>(1), MEMORY_ORDER_ACQUIRE)) {
+            return &caches[i];
+        }
+    }
+    return NULL;
+}
+
+static void UnlockCache(PoolCache* cache)
+{
+    AtomicStore(&cache->busy, static_cast<int32_t>(0), MEMORY_ORDER_RELEASE);
+}
+
+/*
+ * Take up to max blocks from the shared list, or carve new ones from the heap
+ * if it is empty.  Returns a chain of blocks and how many are in it.
+ */
+static PoolBlock* TakeBlocks(size_t cls, size_t max, size_t& count)
+{
+    PoolDepot& depot = depots[cls];
+    SpinLock(depot.lock);
+    PoolBlock* first = depot.head;
+    PoolBlock* last = NULL;
+    for (count = 0; (count < max) && depot.head; ++count) {
+        last = depot.head;
+        depot.head = last->next;
+    }
+    depot.count -= count;
+    SpinUnlock(depot.lock);
+    if (count) {
+        last->next = NULL;
+        return first;
+    }
+
+    size_t size = ClassSize(cls);
+    char* chunk = static_cast<char*>(malloc(size * max));
+    if (!chunk) {
+        return NULL;
+    }
+    for (size_t i = 0; i < max; ++i) {
+        reinterpret_cast<PoolBlock*>(chunk + i * size)->next = (i + 1 < max) ? reinterpret_cast<PoolBlock*>(chunk + (i + 1) * size) : NULL;
+    }
+    count = max;
+    return reinterpret_cast<PoolBlock*>(chunk);
+}
+
+/* Put a chain of count blocks from first to last on the shared list */
+static void GiveBlocks(size_t cls, PoolBlock* first, PoolBlock* last, size_t count)
+{
+    PoolDepot& depot = depots[cls];
+    SpinLock(depot.lock);
+    last->next = depot.head;
+    depot.head = first;
+    depot.count += count;
+    SpinUnlock(depot.lock);
+}
+
+static void* PoolAllocate(size_t size)
+{
+#if !defined(POOL_DISABLED)
+    if (size <= POOL_LIMIT) {
+        size_t cls = ClassOf(size);
+        PoolCache* cache = LockCache();
+        if (!cache) {
+            size_t count;
+            return TakeBlocks(cls, 1, count);
+        }
+        PoolBlock* block = cache->heads[cls];
+        if (!block) {
+            size_t count;
+            block = TakeBlocks(cls, BATCH, count);
+            cache->counts[cls] = static_cast<uint32_t>(count);
+        }
+        if (block) {
+            cache->heads[cls] = block->next;
+            --cache->counts[cls];
+        }
+        UnlockCache(cache);
+        return block;
+    }
+#endif
+    return malloc(size);
+}
+
+static void PoolFree(void* mem, size_t size)
+{
+#if !defined(POOL_DISABLED)
+    if (mem && (size <= POOL_LIMIT)) {
+        size_t cls = ClassOf(size);
+        PoolBlock* block = reinterpret_cast<PoolBlock*>(mem);
+        PoolCache* cache = LockCache();
+        if (!cache) {
+            GiveBlocks(cls, block, block, 1);
+            return;
+        }
+        block->next = cache->heads[cls];
+        cache->heads[cls] = block;
+        if (++cache->counts[cls] > MAX_CACHED) {
+            /* Pass the most recently freed blocks back, keeping the rest */
+            PoolBlock* last = block;
+            for (size_t i = 1; i < BATCH; ++i) {
+                last = last->next;
+            }
+            cache->heads[cls] = last->next;
+            cache->counts[cls] -= BATCH;
+            UnlockCache(cache);
+            GiveBlocks(cls, block, last, BATCH);
+            return;
+        }
+        UnlockCache(cache);
+        return;
+    }
+#endif
+    free(mem);
+}
+
+class PoolAllocator : public Allocator {
+  public:
+    void* Allocate(size_t size) { return PoolAllocate(size); }
+    void Free(void* mem, size_t size) { PoolFree(mem, size); }
+};
+
+Allocator& Allocator::GetPool()
+{
+    static PoolAllocator pool;
+    return pool;
+}
+
+/*
+ * Slot 0 of the table is the pool, which is called directly rather than
+ * through the table so that it works before any constructors have run.
+ */
+QStatus Allocator::SetCurrent(Allocator* allocator)
+{
+    if (!allocator || (allocator == &GetPool())) {
+        AtomicStore(&currentAllocator, static_cast<uint32_t>(0), MEMORY_ORDER_RELEASE);
+        return ER_OK;
+    }
+    QStatus status = ER_FAIL;
+    SpinLock(allocatorsLock);
+    for (uint32_t i = 1; i < MAX_ALLOCATORS; ++i) {
+        if (!allocators[i]) {
+            AtomicStore(&allocators[i], allocator, MEMORY_ORDER_RELEASE);
+        }
+        if (allocators[i] == allocator) {
+            AtomicStore(&currentAllocator, i, MEMORY_ORDER_RELEASE);
+            status = ER_OK;
+            break;
+        }
+    }
+    SpinUnlock(allocatorsLock);
+    return status;
+}
+
+Allocator& Allocator::GetCurrent()
+{
+    uint32_t i = AtomicLoad(&currentAllocator, MEMORY_ORDER_ACQUIRE);
+    return i ? *AtomicLoad(&allocators[i], MEMORY_ORDER_ACQUIRE) : GetPool();
+}
+
+void* Allocator::AllocateBlock(size_t size, uint16_t& allocator)
+{
+    uint32_t i = AtomicLoad(&currentAllocator, MEMORY_ORDER_ACQUIRE);
+    allocator = static_cast<uint16_t>(i);
+    return i ? AtomicLoad(&allocators[i], MEMORY_ORDER_ACQUIRE)->Allocate(size) : PoolAllocate(size);
+}
+
+void Allocator::FreeBlock(void* mem, size_t size, uint16_t allocator)
+{
+    if (allocator) {
+        AtomicLoad(&allocators[allocator], MEMORY_ORDER_ACQUIRE)->Free(mem, size);
+    } else {
+        PoolFree(mem, size);
+    }
+}
+
+/*
+ * Shorten "... [with T = Foo; RefCount = ...]" from GCC and
+ * "...ManagedObj<class Foo,class qcc::AtomicRefCount>::..." from MSVC to
+ * "Foo".  The result is never freed.
+ */
+static const char* ShortTypeName(const char* name)
+{
+    const char* start = strstr(name, "[with T = ");
+    const char* end = NULL;
+    if (start) {
+        start += 10;
+        end = strstr(start, "; RefCount = ");
+        if (!end) {
+            end = strrchr(start, ']');
+        }
+    } else if ((start = strstr(name, "ManagedObj<")) != NULL) {
+        start += 11;
+        if ((strncmp(start, "class ", 6) == 0) || (strncmp(start, "struct ", 7) == 0)) {
+            start = strchr(start, ' ') + 1;
+        }
+        end = strstr(start, ">::");
+        /* Drop the policy, which is the last template argument */
+        for (const char* p = end; end && (p > start); --p) {
+            if (*p == ',') {
+                end = p;
+                break;
+            }
+        }
+    }
+    if (!end || (end <= start)) {
+        return name;
+    }
+    size_t len = end - start;
+    char* shortName = static_cast<char*>(malloc(len + 1));
+    if (!shortName) {
+        return name;
+    }
+    memcpy(shortName, start, len);
+    shortName[len] = '\0';
+    return shortName;
+}
+
+void AllocStats::Register(const char* typeName)
+{
+    int32_t expected = 0;
+    if (AtomicCompareExchange(&registered, expected, static_cast<int32_t>(1), MEMORY_ORDER_ACQ_REL)) {
+        if (typeName) {
+            name = ShortTypeName(typeName);
+        }
+        AllocStats* head = AtomicLoad(&firstStats, MEMORY_ORDER_RELAXED);
+        do {
+            next = head;
+        } while (!AtomicCompareExchange(&firstStats, head, this, MEMORY_ORDER_RELEASE));
+    }
+}
+
+const AllocStats* AllocStats::GetFirst()
+{
+    return AtomicLoad(&firstStats, MEMORY_ORDER_ACQUIRE);
+}
+
+}
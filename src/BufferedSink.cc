@@ -44,14 +44,22 @@ BufferedSink::BufferedSink(Sink& sink, size_t minChunk)
     buf(new uint8_t[minChunk]),
     wrPtr(buf),
     completeIdx(0),
-    isBuffered(false)
+    isBuffered(false),
+    isCorked(false)
 {
     QCC_DbgTrace(("BufferedSink(%p, %d)", &sink, minChunk));
+    /* Chunks are pushed from buf, which is refilled as soon as the push returns */
+    sink.SetBufferReuse(true);
 }
 
 BufferedSink::~BufferedSink()
 {
     QCC_DbgTrace(("~BufferedSink()"));
+    /* Do not leave the sink holding back the chunks already pushed */
+    if (isCorked) {
+        sink.Uncork();
+    }
+    sink.SetBufferReuse(false);
     delete [] buf;
 }
 
@@ -87,6 +95,14 @@ QStatus BufferedSink::PushBytes(const void* dataIn, size_t numBytes, size_t& num
     } else {
         /* data doesn't fit in buf */
         size_t ns = minChunk;
+        numSent = 0;
+        /*
+         * Full chunks are going out now and the rest when Flush() is called,
+         * so let the sink hold back partial packets until then.
+         */
+        if (!isCorked) {
+            isCorked = (sink.Cork() == ER_OK);
+        }
         if (curBytes > 0) {
             /* buf is not empty. Fill with first part of data */
             memcpy(wrPtr, data, minChunk - curBytes);
@@ -100,12 +116,12 @@ QStatus BufferedSink::PushBytes(const void* dataIn, size_t numBytes, size_t& num
         }
         /* Copy full size chunks of data if initial chunk fully sent */
         if ((status == ER_OK) && (ns == minChunk)) {
-            while ((numBytes - numSent) > minChunk) {
+            while ((numBytes - numSent) >= minChunk) {
                 status = sink.PushBytes(data, minChunk, ns);
                 QCC_DbgHLPrintf(("BufferedSink: (2) Pushed %d:%d bytes (%d)", minChunk, ns, status));
                 if ((status == ER_OK) && (ns > 0)) {
                     numSent += ns;
-                    data += numSent;
+                    data += ns;
                 }
                 if ((status != ER_OK) || (ns != minChunk)) {
                     break;
@@ -142,5 +158,9 @@ QStatus BufferedSink::Flush()
             }
         }
     }
+    if ((status == ER_OK) && isCorked) {
+        status = sink.Uncork();
+        isCorked = false;
+    }
     return status;
 }
@@ -65,10 +65,10 @@ Config::Config(void)
     if (!iniSource.IsValid()) {
         QCC_LogError(ER_NONE, ("Unable to open config file %s", iniFileResolved.c_str()));
         // use defaults...
-        nameValuePairs["STUNTURN_GATHER_PACING_INTERVAL_MSEC"] = "500";
-        nameValuePairs["STUNTURN_SERVER_IP_ADDRESS"] = "10.4.108.55";
-        nameValuePairs["STUNTURN_SERVER_UDP_PORT"] = "3478";
-        nameValuePairs["STUNTURN_SERVER_TCP_PORT"] = "3478";
+        nameValuePairs[String("STUNTURN_GATHER_PACING_INTERVAL_MSEC")] = "500";
+        nameValuePairs[String("STUNTURN_SERVER_IP_ADDRESS")] = "10.4.108.55";
+        nameValuePairs[String("STUNTURN_SERVER_UDP_PORT")] = "3478";
+        nameValuePairs[String("STUNTURN_SERVER_TCP_PORT")] = "3478";
         // ...
     } else {
         String line;
@@ -28,6 +28,7 @@
 #include <qcc/Mutex.h>
 #include <qcc/Thread.h>
 #include <qcc/Util.h>
+#include <qcc/atomic.h>
 
 #include <Status.h>
 
@@ -38,26 +39,30 @@ using namespace qcc;
 
 namespace qcc {
 
-static Mutex* mutex = NULL;
+/*
+ * Not an Atomic<Mutex*> so that it is initialized before any static
+ * constructor can take the lock.  The release store publishes the new mutex.
+ */
+static Mutex* volatile mutex = NULL;
 static int32_t refCount = 0;
 
 Crypto_ScopedLock::Crypto_ScopedLock()
 {
     if (IncrementAndFetch(&refCount) == 1) {
-        mutex = new Mutex();
+        AtomicStore(&mutex, new Mutex(), MEMORY_ORDER_RELEASE);
     } else {
         DecrementAndFetch(&refCount);
-        while (!mutex) {
+        while (!AtomicLoad(&mutex, MEMORY_ORDER_ACQUIRE)) {
             qcc::Sleep(1);
         }
     }
-    mutex->Lock();
+    mutex->Lock(MUTEX_CONTEXT);
 }
 
 Crypto_ScopedLock::~Crypto_ScopedLock()
 {
     assert(mutex);
-    mutex->Unlock();
+    mutex->Unlock(MUTEX_CONTEXT);
 }
 
 QStatus Crypto_PseudorandomFunctionCCM(const KeyBlob& secret, const char* label, const qcc::String& seed, uint8_t* out, size_t outLen)
@@ -33,8 +33,11 @@
 
 #include <qcc/Debug.h>
 #include <qcc/Environ.h>
+#include <qcc/Epoch.h>
 #include <qcc/Mutex.h>
 #include <qcc/String.h>
+#include <qcc/StringBuilder.h>
+#include <qcc/StringMapKey.h>
 #include <qcc/StringUtil.h>
 #include <qcc/Thread.h>
 #include <qcc/time.h>
@@ -61,9 +64,9 @@ int QCC_SyncPrintf(const char* fmt, ...)
     va_list ap;
 
     va_start(ap, fmt);
-    if (ER_OK == stdoutLock->Lock()) {
+    if (ER_OK == stdoutLock->Lock(MUTEX_CONTEXT)) {
         ret = vprintf(fmt, ap);
-        stdoutLock->Unlock();
+        stdoutLock->Unlock(MUTEX_CONTEXT);
     }
     va_end(ap);
 
@@ -75,10 +78,10 @@ static void WriteMsg(DbgMsgType type, const char* module, const char* msg, void*
 {
     FILE* file = reinterpret_cast<FILE*>(context);
 
-    if (ER_OK == stdoutLock->Lock()) {
+    if (ER_OK == stdoutLock->Lock(MUTEX_CONTEXT)) {
         fflush(stdout);             // Helps make output cleaner on Windows.
         fputs(msg, file);
-        stdoutLock->Unlock();
+        stdoutLock->Unlock(MUTEX_CONTEXT);
     }
 }
 
@@ -93,7 +96,15 @@ class DebugControl {
 
     void AddTagLevelPair(const char* tag, uint32_t level)
     {
-        modLevels.insert(pair<const qcc::String, uint32_t>(tag, level));
+        /*
+         * Check() reads the levels without locking so publish a modified copy
+         * rather than changing the map in place.
+         */
+        levelsLock.Lock(MUTEX_CONTEXT);
+        ModLevelMap* levels = new ModLevelMap(*modLevels.Get());
+        levels->insert(pair<const StringMapKey, uint32_t>(qcc::String(tag), level));
+        modLevels.Publish(levels);
+        levelsLock.Unlock(MUTEX_CONTEXT);
     }
 
     void SetAllLevel(uint32_t level)
@@ -103,9 +114,9 @@ class DebugControl {
 
     void WriteDebugMessage(DbgMsgType type, const char* module, const qcc::String msg)
     {
-        mutex.Lock();
+        mutex.Lock(MUTEX_CONTEXT);
         cb(type, module, msg.c_str(), context);
-        mutex.Unlock();
+        mutex.Unlock(MUTEX_CONTEXT);
     }
 
     void Register(QCC_DbgMsgCallback cb, void* context)
@@ -120,8 +131,15 @@ class DebugControl {
     bool PrintThread() const { return printThread; }
 
   private:
+    /*
+     * Keyed on StringMapKey so that Check() can look up the module name
+     * without constructing a String.
+     */
+    typedef map<const StringMapKey, uint32_t> ModLevelMap;
+
     void Init(void)
     {
+        ModLevelMap* levels = new ModLevelMap();
         Environ* env = Environ::GetAppEnviron();
         Environ::const_iterator iter;
         static const char varPrefix[] = "ER_DEBUG_";
@@ -139,30 +157,35 @@ class DebugControl {
                 if (var.compare("ER_DEBUG_ALL") == 0) {
                     allLevel = level;
                 } else {
-                    modLevels.insert(pair<const qcc::String, int>(var.substr(varPrefixLen), level));
+                    levels->insert(pair<const StringMapKey, uint32_t>(var.substr(varPrefixLen), level));
                 }
             }
         }
+        modLevels.Publish(levels);
     }
 
     Mutex mutex;
     QCC_DbgMsgCallback cb;
     void* context;
     uint32_t allLevel;
-    map<const qcc::String, uint32_t> modLevels;
+    Mutex levelsLock;               /* Serializes updates of modLevels */
+    RcuPtr<ModLevelMap> modLevels;
     bool printThread;
 };
 
 
 bool DebugControl::Check(DbgMsgType type, const char* module)
 {
-    map<const qcc::String, uint32_t>::const_iterator iter;
     uint32_t level;
-    iter = modLevels.find(module);
-    if (iter == modLevels.end()) {
-        level = allLevel;
-    } else {
-        level = iter->second;
+    {
+        ScopedEpoch epoch;
+        const ModLevelMap* levels = modLevels.Get();
+        ModLevelMap::const_iterator iter = levels->find(StringMapKey(module));
+        if (iter == levels->end()) {
+            level = allLevel;
+        } else {
+            level = iter->second;
+        }
     }
 
     switch (type) {
@@ -247,7 +270,7 @@ static const char* Type2Str(DbgMsgType type)
 }
 
 
-static void GenPrefix(qcc::String& oss, DbgMsgType type, const char* module, const char* filename, int lineno, bool printThread)
+static void GenPrefix(StringBuilder& oss, DbgMsgType type, const char* module, const char* filename, int lineno, bool printThread)
 {
     uint32_t timestamp = GetTimestamp();
     static const size_t timeTypeWidth = 18;
@@ -257,34 +280,26 @@ static void GenPrefix(qcc::String& oss, DbgMsgType type, const char* module, con
     static const size_t fileLineWidth = 32;
     size_t colStop = timeTypeWidth;
 
-    oss.reserve(timeTypeWidth + moduleWidth + threadWidth + fileLineWidth + oss.capacity());
-
     // Timestamp - col 0
-    oss.append(U32ToString((timestamp / 1000) % 10000, 10, 4, ' '));
-    oss.push_back('.');
-    oss.append(U32ToString(timestamp % 1000, 10, 3, '0'));
-    oss.push_back(' ');
+    oss.appendU32((timestamp / 1000) % 10000, 10, 4, ' ');
+    oss.append('.');
+    oss.appendU32(timestamp % 1000, 10, 3, '0');
+    oss.append(' ');
 
     // Output type - col 9
     oss.append(Type2Str(type));
-    do {
-        oss.push_back(' ');
-    } while (oss.size() < colStop);
+    oss.append(' ').padTo(colStop);
 
     // Subsystem module - col 18
     colStop += moduleWidth;
     oss.append(module);
-    do {
-        oss.push_back(' ');
-    } while (oss.size() < colStop);
+    oss.append(' ').padTo(colStop);
 
     if (printThread) {
         // Thread name - col 30
         colStop += threadWidth;
         oss.append(Thread::GetThreadName());
-        do {
-            oss.push_back(' ');
-        } while (oss.size() < colStop);
+        oss.append(' ').padTo(colStop);
     } else {
         // Extra space for file name
         colStop += bonusWidth;
@@ -293,26 +308,28 @@ static void GenPrefix(qcc::String& oss, DbgMsgType type, const char* module, con
     // File name - col 30 or 48
     colStop += fileLineWidth;
     size_t fnSize = strlen(filename);
-    qcc::String line = U32ToString(lineno, 10);
-    size_t fileWidth = colStop - (oss.size() + line.size() + 4);  // Figure out how much room for filename
+    char line[16];
+    size_t lineSize = snprintf(line, sizeof(line), "%u", static_cast<uint32_t>(lineno));
+    size_t fileWidth = colStop - (oss.size() + lineSize + 4);  // Figure out how much room for filename
     if (fnSize > fileWidth) {
         // Filename is too long so chop off the first part (which should just be leading directories).
         oss.append("...");
         oss.append(filename + (fnSize - (fileWidth - 3)));
     } else {
-        oss.append(filename);
+        oss.append(filename, fnSize);
     }
-    oss.push_back(':');
-    oss.append(line);
-    do {
-        oss.push_back(' ');
-    } while (oss.size() < (colStop - 2));
+    oss.append(':');
+    oss.append(line, lineSize);
+    oss.append(' ').padTo(colStop - 2);
 
     oss.append("| ");
 
     // Msg at col 70 or 80
 }
 
+/** Longest prefix GenPrefix writes for typical module and thread names */
+static const size_t PREFIX_SIZE_HINT = 96;
+
 
 class DebugContext {
   private:
@@ -335,26 +352,22 @@ class DebugContext {
 
 void DebugContext::Process(DbgMsgType type, const char* module, const char* filename, int lineno)
 {
-    qcc::String oss;
-
-    oss.reserve(sizeof(msg));
+    StringBuilder oss(PREFIX_SIZE_HINT + msgLen + 1);
 
     GenPrefix(oss, type, module, filename, lineno, dbgControl->PrintThread());
 
-    if (msg != NULL) {
-        oss.append(msg);
-    }
+    oss.append(msg);
 
-    oss.push_back('\n');
+    oss.append('\n');
 
-    dbgControl->WriteDebugMessage(type, module, oss);
+    dbgControl->WriteDebugMessage(type, module, oss.ToString());
 }
 
 void DebugContext::Vprintf(const char* fmt, va_list ap)
 {
     int mlen;
 
-    if (ER_OK == stdoutLock->Lock()) {
+    if (ER_OK == stdoutLock->Lock(MUTEX_CONTEXT)) {
         if (msgLen < sizeof(msg)) {
             mlen = vsnprintf(msg + msgLen, sizeof(msg) - msgLen, fmt, ap);
 
@@ -365,7 +378,7 @@ void DebugContext::Vprintf(const char* fmt, va_list ap)
                 }
             }
         }
-        stdoutLock->Unlock();
+        stdoutLock->Unlock(MUTEX_CONTEXT);
     }
 }
 
@@ -441,26 +454,24 @@ void _QCC_DbgDumpHex(DbgMsgType type, const char* module, const char* filename,
             const uint8_t* pos(reinterpret_cast<const uint8_t*>(data));
             static const size_t LINE_LEN = 16;
             size_t i;
-            qcc::String oss;
-
-            oss.reserve(strlen(dataStr) + 8 + dataLen * 4 + (((dataLen + 15) / 16) * (40 + strlen(module))));
+            StringBuilder oss(PREFIX_SIZE_HINT + strlen(dataStr) + 8 + dataLen * 4 + (((dataLen + 15) / 16) * (40 + strlen(module))));
 
             GenPrefix(oss, type, module, filename, lineno, dbgControl->PrintThread());
 
             oss.append(dataStr);
-            oss.push_back('[');
-            oss.append(U32ToString(dataLen, 16, 4, '0'));
+            oss.append('[');
+            oss.appendU32(dataLen, 16, 4, '0');
             oss.append("]:\n");
 
             while (dataLen > 0) {
                 size_t dumpLen = (std::min)(dataLen, LINE_LEN);
 
-                oss.append("         ");
+                oss.append(9, ' ');
                 oss.append(Type2Str(type));
-                oss.push_back(' ');
+                oss.append(' ');
                 oss.append(module);
-                oss.append("    ");
-                oss.append(U32ToString(pos - reinterpret_cast<const uint8_t*>(data), 16, 4, '0'));
+                oss.append(4, ' ');
+                oss.appendU32(pos - reinterpret_cast<const uint8_t*>(data), 16, 4, '0');
                 oss.append(" | ");
 
                 for (i = 0; i < LINE_LEN; ++i) {
@@ -468,10 +479,10 @@ void _QCC_DbgDumpHex(DbgMsgType type, const char* module, const char* filename,
                         oss.append("- ");
                     }
                     if (i < dumpLen) {
-                        oss.append(U32ToString(static_cast<uint32_t>(pos[i]), 16, 2, '0'));
-                        oss.push_back(' ');
+                        oss.appendHex(&pos[i], 1);
+                        oss.append(' ');
                     } else {
-                        oss.append("   ");
+                        oss.append(3, ' ');
                     }
                 }
 
@@ -482,18 +493,18 @@ void _QCC_DbgDumpHex(DbgMsgType type, const char* module, const char* filename,
                         oss.append(" - ");
                     }
                     if (i < dumpLen) {
-                        oss.push_back(isprint(pos[i]) ? pos[i] : '.');
+                        oss.append(static_cast<char>(isprint(pos[i]) ? pos[i] : '.'));
                     } else {
-                        oss.push_back(' ');
+                        oss.append(' ');
                     }
                 }
 
-                oss.push_back('\n');
+                oss.append('\n');
 
                 pos += dumpLen;
                 dataLen -= dumpLen;
             }
-            dbgControl->WriteDebugMessage(type, module, oss);
+            dbgControl->WriteDebugMessage(type, module, oss.ToString());
         }
     }
 }
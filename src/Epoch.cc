@@ -0,0 +1,218 @@
+/**
+ * @file
+ *
+ * Epoch based reclamation for data structures with lock-free readers
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <qcc/Epoch.h>
+#include <qcc/Thread.h>
+
+#define QCC_MODULE "EPOCH"
+
+/*
+ * Number of reader slots.  This bounds the number of reader sections that can
+ * be active at the same time without waiting.
+ */
+#define NUM_SLOTS 128
+
+/*
+ * Retire() tries to reclaim whenever this many more objects are pending than
+ * after the last attempt.
+ */
+#define RECLAIM_THRESHOLD 64
+
+namespace qcc {
+
+/*
+ * A reader slot holds the epoch its reader entered in, or 0 when free.  Each
+ * slot has its own cache line so readers do not disturb each other.
+ */
+struct EpochSlot {
+    volatile uint32_t epoch;
+    char pad[QCC_CACHE_LINE_SIZE - sizeof(uint32_t)];
+};
+
+struct RetiredObject {
+    void* object;
+    Epoch::Deleter deleter;
+    uint32_t epoch;
+    RetiredObject* next;
+};
+
+/*
+ * All of the state is constant initialized so that reader sections work
+ * during static construction and destruction.
+ */
+static volatile uint32_t globalEpoch = 1;
+static EpochSlot slots[NUM_SLOTS];
+static RetiredObject* volatile retired = NULL;
+static volatile int32_t numRetired = 0;
+static volatile int32_t reclaimMark = 0;
+static volatile int32_t reclaiming = 0;
+
+/*
+ * Pick the first slot to try from the address of the caller's stack.  Threads
+ * have separate stacks so concurrent readers usually start at different slots.
+ */
+static inline uint32_t FirstSlot(const void* stackAddress)
+{
+    uint32_t page = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(stackAddress) >> 12);
+    return (page * 0x9E3779B9U) >> 25;
+}
+
+uint32_t Epoch::Enter()
+{
+    uint32_t i = FirstSlot(&i);
+    while (true) {
+        for (uint32_t n = 0; n < NUM_SLOTS; ++n, i = (i + 1) % NUM_SLOTS) {
+            if (AtomicLoad(&slots[i].epoch, MEMORY_ORDER_RELAXED) == 0) {
+                /*
+                 * The epoch read here may be stale by the time the slot is
+                 * claimed.  That only holds back reclamation a little longer.
+                 */
+                uint32_t expected = 0;
+                if (AtomicCompareExchange(&slots[i].epoch, expected, AtomicLoad(&globalEpoch))) {
+                    return i;
+                }
+            }
+        }
+        qcc::Sleep(0);
+    }
+}
+
+void Epoch::Exit(uint32_t handle)
+{
+    AtomicStore(&slots[handle].epoch, static_cast<uint32_t>(0), MEMORY_ORDER_RELEASE);
+}
+
+/*
+ * Advance the global epoch if every active reader has entered in the current
+ * one.
+ */
+static bool TryAdvance()
+{
+    uint32_t epoch = AtomicLoad(&globalEpoch);
+    for (uint32_t i = 0; i < NUM_SLOTS; ++i) {
+        uint32_t e = AtomicLoad(&slots[i].epoch);
+        if ((e != 0) && (e != epoch)) {
+            return false;
+        }
+    }
+    uint32_t next = (epoch + 1 == 0) ? 1 : epoch + 1;
+    return AtomicCompareExchange(&globalEpoch, epoch, next);
+}
+
+void Epoch::Retire(void* object, Deleter deleter)
+{
+    /* Order the caller's unlinking before the epoch is read */
+    AtomicFence(MEMORY_ORDER_SEQ_CST);
+
+    RetiredObject* entry = new RetiredObject;
+    entry->object = object;
+    entry->deleter = deleter;
+    entry->epoch = AtomicLoad(&globalEpoch);
+    entry->next = AtomicLoad(&retired, MEMORY_ORDER_RELAXED);
+    while (!AtomicCompareExchange(&retired, entry->next, entry, MEMORY_ORDER_RELEASE)) {
+    }
+
+    int32_t count = IncrementAndFetch(&numRetired);
+    if (count - AtomicLoad(&reclaimMark, MEMORY_ORDER_RELAXED) >= RECLAIM_THRESHOLD) {
+        Reclaim();
+    }
+}
+
+/*
+ * Delete the retired objects that are at least two epochs old.  Only one
+ * thread reclaims at a time; returns false without doing anything if another
+ * thread is already at it.
+ */
+static bool TryReclaim(size_t& count)
+{
+    int32_t idle = 0;
+    if (!AtomicCompareExchange(&reclaiming, idle, static_cast<int32_t>(1), MEMORY_ORDER_ACQUIRE)) {
+        return false;
+    }
+
+    TryAdvance();
+    uint32_t epoch = AtomicLoad(&globalEpoch);
+
+    /* Take the whole list, delete what is old enough and put the rest back */
+    RetiredObject* list = AtomicExchange(&retired, static_cast<RetiredObject*>(NULL), MEMORY_ORDER_ACQUIRE);
+    RetiredObject* keep = NULL;
+    RetiredObject** keepTail = &keep;
+    count = 0;
+    while (list) {
+        RetiredObject* entry = list;
+        list = list->next;
+        if (epoch - entry->epoch >= 2) {
+            entry->deleter(entry->object);
+            delete entry;
+            ++count;
+        } else {
+            *keepTail = entry;
+            keepTail = &entry->next;
+        }
+    }
+    if (keep) {
+        *keepTail = AtomicLoad(&retired, MEMORY_ORDER_RELAXED);
+        while (!AtomicCompareExchange(&retired, *keepTail, keep, MEMORY_ORDER_RELEASE)) {
+        }
+    }
+
+    int32_t remaining = AtomicFetchAdd(&numRetired, -static_cast<int32_t>(count)) - static_cast<int32_t>(count);
+    AtomicStore(&reclaimMark, remaining, MEMORY_ORDER_RELAXED);
+    AtomicStore(&reclaiming, static_cast<int32_t>(0), MEMORY_ORDER_RELEASE);
+    return true;
+}
+
+size_t Epoch::Reclaim()
+{
+    size_t count = 0;
+    TryReclaim(count);
+    return count;
+}
+
+void Epoch::Synchronize()
+{
+    uint32_t start = AtomicLoad(&globalEpoch);
+    while (AtomicLoad(&globalEpoch) - start < 2) {
+        if (!TryAdvance()) {
+            qcc::Sleep(1);
+        }
+    }
+
+    /*
+     * Everything retired before we were called can be deleted now.  If
+     * another thread is reclaiming it may have started before that was true,
+     * so wait for our turn.
+     */
+    size_t count;
+    while (!TryReclaim(count)) {
+        qcc::Sleep(0);
+    }
+}
+
+size_t Epoch::Pending()
+{
+    return static_cast<size_t>(AtomicLoad(&numRetired));
+}
+
+}
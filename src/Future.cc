@@ -0,0 +1,122 @@
+/**
+ * @file
+ *
+ * Future and Promise result handles for work that completes on another thread
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/Future.h>
+#include <qcc/Debug.h>
+
+#define QCC_MODULE "FUTURE"
+
+namespace qcc {
+
+_FutureStateBase::_FutureStateBase() : m_ready(false), m_status(ER_OK), m_event(NULL)
+{
+}
+
+_FutureStateBase::~_FutureStateBase()
+{
+    delete m_event;
+}
+
+bool _FutureStateBase::IsReady()
+{
+    m_lock.Lock();
+    bool ready = m_ready;
+    m_lock.Unlock();
+    return ready;
+}
+
+QStatus _FutureStateBase::Wait(uint32_t maxMs)
+{
+    m_lock.Lock();
+    if (m_ready) {
+        QStatus status = m_status;
+        m_lock.Unlock();
+        return status;
+    }
+
+    /*
+     * Somebody has to wait, so now we need an event.  It is only ever set, by
+     * Complete(), so once created it simply stays around until we are
+     * destroyed.  Our caller holds a reference to us which keeps the event
+     * alive for the duration of the wait.
+     */
+    if (!m_event) {
+        m_event = new Event();
+    }
+    Event* event = m_event;
+    m_lock.Unlock();
+
+    QStatus status = Event::Wait(*event, maxMs);
+    if (status == ER_OK) {
+        m_lock.Lock();
+        status = m_status;
+        m_lock.Unlock();
+    }
+    return status;
+}
+
+bool _FutureStateBase::Complete(QStatus status)
+{
+    m_lock.Lock();
+    return CompleteAndUnlock(status);
+}
+
+bool _FutureStateBase::CompleteAndUnlock(QStatus status)
+{
+    if (m_ready) {
+        m_lock.Unlock();
+        return false;
+    }
+    m_ready = true;
+    m_status = status;
+    if (m_event) {
+        m_event->SetEvent();
+    }
+
+    /*
+     * Notify dependents without holding our lock; they are free to look at
+     * us again.
+     */
+    std::vector<Ptr<_FutureStateBase> > dependents;
+    dependents.swap(m_dependents);
+    m_lock.Unlock();
+
+    for (size_t i = 0; i < dependents.size(); ++i) {
+        dependents[i]->DependencyComplete(status);
+    }
+    return true;
+}
+
+void _FutureStateBase::AddDependent(Ptr<_FutureStateBase> dependent)
+{
+    m_lock.Lock();
+    if (!m_ready) {
+        m_dependents.push_back(dependent);
+        m_lock.Unlock();
+        return;
+    }
+    QStatus status = m_status;
+    m_lock.Unlock();
+    dependent->DependencyComplete(status);
+}
+
+} // namespace qcc
@@ -24,14 +24,14 @@
 
 using namespace qcc;
 using namespace std;
-IODispatch::IODispatch(const char* name, uint32_t concurrency) :
-    timer(name, true, concurrency, false, 50),
+IODispatch::IODispatch(const char* name, uint32_t concurrency, const ThreadAttributes& attributes) :
+    timer(name, true, concurrency, false, 50, attributes),
     reload(false),
     isRunning(false),
     numAlarmsInProgress(0),
     crit(false)
 {
-
+    SetAttributes(attributes);
 }
 IODispatch::~IODispatch()
 {
@@ -63,19 +63,19 @@ QStatus IODispatch::Start()
 
 QStatus IODispatch::Stop()
 {
-    lock.Lock();
+    lock.Lock(MUTEX_CONTEXT);
     isRunning = false;
     map<Stream*, IODispatchEntry>::iterator it = dispatchEntries.begin();
     Stream* stream;
     while (it != dispatchEntries.end()) {
 
         stream = it->first;
-        lock.Unlock();
+        lock.Unlock(MUTEX_CONTEXT);
         StopStream(stream);
-        lock.Lock();
+        lock.Lock(MUTEX_CONTEXT);
         it = dispatchEntries.upper_bound(stream);
     }
-    lock.Unlock();
+    lock.Unlock(MUTEX_CONTEXT);
 
     Thread::Stop();
     timer.Stop();
@@ -84,18 +84,18 @@ QStatus IODispatch::Stop()
 
 QStatus IODispatch::Join()
 {
-    lock.Lock();
+    lock.Lock(MUTEX_CONTEXT);
 
     map<Stream*, IODispatchEntry>::iterator it = dispatchEntries.begin();
     Stream* stream;
     while (it != dispatchEntries.end()) {
         stream = it->first;
-        lock.Unlock();
+        lock.Unlock(MUTEX_CONTEXT);
         JoinStream(stream);
-        lock.Lock();
+        lock.Lock(MUTEX_CONTEXT);
         it = dispatchEntries.upper_bound(stream);
     }
-    lock.Unlock();
+    lock.Unlock(MUTEX_CONTEXT);
 
     Thread::Join();
     timer.Join();
@@ -106,14 +106,14 @@ QStatus IODispatch::StartStream(Stream* stream, IOReadListener* readListener, IO
 {
     QCC_DbgTrace(("StartStream %p", stream));
 
-    lock.Lock();
+    lock.Lock(MUTEX_CONTEXT);
     /* Dont attempt to register a stream if the IODispatch is shutting down */
     if (!isRunning) {
-        lock.Unlock();
+        lock.Unlock(MUTEX_CONTEXT);
         return ER_BUS_STOPPING;
     }
     if (dispatchEntries.find(stream) != dispatchEntries.end()) {
-        lock.Unlock();
+        lock.Unlock(MUTEX_CONTEXT);
         return ER_INVALID_STREAM;
 
     }
@@ -126,7 +126,7 @@ QStatus IODispatch::StartStream(Stream* stream, IOReadListener* readListener, IO
 
     /* Set reload to false and alert the IODispatch::Run thread */
     reload = false;
-    lock.Unlock();
+    lock.Unlock(MUTEX_CONTEXT);
 
     Thread::Alert();
     /* Dont need to wait for the IODispatch::Run thread to reload
@@ -137,17 +137,17 @@ QStatus IODispatch::StartStream(Stream* stream, IOReadListener* readListener, IO
 
 
 QStatus IODispatch::StopStream(Stream* stream) {
-    lock.Lock();
+    lock.Lock(MUTEX_CONTEXT);
     QCC_DbgTrace(("StopStream %p", stream));
     map<Stream*, IODispatchEntry>::iterator it = dispatchEntries.find(stream);
 
     /* Check if stream is still present in dispatchEntries. */
     if (it == dispatchEntries.end()) {
-        lock.Unlock();
+        lock.Unlock(MUTEX_CONTEXT);
         return ER_INVALID_STREAM;
     }
     if (it->second.stopping_state == IO_STOPPED) {
-        lock.Unlock();
+        lock.Unlock(MUTEX_CONTEXT);
         return ER_FAIL;
     }
     IODispatchEntry dispatchEntry = it->second;
@@ -167,11 +167,11 @@ QStatus IODispatch::StopStream(Stream* stream) {
 
         /* Wait until the IODispatch::Run thread reloads the set of check events */
         while (!reload && crit && isRunning) {
-            lock.Unlock();
+            lock.Unlock(MUTEX_CONTEXT);
             Sleep(1);
-            lock.Lock();
+            lock.Lock(MUTEX_CONTEXT);
         }
-        lock.Unlock();
+        lock.Unlock(MUTEX_CONTEXT);
     } else {
 
         /* If the main thread has been asked to stopped, it may or may not have
@@ -185,17 +185,17 @@ QStatus IODispatch::StopStream(Stream* stream) {
              * the exit alarm. Hence it is not a part of IODispatchEntry.
              */
             Alarm exitAlarm = Alarm(when, listener, it->second.exitCtxt);
-            lock.Unlock();
+            lock.Unlock(MUTEX_CONTEXT);
             timer.AddAlarm(exitAlarm);
         }       else {
-            lock.Unlock();
+            lock.Unlock(MUTEX_CONTEXT);
         }
     }
 
     return ER_OK;
 }
 QStatus IODispatch::JoinStream(Stream* stream) {
-    lock.Lock();
+    lock.Lock(MUTEX_CONTEXT);
     QCC_DbgTrace(("JoinStream %p", stream));
 
     /* Wait until the exit callback is complete and the
@@ -203,17 +203,17 @@ QStatus IODispatch::JoinStream(Stream* stream) {
      */
     map<Stream*, IODispatchEntry>::iterator it = dispatchEntries.find(stream);
     while (it != dispatchEntries.end()) {
-        lock.Unlock();
+        lock.Unlock(MUTEX_CONTEXT);
         qcc::Sleep(10);
-        lock.Lock();
+        lock.Lock(MUTEX_CONTEXT);
         it = dispatchEntries.find(stream);
     }
-    lock.Unlock();
+    lock.Unlock(MUTEX_CONTEXT);
     return ER_OK;
 }
 void IODispatch::AlarmTriggered(const Alarm& alarm, QStatus reason)
 {
-    lock.Lock();
+    lock.Lock(MUTEX_CONTEXT);
     /* Find the stream associated with this alarm */
     CallbackContext* ctxt = static_cast<CallbackContext*>(alarm->GetContext());
     Stream* stream = ctxt->stream;
@@ -227,7 +227,7 @@ void IODispatch::AlarmTriggered(const Alarm& alarm, QStatus reason)
         /* If IODispatch is being shut down, only service exit alarms.
          * Ignore read/write/timeout alarms
          */
-        lock.Unlock();
+        lock.Unlock(MUTEX_CONTEXT);
         return;
     }
 
@@ -241,7 +241,7 @@ void IODispatch::AlarmTriggered(const Alarm& alarm, QStatus reason)
     if (((it->second.stopping_state != IO_RUNNING) && ctxt->type != IO_EXIT)) {
         /* If stream is being stopped and this is not an exit alarm, return.
          */
-        lock.Unlock();
+        lock.Unlock(MUTEX_CONTEXT);
         return;
     }
 
@@ -256,15 +256,15 @@ void IODispatch::AlarmTriggered(const Alarm& alarm, QStatus reason)
          */
         it->second.readInProgress = true;
         while (!reload && crit && isRunning) {
-            lock.Unlock();
+            lock.Unlock(MUTEX_CONTEXT);
             Sleep(1);
-            lock.Lock();
+            lock.Lock(MUTEX_CONTEXT);
         }
 
     case IO_READ:
         IncrementAndFetch(&numAlarmsInProgress);
 
-        lock.Unlock();
+        lock.Unlock(MUTEX_CONTEXT);
         if (dispatchEntry.readEnable) {
             /* Ensure read has not been disabled */
             dispatchEntry.readListener->ReadCallback(*stream, ctxt->type == IO_READ_TIMEOUT);
@@ -281,16 +281,16 @@ void IODispatch::AlarmTriggered(const Alarm& alarm, QStatus reason)
          */
         it->second.writeInProgress = true;
         while (!reload && crit && isRunning) {
-            lock.Unlock();
+            lock.Unlock(MUTEX_CONTEXT);
             Sleep(1);
-            lock.Lock();
+            lock.Lock(MUTEX_CONTEXT);
         }
 
     case IO_WRITE_TIMEOUT:
 
         IncrementAndFetch(&numAlarmsInProgress);
 
-        lock.Unlock();
+        lock.Unlock(MUTEX_CONTEXT);
 
         /* Make the write callback */
         if (dispatchEntry.writeEnable) {
@@ -302,7 +302,7 @@ void IODispatch::AlarmTriggered(const Alarm& alarm, QStatus reason)
 
     case IO_EXIT:
 
-        lock.Unlock();
+        lock.Unlock(MUTEX_CONTEXT);
 
         if (isRunning) {
             /* Timer is running. Remove any pending alarms */
@@ -319,7 +319,7 @@ void IODispatch::AlarmTriggered(const Alarm& alarm, QStatus reason)
         /* Make the exit callback */
         dispatchEntry.exitListener->ExitCallback();
         /* Find and erase the stream entry */
-        lock.Lock();
+        lock.Lock(MUTEX_CONTEXT);
         it = dispatchEntries.find(stream);
         if (it == dispatchEntries.end()) {
             /* This should never happen - it means that the entry was deleted
@@ -348,7 +348,7 @@ void IODispatch::AlarmTriggered(const Alarm& alarm, QStatus reason)
             it->second.readTimeoutCtxt = NULL;
         }
         dispatchEntries.erase(it);
-        lock.Unlock();
+        lock.Unlock(MUTEX_CONTEXT);
         break;
 
     default:
@@ -372,7 +372,7 @@ ThreadReturn STDCALL IODispatch::Run(void* arg) {
         /* Set reload to true to indicate that this thread is not in the Event::Wait and is
          * reloading the set of source and sink events
          */
-        lock.Lock();
+        lock.Lock(MUTEX_CONTEXT);
         reload = true;
         map<Stream*, IODispatchEntry>::iterator it = dispatchEntries.begin();
         while (it != dispatchEntries.end() && isRunning) {
@@ -394,12 +394,12 @@ ThreadReturn STDCALL IODispatch::Run(void* arg) {
             it++;
         }
         crit = true;
-        lock.Unlock();
+        lock.Unlock(MUTEX_CONTEXT);
 
         /* Wait for an event to occur */
         qcc::Event::Wait(checkEvents, signaledEvents);
 
-        lock.Lock();
+        lock.Lock(MUTEX_CONTEXT);
         crit = false;
         reload = true;
 
@@ -413,15 +413,15 @@ ThreadReturn STDCALL IODispatch::Run(void* arg) {
                 it->second.stopping_state = IO_STOPPED;
                 Stream* s = it->first;
                 Alarm exitAlarm = Alarm(when, listener, it->second.exitCtxt);
-                lock.Unlock();
+                lock.Unlock(MUTEX_CONTEXT);
                 QStatus status = timer.AddAlarm(exitAlarm);
-                lock.Lock();
+                lock.Lock(MUTEX_CONTEXT);
                 it = dispatchEntries.upper_bound(s);
             } else {
                 it++;
             }
         }
-        lock.Unlock();
+        lock.Unlock(MUTEX_CONTEXT);
         for (vector<qcc::Event*>::iterator i = signaledEvents.begin(); i != signaledEvents.end(); ++i) {
             if (*i == &stopEvent) {
                 /* This thread has been alerted or is being stopped. Will check the IsStopping()
@@ -430,7 +430,7 @@ ThreadReturn STDCALL IODispatch::Run(void* arg) {
                 stopEvent.ResetEvent();
                 continue;
             } else {
-                lock.Lock();
+                lock.Lock(MUTEX_CONTEXT);
                 map<Stream*, IODispatchEntry>::iterator it = dispatchEntries.begin();
                 while (it != dispatchEntries.end()) {
 
@@ -447,11 +447,11 @@ ThreadReturn STDCALL IODispatch::Run(void* arg) {
                                 it->second.readInProgress = true;
                                 it->second.readAlarm = Alarm(when, listener, it->second.readCtxt);
                                 Alarm readAlarm = it->second.readAlarm;
-                                lock.Unlock();
+                                lock.Unlock(MUTEX_CONTEXT);
                                 /* Remove the read timeout alarm if any first */
                                 timer.RemoveAlarm(prevAlarm, true);
                                 timer.AddAlarm(readAlarm);
-                                lock.Lock();
+                                lock.Lock(MUTEX_CONTEXT);
                                 break;
                             }
                         } else if (&stream->GetSinkEvent() == *i) {
@@ -463,36 +463,36 @@ ThreadReturn STDCALL IODispatch::Run(void* arg) {
                                 it->second.writeInProgress = true;
                                 it->second.writeAlarm = Alarm(when, listener, it->second.writeCtxt);
                                 Alarm writeAlarm = it->second.writeAlarm;
-                                lock.Unlock();
+                                lock.Unlock(MUTEX_CONTEXT);
                                 /* Remove the write timeout alarm if any first */
                                 timer.RemoveAlarm(prevAlarm, true);
                                 timer.AddAlarm(writeAlarm);
-                                lock.Lock();
+                                lock.Lock(MUTEX_CONTEXT);
                                 break;
                             }
                         }
                     }
                     it++;
                 }
-                lock.Unlock();
+                lock.Unlock(MUTEX_CONTEXT);
             }
         }
     }
-    lock.Lock();
+    lock.Lock(MUTEX_CONTEXT);
     /* Set isRunning flag and reload flag. */
     reload = true;
     QCC_DbgPrintf(("IODispatch::Run exiting"));
-    lock.Unlock();
+    lock.Unlock(MUTEX_CONTEXT);
 
     return (ThreadReturn) 0;
 }
 
 QStatus IODispatch::EnableReadCallback(const Source* source, uint32_t timeout)
 {
-    lock.Lock();
+    lock.Lock(MUTEX_CONTEXT);
     /* Dont attempt to modify an entry if the IODispatch is shutting down */
     if (!isRunning) {
-        lock.Unlock();
+        lock.Unlock(MUTEX_CONTEXT);
         return ER_BUS_STOPPING;
     }
     Stream* lookup = (Stream*)source;
@@ -500,7 +500,7 @@ QStatus IODispatch::EnableReadCallback(const Source* source, uint32_t timeout)
 
     /* Ensure stream is valid and still running */
     if (it == dispatchEntries.end() || (it->second.stopping_state != IO_RUNNING)) {
-        lock.Unlock();
+        lock.Unlock(MUTEX_CONTEXT);
         return ER_INVALID_STREAM;
     }
 
@@ -512,9 +512,9 @@ QStatus IODispatch::EnableReadCallback(const Source* source, uint32_t timeout)
         AlarmListener* listener = this;
         it->second.readAlarm = Alarm(temp, listener, it->second.readTimeoutCtxt);
         Alarm readAlarm = it->second.readAlarm;
-        lock.Unlock();
+        lock.Unlock(MUTEX_CONTEXT);
         timer.AddAlarm(readAlarm);
-        lock.Lock();
+        lock.Lock(MUTEX_CONTEXT);
         /* Set readInProgress to false only after adding the alarm
          * This is to ensure that there is no race condition due to the main thread
          * trying to remove this alarm before it has been added and assuming
@@ -528,7 +528,7 @@ QStatus IODispatch::EnableReadCallback(const Source* source, uint32_t timeout)
         /* Timeout = 0 indicates that no timeout alarm is required for this stream */
         it->second.readInProgress = false;
     }
-    lock.Unlock();
+    lock.Unlock(MUTEX_CONTEXT);
 
     Thread::Alert();
     /* Dont need to wait for the IODispatch::Run thread to reload
@@ -538,10 +538,10 @@ QStatus IODispatch::EnableReadCallback(const Source* source, uint32_t timeout)
 }
 QStatus IODispatch::EnableTimeoutCallback(const Source* source, uint32_t timeout)
 {
-    lock.Lock();
+    lock.Lock(MUTEX_CONTEXT);
     /* Dont attempt to modify an entry if the IODispatch is shutting down */
     if (!isRunning) {
-        lock.Unlock();
+        lock.Unlock(MUTEX_CONTEXT);
         return ER_BUS_STOPPING;
     }
 
@@ -549,7 +549,7 @@ QStatus IODispatch::EnableTimeoutCallback(const Source* source, uint32_t timeout
     map<Stream*, IODispatchEntry>::iterator it = dispatchEntries.find(lookup);
     /* Ensure stream is valid and still running */
     if (it == dispatchEntries.end() || (it->second.stopping_state != IO_RUNNING)) {
-        lock.Unlock();
+        lock.Unlock(MUTEX_CONTEXT);
         return ER_INVALID_STREAM;
     }
 
@@ -574,9 +574,9 @@ QStatus IODispatch::EnableTimeoutCallback(const Source* source, uint32_t timeout
             if (status != ER_TIMER_FULL) {
                 break;
             }
-            lock.Unlock();
+            lock.Unlock(MUTEX_CONTEXT);
             qcc::Sleep(2);
-            lock.Lock();
+            lock.Lock(MUTEX_CONTEXT);
             it = dispatchEntries.find(lookup);
         }
     } else {
@@ -584,15 +584,15 @@ QStatus IODispatch::EnableTimeoutCallback(const Source* source, uint32_t timeout
         timer.RemoveAlarm(prevAlarm, false);
 
     }
-    lock.Unlock();
+    lock.Unlock(MUTEX_CONTEXT);
     return ER_OK;
 }
 QStatus IODispatch::DisableReadCallback(const Source* source)
 {
-    lock.Lock();
+    lock.Lock(MUTEX_CONTEXT);
     /* Dont attempt to modify an entry if the IODispatch is shutting down */
     if (!isRunning) {
-        lock.Unlock();
+        lock.Unlock(MUTEX_CONTEXT);
         return ER_BUS_STOPPING;
     }
 
@@ -600,11 +600,11 @@ QStatus IODispatch::DisableReadCallback(const Source* source)
     map<Stream*, IODispatchEntry>::iterator it = dispatchEntries.find(lookup);
     /* Ensure stream is valid and still running */
     if (it == dispatchEntries.end() || (it->second.stopping_state != IO_RUNNING)) {
-        lock.Unlock();
+        lock.Unlock(MUTEX_CONTEXT);
         return ER_INVALID_STREAM;
     }
     it->second.readEnable = false;
-    lock.Unlock();
+    lock.Unlock(MUTEX_CONTEXT);
     Thread::Alert();
     /* Wait until the IODispatch::Run thread reloads the set of check events
      * since we are disabling read.
@@ -617,10 +617,10 @@ QStatus IODispatch::DisableReadCallback(const Source* source)
 
 QStatus IODispatch::EnableWriteCallbackNow(Sink* sink)
 {
-    lock.Lock();
+    lock.Lock(MUTEX_CONTEXT);
     /* Dont attempt to modify an entry if the IODispatch is shutting down */
     if (!isRunning) {
-        lock.Unlock();
+        lock.Unlock(MUTEX_CONTEXT);
         return ER_BUS_STOPPING;
     }
 
@@ -628,11 +628,11 @@ QStatus IODispatch::EnableWriteCallbackNow(Sink* sink)
     map<Stream*, IODispatchEntry>::iterator it = dispatchEntries.find(lookup);
     /* Ensure stream is valid and still running */
     if (it == dispatchEntries.end() || (it->second.stopping_state != IO_RUNNING)) {
-        lock.Unlock();
+        lock.Unlock(MUTEX_CONTEXT);
         return ER_INVALID_STREAM;
     }
     if (it->second.writeEnable) {
-        lock.Unlock();
+        lock.Unlock(MUTEX_CONTEXT);
         return ER_OK;
     }
     it->second.writeEnable = true;
@@ -653,22 +653,22 @@ QStatus IODispatch::EnableWriteCallbackNow(Sink* sink)
         it->second.writeInProgress = false;
         Thread::Alert();
     }
-    lock.Unlock();
+    lock.Unlock(MUTEX_CONTEXT);
     return ER_OK;
 }
 QStatus IODispatch::EnableWriteCallback(Sink* sink, uint32_t timeout)
 {
-    lock.Lock();
+    lock.Lock(MUTEX_CONTEXT);
     /* Dont attempt to modify an entry if the IODispatch is shutting down */
     if (!isRunning) {
-        lock.Unlock();
+        lock.Unlock(MUTEX_CONTEXT);
         return ER_BUS_STOPPING;
     }
 
     Stream* lookup = (Stream*)sink;
     map<Stream*, IODispatchEntry>::iterator it = dispatchEntries.find(lookup);
     if (it == dispatchEntries.end() || (it->second.stopping_state != IO_RUNNING)) {
-        lock.Unlock();
+        lock.Unlock(MUTEX_CONTEXT);
         return ER_INVALID_STREAM;
     }
 
@@ -682,9 +682,9 @@ QStatus IODispatch::EnableWriteCallback(Sink* sink, uint32_t timeout)
         it->second.writeAlarm = Alarm(when, listener, it->second.writeTimeoutCtxt);
 
         Alarm writeAlarm = it->second.writeAlarm;
-        lock.Unlock();
+        lock.Unlock(MUTEX_CONTEXT);
         timer.AddAlarm(writeAlarm);
-        lock.Lock();
+        lock.Lock(MUTEX_CONTEXT);
         it = dispatchEntries.find(lookup);
         if (it != dispatchEntries.end()) {
             it->second.writeInProgress = false;
@@ -692,7 +692,7 @@ QStatus IODispatch::EnableWriteCallback(Sink* sink, uint32_t timeout)
     } else {
         it->second.writeInProgress = false;
     }
-    lock.Unlock();
+    lock.Unlock(MUTEX_CONTEXT);
     Thread::Alert();
 
     /* Dont need to wait for the IODispatch::Run thread to reload
@@ -702,22 +702,22 @@ QStatus IODispatch::EnableWriteCallback(Sink* sink, uint32_t timeout)
 }
 QStatus IODispatch::DisableWriteCallback(const Sink* sink)
 {
-    lock.Lock();
+    lock.Lock(MUTEX_CONTEXT);
     /* Dont attempt to modify an entry if the IODispatch is shutting down */
     if (!isRunning) {
-        lock.Unlock();
+        lock.Unlock(MUTEX_CONTEXT);
         return ER_BUS_STOPPING;
     }
 
     Stream* lookup = (Stream*)sink;
     map<Stream*, IODispatchEntry>::iterator it = dispatchEntries.find(lookup);
     if (it == dispatchEntries.end() || (it->second.stopping_state != IO_RUNNING)) {
-        lock.Unlock();
+        lock.Unlock(MUTEX_CONTEXT);
         return ER_INVALID_STREAM;
     }
     it->second.writeEnable = false;
 
-    lock.Unlock();
+    lock.Unlock(MUTEX_CONTEXT);
     Thread::Alert();
     /* Wait until the IODispatch::Run thread reloads the set of check events
      * since we are disabling write.
@@ -0,0 +1,209 @@
+/**
+ * @file
+ *
+ * Shared, process wide storage for frequently repeated names.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <string.h>
+
+#include <qcc/atomic.h>
+#include <qcc/Epoch.h>
+#include <qcc/InternedString.h>
+#include <qcc/Mutex.h>
+
+#define QCC_MODULE "INTERN"
+
+/** Number of independently locked parts of the table */
+#define NUM_SHARDS 16
+
+/** Initial number of hash buckets per shard */
+#define INITIAL_BUCKETS 64
+
+namespace qcc {
+
+struct InternedStringEntry {
+    InternedStringEntry(const StringRef& str, size_t hash) : str(str.ToString()), hash(hash) { }
+    const qcc::String str;
+    const size_t hash;
+};
+
+/*
+ * Each shard is a chained hash table.  Readers walk the chains inside an epoch
+ * without locking; a writer holding the shard lock pushes new nodes onto the
+ * front of a chain.  When the table gets full the writer builds a larger copy
+ * with new nodes and publishes it, and the old one is retired.  The entries
+ * themselves are never freed, which is what makes the handles stable.
+ */
+struct InternNode {
+    const InternedStringEntry* entry;
+    InternNode* next;
+};
+
+struct InternBuckets {
+    InternBuckets(size_t numBuckets) : mask(numBuckets - 1), count(0), heads(new InternNode*[numBuckets])
+    {
+        ::memset(heads, 0, numBuckets * sizeof(InternNode*));
+    }
+
+    ~InternBuckets()
+    {
+        for (size_t i = 0; i <= mask; ++i) {
+            InternNode* node = heads[i];
+            while (node) {
+                InternNode* next = node->next;
+                delete node;
+                node = next;
+            }
+        }
+        delete [] heads;
+    }
+
+    InternNode* volatile& Head(size_t hash) { return const_cast<InternNode * volatile&>(heads[Index(hash)]); }
+
+    const InternNode* First(size_t hash) const { return AtomicLoad(&heads[Index(hash)], MEMORY_ORDER_ACQUIRE); }
+
+    size_t Index(size_t hash) const { return (hash ^ (hash >> 16)) & mask; }
+
+    const size_t mask;
+    size_t count;
+    InternNode** heads;
+};
+
+struct InternShard {
+    InternShard() : buckets(new InternBuckets(INITIAL_BUCKETS)) { }
+    Mutex lock;                     /* Serializes writers */
+    RcuPtr<InternBuckets> buckets;
+    char pad[QCC_CACHE_LINE_SIZE];  /* Keeps shards off each other's cache lines */
+};
+
+static InternShard* volatile shards = NULL;
+static volatile int32_t numInterned = 0;
+
+/*
+ * The shards are created on first use so that strings can be interned during
+ * static initialization.  They live as long as the process.
+ */
+static InternShard* GetShards()
+{
+    InternShard* s = AtomicLoad(&shards, MEMORY_ORDER_ACQUIRE);
+    if (!s) {
+        InternShard* fresh = new InternShard[NUM_SHARDS];
+        if (AtomicCompareExchange(&shards, s, fresh, MEMORY_ORDER_ACQ_REL)) {
+            s = fresh;
+        } else {
+            delete [] fresh;
+        }
+    }
+    return s;
+}
+
+static const InternedStringEntry* FindEntry(const InternBuckets* buckets, const StringRef& str, size_t hash)
+{
+    for (const InternNode* node = buckets->First(hash); node; node = node->next) {
+        if ((node->entry->hash == hash) && (str == node->entry->str)) {
+            return node->entry;
+        }
+    }
+    return NULL;
+}
+
+static void Insert(InternBuckets* buckets, const InternedStringEntry* entry)
+{
+    InternNode* node = new InternNode;
+    node->entry = entry;
+    node->next = buckets->Head(entry->hash);
+    AtomicStore(&buckets->Head(entry->hash), node, MEMORY_ORDER_RELEASE);
+    ++buckets->count;
+}
+
+static const InternedStringEntry* Intern(const StringRef& str, bool add)
+{
+    if (str.empty()) {
+        return NULL;
+    }
+    size_t hash = str.hash();
+    InternShard& shard = GetShards()[(static_cast<uint32_t>(hash) * 0x9E3779B9U) >> 28];
+    {
+        ScopedEpoch epoch;
+        const InternedStringEntry* entry = FindEntry(shard.buckets.Get(), str, hash);
+        if (entry || !add) {
+            return entry;
+        }
+    }
+
+    shard.lock.Lock(MUTEX_CONTEXT);
+    /* Only writers change the table and we are the writer now */
+    InternBuckets* buckets = const_cast<InternBuckets*>(shard.buckets.Get());
+    const InternedStringEntry* entry = FindEntry(buckets, str, hash);
+    if (!entry) {
+        if (buckets->count > buckets->mask) {
+            InternBuckets* bigger = new InternBuckets(2 * (buckets->mask + 1));
+            for (size_t i = 0; i <= buckets->mask; ++i) {
+                for (const InternNode* node = buckets->heads[i]; node; node = node->next) {
+                    Insert(bigger, node->entry);
+                }
+            }
+            shard.buckets.Publish(bigger);
+            buckets = bigger;
+        }
+        entry = new InternedStringEntry(str, hash);
+        Insert(buckets, entry);
+        IncrementAndFetch(&numInterned);
+    }
+    shard.lock.Unlock(MUTEX_CONTEXT);
+    return entry;
+}
+
+InternedString::InternedString(const StringRef& str) : entry(Intern(str, true))
+{
+}
+
+InternedString::InternedString(const qcc::String& str) : entry(Intern(str, true))
+{
+}
+
+InternedString::InternedString(const char* str) : entry(Intern(str, true))
+{
+}
+
+InternedString InternedString::Lookup(const StringRef& str)
+{
+    InternedString handle;
+    handle.entry = Intern(str, false);
+    return handle;
+}
+
+size_t InternedString::Count()
+{
+    return static_cast<size_t>(AtomicLoad(&numInterned));
+}
+
+const qcc::String& InternedString::str() const
+{
+    return entry ? entry->str : String::Empty;
+}
+
+size_t InternedString::hash() const
+{
+    return entry ? entry->hash : 0;
+}
+
+}
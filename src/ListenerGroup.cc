@@ -0,0 +1,103 @@
+/**
+ * @file
+ *
+ * A group of listening sockets sharing one address and port.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <qcc/Debug.h>
+#include <qcc/ListenerGroup.h>
+#include <qcc/Socket.h>
+#include <qcc/SocketStream.h>
+
+#include <Status.h>
+
+#define QCC_MODULE "NETWORK"
+
+using namespace qcc;
+
+QStatus ListenerGroup::Listen(AddressFamily family, const IPAddress& addr, uint16_t localPort, size_t count, int backlog, bool steerByCpu)
+{
+    QCC_DbgTrace(("ListenerGroup::Listen(family = %d, addr = %s, port = %u, count = %u)",
+                  family, addr.ToString().c_str(), localPort, static_cast<uint32_t>(count)));
+
+    if (count == 0) {
+        return ER_BAD_ARG_4;
+    }
+    if (!listeners.empty()) {
+        return ER_FAIL;
+    }
+
+    /*
+     * The sockets join the SO_REUSEPORT group in the order they start
+     * listening, which is the order CPU steering indexes them in.
+     */
+    QStatus status = ER_OK;
+    port = localPort;
+    for (size_t i = 0; (status == ER_OK) && (i < count); ++i) {
+        SocketFd sockfd;
+        status = Socket(family, QCC_SOCK_STREAM, sockfd);
+        if (status != ER_OK) {
+            QCC_LogError(status, ("ListenerGroup: Socket failed"));
+            break;
+        }
+        listeners.push_back(new SocketStream(sockfd));
+        status = SetReusePort(sockfd, true);
+        if (status == ER_OK) {
+            status = Bind(sockfd, addr, port);
+        }
+        if ((status == ER_OK) && (port == 0)) {
+            IPAddress boundAddr;
+            status = GetLocalAddress(sockfd, boundAddr, port);
+        }
+        if (status == ER_OK) {
+            status = qcc::Listen(sockfd, backlog);
+        }
+        if (status == ER_OK) {
+            status = SetBlocking(sockfd, false);
+        }
+        if (status != ER_OK) {
+            QCC_LogError(status, ("ListenerGroup: Listener %u on %s port %u failed",
+                                  static_cast<uint32_t>(i), addr.ToString().c_str(), port));
+        }
+    }
+
+    if (status != ER_OK) {
+        Close();
+        return status;
+    }
+
+    if (steerByCpu) {
+        QStatus steerStatus = SetReusePortCpuSteering(listeners[0]->GetSocketFd(), static_cast<uint32_t>(count));
+        if (steerStatus != ER_OK) {
+            QCC_LogError(steerStatus, ("ListenerGroup: CPU steering not available, using the default distribution"));
+        }
+    }
+    return ER_OK;
+}
+
+void ListenerGroup::Close()
+{
+    for (size_t i = 0; i < listeners.size(); ++i) {
+        delete listeners[i];
+    }
+    listeners.clear();
+    port = 0;
+}
@@ -0,0 +1,216 @@
+/**
+ * @file
+ *
+ * Per call site lock contention statistics.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <qcc/platform.h>
+
+#include <algorithm>
+#include <map>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(QCC_OS_DARWIN)
+#include <mach/mach_time.h>
+#elif defined(QCC_OS_GROUP_POSIX)
+#include <time.h>
+#elif defined(QCC_OS_GROUP_WINDOWS) || defined(QCC_OS_GROUP_WINRT)
+#include <windows.h>
+#endif
+
+#include <qcc/FastMutex.h>
+#include <qcc/LockProfiler.h>
+
+/*
+ * Nothing in here may lock a qcc::Mutex (or log, which does) since this is
+ * called from inside Mutex.
+ */
+
+/** Number of independently locked parts of the statistics table */
+#define NUM_STRIPES 64
+
+namespace qcc {
+
+volatile bool LockProfiler::enabled = false;
+
+typedef std::pair<const char*, uint32_t> SiteKey;
+
+struct Stripe {
+    FastMutex lock;
+    std::map<SiteKey, LockProfiler::SiteStats> sites;
+};
+
+/*
+ * Allocated once and never freed so that Mutexes used during static
+ * destruction cannot find it gone.
+ */
+static Stripe* stripes = new Stripe[NUM_STRIPES];
+
+static Stripe& GetStripe(const char* file, uint32_t line)
+{
+    size_t hash = (reinterpret_cast<size_t>(file) >> 3) * 31 + line;
+    return stripes[hash % NUM_STRIPES];
+}
+
+static LockProfiler::SiteStats& GetSite(Stripe& stripe, const char* file, uint32_t line)
+{
+    std::map<SiteKey, LockProfiler::SiteStats>::iterator it = stripe.sites.find(SiteKey(file, line));
+    if (it == stripe.sites.end()) {
+        LockProfiler::SiteStats stats;
+        memset(&stats, 0, sizeof(stats));
+        stats.file = file;
+        stats.line = line;
+        it = stripe.sites.insert(std::make_pair(SiteKey(file, line), stats)).first;
+    }
+    return it->second;
+}
+
+static uint32_t WaitBucket(uint64_t waitNs)
+{
+    uint64_t us = waitNs / 1000;
+    uint32_t bucket = 0;
+    while (us && (bucket < LockProfiler::WAIT_BUCKETS - 1)) {
+        us >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+uint64_t LockProfiler::Now()
+{
+#if defined(QCC_OS_DARWIN)
+    static mach_timebase_info_data_t timebase;
+    if (timebase.denom == 0) {
+        mach_timebase_info(&timebase);
+    }
+    return mach_absolute_time() * timebase.numer / timebase.denom;
+#elif defined(QCC_OS_GROUP_POSIX)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#else
+    static LARGE_INTEGER frequency;
+    if (frequency.QuadPart == 0) {
+        QueryPerformanceFrequency(&frequency);
+    }
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return static_cast<uint64_t>(counter.QuadPart / frequency.QuadPart) * 1000000000 +
+           static_cast<uint64_t>(counter.QuadPart % frequency.QuadPart) * 1000000000 / frequency.QuadPart;
+#endif
+}
+
+void LockProfiler::Acquired(const char* file, uint32_t line, bool contended, uint64_t waitNs)
+{
+    Stripe& stripe = GetStripe(file, line);
+    stripe.lock.Lock();
+    SiteStats& site = GetSite(stripe, file, line);
+    ++site.acquisitions;
+    if (contended) {
+        ++site.contentions;
+        site.totalWaitNs += waitNs;
+        site.maxWaitNs = std::max(site.maxWaitNs, waitNs);
+        ++site.waitHistogram[WaitBucket(waitNs)];
+    }
+    stripe.lock.Unlock();
+}
+
+void LockProfiler::Released(const char* file, uint32_t line, uint64_t holdNs)
+{
+    Stripe& stripe = GetStripe(file, line);
+    stripe.lock.Lock();
+    SiteStats& site = GetSite(stripe, file, line);
+    site.totalHoldNs += holdNs;
+    site.maxHoldNs = std::max(site.maxHoldNs, holdNs);
+    stripe.lock.Unlock();
+}
+
+void LockProfiler::Reset()
+{
+    for (size_t i = 0; i < NUM_STRIPES; ++i) {
+        stripes[i].lock.Lock();
+        stripes[i].sites.clear();
+        stripes[i].lock.Unlock();
+    }
+}
+
+static bool Hotter(const LockProfiler::SiteStats& a, const LockProfiler::SiteStats& b)
+{
+    if (a.totalWaitNs != b.totalWaitNs) {
+        return a.totalWaitNs > b.totalWaitNs;
+    }
+    return a.contentions > b.contentions;
+}
+
+void LockProfiler::GetStats(std::vector<SiteStats>& stats)
+{
+    stats.clear();
+    for (size_t i = 0; i < NUM_STRIPES; ++i) {
+        stripes[i].lock.Lock();
+        std::map<SiteKey, SiteStats>::const_iterator it;
+        for (it = stripes[i].sites.begin(); it != stripes[i].sites.end(); ++it) {
+            stats.push_back(it->second);
+        }
+        stripes[i].lock.Unlock();
+    }
+    std::sort(stats.begin(), stats.end(), Hotter);
+}
+
+qcc::String LockProfiler::Dump(size_t maxSites)
+{
+    std::vector<SiteStats> stats;
+    GetStats(stats);
+
+    char buf[256];
+    qcc::String out("Lock contention by call site (times in us):\n");
+    snprintf(buf, sizeof(buf), "%-40s %10s %10s %12s %10s %12s %10s\n",
+             "site", "acquired", "contended", "wait total", "wait max", "hold total", "hold max");
+    out += buf;
+    for (size_t i = 0; (i < stats.size()) && (i < maxSites); ++i) {
+        const SiteStats& s = stats[i];
+        const char* base = strrchr(s.file, '/');
+        base = base ? base + 1 : s.file;
+        char site[64];
+        snprintf(site, sizeof(site), "%s:%u", base, s.line);
+        snprintf(buf, sizeof(buf), "%-40s %10llu %10llu %12llu %10llu %12llu %10llu\n", site,
+                 (unsigned long long)s.acquisitions, (unsigned long long)s.contentions,
+                 (unsigned long long)(s.totalWaitNs / 1000), (unsigned long long)(s.maxWaitNs / 1000),
+                 (unsigned long long)(s.totalHoldNs / 1000), (unsigned long long)(s.maxHoldNs / 1000));
+        out += buf;
+        if (s.contentions) {
+            out += "    waits:";
+            for (uint32_t b = 0; b < WAIT_BUCKETS; ++b) {
+                if (s.waitHistogram[b]) {
+                    if (b == 0) {
+                        snprintf(buf, sizeof(buf), " <1us:%llu", (unsigned long long)s.waitHistogram[b]);
+                    } else if (b == WAIT_BUCKETS - 1) {
+                        snprintf(buf, sizeof(buf), " >=%uus:%llu", 1U << (b - 1), (unsigned long long)s.waitHistogram[b]);
+                    } else {
+                        snprintf(buf, sizeof(buf), " <%uus:%llu", 1U << b, (unsigned long long)s.waitHistogram[b]);
+                    }
+                    out += buf;
+                }
+            }
+            out += "\n";
+        }
+    }
+    return out;
+}
+
+}
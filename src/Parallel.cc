@@ -0,0 +1,89 @@
+/**
+ * @file
+ *
+ * Data-parallel loops executed on a ThreadPool
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/Parallel.h>
+#include <qcc/Thread.h>
+#include <qcc/Debug.h>
+
+#define QCC_MODULE "PARALLEL"
+
+/*
+ * When no grain is given, cut the range into this many chunks per thread that
+ * can work on the loop.  More chunks balance uneven work better; fewer chunks
+ * mean less claiming.
+ */
+#define CHUNKS_PER_THREAD 4
+
+namespace qcc {
+
+_ParallelLoop::_ParallelLoop(size_t begin, size_t end, size_t grain, uint32_t concurrency)
+    : m_begin(begin), m_end(end), m_grain(grain), m_numChunks(0), m_numHelpers(0), m_next(0), m_completed(0)
+{
+    size_t n = end - begin;
+
+    /*
+     * The calling thread joins in, so concurrency + 1 threads may work on the
+     * loop.
+     */
+    size_t threads = static_cast<size_t>(concurrency) + 1;
+    if (m_grain == 0) {
+        m_grain = n / (threads * CHUNKS_PER_THREAD);
+        if (m_grain == 0) {
+            m_grain = 1;
+        }
+    }
+
+    /*
+     * The chunk counter is an int32_t.  Huge ranges just get bigger chunks.
+     */
+    size_t numChunks = (n + m_grain - 1) / m_grain;
+    while (numChunks > 0x3FFFFFFF) {
+        m_grain *= 2;
+        numChunks = (n + m_grain - 1) / m_grain;
+    }
+    m_numChunks = static_cast<int32_t>(numChunks);
+
+    /*
+     * There is no point in asking for more helpers than there are chunks left
+     * once the calling thread has taken one.
+     */
+    m_numHelpers = (numChunks - 1 < concurrency) ? static_cast<uint32_t>(numChunks - 1) : concurrency;
+
+    QCC_DbgPrintf(("_ParallelLoop: %lu indices, grain %lu, %d chunks, %u helpers", (unsigned long)n, (unsigned long)m_grain, m_numChunks, m_numHelpers));
+}
+
+void _ParallelLoop::Wait()
+{
+    /*
+     * Helpers may still be working on the chunks they claimed and those refer
+     * to state on our caller's stack, so we cannot return before they are
+     * done, even if this thread is being stopped or alerted.
+     */
+    while (m_completed != m_numChunks) {
+        QStatus status = Event::Wait(m_done);
+        if ((status != ER_OK) && (m_completed != m_numChunks)) {
+            qcc::Sleep(1);
+        }
+    }
+}
+
+} // namespace qcc
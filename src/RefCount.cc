@@ -0,0 +1,44 @@
+/**
+ * @file
+ *
+ * Reference count policies for ManagedObj and Ptr.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#if defined(QCC_OS_GROUP_WINDOWS) || defined(QCC_OS_GROUP_WINRT)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#include <qcc/RefCount.h>
+
+namespace qcc {
+
+uintptr_t SingleThreadRefCount::CurrentThread()
+{
+#if defined(QCC_OS_GROUP_WINDOWS) || defined(QCC_OS_GROUP_WINRT)
+    return static_cast<uintptr_t>(GetCurrentThreadId());
+#else
+    return (uintptr_t)pthread_self();
+#endif
+}
+
+}
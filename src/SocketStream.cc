@@ -22,10 +22,17 @@
 
 #include <qcc/platform.h>
 
+#include <deque>
+#include <vector>
+
+#include <qcc/Debug.h>
+#include <qcc/Mutex.h>
 #include <qcc/Socket.h>
 #include <qcc/SocketStream.h>
 #include <qcc/Stream.h>
 #include <qcc/String.h>
+#include <qcc/Thread.h>
+#include <qcc/time.h>
 
 #include <Status.h>
 
@@ -35,6 +42,37 @@ using namespace qcc;
 #define QCC_MODULE "NETWORK"
 
 
+/*
+ * The buffers of zero copy sends in the order they were sent.  The kernel
+ * numbers the sends and reports ranges of them complete, normally in order.
+ */
+struct SocketStream::ZeroCopySends {
+    struct Send {
+        const void* buf;
+        size_t len;
+        bool released;
+        Send(const void* buf, size_t len) : buf(buf), len(len), released(false) { }
+    };
+
+    /** A buffer to return to the listener once the lock is released */
+    struct Release {
+        const void* buf;
+        size_t len;
+        bool copied;
+        Release(const void* buf, size_t len, bool copied) : buf(buf), len(len), copied(copied) { }
+    };
+
+    ZeroCopySends(size_t threshold, ZeroCopyListener* listener, uint32_t closeTimeout) :
+        threshold(threshold), listener(listener), closeTimeout(closeTimeout), firstSeq(0) { }
+
+    Mutex lock;
+    const size_t threshold;
+    ZeroCopyListener* listener;
+    const uint32_t closeTimeout;    /* Longest wait for outstanding sends on destruction */
+    uint32_t firstSeq;              /* Number of the send at the front of sends */
+    std::deque<Send> sends;
+};
+
 static int MakeSock(AddressFamily family, SocketType type)
 {
     SocketFd sock = static_cast<SocketFd>(-1);
@@ -58,7 +96,10 @@ SocketStream::SocketStream(SocketFd sock) :
     sock(sock),
     sourceEvent(new Event(sock, Event::IO_READ, false)),
     sinkEvent(new Event(*sourceEvent, Event::IO_WRITE, false)),
-    isDetached(false)
+    isDetached(false),
+    corkWrites(false),
+    zeroCopy(NULL),
+    bufferReusers(0)
 {
 }
 
@@ -68,8 +109,39 @@ SocketStream::SocketStream(AddressFamily family, SocketType type) :
     sock(MakeSock(family, type)),
     sourceEvent(new Event(sock, Event::IO_READ, false)),
     sinkEvent(new Event(*sourceEvent, Event::IO_WRITE, false)),
-    isDetached(false)
+    isDetached(false),
+    corkWrites(false),
+    zeroCopy(NULL),
+    bufferReusers(0)
+{
+}
+
+SocketStream::SocketStream(SocketFd sock, const SocketOptions& options) :
+    isConnected(true),
+    sock(sock),
+    sourceEvent(new Event(sock, Event::IO_READ, false)),
+    sinkEvent(new Event(*sourceEvent, Event::IO_WRITE, false)),
+    isDetached(false),
+    corkWrites(options.corkBufferedWrites),
+    zeroCopy(NULL),
+    bufferReusers(0)
+{
+    SetSocketOptions(sock, options);
+}
+
+SocketStream::SocketStream(AddressFamily family, SocketType type, const SocketOptions& options) :
+    isConnected(false),
+    sock(MakeSock(family, type)),
+    sourceEvent(new Event(sock, Event::IO_READ, false)),
+    sinkEvent(new Event(*sourceEvent, Event::IO_WRITE, false)),
+    isDetached(false),
+    corkWrites(options.corkBufferedWrites),
+    zeroCopy(NULL),
+    bufferReusers(0)
 {
+    if (sock != static_cast<SocketFd>(-1)) {
+        SetSocketOptions(sock, options);
+    }
 }
 
 SocketStream::SocketStream(const SocketStream& other) :
@@ -77,7 +149,10 @@ SocketStream::SocketStream(const SocketStream& other) :
     sock(CopySock(other.sock)),
     sourceEvent(new Event(sock, Event::IO_READ, false)),
     sinkEvent(new Event(*sourceEvent, Event::IO_WRITE, false)),
-    isDetached(other.isDetached)
+    isDetached(other.isDetached),
+    corkWrites(other.corkWrites),
+    zeroCopy(NULL),
+    bufferReusers(0)
 {
 }
 
@@ -95,6 +170,7 @@ SocketStream SocketStream::operator=(const SocketStream& other)
         delete sinkEvent;
         sinkEvent = new Event(*sourceEvent, Event::IO_WRITE, false);
         isDetached = other.isDetached;
+        corkWrites = other.corkWrites;
         sendTimeout = other.sendTimeout;
     }
 
@@ -103,6 +179,11 @@ SocketStream SocketStream::operator=(const SocketStream& other)
 
 SocketStream::~SocketStream()
 {
+    if (zeroCopy) {
+        DrainZeroCopySends();
+        delete zeroCopy;
+        zeroCopy = NULL;
+    }
     /*
      * Must delete the events before closing the socket they monitor
      */
@@ -153,6 +234,141 @@ void SocketStream::Close()
     }
 }
 
+QStatus SocketStream::Cork()
+{
+    return corkWrites ? SetCork(sock, true) : ER_NOT_IMPLEMENTED;
+}
+
+QStatus SocketStream::Uncork()
+{
+    return corkWrites ? SetCork(sock, false) : ER_OK;
+}
+
+QStatus SocketStream::EnableZeroCopy(size_t threshold, ZeroCopyListener* listener, uint32_t closeTimeout)
+{
+    if (zeroCopy) {
+        return ER_FAIL;
+    }
+    if (bufferReusers > 0) {
+        QCC_LogError(ER_FAIL, ("Zero copy cannot be enabled while a wrapper reuses the buffers it pushes"));
+        return ER_FAIL;
+    }
+    QStatus status = SetZeroCopy(sock, true);
+    if (status == ER_OK) {
+        zeroCopy = new ZeroCopySends(threshold, listener, closeTimeout);
+    }
+    return status;
+}
+
+void SocketStream::SetBufferReuse(bool reused)
+{
+    if (reused) {
+        ++bufferReusers;
+        if (zeroCopy) {
+            QCC_DbgHLPrintf(("SocketStream: wrapper reuses pushed buffers, zero copy sends suspended"));
+        }
+    } else {
+        --bufferReusers;
+    }
+}
+
+/*
+ * The kernel keeps sending from the buffers of outstanding zero copy sends
+ * after the socket is closed, and their completions can no longer be read
+ * then.  So stop sending, which also flushes anything corked, and wait a
+ * bounded time for the completions.  Buffers still outstanding after that are
+ * never given back, the kernel may still be reading them.
+ */
+void SocketStream::DrainZeroCopySends()
+{
+    ProcessZeroCopyCompletions();
+    if (GetZeroCopyPending() == 0) {
+        return;
+    }
+    if (!isDetached) {
+        ShutdownSend(sock);
+    }
+    uint64_t deadline = GetTimestamp64() + zeroCopy->closeTimeout;
+    size_t pending;
+    while ((pending = GetZeroCopyPending()) > 0) {
+        uint64_t now = GetTimestamp64();
+        if (now >= deadline) {
+            QCC_LogError(ER_TIMEOUT, ("SocketStream: %u zero copy sends still outstanding, leaking their buffers",
+                                      static_cast<uint32_t>(pending)));
+            break;
+        }
+        QStatus status = WaitForZeroCopyCompletion(sock, static_cast<uint32_t>(deadline - now));
+        if (ProcessZeroCopyCompletions() != ER_OK) {
+            break;
+        }
+        if ((status == ER_OK) || (status == ER_TIMEOUT)) {
+            continue;
+        }
+        /*
+         * A hangup is reported again on every wait, so keep going only while
+         * completions are still coming in.
+         */
+        if ((status == ER_SOCK_OTHER_END_CLOSED) && (GetZeroCopyPending() < pending)) {
+            continue;
+        }
+        QCC_LogError(status, ("SocketStream: connection ended with %u zero copy sends outstanding, leaking their buffers",
+                              static_cast<uint32_t>(GetZeroCopyPending())));
+        break;
+    }
+}
+
+QStatus SocketStream::ProcessZeroCopyCompletions()
+{
+    if (!zeroCopy) {
+        return ER_OK;
+    }
+    std::vector<ZeroCopySends::Release> released;
+    QStatus status;
+    zeroCopy->lock.Lock(MUTEX_CONTEXT);
+    while (true) {
+        uint32_t first, last;
+        bool copied;
+        status = GetZeroCopyCompletion(sock, first, last, copied);
+        if (status != ER_OK) {
+            break;
+        }
+        /* The numbers are 32 bits and wrap, so work with offsets from the front */
+        uint32_t begin = first - zeroCopy->firstSeq;
+        uint32_t end = last - zeroCopy->firstSeq;
+        for (uint32_t i = begin; (i <= end) && (i < zeroCopy->sends.size()); ++i) {
+            ZeroCopySends::Send& send = zeroCopy->sends[i];
+            if (!send.released) {
+                send.released = true;
+                released.push_back(ZeroCopySends::Release(send.buf, send.len, copied));
+            }
+        }
+        while (!zeroCopy->sends.empty() && zeroCopy->sends.front().released) {
+            zeroCopy->sends.pop_front();
+            ++zeroCopy->firstSeq;
+        }
+    }
+    zeroCopy->lock.Unlock(MUTEX_CONTEXT);
+
+    for (size_t i = 0; i < released.size(); ++i) {
+        zeroCopy->listener->BufferReleased(released[i].buf, released[i].len, released[i].copied);
+    }
+    return (status == ER_WOULDBLOCK) ? ER_OK : status;
+}
+
+size_t SocketStream::GetZeroCopyPending()
+{
+    if (!zeroCopy) {
+        return 0;
+    }
+    zeroCopy->lock.Lock(MUTEX_CONTEXT);
+    size_t pending = 0;
+    for (size_t i = 0; i < zeroCopy->sends.size(); ++i) {
+        pending += zeroCopy->sends[i].released ? 0 : 1;
+    }
+    zeroCopy->lock.Unlock(MUTEX_CONTEXT);
+    return pending;
+}
+
 QStatus SocketStream::PullBytes(void* buf, size_t reqBytes, size_t& actualBytes, uint32_t timeout)
 {
     if (reqBytes == 0) {
@@ -166,6 +382,8 @@ QStatus SocketStream::PullBytes(void* buf, size_t reqBytes, size_t& actualBytes,
         }
         status = Recv(sock, buf, reqBytes, actualBytes);
         if (ER_WOULDBLOCK == status) {
+            /* Zero copy completions signal the source event too */
+            ProcessZeroCopyCompletions();
             status = Event::Wait(*sourceEvent, timeout);
             if (ER_OK != status) {
                 break;
@@ -200,6 +418,8 @@ QStatus SocketStream::PullBytesAndFds(void* buf, size_t reqBytes, size_t& actual
             status = RecvWithFds(sock, buf, reqBytes, actualBytes, fdList, numFds, recvdFds);
         }
         if (ER_WOULDBLOCK == status) {
+            /* Zero copy completions signal the source event too */
+            ProcessZeroCopyCompletions();
             status = Event::Wait(*sourceEvent, timeout);
             if (ER_OK != status) {
                 break;
@@ -228,8 +448,21 @@ QStatus SocketStream::PushBytes(const void* buf, size_t numBytes, size_t& numSen
         if (!isConnected) {
             return ER_WRITE_ERROR;
         }
-        status = qcc::Send(sock, buf, numBytes, numSent);
+        if (zeroCopy && (numBytes >= zeroCopy->threshold) && (bufferReusers == 0)) {
+            bool zeroCopied;
+            /* Hold the lock so the send is recorded before its completion can be processed */
+            zeroCopy->lock.Lock(MUTEX_CONTEXT);
+            status = SendZeroCopy(sock, buf, numBytes, numSent, zeroCopied);
+            if (zeroCopied) {
+                zeroCopy->sends.push_back(ZeroCopySends::Send(buf, numSent));
+            }
+            zeroCopy->lock.Unlock(MUTEX_CONTEXT);
+        } else {
+            status = qcc::Send(sock, buf, numBytes, numSent);
+        }
         if (ER_WOULDBLOCK == status) {
+            /* Zero copy completions signal the sink event too */
+            ProcessZeroCopyCompletions();
             if (sendTimeout == Event::WAIT_FOREVER) {
                 status = Event::Wait(*sinkEvent);
             } else {
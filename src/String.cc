@@ -21,37 +21,11 @@
  ******************************************************************************/
 #include <qcc/platform.h>
 #include <qcc/atomic.h>
+#include <qcc/Allocator.h>
 #include <qcc/String.h>
+#include <qcc/StringSearch.h>
 #include <new>
 
-#if defined(WIN32) || (defined(QCC_OS_DARWIN) && MAC_OS_X_VERSION_MAX_ALLOWED < 1070)
-/*
- * memmem not provided on Windows
- */
-static const void* memmem(const void* haystack, size_t haystacklen, const void* needle, size_t needlelen)
-{
-    if (!haystack || !needle) {
-        return haystack;
-    } else {
-        const char* h = (const char*)haystack;
-        const char* n = (const char*)needle;
-        size_t l = needlelen;
-        const char* r = h;
-        while (l && (l <= haystacklen)) {
-            if (*n++ != *h++) {
-                r = h;
-                n = (const char*)needle;
-                l = needlelen;
-            } else {
-                --l;
-            }
-            --haystacklen;
-        }
-        return l ? NULL : r;
-    }
-}
-#endif
-
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
 #define MAX(a, b) ((a) > (b) ? (a) : (b))
 
@@ -63,8 +37,19 @@ static const String* emptyString = new String();
 
 const String& String::Empty = *emptyString;
 
+const size_t String::InlineCapacity;
+
 String::ManagedCtx String::nullContext = { 0 };
 
+/*
+ * Heap contexts come from the current Allocator.  The index of that allocator
+ * is stored in the four bytes before the context so sizeof(String) does not
+ * change.
+ */
+static const size_t AllocatorPrefix = sizeof(uint32_t);
+
+static AllocStats stringStats = { "qcc::String", 0, 0, NULL };
+
 String::String()
 {
     context = &nullContext;
@@ -94,8 +79,7 @@ String::String(size_t n, char c, size_t sizeHint)
 
 String::String(const String& copyMe)
 {
-    context = copyMe.context;
-    IncRef();
+    CopyFrom(copyMe);
 }
 
 String::~String()
@@ -111,15 +95,24 @@ String& String::operator=(const String& assignFromMe)
         DecRef(context);
 
         /* Reassign this Managed Obj */
-        context = assignFromMe.context;
-
-        /* Increment the ref */
-        IncRef();
+        CopyFrom(assignFromMe);
     }
 
     return *this;
 }
 
+void String::CopyFrom(const String& other)
+{
+    if (other.IsInline()) {
+        /* Short strings are copied rather than shared */
+        inlineCtx = other.inlineCtx;
+        context = &inlineCtx.ctx;
+    } else {
+        context = other.context;
+        IncRef();
+    }
+}
+
 String& String::assign(const char* str, size_t len)
 {
     if (context == &nullContext) {
@@ -342,10 +335,10 @@ String& String::insert(size_t pos, const char* str, size_t strLen)
 
 size_t String::find(const char* str, size_t pos) const
 {
-    if (context == &nullContext) return npos;
+    if ((context == &nullContext) || (pos > context->offset)) return npos;
 
     const char* base = context->c_str;
-    const char* p = static_cast<const char*>(::memmem(base + pos, context->offset - pos, str, ::strlen(str)));
+    const char* p = StringSearch::Find(base + pos, context->offset - pos, str, ::strlen(str));
     return p ? p - base : npos;
 }
 
@@ -353,20 +346,19 @@ size_t String::find(const String& str, size_t pos) const
 {
     if (context == &nullContext) return npos;
     if (0 == str.size()) return 0;
+    if (pos > context->offset) return npos;
 
     const char* base = context->c_str;
-    const char* p = static_cast<const char*>(::memmem(base + pos,
-                                                      context->offset - pos,
-                                                      str.context->c_str,
-                                                      str.context->offset));
+    const char* p = StringSearch::Find(base + pos, context->offset - pos, str.context->c_str, str.context->offset);
     return p ? p - base : npos;
 }
 
 size_t String::find_first_of(const char c, size_t pos) const
 {
-    if (context == &nullContext) return npos;
+    if ((context == &nullContext) || (pos > context->offset)) return npos;
 
-    const char* ret = ::strchr(context->c_str + pos, (int) c);
+    /* Include the nul terminator so that searching for '\0' finds it */
+    const char* ret = static_cast<const char*>(::memchr(context->c_str + pos, c, context->offset - pos + 1));
     return ret ? (ret - context->c_str) : npos;
 }
 
@@ -374,72 +366,46 @@ size_t String::find_last_of(const char c, size_t pos) const
 {
     if (context == &nullContext) return npos;
 
-    size_t i = MIN(pos, size());
-    while (i-- > 0) {
-        if (c == context->c_str[i]) {
-            return i;
-        }
-    }
-    return npos;
+    size_t n = MIN(pos, size());
+    size_t i = StringSearch::FindLastOf(context->c_str, n, &c, 1);
+    return (i == n) ? npos : i;
 }
 
+/*
+ * The C library's strcspn() and strspn() beat the vector searches and the
+ * storage is always nul terminated.  They stop at an embedded nul too, which
+ * strcspn() has to search past.
+ */
 size_t String::find_first_of(const char* set, size_t pos) const
 {
-    if (context == &nullContext) return npos;
+    if ((context == &nullContext) || (pos >= context->offset)) return npos;
 
-    size_t i = pos;
-    size_t endIdx = size();
-    while (i < endIdx) {
-        for (const char* c = set; *c != '\0'; ++c) {
-            if (*c == context->c_str[i]) {
-                return i;
-            }
-        }
-        ++i;
+    const char* base = context->c_str;
+    size_t i = pos + ::strcspn(base + pos, set);
+    if ((i < context->offset) && (base[i] == '\0')) {
+        size_t n = context->offset - i - 1;
+        size_t j = StringSearch::FindFirstOf(base + i + 1, n, set, ::strlen(set));
+        return (j == n) ? npos : i + 1 + j;
     }
-    return npos;
+    return (i < context->offset) ? i : npos;
 }
 
 size_t String::find_first_not_of(const char* set, size_t pos) const
 {
-    if (context == &nullContext) return npos;
+    if ((context == &nullContext) || (pos >= context->offset)) return npos;
 
-    size_t i = pos;
-    size_t endIdx = size();
-    while (i < endIdx) {
-        bool found = false;
-        for (const char* c = set; *c != '\0'; ++c) {
-            if (*c == context->c_str[i]) {
-                found = true;
-                break;
-            }
-        }
-        if (!found) {
-            return i;
-        }
-        ++i;
-    }
-    return npos;
+    /* An embedded nul is never in set so it is the answer where strspn() stops */
+    size_t i = pos + ::strspn(context->c_str + pos, set);
+    return (i < context->offset) ? i : npos;
 }
 
 size_t String::find_last_not_of(const char* set, size_t pos) const
 {
     if (context == &nullContext) return npos;
 
-    size_t i = MIN(pos, size());
-    while (i-- > 0) {
-        bool found = false;
-        for (const char* c = set; *c != '\0'; ++c) {
-            if (*c == context->c_str[i]) {
-                found = true;
-                break;
-            }
-        }
-        if (!found) {
-            return i;
-        }
-    }
-    return npos;
+    size_t n = MIN(pos, size());
+    size_t i = StringSearch::FindLastOf(context->c_str, n, set, ::strlen(set), false);
+    return (i == n) ? npos : i;
 }
 
 String String::substr(size_t pos, size_t n) const
@@ -494,8 +460,27 @@ void String::NewContext(const char* str, size_t strLen, size_t sizeHint)
         strLen = ::strlen(str);
     }
     size_t capacity = MAX(MinCapacity, MAX(strLen, sizeHint));
-    size_t mallocSz = capacity + 1 + sizeof(ManagedCtx) - MinCapacity;
-    context = new (malloc(mallocSz))ManagedCtx();
+    if (capacity <= InlineCapacity) {
+        /*
+         * Use the inline buffer.  The caller may be moving the string within
+         * the inline buffer (e.g. when shrinking) so str may overlap it.
+         */
+        context = &inlineCtx.ctx;
+        context->refCount = 1;
+        context->capacity = static_cast<uint32_t>(InlineCapacity);
+        context->offset = static_cast<uint32_t>(strLen);
+        if (str) {
+            ::memmove(context->c_str, str, strLen);
+        }
+        context->c_str[strLen] = '\0';
+        return;
+    }
+    size_t mallocSz = AllocatorPrefix + capacity + 1 + sizeof(ManagedCtx) - MinCapacity;
+    uint16_t allocator;
+    char* block = static_cast<char*>(Allocator::AllocateBlock(mallocSz, allocator));
+    *reinterpret_cast<uint32_t*>(block) = allocator;
+    stringStats.Add(mallocSz, NULL);
+    context = new (block + AllocatorPrefix)ManagedCtx();
     context->refCount = 1;
 
     context->capacity = static_cast<uint32_t>(capacity);
@@ -509,7 +494,7 @@ void String::NewContext(const char* str, size_t strLen, size_t sizeHint)
 void String::IncRef()
 {
     /* Increment the ref count */
-    if (context != &nullContext) {
+    if ((context != &nullContext) && !IsInline()) {
         IncrementAndFetch(&context->refCount);
     }
 }
@@ -517,15 +502,18 @@ void String::IncRef()
 void String::DecRef(ManagedCtx* ctx)
 {
     /* Decrement the ref count */
-    if (ctx != &nullContext) {
+    if ((ctx != &nullContext) && (ctx != &inlineCtx.ctx)) {
         uint32_t refs = DecrementAndFetch(&ctx->refCount);
         if (0 == refs) {
+            size_t mallocSz = AllocatorPrefix + ctx->capacity + 1 + sizeof(ManagedCtx) - MinCapacity;
+            char* block = reinterpret_cast<char*>(ctx) - AllocatorPrefix;
 #if defined(QCC_OS_DARWIN)
             ctx->~ManagedCtx();
 #else
             ctx->ManagedCtx::~ManagedCtx();
 #endif
-            free(ctx);
+            stringStats.Remove(mallocSz);
+            Allocator::FreeBlock(block, mallocSz, static_cast<uint16_t>(*reinterpret_cast<uint32_t*>(block)));
         }
     }
 }
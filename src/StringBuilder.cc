@@ -0,0 +1,164 @@
+/**
+ * @file
+ *
+ * Incremental construction of strings.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <stdio.h>
+
+#include <qcc/StringBuilder.h>
+
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+
+namespace qcc {
+
+static const char hexCharsUC[] = "0123456789ABCDEF";
+static const char hexCharsLC[] = "0123456789abcdef";
+
+const size_t StringBuilder::StackCapacity;
+
+/*
+ * While the characters are in the stack buffer heap is the empty String.  Once
+ * they move to the heap, buf points into the storage of heap, which nothing
+ * else references, and the String's length is only brought up to date when
+ * it is handed over.
+ */
+void StringBuilder::Grow(size_t n)
+{
+    size_t newCap = MAX(2 * cap, len + n);
+    String::ManagedCtx* oldContext = heap.context;
+    heap.NewContext(len ? buf : NULL, len, newCap);
+    heap.DecRef(oldContext);
+    buf = heap.context->c_str;
+    cap = heap.context->capacity;
+}
+
+String StringBuilder::ToString()
+{
+    String str;
+    if (buf == stack) {
+        if (len) {
+            str.NewContext(stack, len, len);
+        }
+    } else {
+        /* Hand over the heap storage as it is */
+        heap.context->offset = static_cast<uint32_t>(len);
+        buf[len] = '\0';
+        str.context = heap.context;
+        heap.context = &String::nullContext;
+        buf = stack;
+        cap = StackCapacity;
+    }
+    len = 0;
+    return str;
+}
+
+void StringBuilder::AppendTo(String& str)
+{
+    if (str.empty()) {
+        str = ToString();
+    } else {
+        if (len) {
+            str.append(buf, len);
+        }
+        len = 0;
+    }
+}
+
+StringBuilder& StringBuilder::appendf(const char* fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    vappendf(fmt, args);
+    va_end(args);
+    return *this;
+}
+
+StringBuilder& StringBuilder::vappendf(const char* fmt, va_list args)
+{
+    va_list retry;
+    va_copy(retry, args);
+    /* Both buffers have room for a nul after cap characters */
+    int n = vsnprintf(buf + len, cap - len + 1, fmt, args);
+    if (n > 0) {
+        if (static_cast<size_t>(n) > (cap - len)) {
+            Grow(n);
+            vsnprintf(buf + len, cap - len + 1, fmt, retry);
+        }
+        len += n;
+    }
+    va_end(retry);
+    return *this;
+}
+
+StringBuilder& StringBuilder::appendHex(const uint8_t* bytes, size_t numBytes, bool toLower, char separator)
+{
+    if (numBytes == 0) {
+        return *this;
+    }
+    const char* hexChars = toLower ? hexCharsLC : hexCharsUC;
+    size_t outLen = 2 * numBytes + (separator ? numBytes - 1 : 0);
+    char* out = Reserve(outLen);
+    for (size_t i = 0; i < numBytes; ++i) {
+        if (separator && (i != 0)) {
+            *out++ = separator;
+        }
+        *out++ = hexChars[bytes[i] >> 4];
+        *out++ = hexChars[bytes[i] & 0x0F];
+    }
+    len += outLen;
+    return *this;
+}
+
+StringBuilder& StringBuilder::appendU64(uint64_t num, unsigned int base, size_t width, char fill)
+{
+    /* Digits are produced right to left, 64 is enough for base 2 */
+    char digits[64];
+    char* end = digits + sizeof(digits);
+    char* p = end;
+    if ((1 < base) && (16 >= base)) {
+        do {
+            *--p = hexCharsUC[num % base];
+            num /= base;
+        } while (num);
+    } else {
+        *--p = '0';
+    }
+    size_t numDigits = end - p;
+    if (width > numDigits) {
+        append(width - numDigits, fill);
+    }
+    return append(p, numDigits);
+}
+
+StringBuilder& StringBuilder::appendI64(int64_t num, unsigned int base, size_t width, char fill)
+{
+    uint64_t unum = static_cast<uint64_t>(num);
+    if (num < 0) {
+        /* The sign goes before any fill and counts toward the width */
+        append('-');
+        unum = 0 - unum;
+        width = (width > 1) ? width - 1 : 1;
+    }
+    return appendU64(unum, base, width, fill);
+}
+
+}
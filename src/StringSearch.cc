@@ -0,0 +1,566 @@
+/**
+ * @file
+ *
+ * Vectorized search and comparison primitives used by qcc::String.
+ */
+
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+
+#include <qcc/platform.h>
+
+#include <string.h>
+
+#include <qcc/atomic.h>
+#include <qcc/StringSearch.h>
+
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+#define QCC_STRINGSEARCH_X86
+#include <emmintrin.h>
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+/*
+ * The vector versions of FindFirstOf and FindLastOf compare each block against
+ * every character of the set.  Larger sets use the bitmap in the portable
+ * version.
+ */
+#define MAX_VECTOR_SET 16
+
+using namespace qcc;
+
+/*
+ * Portable implementations.  These are also used by the vector versions for
+ * whatever is left over after the last whole block.
+ */
+
+namespace {
+
+/** Bitmap of the characters in a set */
+class CharSet {
+  public:
+    CharSet(const char* set, size_t setLen)
+    {
+        ::memset(bits, 0, sizeof(bits));
+        for (size_t i = 0; i < setLen; ++i) {
+            uint8_t c = static_cast<uint8_t>(set[i]);
+            bits[c >> 5] |= (1U << (c & 31));
+        }
+    }
+    bool Has(char ch) const
+    {
+        uint8_t c = static_cast<uint8_t>(ch);
+        return (bits[c >> 5] & (1U << (c & 31))) != 0;
+    }
+  private:
+    uint32_t bits[8];
+};
+
+}
+
+static const char* ScalarFind(const char* str, size_t len, const char* pat, size_t patLen)
+{
+    if (patLen == 0) {
+        return str;
+    }
+    if (patLen > len) {
+        return NULL;
+    }
+    const char* last = str + len - patLen;
+    const char* p = str;
+    while (p <= last) {
+        p = static_cast<const char*>(::memchr(p, pat[0], last - p + 1));
+        if (!p) {
+            break;
+        }
+        if (::memcmp(p + 1, pat + 1, patLen - 1) == 0) {
+            return p;
+        }
+        ++p;
+    }
+    return NULL;
+}
+
+static size_t ScalarFindFirstOf(const char* str, size_t len, const char* set, size_t setLen, bool inSet)
+{
+    if ((setLen == 1) && inSet) {
+        const char* p = static_cast<const char*>(::memchr(str, set[0], len));
+        return p ? static_cast<size_t>(p - str) : len;
+    }
+    CharSet chars(set, setLen);
+    for (size_t i = 0; i < len; ++i) {
+        if (chars.Has(str[i]) == inSet) {
+            return i;
+        }
+    }
+    return len;
+}
+
+static size_t ScalarFindLastOf(const char* str, size_t len, const char* set, size_t setLen, bool inSet)
+{
+    CharSet chars(set, setLen);
+    size_t i = len;
+    while (i-- > 0) {
+        if (chars.Has(str[i]) == inSet) {
+            return i;
+        }
+    }
+    return len;
+}
+
+static size_t ScalarMismatch(const char* a, const char* b, size_t len)
+{
+    for (size_t i = 0; i < len; ++i) {
+        if (a[i] != b[i]) {
+            return i;
+        }
+    }
+    return len;
+}
+
+#if defined(QCC_STRINGSEARCH_X86)
+
+/*
+ * The vector versions are compiled for their instruction set regardless of the
+ * flags the rest of the library is built with; they are only called if the
+ * processor supports it.
+ */
+#if defined(__GNUC__)
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_SSE2
+#define TARGET_AVX2
+#endif
+
+static inline uint32_t LowestBit(uint32_t mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+static inline uint32_t HighestBit(uint32_t mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse(&index, mask);
+    return index;
+#else
+    return 31 - __builtin_clz(mask);
+#endif
+}
+
+/*
+ * Move pos forward to the next occurrence of the first character of the
+ * pattern.  Returns false if there is none where the pattern would still fit.
+ */
+static inline bool SkipTo(const char* str, size_t len, const char* pat, size_t patLen, size_t& pos)
+{
+    const char* p = static_cast<const char*>(::memchr(str + pos, pat[0], len - patLen + 1 - pos));
+    if (!p) {
+        return false;
+    }
+    pos = p - str;
+    return true;
+}
+
+/*
+ * Number of times the first character of the pattern may turn up without the
+ * rest of it matching before Find gives up on memchr() alone.
+ */
+#define MAX_FIND_FALSE_HITS 4
+
+/*
+ * Search the way the portable version does while the first character of the
+ * pattern is rare.  Returns true with the result in found if the search is
+ * over, or false with pos where the block search should carry on.
+ */
+static inline bool FindRare(const char* str, size_t len, const char* pat, size_t patLen, size_t& pos, const char*& found)
+{
+    found = NULL;
+    for (uint32_t hits = 0; hits < MAX_FIND_FALSE_HITS; ++hits) {
+        if (!SkipTo(str, len, pat, patLen, pos)) {
+            return true;
+        }
+        if (::memcmp(str + pos + 1, pat + 1, patLen - 1) == 0) {
+            found = str + pos;
+            return true;
+        }
+        if (++pos > len - patLen) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * memchr() is already vectorized so Find starts out like the portable version
+ * and only switches to blocks once the first character of the pattern keeps
+ * turning up.  Each block is then compared against the first and the last
+ * character of the pattern at once and the rest of the pattern is only looked
+ * at where both match.  Before every block Find skips ahead to the next
+ * occurrence of the first character.
+ */
+TARGET_SSE2 static const char* Sse2Find(const char* str, size_t len, const char* pat, size_t patLen)
+{
+    if ((patLen < 2) || (patLen - 1 + 16 > len)) {
+        return ScalarFind(str, len, pat, patLen);
+    }
+    size_t i = 0;
+    const char* found;
+    if (FindRare(str, len, pat, patLen, i, found)) {
+        return found;
+    }
+    const __m128i first = _mm_set1_epi8(pat[0]);
+    const __m128i last = _mm_set1_epi8(pat[patLen - 1]);
+    while (SkipTo(str, len, pat, patLen, i)) {
+        if (i + patLen - 1 + 16 > len) {
+            return ScalarFind(str + i, len - i, pat, patLen);
+        }
+        __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i));
+        __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i + patLen - 1));
+        uint32_t mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, blockFirst), _mm_cmpeq_epi8(last, blockLast)));
+        while (mask) {
+            uint32_t bit = LowestBit(mask);
+            if (::memcmp(str + i + bit + 1, pat + 1, patLen - 2) == 0) {
+                return str + i + bit;
+            }
+            mask &= mask - 1;
+        }
+        i += 16;
+    }
+    return NULL;
+}
+
+TARGET_SSE2 static size_t Sse2FindFirstOf(const char* str, size_t len, const char* set, size_t setLen)
+{
+    if ((setLen == 0) || (setLen > MAX_VECTOR_SET)) {
+        return ScalarFindFirstOf(str, len, set, setLen, true);
+    }
+    __m128i chars[MAX_VECTOR_SET];
+    for (size_t k = 0; k < setLen; ++k) {
+        chars[k] = _mm_set1_epi8(set[k]);
+    }
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i));
+        __m128i match = _mm_cmpeq_epi8(block, chars[0]);
+        for (size_t k = 1; k < setLen; ++k) {
+            match = _mm_or_si128(match, _mm_cmpeq_epi8(block, chars[k]));
+        }
+        uint32_t mask = _mm_movemask_epi8(match);
+        if (mask) {
+            return i + LowestBit(mask);
+        }
+    }
+    return i + ScalarFindFirstOf(str + i, len - i, set, setLen, true);
+}
+
+TARGET_SSE2 static size_t Sse2FindLastOf(const char* str, size_t len, const char* set, size_t setLen)
+{
+    if ((setLen == 0) || (setLen > MAX_VECTOR_SET)) {
+        return ScalarFindLastOf(str, len, set, setLen, true);
+    }
+    __m128i chars[MAX_VECTOR_SET];
+    for (size_t k = 0; k < setLen; ++k) {
+        chars[k] = _mm_set1_epi8(set[k]);
+    }
+    size_t i = len;
+    while (i >= 16) {
+        i -= 16;
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i));
+        __m128i match = _mm_cmpeq_epi8(block, chars[0]);
+        for (size_t k = 1; k < setLen; ++k) {
+            match = _mm_or_si128(match, _mm_cmpeq_epi8(block, chars[k]));
+        }
+        uint32_t mask = _mm_movemask_epi8(match);
+        if (mask) {
+            return i + HighestBit(mask);
+        }
+    }
+    size_t pos = ScalarFindLastOf(str, i, set, setLen, true);
+    return (pos == i) ? len : pos;
+}
+
+TARGET_SSE2 static size_t Sse2Mismatch(const char* a, const char* b, size_t len)
+{
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i blockA = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i blockB = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        uint32_t mask = _mm_movemask_epi8(_mm_cmpeq_epi8(blockA, blockB)) ^ 0xFFFF;
+        if (mask) {
+            return i + LowestBit(mask);
+        }
+    }
+    return i + ScalarMismatch(a + i, b + i, len - i);
+}
+
+/*
+ * The AVX2 versions work the same way on 32 byte blocks and hand what is left
+ * to the SSE2 versions.  They clear the upper halves of the vector registers
+ * before returning or calling out: running SSE2 code while they are dirty
+ * costs far more than the search itself on many processors.
+ */
+
+TARGET_AVX2 static const char* Avx2Find(const char* str, size_t len, const char* pat, size_t patLen)
+{
+    if ((patLen < 2) || (patLen - 1 + 32 > len)) {
+        return Sse2Find(str, len, pat, patLen);
+    }
+    size_t i = 0;
+    const char* found;
+    if (FindRare(str, len, pat, patLen, i, found)) {
+        return found;
+    }
+    const __m256i first = _mm256_set1_epi8(pat[0]);
+    const __m256i last = _mm256_set1_epi8(pat[patLen - 1]);
+    while (SkipTo(str, len, pat, patLen, i)) {
+        if (i + patLen - 1 + 32 > len) {
+            _mm256_zeroupper();
+            return ScalarFind(str + i, len - i, pat, patLen);
+        }
+        __m256i blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(str + i));
+        __m256i blockLast = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(str + i + patLen - 1));
+        uint32_t mask = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(first, blockFirst), _mm256_cmpeq_epi8(last, blockLast)));
+        while (mask) {
+            uint32_t bit = LowestBit(mask);
+            if (::memcmp(str + i + bit + 1, pat + 1, patLen - 2) == 0) {
+                _mm256_zeroupper();
+                return str + i + bit;
+            }
+            mask &= mask - 1;
+        }
+        i += 32;
+    }
+    _mm256_zeroupper();
+    return NULL;
+}
+
+TARGET_AVX2 static size_t Avx2FindFirstOf(const char* str, size_t len, const char* set, size_t setLen)
+{
+    if ((setLen == 0) || (setLen > MAX_VECTOR_SET)) {
+        return ScalarFindFirstOf(str, len, set, setLen, true);
+    }
+    if (len < 32) {
+        return Sse2FindFirstOf(str, len, set, setLen);
+    }
+    __m256i chars[MAX_VECTOR_SET];
+    for (size_t k = 0; k < setLen; ++k) {
+        chars[k] = _mm256_set1_epi8(set[k]);
+    }
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(str + i));
+        __m256i match = _mm256_cmpeq_epi8(block, chars[0]);
+        for (size_t k = 1; k < setLen; ++k) {
+            match = _mm256_or_si256(match, _mm256_cmpeq_epi8(block, chars[k]));
+        }
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(match));
+        if (mask) {
+            _mm256_zeroupper();
+            return i + LowestBit(mask);
+        }
+    }
+    _mm256_zeroupper();
+    return i + Sse2FindFirstOf(str + i, len - i, set, setLen);
+}
+
+TARGET_AVX2 static size_t Avx2FindLastOf(const char* str, size_t len, const char* set, size_t setLen)
+{
+    if ((setLen == 0) || (setLen > MAX_VECTOR_SET)) {
+        return ScalarFindLastOf(str, len, set, setLen, true);
+    }
+    if (len < 32) {
+        return Sse2FindLastOf(str, len, set, setLen);
+    }
+    __m256i chars[MAX_VECTOR_SET];
+    for (size_t k = 0; k < setLen; ++k) {
+        chars[k] = _mm256_set1_epi8(set[k]);
+    }
+    size_t i = len;
+    while (i >= 32) {
+        i -= 32;
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(str + i));
+        __m256i match = _mm256_cmpeq_epi8(block, chars[0]);
+        for (size_t k = 1; k < setLen; ++k) {
+            match = _mm256_or_si256(match, _mm256_cmpeq_epi8(block, chars[k]));
+        }
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(match));
+        if (mask) {
+            _mm256_zeroupper();
+            return i + HighestBit(mask);
+        }
+    }
+    _mm256_zeroupper();
+    size_t pos = Sse2FindLastOf(str, i, set, setLen);
+    return (pos == i) ? len : pos;
+}
+
+TARGET_AVX2 static size_t Avx2Mismatch(const char* a, const char* b, size_t len)
+{
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i blockA = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i blockB = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(blockA, blockB))) ^ 0xFFFFFFFF;
+        if (mask) {
+            _mm256_zeroupper();
+            return i + LowestBit(mask);
+        }
+    }
+    _mm256_zeroupper();
+    return i + Sse2Mismatch(a + i, b + i, len - i);
+}
+
+#endif
+
+/*
+ * Runtime dispatch.  The table is picked on first use; racing threads all pick
+ * the same one.  The set searches in the table only look for characters in
+ * the set.
+ */
+
+struct SearchOps {
+    StringSearch::Level level;
+    const char* (*find)(const char* str, size_t len, const char* pat, size_t patLen);
+    size_t (*findFirstOf)(const char* str, size_t len, const char* set, size_t setLen);
+    size_t (*findLastOf)(const char* str, size_t len, const char* set, size_t setLen);
+    size_t (*mismatch)(const char* a, const char* b, size_t len);
+};
+
+static size_t ScalarFindFirstIn(const char* str, size_t len, const char* set, size_t setLen)
+{
+    return ScalarFindFirstOf(str, len, set, setLen, true);
+}
+
+static size_t ScalarFindLastIn(const char* str, size_t len, const char* set, size_t setLen)
+{
+    return ScalarFindLastOf(str, len, set, setLen, true);
+}
+
+static const SearchOps scalarOps = { StringSearch::SCALAR, ScalarFind, ScalarFindFirstIn, ScalarFindLastIn, ScalarMismatch };
+#if defined(QCC_STRINGSEARCH_X86)
+static const SearchOps sse2Ops = { StringSearch::SSE2, Sse2Find, Sse2FindFirstOf, Sse2FindLastOf, Sse2Mismatch };
+static const SearchOps avx2Ops = { StringSearch::AVX2, Avx2Find, Avx2FindFirstOf, Avx2FindLastOf, Avx2Mismatch };
+#endif
+
+static const SearchOps* volatile currentOps = NULL;
+
+static StringSearch::Level SupportedLevel()
+{
+#if defined(QCC_STRINGSEARCH_X86)
+#if defined(__GNUC__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return StringSearch::AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return StringSearch::SSE2;
+    }
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    int maxLeaf = info[0];
+    __cpuid(info, 1);
+    bool sse2 = (info[3] & (1 << 26)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    /* AVX2 also needs the OS to save the upper halves of the registers */
+    if ((maxLeaf >= 7) && osxsave && avx && ((_xgetbv(0) & 6) == 6)) {
+        __cpuidex(info, 7, 0);
+        if (info[1] & (1 << 5)) {
+            return StringSearch::AVX2;
+        }
+    }
+    if (sse2) {
+        return StringSearch::SSE2;
+    }
+#endif
+#endif
+    return StringSearch::SCALAR;
+}
+
+static const SearchOps* OpsFor(StringSearch::Level level)
+{
+    switch (level) {
+#if defined(QCC_STRINGSEARCH_X86)
+    case StringSearch::AVX2:
+        return &avx2Ops;
+
+    case StringSearch::SSE2:
+        return &sse2Ops;
+#endif
+    default:
+        return &scalarOps;
+    }
+}
+
+static inline const SearchOps* Ops()
+{
+    const SearchOps* ops = AtomicLoad(&currentOps, MEMORY_ORDER_ACQUIRE);
+    if (!ops) {
+        ops = OpsFor(SupportedLevel());
+        AtomicStore(&currentOps, ops, MEMORY_ORDER_RELEASE);
+    }
+    return ops;
+}
+
+StringSearch::Level StringSearch::GetLevel()
+{
+    return Ops()->level;
+}
+
+StringSearch::Level StringSearch::SetLevel(Level level)
+{
+    Level supported = SupportedLevel();
+    const SearchOps* ops = OpsFor((level < supported) ? level : supported);
+    AtomicStore(&currentOps, ops, MEMORY_ORDER_RELEASE);
+    return ops->level;
+}
+
+const char* StringSearch::Find(const char* str, size_t len, const char* pat, size_t patLen)
+{
+    return Ops()->find(str, len, pat, patLen);
+}
+
+/*
+ * Searches for a character not in the set usually stop within the first few
+ * characters, where setting up the vectors costs more than the portable
+ * version takes, so only searches for characters in the set are dispatched.
+ */
+size_t StringSearch::FindFirstOf(const char* str, size_t len, const char* set, size_t setLen, bool inSet)
+{
+    return inSet ? Ops()->findFirstOf(str, len, set, setLen) : ScalarFindFirstOf(str, len, set, setLen, false);
+}
+
+size_t StringSearch::FindLastOf(const char* str, size_t len, const char* set, size_t setLen, bool inSet)
+{
+    return inSet ? Ops()->findLastOf(str, len, set, setLen) : ScalarFindLastOf(str, len, set, setLen, false);
+}
+
+size_t StringSearch::Mismatch(const char* a, const char* b, size_t len)
+{
+    return Ops()->mismatch(a, b, len);
+}
@@ -27,6 +27,7 @@
 #include <math.h>
 
 #include <qcc/String.h>
+#include <qcc/StringBuilder.h>
 #include <qcc/StringUtil.h>
 
 using namespace std;
@@ -39,32 +40,22 @@ static const unsigned long __qcc_nan = 0x7fffffffff;
 #endif
 
 
-static const char* hexCharsUC = "0123456789ABCDEF";
-static const char* hexCharsLC = "0123456789abcdef";
-
 qcc::String qcc::BytesToHexString(const uint8_t* bytes, size_t len, bool toLower, char separator)
 {
-    qcc::String outBuf;
-    const char* hexChars = toLower ? hexCharsLC : hexCharsUC;
-    for (size_t i = 0; i < len; i++) {
-        if (separator && (i != 0)) {
-            outBuf.push_back(separator);
-        }
-        outBuf.push_back(hexChars[bytes[i] >> 4]);
-        outBuf.push_back(hexChars[bytes[i] & 0x0F]);
-    }
-    return outBuf;
+    StringBuilder outBuf(len * (separator ? 3 : 2));
+    outBuf.appendHex(bytes, len, toLower, separator);
+    return outBuf.ToString();
 }
 
 
-size_t qcc::HexStringToBytes(const qcc::String& hex, uint8_t* outBytes, size_t len, char separator)
+size_t qcc::HexStringToBytes(const qcc::StringRef& hex, uint8_t* outBytes, size_t len, char separator)
 {
     if (separator) {
         len = min((1 + hex.length()) / 3, len);
     } else {
         len = min(hex.length() / 2, len);
     }
-    qcc::String::const_iterator it = hex.begin();
+    qcc::StringRef::const_iterator it = hex.begin();
     for (size_t i = 0; i < len; i++) {
         if (separator && (i != 0)) {
             if (*it++ != separator) {
@@ -84,7 +75,7 @@ size_t qcc::HexStringToBytes(const qcc::String& hex, uint8_t* outBytes, size_t l
 }
 
 
-qcc::String qcc::HexStringToByteString(const qcc::String& hex, char separator)
+qcc::String qcc::HexStringToByteString(const qcc::StringRef& hex, char separator)
 {
     size_t len;
     if (separator) {
@@ -93,7 +84,7 @@ qcc::String qcc::HexStringToByteString(const qcc::String& hex, char separator)
         len = hex.length() / 2;
     }
     qcc::String result(0, '\0', len);
-    qcc::String::const_iterator it = hex.begin();
+    qcc::StringRef::const_iterator it = hex.begin();
     for (size_t i = 0; i < len; i++) {
         if (separator && (i != 0)) {
             if (*it++ != separator) {
@@ -113,119 +104,33 @@ qcc::String qcc::HexStringToByteString(const qcc::String& hex, char separator)
 
 qcc::String qcc::U32ToString(uint32_t num, unsigned int base, size_t width, char fill)
 {
-    qcc::String outStr;
-    uint32_t tmp = num;
-    size_t pos = 0;
-
-    // Just incase someone overrides the default width with 0.
-    width = (width == 0) ? 1 : width;
-
-    while (--width > 0) {
-        if (tmp >= base) {
-            tmp /= base;
-        } else {
-            ++pos;
-            outStr.push_back(fill);
-        }
-    }
-
-    if ((0 < base) && (16 >= base)) {
-        do {
-            outStr.insert((size_t)pos, &hexCharsUC[num % base], 1);
-            num = num / base;
-        } while (num);
-    }
-
-    if (outStr.empty()) {
-        outStr.push_back('0');
-    }
-
-    return outStr;
+    StringBuilder outStr;
+    return outStr.appendU32(num, base, width, fill).ToString();
 }
 
 
 qcc::String qcc::I32ToString(int32_t num, unsigned int base, size_t width, char fill)
 {
-    const char* sign;
-    uint32_t unum;
-
-    // Just incase caller overrides the default width with 0.
-    width = (width == 0) ? 1 : width;
-
-    if (num >= 0) {
-        sign = "";
-        unum = (uint32_t)num;
-    } else {
-        sign = "-";
-        if ((num << 1) == 0) {
-            unum = (uint32_t)(num);
-        } else {
-            unum = (uint32_t)(-num);
-        }
-        --width;
-    }
-    return sign + U32ToString(unum, base, width, fill);
+    StringBuilder outStr;
+    return outStr.appendI32(num, base, width, fill).ToString();
 }
 
 
 qcc::String qcc::U64ToString(uint64_t num, unsigned int base, size_t width, char fill)
 {
-    qcc::String outStr;
-    uint64_t tmp = num;
-    size_t pos = 0;
-
-    // Just incase someone overrides the default width with 0.
-    width = (width == 0) ? 1 : width;
-
-    while (--width > 0) {
-        if (tmp >= base) {
-            tmp /= base;
-        } else {
-            ++pos;
-            outStr.push_back(fill);
-        }
-    }
-
-    if ((0 < base) && (16 >= base)) {
-        do {
-            outStr.insert((size_t)pos, &hexCharsUC[num % base], 1);
-            num = num / base;
-        } while (num);
-    }
-
-    if (outStr.empty()) {
-        outStr.push_back('0');
-    }
-
-    return outStr;
+    StringBuilder outStr;
+    return outStr.appendU64(num, base, width, fill).ToString();
 }
 
 
 qcc::String qcc::I64ToString(int64_t num, unsigned int base, size_t width, char fill)
 {
-    const char* sign;
-    uint64_t unum;
-
-    // Just incase caller overrides the default width with 0.
-    width = (width == 0) ? 1 : width;
-
-    if (num >= 0) {
-        sign = "";
-        unum = (uint64_t)num;
-    } else {
-        sign = "-";
-        if ((num << 1) == 0) {
-            unum = (uint64_t)(num);
-        } else {
-            unum = (uint64_t)(-num);
-        }
-        --width;
-    }
-    return sign + U64ToString(unum, base, width, fill);
+    StringBuilder outStr;
+    return outStr.appendI64(num, base, width, fill).ToString();
 }
 
 
-uint32_t qcc::StringToU32(const qcc::String& inStr, unsigned int base, uint32_t badValue)
+uint32_t qcc::StringToU32(const qcc::StringRef& inStr, unsigned int base, uint32_t badValue)
 {
     uint32_t val = 0;
 
@@ -234,9 +139,9 @@ uint32_t qcc::StringToU32(const qcc::String& inStr, unsigned int base, uint32_t
     }
     // Convert inStr to val
     bool isBad = true;
-    qcc::String::const_iterator it = inStr.begin();
+    qcc::StringRef::const_iterator it = inStr.begin();
     if (base == 0) {
-        if (*it == '0') {
+        if ((it != inStr.end()) && (*it == '0')) {
             ++it;
             if (it == inStr.end()) {
                 return 0;
@@ -250,9 +155,9 @@ uint32_t qcc::StringToU32(const qcc::String& inStr, unsigned int base, uint32_t
             base = 10;
         }
     } else if (base == 16) {
-        if (*it == '0') {
+        if ((it != inStr.end()) && (*it == '0')) {
             ++it;
-            if ((*it == 'x') || (*it == 'X')) {
+            if ((it != inStr.end()) && ((*it == 'x') || (*it == 'X'))) {
                 ++it;
             }
         }
@@ -277,11 +182,11 @@ uint32_t qcc::StringToU32(const qcc::String& inStr, unsigned int base, uint32_t
 }
 
 
-int32_t qcc::StringToI32(const qcc::String& inStr, unsigned int base, int32_t badValue)
+int32_t qcc::StringToI32(const qcc::StringRef& inStr, unsigned int base, int32_t badValue)
 {
     if (!inStr.empty()) {
         if (inStr[0] == '-') {
-            uint32_t i = StringToU32(inStr.substr(1, inStr.npos), base, (uint32_t)badValue);
+            uint32_t i = StringToU32(inStr.substr(1), base, (uint32_t)badValue);
             if ((i != (uint32_t)badValue) && (i <= 0x80000000)) {
                 return -(int32_t)i;
             }
@@ -296,7 +201,7 @@ int32_t qcc::StringToI32(const qcc::String& inStr, unsigned int base, int32_t ba
 }
 
 
-uint64_t qcc::StringToU64(const qcc::String& inStr, unsigned int base, uint64_t badValue)
+uint64_t qcc::StringToU64(const qcc::StringRef& inStr, unsigned int base, uint64_t badValue)
 {
     uint64_t val = 0;
 
@@ -305,9 +210,9 @@ uint64_t qcc::StringToU64(const qcc::String& inStr, unsigned int base, uint64_t
     }
     // Convert inStr to val
     bool isBad = true;
-    qcc::String::const_iterator it = inStr.begin();
+    qcc::StringRef::const_iterator it = inStr.begin();
     if (base == 0) {
-        if (*it == '0') {
+        if ((it != inStr.end()) && (*it == '0')) {
             ++it;
             if (it == inStr.end()) {
                 return 0;
@@ -321,9 +226,9 @@ uint64_t qcc::StringToU64(const qcc::String& inStr, unsigned int base, uint64_t
             base = 10;
         }
     } else if (base == 16) {
-        if (*it == '0') {
+        if ((it != inStr.end()) && (*it == '0')) {
             ++it;
-            if ((*it == 'x') || (*it == 'X')) {
+            if ((it != inStr.end()) && ((*it == 'x') || (*it == 'X'))) {
                 ++it;
             }
         }
@@ -348,11 +253,11 @@ uint64_t qcc::StringToU64(const qcc::String& inStr, unsigned int base, uint64_t
 }
 
 
-int64_t qcc::StringToI64(const qcc::String& inStr, unsigned int base, int64_t badValue)
+int64_t qcc::StringToI64(const qcc::StringRef& inStr, unsigned int base, int64_t badValue)
 {
     if (!inStr.empty()) {
         if (inStr[0] == '-') {
-            uint64_t i = StringToU64(inStr.substr(1, inStr.npos), base, (uint32_t)badValue);
+            uint64_t i = StringToU64(inStr.substr(1), base, (uint32_t)badValue);
             if ((i != (uint64_t)badValue) && (i <= ((uint64_t)1 << 63))) {
                 return -(int64_t)i;
             }
@@ -366,13 +271,13 @@ int64_t qcc::StringToI64(const qcc::String& inStr, unsigned int base, int64_t ba
     return badValue;
 }
 
-double qcc::StringToDouble(const qcc::String& inStr)
+double qcc::StringToDouble(const qcc::StringRef& inStr)
 {
     const double decimal_base = 10.0;
     if (!inStr.empty()) {
         double val = 0.0;
         bool neg = false;
-        qcc::String::const_iterator it = inStr.begin();
+        qcc::StringRef::const_iterator it = inStr.begin();
         if (*it == '-') {
             neg = true;
             ++it;
@@ -386,7 +291,7 @@ double qcc::StringToDouble(const qcc::String& inStr)
             val += static_cast<double>(v);
             ++it;
         }
-        if (*it == '.') {
+        if ((it != inStr.end()) && (*it == '.')) {
             double divisor = 1.0;
             ++it;
             while ((it != inStr.end()) && ((*it != 'e') && (*it != 'E'))) {
@@ -401,13 +306,13 @@ double qcc::StringToDouble(const qcc::String& inStr)
             }
             val /= divisor;
         }
-        if ((*it == 'e') || (*it == 'E')) {
+        if ((it != inStr.end()) && ((*it == 'e') || (*it == 'E'))) {
             ++it;
-            qcc::String exponentString = qcc::String(it, inStr.end() - it);
+            qcc::StringRef exponentString(it, inStr.end() - it);
 
             // verify that the exponent portion is sane
-            qcc::String::const_iterator expStrIter = exponentString.begin();
-            if (*expStrIter == '-') {
+            qcc::StringRef::const_iterator expStrIter = exponentString.begin();
+            if ((expStrIter != exponentString.end()) && (*expStrIter == '-')) {
                 ++expStrIter;
             }
             while (expStrIter != exponentString.end()) {
@@ -1,7 +1,7 @@
 /**
  * @file
  *
- * Simple ThreadPool using Timers and Alarms
+ * ThreadPool built on a bounded work queue and a fixed set of worker threads
  */
 
 /******************************************************************************
@@ -22,90 +22,401 @@
 
 #include <assert.h>
 #include <qcc/ThreadPool.h>
+#include <qcc/Debug.h>
+#include <qcc/time.h>
 
 #define QCC_MODULE "THREADPOOL"
 
 namespace qcc {
 
-void Runnable::AlarmTriggered(const Alarm& alarm, QStatus reason)
-{
-    QCC_DbgPrintf(("Runnable::AlarmTriggered()"));
+/**
+ * A fixed capacity work-stealing deque in the style of Chase and Lev
+ * ("Dynamic Circular Work-Stealing Deque", SPAA 2005).
+ *
+ * Only the owning worker pushes and pops, and it does so at the bottom of the
+ * deque.  Any other worker may steal from the top.  The owner and the thieves
+ * only need to agree (with a compare and exchange on the top index) when they
+ * go after the same last remaining Runnable.
+ *
+ * The indices only ever grow; they are allowed to wrap, which is why all
+ * comparisons are done on their difference and why the capacity must be a
+ * power of two.  A slot holds a reference on its Runnable which is handed over
+ * to whoever pops or steals it.
+ */
+class WorkStealingDeque {
+  public:
+    WorkStealingDeque(uint32_t capacity) : m_top(0), m_bottom(0), m_mask(capacity - 1), m_slots(capacity, NULL)
+    {
+        assert(((capacity & m_mask) == 0) && "WorkStealingDeque: capacity must be a power of two");
+    }
 
-    /*
-     * Execute the user's provided run function.  Note that this is done in an
-     * OS-specific context.  For example, on Linux-based systems, this may
-     * happen in the context of a pthread from the Timer; but on Windows systems
-     * it may happen in the context of an asynchronous OS callback.
+    /**
+     * Push a Runnable onto the bottom of the deque.  Owner only.
+     *
+     * @return false if the deque is full.
+     */
+    bool Push(Runnable* runnable)
+    {
+        int32_t b = m_bottom;
+        int32_t t = m_top;
+        if (Distance(t, b) > static_cast<int32_t>(m_mask)) {
+            return false;
+        }
+        m_slots[b & m_mask] = runnable;
+
+        /*
+         * The atomic increment is a full barrier so the slot is visible before
+         * the new bottom is.
+         */
+        IncrementAndFetch(&m_bottom);
+        return true;
+    }
+
+    /**
+     * Pop the most recently pushed Runnable off of the bottom of the deque.
+     * Owner only.
+     *
+     * @return The Runnable or NULL if the deque is empty.
+     */
+    Runnable* Pop()
+    {
+        /*
+         * Claim the bottom slot before looking at the top.  The atomic
+         * decrement is a full barrier so thieves see the claim before we read
+         * top.
+         */
+        int32_t b = DecrementAndFetch(&m_bottom);
+        int32_t t = m_top;
+        int32_t n = Distance(t, b);
+
+        if (n < 0) {
+            m_bottom = t;
+            return NULL;
+        }
+
+        Runnable* runnable = m_slots[b & m_mask];
+        if (n > 0) {
+            return runnable;
+        }
+
+        /*
+         * This was the last Runnable, so we have to race any thieves for it.
+         */
+        if (!CompareAndExchange(&m_top, t, t + 1)) {
+            runnable = NULL;
+        }
+        m_bottom = t + 1;
+        return runnable;
+    }
+
+    /**
+     * Steal the oldest Runnable off of the top of the deque.  Any thread.
+     *
+     * @return The Runnable or NULL if the deque is empty or another thread
+     *         got there first.
      */
-    Run();
+    Runnable* Steal()
+    {
+        int32_t t = m_top;
+        FullBarrier();
+        int32_t b = m_bottom;
+        if (Distance(t, b) <= 0) {
+            return NULL;
+        }
+        FullBarrier();
+        Runnable* runnable = m_slots[t & m_mask];
+        if (!CompareAndExchange(&m_top, t, t + 1)) {
+            return NULL;
+        }
+        return runnable;
+    }
+
+    /**
+     * A snapshot of the number of Runnables on the deque.
+     */
+    uint32_t Size() const
+    {
+        int32_t n = Distance(m_top, m_bottom);
+        return (n > 0) ? n : 0;
+    }
+
+  private:
+    static int32_t Distance(int32_t from, int32_t to)
+    {
+        return static_cast<int32_t>(static_cast<uint32_t>(to) - static_cast<uint32_t>(from));
+    }
 
     /*
-     * Tell the threadpool that we are done with this runnable object.  This
-     * allows the threadpool to release its reference to the object which may
-     * result in an immediate delete of the object.  So one must never refer to
-     * the underlying runnable after this point.
+     * qcc/atomic.h has no explicit fence, but every atomic read-modify-write
+     * operation is a full barrier.
+     */
+    static void FullBarrier()
+    {
+        volatile int32_t barrier = 0;
+        CompareAndExchange(&barrier, 0, 0);
+    }
+
+    volatile int32_t m_top;
+    volatile int32_t m_bottom;
+    const uint32_t m_mask;
+    std::vector<Runnable*> m_slots;
+};
+
+/**
+ * A worker thread of a ThreadPool.  Workers loop pulling Runnable tasks off of
+ * the head of the work queue and running them until they are stopped.  In
+ * work-stealing mode they look at their own deque first and steal from the
+ * other workers when there is nothing else to do.
+ */
+class ThreadPoolWorker : public Thread {
+  public:
+    ThreadPoolWorker(const char* name, ThreadPool* pool, uint32_t index, uint32_t dequeSize)
+        : Thread(name), m_pool(pool), m_index(index), m_deque(dequeSize ? new WorkStealingDeque(dequeSize) : NULL) { }
+
+    ~ThreadPoolWorker()
+    {
+        Stop();
+        Join();
+        if (m_deque) {
+            Runnable* runnable;
+            while ((runnable = m_deque->Pop()) != NULL) {
+                runnable->DecRef();
+            }
+            delete m_deque;
+        }
+    }
+
+    WorkStealingDeque* GetDeque() { return m_deque; }
+
+  protected:
+    virtual ThreadReturn STDCALL Run(void* arg);
+
+  private:
+    /**
+     * Look for a Runnable in the work-stealing case.  Our own deque comes
+     * first, then the shared work queue, then the deques of the other workers.
      */
-    m_threadpool->Release(this);
+    Ptr<Runnable> FindWork();
+
+    /**
+     * Take a Runnable that was removed from a deque.  The deque slot held a
+     * reference which is transferred to the returned Ptr.
+     */
+    static Ptr<Runnable> Adopt(Runnable* runnable)
+    {
+        Ptr<Runnable> ptr(runnable);
+        runnable->DecRef();
+        return ptr;
+    }
+
+    ThreadPool* m_pool;
+    uint32_t m_index;
+    WorkStealingDeque* m_deque;
+};
+
+Ptr<Runnable> ThreadPoolWorker::FindWork()
+{
+    Runnable* runnable = m_deque->Pop();
+    if (runnable) {
+        return Adopt(runnable);
+    }
+
+    if (m_pool->m_pending) {
+        m_pool->m_lock.Lock();
+        if (m_pool->m_pending) {
+            Ptr<Runnable> ptr = m_pool->Dequeue();
+            m_pool->m_lock.Unlock();
+            return ptr;
+        }
+        m_pool->m_lock.Unlock();
+    }
+
+    for (uint32_t i = 1; i < m_pool->m_poolsize; ++i) {
+        ThreadPoolWorker* victim = m_pool->m_workers[(m_index + i) % m_pool->m_poolsize];
+        runnable = victim->m_deque->Steal();
+        if (runnable) {
+            return Adopt(runnable);
+        }
+    }
+    return Ptr<Runnable>();
+}
+
+ThreadReturn STDCALL ThreadPoolWorker::Run(void* arg)
+{
+    QCC_DbgPrintf(("ThreadPoolWorker::Run()"));
+
+    while (!IsStopping()) {
+        Ptr<Runnable> runnable;
+
+        if (m_deque) {
+            runnable = FindWork();
+            if (!runnable.Peek()) {
+                /*
+                 * Announce that we are going idle and only then reset the work
+                 * event and take a last look around.  A worker that pushes onto
+                 * its deque after we have looked sees our announcement and sets
+                 * the work event, so we cannot sleep through its Runnable.
+                 */
+                IncrementAndFetch(&m_pool->m_idle);
+                m_pool->m_lock.Lock();
+                if (m_pool->m_pending == 0) {
+                    m_pool->m_workEvent.ResetEvent();
+                }
+                m_pool->m_lock.Unlock();
+                runnable = FindWork();
+                if (!runnable.Peek()) {
+                    QCC_DbgPrintf(("ThreadPoolWorker::Run(): Idle"));
+                    QStatus status = Event::Wait(m_pool->m_workEvent);
+                    if (status == ER_ALERTED_THREAD) {
+                        stopEvent.ResetEvent();
+                    }
+                }
+                DecrementAndFetch(&m_pool->m_idle);
+                if (!runnable.Peek()) {
+                    continue;
+                }
+            }
+            IncrementAndFetch(&m_pool->m_running);
+        } else {
+            m_pool->m_lock.Lock();
+            if (m_pool->m_pending == 0) {
+                /*
+                 * Nothing to do so sleep until the work event is set.  The
+                 * event stays set as long as there is anything on the queue,
+                 * so there is no way for us to miss a Runnable that is queued
+                 * after we give up the lock.  A Stop() sets our stop event
+                 * which also wakes us up.
+                 */
+                QCC_DbgPrintf(("ThreadPoolWorker::Run(): Idle"));
+                m_pool->m_lock.Unlock();
+                QStatus status = Event::Wait(m_pool->m_workEvent);
+                if (status == ER_ALERTED_THREAD) {
+                    stopEvent.ResetEvent();
+                }
+                continue;
+            }
+            runnable = m_pool->Dequeue();
+            IncrementAndFetch(&m_pool->m_running);
+            m_pool->m_lock.Unlock();
+        }
+
+        QCC_DbgPrintf(("ThreadPoolWorker::Run(): Run()"));
+        runnable->Run();
+
+        /*
+         * Drop our reference to the closure before we go looking for more
+         * work since this may run the destructor of the Runnable.
+         */
+        runnable = Ptr<Runnable>();
+        DecrementAndFetch(&m_pool->m_running);
+    }
+
+    return (ThreadReturn) 0;
 }
 
-ThreadPool::ThreadPool(const char* name, uint32_t poolsize)
-    : m_stopping(false), m_poolsize(poolsize), m_dispatcher(name, false, poolsize)
+ThreadPool::ThreadPool(const char* name, uint32_t poolsize, uint32_t backlog, bool workStealing, const ThreadAttributes& attributes)
+    : m_stopping(false),
+    m_poolsize(poolsize),
+    m_backlog(backlog ? backlog : poolsize),
+    m_queue(m_backlog),
+    m_head(0),
+    m_pending(0),
+    m_running(0),
+    m_workStealing(workStealing),
+    m_idle(0),
+    m_workers(poolsize)
 {
     QCC_DbgPrintf(("ThreadPool::ThreadPool()"));
 
     assert(poolsize && "ThreadPool::ThreadPool(): Empty pools are no good for anyone");
 
     /*
-     * Start the dispatcher Timer.  The Timer is the code that will cause alarms
-     * to be executed.  It is the alarms that provide the callbacks that the
-     * timer will fire.  Our timer will have a concurrency variable that
-     * corresponds to the poolsize provided.  This means that there will be
-     * <poolsize> theads waiting to dispatch expired alarms (either AllJoyn
-     * created in Posix systems or OS dispatched in Windows systems).  The
-     * concurrent threads in the Timer provide us with the thread pool we
-     * actually use.
+     * The work queue starts out empty, so there is room for callers but
+     * nothing for the workers to do.
      */
-    m_dispatcher.Start();
+    m_roomEvent.SetEvent();
+
+    uint32_t dequeSize = 0;
+    if (m_workStealing) {
+        dequeSize = 1;
+        while (dequeSize < m_backlog) {
+            dequeSize <<= 1;
+        }
+    }
 
     /*
-     * Set the event that callers will ultimately use to sleep on until a thread
-     * becomes available.  We just created a Timer dispatcher which has
-     * concurrency of at least one, so there is definitely a thread available.
+     * All of the workers must exist before any of them starts looking for
+     * someone to steal from.
      */
-    m_event.SetEvent();
+    for (uint32_t i = 0; i < m_poolsize; ++i) {
+        m_workers[i] = new ThreadPoolWorker(name, this, i, dequeSize);
+        m_workers[i]->SetAttributes(attributes);
+    }
+    for (uint32_t i = 0; i < m_poolsize; ++i) {
+        QStatus status = m_workers[i]->Start();
+        if (status != ER_OK) {
+            QCC_LogError(status, ("ThreadPool::ThreadPool(): Unable to start worker %d", i));
+        }
+    }
 }
 
 ThreadPool::~ThreadPool()
 {
-    QCC_DbgPrintf(("ThreadPool::~ThreadPool(): %d closures remain", m_closures.size()));
+    QCC_DbgPrintf(("ThreadPool::~ThreadPool(): %d closures remain", m_pending + m_running));
     Stop();
     Join();
 
-    /*
-     * We have joined the underlying timer, so all of its threads must be
-     * stopped.  That doesn't necessarily mean that they have executed the
-     * AlarmTriggered() function that would take the closure off of the
-     * pending closures list.  In this case, we need to make sure we clear
-     * the closures map so we release the underlying Ptr and free the
-     * runnable.
-     */
-    m_closures.clear();
+    for (uint32_t i = 0; i < m_poolsize; ++i) {
+        delete m_workers[i];
+        m_workers[i] = NULL;
+    }
 }
 
 QStatus ThreadPool::Stop()
 {
     QCC_DbgPrintf(("ThreadPool::Stop()"));
+
+    m_lock.Lock();
     m_stopping = true;
-    QStatus status = m_dispatcher.Stop();
-    return status;
 
+    /*
+     * Wake up anyone waiting for room on the queue so they notice that we are
+     * stopping.
+     */
+    m_roomEvent.SetEvent();
+    m_lock.Unlock();
+
+    QStatus status = ER_OK;
+    for (uint32_t i = 0; i < m_poolsize; ++i) {
+        QStatus tStatus = m_workers[i]->Stop();
+        status = (status == ER_OK) ? tStatus : status;
+    }
+    return status;
 }
 
 QStatus ThreadPool::Join()
 {
     QCC_DbgPrintf(("ThreadPool::Join()"));
     assert(m_stopping && "ThreadPool::Join(): must have previously Stop()ped");
-    QStatus status = m_dispatcher.Join();
+
+    QStatus status = ER_OK;
+    for (uint32_t i = 0; i < m_poolsize; ++i) {
+        QStatus tStatus = m_workers[i]->Join();
+        status = (status == ER_OK) ? tStatus : status;
+    }
+
+    /*
+     * All of the workers are gone, so any closures still on the work queue will
+     * never run.  Release our references to them so they can be freed.  The
+     * closures left on the deques of the workers are released when the
+     * workers are deleted.
+     */
+    m_lock.Lock();
+    while (m_pending) {
+        Dequeue();
+    }
+    m_lock.Unlock();
+
     return status;
 }
 
@@ -119,27 +430,111 @@ uint32_t ThreadPool::GetN(void)
 {
     QCC_DbgPrintf(("ThreadPool::GetN()"));
 
-    uint32_t n = 0;
-    QCC_DbgPrintf(("ThreadPool::GetN(): Taking lock"));
     m_lock.Lock();
-    n = m_closures.size();
-    QCC_DbgPrintf(("ThreadPool::GetN(): Giving lock"));
+    uint32_t n = m_pending + m_running;
     m_lock.Unlock();
+    if (m_workStealing) {
+        for (uint32_t i = 0; i < m_poolsize; ++i) {
+            n += m_workers[i]->GetDeque()->Size();
+        }
+    }
     return n;
 }
 
+void ThreadPool::Enqueue(const Ptr<Runnable>& runnable)
+{
+    assert(m_pending < m_backlog && "ThreadPool::Enqueue(): Work queue overflow");
+
+    /*
+     * The slot holds the reference that keeps the closure alive until a worker
+     * takes it off of the queue.
+     */
+    m_queue[(m_head + m_pending) % m_backlog] = runnable;
+
+    /*
+     * Events are only touched on transitions; setting an event is a system
+     * call, so we don't want to do it for every Runnable.
+     */
+    if (m_pending++ == 0) {
+        m_workEvent.SetEvent();
+    }
+    if (m_pending == m_backlog) {
+        m_roomEvent.ResetEvent();
+    }
+}
+
+Ptr<Runnable> ThreadPool::Dequeue()
+{
+    assert(m_pending && "ThreadPool::Dequeue(): Work queue underflow");
+
+    Ptr<Runnable> runnable = m_queue[m_head];
+    m_queue[m_head] = Ptr<Runnable>();
+    m_head = (m_head + 1) % m_backlog;
+
+    if (m_pending-- == m_backlog) {
+        m_roomEvent.SetEvent();
+    }
+    if (m_pending == 0) {
+        m_workEvent.ResetEvent();
+    }
+    return runnable;
+}
+
+ThreadPoolWorker* ThreadPool::GetCurrentWorker()
+{
+    Thread* thread = Thread::GetThread();
+    for (uint32_t i = 0; i < m_poolsize; ++i) {
+        if (m_workers[i] == thread) {
+            return m_workers[i];
+        }
+    }
+    return NULL;
+}
+
+bool ThreadPool::PushLocal(ThreadPoolWorker* worker, const Ptr<Runnable>& runnable)
+{
+    /*
+     * The deque slot holds its own reference to the closure.
+     */
+    Runnable* raw = runnable.Peek();
+    raw->IncRef();
+    if (!worker->GetDeque()->Push(raw)) {
+        raw->DecRef();
+        return false;
+    }
+    return true;
+}
+
+void ThreadPool::WakeIdle()
+{
+    /*
+     * The push was a full barrier, so if a worker that is going idle has not
+     * announced itself yet it will find our Runnable when it takes its last
+     * look around.
+     */
+    if (m_idle) {
+        m_workEvent.SetEvent();
+    }
+}
+
 QStatus ThreadPool::Execute(Ptr<Runnable> runnable)
 {
     QCC_DbgPrintf(("ThreadPool::Execute()"));
 
-    QCC_DbgPrintf(("ThreadPool::Execute(): Taking lock"));
+    if (m_workStealing && !m_stopping) {
+        ThreadPoolWorker* worker = GetCurrentWorker();
+        if (worker && PushLocal(worker, runnable)) {
+            WakeIdle();
+            return ER_OK;
+        }
+    }
+
     m_lock.Lock();
 
     /*
      * Refuse to add any new closures if we're in the process of closing.
      */
     if (m_stopping) {
-        QCC_DbgPrintf(("ThreadPool::Execute(): Giving lock"));
         m_lock.Unlock();
         QCC_DbgPrintf(("ThreadPool::Execute(): Stopping"));
         return ER_THREADPOOL_STOPPING;
@@ -149,184 +544,179 @@ QStatus ThreadPool::Execute(Ptr<Runnable> runnable)
      * Since AllJoyn is at its heart a distributed network application, and what
      * drives the execution of our threads will be network traffic, we need to
      * be able to apply backpressure to the network to avoid exhausting all
-     * available resources.  This is enabled by returning an error when all of
-     * the threads are in process.  This is a thread pool, not a work queue.
+     * available resources.  This is enabled by returning an error when the
+     * work queue is full.
      */
-    if (m_closures.size() == m_poolsize) {
-        QCC_DbgPrintf(("ThreadPool::Execute(): Giving lock"));
+    if (m_pending == m_backlog) {
         m_lock.Unlock();
         QCC_DbgPrintf(("ThreadPool::Execute(): Exhausted"));
         return ER_THREADPOOL_EXHAUSTED;
     }
 
-    /*
-     * We need to make sure that the runnable object is kept alive while it is
-     * waiting to be run (and while it is running) so we keep a reference to it
-     * until we don't need it any more.  This also allows us to keep track of
-     * how many pending operations there are.  Note that the map is keyed on the
-     * underlying runnable object pointer, but the smart pointer is saved in the
-     * map in order to hold a reference to the object.
-     */
-    QCC_DbgPrintf(("ThreadPool::Execute(): Schedule runnable"));
-    m_closures[runnable.Peek()] = runnable;
-    QCC_DbgPrintf(("ThreadPool::Execute(): %d closures remain", m_closures.size()));
+    Enqueue(runnable);
+    m_lock.Unlock();
+    return ER_OK;
+}
 
-    /*
-     * Tell the runnable object where to contact us when it is done executing.
-     * Since we're not the one that is actually going to dispatch the thread
-     * we need to have whatever thread that goes in there call us us back so
-     * we can know when to release the object.
-     */
-    runnable->SetThreadPool(this);
+QStatus ThreadPool::ExecuteBatch(const std::vector<Ptr<Runnable> >& runnables, uint32_t maxMs, uint32_t* queued)
+{
+    QCC_DbgPrintf(("ThreadPool::ExecuteBatch(): %d runnables", runnables.size()));
+
+    size_t i = 0;
+    QStatus status = ER_OK;
+
+    if (m_workStealing && !m_stopping) {
+        ThreadPoolWorker* worker = GetCurrentWorker();
+        if (worker) {
+            while ((i < runnables.size()) && PushLocal(worker, runnables[i])) {
+                ++i;
+            }
+            if (i) {
+                WakeIdle();
+            }
+        }
+    }
 
-    /*
-     * The trick here is to add an alarm that expires immediately and executes
-     * the AlarmTriggered method of the provided Runnable object.  This will
-     * call the Run() method of the Runnable.  So although we use Timers and
-     * Alarms, we schedule everthing to happen immediately, and the result looks
-     * like a thread pool that we all know and love.
-     *
-     * Since <runnable> is a smart pointer, we need to get the underlying object
-     * pointer using Peek().  This object pointer is automagically cast to an
-     * AlarmListener which defines which actual callback which the alarm will
-     * call.
-     */
-    uint32_t zero = 0;
-    void* voidptr = NULL;
-    AlarmListener* listener = runnable.Peek();
-    Alarm alarm = Alarm(zero, listener, voidptr, zero);
-    QCC_DbgPrintf(("ThreadPool::Execute(): AddAlarm()"));
-    QStatus status = m_dispatcher.AddAlarm(alarm);
-    QCC_DbgPrintf(("ThreadPool::Execute(): Giving lock"));
-    m_lock.Unlock();
+    if (i < runnables.size()) {
+        /*
+         * Enqueue() only sets the work event when the queue goes from empty to
+         * non-empty, so the workers are woken at most once for every time we
+         * have to wait for room.
+         */
+        uint64_t startTime = GetTimestamp64();
+        m_lock.Lock();
+        while (i < runnables.size()) {
+            uint32_t waitMs = Event::WAIT_FOREVER;
+            if (maxMs != Event::WAIT_FOREVER) {
+                uint64_t elapsed = GetTimestamp64() - startTime;
+                waitMs = (elapsed < maxMs) ? (maxMs - static_cast<uint32_t>(elapsed)) : 0;
+            }
+            status = WaitForRoom(waitMs);
+            if (status != ER_OK) {
+                break;
+            }
+            while ((i < runnables.size()) && (m_pending < m_backlog)) {
+                Enqueue(runnables[i++]);
+            }
+        }
+        m_lock.Unlock();
+    }
+
+    if (queued) {
+        *queued = static_cast<uint32_t>(i);
+    }
     return status;
 }
 
-void ThreadPool::Release(Runnable* runnable)
+QStatus ThreadPool::Spawn(Ptr<Runnable> runnable)
 {
-    QCC_DbgPrintf(("ThreadPool::Release()"));
+    QCC_DbgPrintf(("ThreadPool::Spawn()"));
 
-    /*
-     * After the closure corresponding to the Runnable pointer above has finished
-     * executing, it needs to call us back here and tell us that its heap object is
-     * no longer required; and that we can release our hold on that object.
-     *
-     * We save a smart pointer to the Runnable in our m_closures map, so we need to
-     * erase that entry.  Since the entry is a smart pointer, the act of erasing it
-     * will cause the reference count of the object to be decremented and the
-     * underlying object to be deleted if possible.
-     */
-    QCC_DbgPrintf(("ThreadPool::Release(): Taking lock"));
-    m_lock.Lock();
-    QCC_DbgPrintf(("ThreadPool::Release(): Got lock"));
+    ThreadPoolWorker* worker = GetCurrentWorker();
+    if (!worker) {
+        return Execute(runnable);
+    }
+
+    if (m_stopping) {
+        return ER_THREADPOOL_STOPPING;
+    }
 
-    RunnableEntry::iterator i = m_closures.find(runnable);
-    assert(i != m_closures.end() && "ThreadPool::Release(): Cannot find closure to release");
-    m_closures.erase(i);
+    if (m_workStealing && PushLocal(worker, runnable)) {
+        WakeIdle();
+        return ER_OK;
+    }
+
+    m_lock.Lock();
+    if (m_pending < m_backlog) {
+        Enqueue(runnable);
+        m_lock.Unlock();
+        return ER_OK;
+    }
+    m_lock.Unlock();
 
     /*
-     * Release needs to work in conjunction with Execute() and
-     * WaitForAvailableThread() to ensure that no than m_poolSize threads are
-     * dispatched at any one time.  We set an event every time a thread
-     * completes its Run() method which can then wake up an external thread
-     * waiting for an available thread to do its work.
+     * Blocking a worker until there is room could deadlock the pool if every
+     * worker ends up doing so, and refusing the subtask would break whatever
+     * is waiting on it.  So we just run it here.
      */
-    m_event.SetEvent();
+    QCC_DbgPrintf(("ThreadPool::Spawn(): No room, running inline"));
+    IncrementAndFetch(&m_running);
+    runnable->Run();
+    DecrementAndFetch(&m_running);
+    return ER_OK;
+}
 
-    QCC_DbgPrintf(("ThreadPool::Release(): %d closures remain", m_closures.size()));
+QStatus ThreadPool::ExecuteBlocking(Ptr<Runnable> runnable, uint32_t maxMs)
+{
+    QCC_DbgPrintf(("ThreadPool::ExecuteBlocking()"));
 
-    QCC_DbgPrintf(("ThreadPool::Release(): Giving lock"));
+    m_lock.Lock();
+    QStatus status = WaitForRoom(maxMs);
+    if (status == ER_OK) {
+        Enqueue(runnable);
+    }
     m_lock.Unlock();
+    return status;
 }
 
 QStatus ThreadPool::WaitForAvailableThread(void)
 {
     QCC_DbgPrintf(("ThreadPool::WaitForAvailableThread()"));
 
-    /*
-     * Our job here is loop until a thread is available to execute a closure.
-     */
-    QCC_DbgPrintf(("ThreadPool::WaitForAvailableThread(): Taking lock"));
     m_lock.Lock();
+    QStatus status = WaitForRoom(Event::WAIT_FOREVER);
+    m_lock.Unlock();
+    return status;
+}
 
-    for (;;) {
+QStatus ThreadPool::WaitForRoom(uint32_t maxMs)
+{
+    uint64_t startTime = GetTimestamp64();
 
+    for (;;) {
         /*
-         * We can't have an available thread if we're stopping.
+         * We can't have room for a closure if we're stopping.
          */
         if (m_stopping) {
-            QCC_DbgPrintf(("ThreadPool::WaitforAvailableThread(): Giving lock"));
-            m_lock.Unlock();
-            QCC_DbgPrintf(("ThreadPool::WaitForAvailableThread(): Stopping"));
+            QCC_DbgPrintf(("ThreadPool::WaitForRoom(): Stopping"));
             return ER_THREADPOOL_STOPPING;
         }
 
-        QCC_DbgPrintf(("ThreadPool::WaitForAvailableThread(): m_closures.size() == %d.", m_closures.size()));
-        QCC_DbgPrintf(("ThreadPool::WaitForAvailableThread(): m_poolsize == %d.", m_poolsize));
-
-        /*
-         * There are no available threads for us to use doing our work, so we
-         * must block until one of them completes.  When one completes, in its
-         * Release() function, it will do a SetEvent() on our wait event to let
-         * us know that it is done.  We reset this event here, with the shared
-         * lock taken.  This ensures that there can be no Release() in progress
-         * and when the next one happens we will be notified.
-         *
-         * This may seem a peculiar place to put this reset, but there is a
-         * method to my madness.  It turns out that SetEvent() is implemented by
-         * a write to an FD.  ResetEvent reads the file and empties it.  If the
-         * Release() function always does a SetEvent(), it writes characters to
-         * the underlying file.  If that file is never read, it eventually
-         * blocks writes and SetEvent() blocks.  So there must be ResetEvent()
-         * calls made to read this file even though we may not need to block and
-         * wait for threads to finish.  Thus, even though the ResetEvent() should
-         * logically go right before the Event::Wait() we do it here to drain
-         * the event file (on Linux).
-         */
-        m_event.ResetEvent();
-
-        /*
-         * We enter the loop with the mutex that interlocks us with the release
-         * method taken.  Since the lock is taken, the release function must
-         * not change its state so we can look around safely and see whether
-         * or not there is currently an available thread.
-         *
-         * There is a closure on the m_closures map for the duration of time
-         * when a Runnable closure is waiting to be executed and while it is in
-         * process.  So, if the size of the m_closures map is less than the pool
-         * size, it means that not all of our thread pool threads are occupied
-         * and at least one is available, so we return.
-         */
-        if (m_closures.size() < m_poolsize) {
-            QCC_DbgPrintf(("ThreadPool::WaitforAvailableThread(): Giving lock"));
-            m_lock.Unlock();
-            QCC_DbgPrintf(("ThreadPool::WaitForAvailableThread(): Thread available"));
+        if (m_pending < m_backlog) {
             return ER_OK;
         }
 
-        QCC_DbgPrintf(("ThreadPool::WaitForAvailableThread(): Waiting on thread completion event.  Giving lock"));
-        m_lock.Unlock();
+        uint32_t waitMs = Event::WAIT_FOREVER;
+        if (maxMs != Event::WAIT_FOREVER) {
+            uint64_t elapsed = GetTimestamp64() - startTime;
+            if (elapsed >= maxMs) {
+                return ER_TIMEOUT;
+            }
+            waitMs = maxMs - static_cast<uint32_t>(elapsed);
+        }
 
         /*
+         * The room event is reset with the lock held when the queue fills and
+         * set with the lock held when a worker takes a closure off of a full
+         * queue, so it cannot change state between our check above and the
+         * wait below.
+         *
          * We are executing in the context of some unknown (to us) thread.  This
          * thread can be stopped and alerted using its own mechanisms so we have
-         * to play fair with all of that.  The only return code we are interested
-         * in is ER_OK, which means that we set our event.  Any other error code
-         * should be returned to the caller, who can figure out the right thing
-         * to do.
+         * to play fair with all of that.  The only return codes we are
+         * interested in are ER_OK, which means that our event was set, and
+         * ER_TIMEOUT.  Any other error code should be returned to the caller,
+         * who can figure out the right thing to do.
          */
-        QStatus status = Event::Wait(m_event, Event::WAIT_FOREVER);
-        if (status != ER_OK) {
-            QCC_DbgPrintf(("ThreadPool::WaitForAvailableThread(): Event::Wait() error"));
+        QCC_DbgPrintf(("ThreadPool::WaitForRoom(): Waiting on room event"));
+        m_lock.Unlock();
+        QStatus status = Event::Wait(m_roomEvent, waitMs);
+        m_lock.Lock();
+        if ((status != ER_OK) && (status != ER_TIMEOUT)) {
+            QCC_DbgPrintf(("ThreadPool::WaitForRoom(): Event::Wait() error"));
             return status;
         }
-
-        QCC_DbgPrintf(("ThreadPool::WaitForAvailableThread(): Taking lock"));
-        m_lock.Lock();
     }
-
-    assert(false && "ThreadPool::WaitForAvailableThread(): Can't happen");
-    return ER_FAIL;
 }
 
 } // namespace qcc
@@ -27,6 +27,7 @@
 
 #include <qcc/Debug.h>
 #include <qcc/String.h>
+#include <qcc/StringBuilder.h>
 #include <qcc/StringUtil.h>
 #include <qcc/XmlElement.h>
 
@@ -38,8 +39,7 @@ using namespace std;
 
 namespace qcc {
 
-static qcc::String escapeXml(const qcc::String& str) {
-    qcc::String outStr;
+static void escapeXml(StringBuilder& outStr, const qcc::String& str) {
     qcc::String::const_iterator it = str.begin();
     int multi = 0;
     int idx = 0;
@@ -69,11 +69,11 @@ static qcc::String escapeXml(const qcc::String& str) {
             } else if (c == '>') {
                 outStr.append("&gt;");
             } else if (((0x20 <= c) && (0x7e >= c)) || (0x09 == 9) || (0x0a == c) || (0x0d == c)) {
-                outStr.push_back(c);
+                outStr.append(static_cast<char>(c));
             } else {
                 outStr.append("&#");
-                outStr.append(U32ToString(c, 16));
-                outStr.push_back(';');
+                outStr.appendU32(c, 16);
+                outStr.append(';');
             }
         } else if (1 == multi) {
             if (1 == idx) {
@@ -103,15 +103,14 @@ static qcc::String escapeXml(const qcc::String& str) {
 
         if ((0 < multi) && (0 == idx)) {
             outStr.append("&#");
-            outStr.append(U32ToString(val, 16));
-            outStr.push_back(';');
+            outStr.appendU32(val, 16);
+            outStr.append(';');
         }
 
         if (0 < idx) {
             --idx;
         }
     }
-    return outStr;
 }
 
 static qcc::String unescapeXml(const qcc::String& str) {
@@ -346,21 +345,27 @@ XmlElement::~XmlElement()
 
 qcc::String XmlElement::Generate(qcc::String* outStr) const
 {
-    qcc::String startStr;
+    StringBuilder builder;
+    Generate(builder);
     if (NULL == outStr) {
-        outStr = &startStr;
+        return builder.ToString();
     }
+    builder.AppendTo(*outStr);
+    return *outStr;
+}
 
-    outStr->append("\n<");
-    outStr->append(name);
+void XmlElement::Generate(StringBuilder& outStr) const
+{
+    outStr.append("\n<");
+    outStr.append(name);
 
     map<qcc::String, qcc::String>::const_iterator ait = attributes.begin();
     while (ait != attributes.end()) {
-        outStr->push_back(' ');
-        outStr->append(ait->first);
-        outStr->append("=\"");
-        outStr->append(ait->second);
-        outStr->push_back('"');
+        outStr.append(' ');
+        outStr.append(ait->first);
+        outStr.append("=\"");
+        outStr.append(ait->second);
+        outStr.append('"');
         ait++;
     }
 
@@ -368,9 +373,9 @@ qcc::String XmlElement::Generate(qcc::String* outStr) const
     bool hasChildren = (cit != children.end());
 
     if (!hasChildren && content.empty()) {
-        outStr->push_back('/');
+        outStr.append('/');
     }
-    outStr->append(">");
+    outStr.append('>');
 
     if (hasChildren) {
         while (cit != children.end()) {
@@ -378,19 +383,17 @@ qcc::String XmlElement::Generate(qcc::String* outStr) const
             ++cit;
         }
     } else if (!content.empty()) {
-        outStr->append(escapeXml(content));
+        escapeXml(outStr, content);
     }
 
     if (hasChildren || !content.empty()) {
         if (hasChildren) {
-            outStr->push_back('\n');
+            outStr.append('\n');
         }
-        outStr->append("</");
-        outStr->append(name);
-        outStr->push_back('>');
+        outStr.append("</");
+        outStr.append(name);
+        outStr.append('>');
     }
-
-    return *outStr;
 }
 
 XmlElement& XmlElement::CreateChild(const qcc::String& name)
@@ -400,12 +403,12 @@ XmlElement& XmlElement::CreateChild(const qcc::String& name)
     return *children.back();
 }
 
-std::vector<const XmlElement*> XmlElement::GetChildren(const qcc::String& name) const
+std::vector<const XmlElement*> XmlElement::GetChildren(const qcc::StringRef& name) const
 {
     std::vector<const XmlElement*> matches;
     vector<XmlElement*>::const_iterator it = children.begin();
     while (it != children.end()) {
-        if (0 == name.compare((*it)->GetName())) {
+        if (name == (*it)->GetName()) {
             matches.push_back(*it);
         }
         it++;
@@ -413,11 +416,11 @@ std::vector<const XmlElement*> XmlElement::GetChildren(const qcc::String& name)
     return matches;
 }
 
-const XmlElement* XmlElement::GetChild(const qcc::String& name) const
+const XmlElement* XmlElement::GetChild(const qcc::StringRef& name) const
 {
     vector<XmlElement*>::const_iterator it = children.begin();
     while (it != children.end()) {
-        if (0 == name.compare((*it)->GetName())) {
+        if (name == (*it)->GetName()) {
             return (*it);
         }
         it++;
@@ -425,44 +428,47 @@ const XmlElement* XmlElement::GetChild(const qcc::String& name) const
     return NULL;
 }
 
-const qcc::String& XmlElement::GetAttribute(const char* attName) const
-{
-    return GetAttribute(String(attName));
-}
-
-const qcc::String& XmlElement::GetAttribute(const qcc::String& attName) const
+const qcc::String& XmlElement::GetAttribute(const qcc::StringRef& attName) const
 {
-    map<qcc::String, qcc::String>::const_iterator it = attributes.find(attName);
-    if (it == attributes.end()) {
-        return String::Empty;
-    } else {
-        return it->second;
+    /*
+     * Elements have few attributes so a scan of the (ordered) map is as quick
+     * as find() and does not need a String key to be constructed.
+     */
+    map<qcc::String, qcc::String>::const_iterator it = attributes.begin();
+    while (it != attributes.end()) {
+        int cmp = StringRef(it->first).compare(attName);
+        if (cmp == 0) {
+            return it->second;
+        } else if (cmp > 0) {
+            break;
+        }
+        ++it;
     }
+    return String::Empty;
 }
 
-std::vector<const XmlElement*> XmlElement::GetPath(const qcc::String& inPath) const
+std::vector<const XmlElement*> XmlElement::GetPath(const qcc::StringRef& inPath) const
 {
     std::vector<const XmlElement*> matches;
-    qcc::String val;
-    qcc::String attr;
-    qcc::String path = inPath;
+    qcc::StringRef attr;
+    qcc::StringRef path = inPath;
 
     /* Strip attribute from the path if present */
-    size_t pos = path.find_first_of('@');
-    if (pos != String::npos) {
+    size_t pos = path.find('@');
+    if (pos != StringRef::npos) {
         attr = path.substr(pos + 1);
-        path.erase(pos);
+        path = path.substr(0, pos);
     }
-    pos = path.find_first_of('/');
+    pos = path.find('/');
     const XmlElement* xml = this;
     while (xml) {
-        if (pos == String::npos) {
-            matches = xml->GetChildren(path.substr(0, pos));
+        if (pos == StringRef::npos) {
+            matches = xml->GetChildren(path);
             break;
         }
         xml = xml->GetChild(path.substr(0, pos));
-        path.erase(0, pos + 1);
-        pos = path.find_first_of('/');
+        path = path.substr(pos + 1);
+        pos = path.find('/');
     }
     /* Filter out matches that don't have the required attribute */
     if (!attr.empty()) {
@@ -0,0 +1,270 @@
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <gtest/gtest.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <qcc/Allocator.h>
+#include <qcc/ManagedObj.h>
+#include <qcc/String.h>
+#include <qcc/Thread.h>
+#include <qcc/time.h>
+#include <Status.h>
+
+using namespace qcc;
+
+namespace {
+
+struct Tracked {
+    Tracked() : value(0) { }
+    Tracked(int value) : value(value) { }
+    int value;
+    char payload[40];
+};
+
+struct Counted {
+    uint64_t a, b;
+};
+
+class CountingAllocator : public Allocator {
+  public:
+    CountingAllocator() : allocs(0), frees(0), bytes(0) { }
+    void* Allocate(size_t size)
+    {
+        IncrementAndFetch(&allocs);
+        AtomicFetchAdd(&bytes, size, MEMORY_ORDER_RELAXED);
+        return malloc(size);
+    }
+    void Free(void* mem, size_t size)
+    {
+        IncrementAndFetch(&frees);
+        AtomicFetchAdd(&bytes, static_cast<size_t>(0) - size, MEMORY_ORDER_RELAXED);
+        free(mem);
+    }
+    volatile int32_t allocs;
+    volatile int32_t frees;
+    volatile size_t bytes;
+};
+
+}
+
+TEST(AllocatorTest, ManagedObjStats) {
+    const AllocStats& stats = ManagedObj<Tracked>::GetStats();
+    int32_t before = stats.GetLiveObjects();
+    size_t bytesBefore = stats.GetLiveBytes();
+    {
+        ManagedObj<Tracked> a(7);
+        ManagedObj<Tracked> b;
+        ManagedObj<Tracked> c = a;
+        EXPECT_EQ(before + 2, stats.GetLiveObjects());
+        EXPECT_EQ(bytesBefore + 2 * stats.objectSize, stats.GetLiveBytes());
+        EXPECT_LE(sizeof(Tracked), stats.objectSize);
+        EXPECT_EQ(7, c->value);
+    }
+    EXPECT_EQ(before, stats.GetLiveObjects());
+    EXPECT_EQ(bytesBefore, stats.GetLiveBytes());
+
+    /* The counts are in the list under the name of the type */
+    bool found = false;
+    for (const AllocStats* s = AllocStats::GetFirst(); s; s = s->GetNext()) {
+        if (s == &stats) {
+            EXPECT_TRUE(strstr(s->GetName(), "Tracked") != NULL);
+            EXPECT_TRUE(strchr(s->GetName(), '[') == NULL);
+            found = true;
+        }
+    }
+    EXPECT_TRUE(found);
+}
+
+TEST(AllocatorTest, StringStats) {
+    const AllocStats* stats = NULL;
+    String longStr(200, 'x');
+    for (const AllocStats* s = AllocStats::GetFirst(); s; s = s->GetNext()) {
+        if (strcmp(s->GetName(), "qcc::String") == 0) {
+            stats = s;
+        }
+    }
+    ASSERT_TRUE(stats != NULL);
+    int32_t before = stats->GetLiveObjects();
+    size_t bytesBefore = stats->GetLiveBytes();
+    {
+        /* Inline strings and shared storage are not counted */
+        String shortStr("short");
+        String copy = longStr;
+        EXPECT_EQ(before, stats->GetLiveObjects());
+        String another(500, 'y');
+        EXPECT_EQ(before + 1, stats->GetLiveObjects());
+        EXPECT_LT(bytesBefore + 500, stats->GetLiveBytes());
+    }
+    EXPECT_EQ(before, stats->GetLiveObjects());
+    EXPECT_EQ(bytesBefore, stats->GetLiveBytes());
+}
+
+TEST(AllocatorTest, SetCurrent) {
+    CountingAllocator counting;
+    ManagedObj<Counted> fromPool;
+    String poolStr(100, 'p');
+
+    ASSERT_EQ(ER_OK, Allocator::SetCurrent(&counting));
+    EXPECT_EQ(&counting, &Allocator::GetCurrent());
+    {
+        ManagedObj<Counted> fromCounting;
+        String countingStr(100, 'c');
+        EXPECT_EQ(2, counting.allocs);
+
+        /* Blocks from the pool go back to the pool */
+        fromPool = ManagedObj<Counted>();
+        poolStr = countingStr;
+        EXPECT_EQ(3, counting.allocs);
+        EXPECT_EQ(0, counting.frees);
+    }
+    EXPECT_EQ(1, counting.frees);
+
+    ASSERT_EQ(ER_OK, Allocator::SetCurrent(NULL));
+    EXPECT_EQ(&Allocator::GetPool(), &Allocator::GetCurrent());
+
+    /* Blocks from the counting allocator go back to it */
+    fromPool = ManagedObj<Counted>();
+    poolStr = "inline";
+    EXPECT_EQ(3, counting.allocs);
+    EXPECT_EQ(3, counting.frees);
+    EXPECT_EQ(0U, counting.bytes);
+
+    /* Installing the same allocator again reuses its slot */
+    ASSERT_EQ(ER_OK, Allocator::SetCurrent(&counting));
+    ASSERT_EQ(ER_OK, Allocator::SetCurrent(&Allocator::GetPool()));
+}
+
+TEST(AllocatorTest, PoolSizes) {
+    Allocator& pool = Allocator::GetPool();
+    void* blocks[2048];
+    for (size_t size = 1; size < 2048; ++size) {
+        blocks[size] = pool.Allocate(size);
+        ASSERT_TRUE(blocks[size] != NULL);
+        EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(blocks[size]) % 8);
+        memset(blocks[size], static_cast<int>(size), size);
+    }
+    for (size_t size = 1; size < 2048; ++size) {
+        const uint8_t* p = static_cast<const uint8_t*>(blocks[size]);
+        EXPECT_EQ(static_cast<uint8_t>(size), p[0]);
+        EXPECT_EQ(static_cast<uint8_t>(size), p[size - 1]);
+        pool.Free(blocks[size], size);
+    }
+}
+
+static const uint32_t STRESS_ITERATIONS = 20000;
+
+static ThreadReturn STDCALL StressThread(void* arg)
+{
+    uint32_t seed = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(arg));
+    Allocator& pool = Allocator::GetPool();
+    void* held[64] = { NULL };
+    size_t sizes[64] = { 0 };
+    for (uint32_t i = 0; i < STRESS_ITERATIONS; ++i) {
+        seed = seed * 1103515245 + 12345;
+        uint32_t slot = (seed >> 8) % 64;
+        if (held[slot]) {
+            if (*static_cast<uint32_t*>(held[slot]) != slot) {
+                return reinterpret_cast<ThreadReturn>(1);
+            }
+            pool.Free(held[slot], sizes[slot]);
+            held[slot] = NULL;
+        } else {
+            sizes[slot] = 4 + (seed >> 16) % 1200;
+            held[slot] = pool.Allocate(sizes[slot]);
+            *static_cast<uint32_t*>(held[slot]) = slot;
+        }
+        if ((i % 1000) == 0) {
+            ManagedObj<Tracked> obj(static_cast<int>(i));
+            String str(64 + (i % 64), 's');
+        }
+    }
+    for (uint32_t slot = 0; slot < 64; ++slot) {
+        pool.Free(held[slot], sizes[slot]);
+    }
+    return 0;
+}
+
+TEST(AllocatorTest, Threads) {
+    const size_t numThreads = 8;
+    Thread* threads[numThreads];
+    int32_t before = ManagedObj<Tracked>::GetStats().GetLiveObjects();
+    for (size_t i = 0; i < numThreads; ++i) {
+        threads[i] = new Thread("AllocStress", StressThread);
+        ASSERT_EQ(ER_OK, threads[i]->Start(reinterpret_cast<void*>(i + 1)));
+    }
+    for (size_t i = 0; i < numThreads; ++i) {
+        threads[i]->Join();
+        EXPECT_TRUE(threads[i]->GetExitValue() == 0);
+        delete threads[i];
+    }
+    EXPECT_EQ(before, ManagedObj<Tracked>::GetStats().GetLiveObjects());
+}
+
+/*
+ * Compare creating and destroying small managed objects and strings with the
+ * pool and with malloc.
+ */
+TEST(AllocatorTest, DISABLED_Benchmark) {
+    const uint32_t iterations = 2000000;
+    CountingAllocator heap;
+
+    for (int pass = 0; pass < 2; ++pass) {
+        Allocator::SetCurrent(pass ? &heap : NULL);
+        uint64_t start = GetTimestamp64();
+        for (uint32_t i = 0; i < iterations; ++i) {
+            ManagedObj<Tracked> obj(static_cast<int>(i));
+            ManagedObj<Tracked> copy = obj;
+            String str(32 + (i & 31), 'x');
+        }
+        uint64_t elapsed = GetTimestamp64() - start;
+        printf("%s: %.1f ns per iteration\n", pass ? "malloc" : "pool  ", elapsed * 1e6 / iterations);
+    }
+    Allocator::SetCurrent(NULL);
+}
+
+static const uint32_t CONTENDED_ITERATIONS = 500000;
+
+static ThreadReturn STDCALL ContendedThread(void* arg)
+{
+    for (uint32_t i = 0; i < CONTENDED_ITERATIONS; ++i) {
+        ManagedObj<Tracked> obj(static_cast<int>(i));
+        String str(32 + (i & 31), 'x');
+    }
+    return 0;
+}
+
+/*
+ * Create and destroy managed objects and strings from several threads at
+ * once, which is where shared counters would contend.
+ */
+TEST(AllocatorTest, DISABLED_ThreadsBenchmark) {
+    const size_t numThreads = 8;
+    Thread* threads[numThreads];
+    uint64_t start = GetTimestamp64();
+    for (size_t i = 0; i < numThreads; ++i) {
+        threads[i] = new Thread("AllocBench", ContendedThread);
+        ASSERT_EQ(ER_OK, threads[i]->Start(NULL));
+    }
+    for (size_t i = 0; i < numThreads; ++i) {
+        threads[i]->Join();
+        delete threads[i];
+    }
+    uint64_t elapsed = GetTimestamp64() - start;
+    printf("%u threads: %.1f ns per iteration\n", static_cast<uint32_t>(numThreads), elapsed * 1e6 / (numThreads * CONTENDED_ITERATIONS));
+}
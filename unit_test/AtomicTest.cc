@@ -0,0 +1,126 @@
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <qcc/Thread.h>
+#include <qcc/atomic.h>
+#include <Status.h>
+
+using namespace qcc;
+
+TEST(AtomicTest, SingleThreaded) {
+    Atomic<int32_t> i(5);
+    EXPECT_EQ(5, i.Load());
+    EXPECT_EQ(5, i.FetchAdd(3));
+    EXPECT_EQ(8, i.FetchSub(2, MEMORY_ORDER_RELAXED));
+    EXPECT_EQ(7, ++i);
+    EXPECT_EQ(6, --i);
+    EXPECT_EQ(6, i.Exchange(10, MEMORY_ORDER_ACQ_REL));
+
+    int32_t expected = 3;
+    EXPECT_FALSE(i.CompareExchange(expected, 4));
+    EXPECT_EQ(10, expected);
+    EXPECT_TRUE(i.CompareExchange(expected, 4, MEMORY_ORDER_ACQUIRE));
+    EXPECT_EQ(4, static_cast<int32_t>(i));
+
+    Atomic<uint64_t> big(0);
+    big.Store(0x100000000ULL, MEMORY_ORDER_RELEASE);
+    EXPECT_EQ(0x100000000ULL, big.FetchAdd(1));
+    EXPECT_EQ(0x100000001ULL, big.Load(MEMORY_ORDER_ACQUIRE));
+
+    Atomic<bool> flag;
+    EXPECT_FALSE(flag);
+    flag = true;
+    EXPECT_TRUE(flag.Load());
+    EXPECT_TRUE(flag.Exchange(false));
+    bool expectedFlag = true;
+    EXPECT_FALSE(flag.CompareExchange(expectedFlag, true));
+    EXPECT_FALSE(expectedFlag);
+    EXPECT_TRUE(flag.CompareExchange(expectedFlag, true));
+    EXPECT_TRUE(flag);
+
+    int32_t array[4] = { 0, 1, 2, 3 };
+    Atomic<int32_t*> p(array);
+    EXPECT_EQ(&array[0], p.FetchAdd(2));
+    EXPECT_EQ(2, *p.Load());
+    EXPECT_EQ(&array[2], p.FetchSub(1));
+    EXPECT_EQ(&array[1], p.Exchange(&array[3]));
+    int32_t* expectedPtr = &array[3];
+    EXPECT_TRUE(p.CompareExchange(expectedPtr, NULL));
+    EXPECT_TRUE(p.Load() == NULL);
+}
+
+/*
+ * Each thread adds to a shared counter and pushes entries onto a shared
+ * lock-free stack.
+ */
+struct Node {
+    Node* next;
+};
+
+class AtomicThread : public Thread {
+  public:
+    AtomicThread(Atomic<int64_t>& counter, Atomic<Node*>& stack, uint32_t iterations)
+        : Thread("AtomicThread"), counter(counter), stack(stack), nodes(iterations) { }
+  protected:
+    ThreadReturn STDCALL Run(void* arg)
+    {
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            counter.FetchAdd(1, MEMORY_ORDER_RELAXED);
+            Node* node = &nodes[i];
+            node->next = stack.Load(MEMORY_ORDER_RELAXED);
+            while (!stack.CompareExchange(node->next, node, MEMORY_ORDER_RELEASE)) {
+            }
+        }
+        return 0;
+    }
+  private:
+    Atomic<int64_t>& counter;
+    Atomic<Node*>& stack;
+    std::vector<Node> nodes;
+};
+
+TEST(AtomicTest, MultiThreaded) {
+    const uint32_t numThreads = 8;
+    const uint32_t iterations = 50000;
+    Atomic<int64_t> counter(0);
+    Atomic<Node*> stack(NULL);
+
+    std::vector<AtomicThread*> threads;
+    for (uint32_t i = 0; i < numThreads; ++i) {
+        threads.push_back(new AtomicThread(counter, stack, iterations));
+    }
+    for (uint32_t i = 0; i < numThreads; ++i) {
+        threads[i]->Start();
+    }
+    for (uint32_t i = 0; i < numThreads; ++i) {
+        threads[i]->Join();
+    }
+    EXPECT_EQ(static_cast<int64_t>(numThreads * iterations), counter.Load());
+
+    /* No push was lost */
+    uint32_t count = 0;
+    for (Node* node = stack.Load(MEMORY_ORDER_ACQUIRE); node; node = node->next) {
+        ++count;
+    }
+    EXPECT_EQ(numThreads * iterations, count);
+
+    for (uint32_t i = 0; i < numThreads; ++i) {
+        delete threads[i];
+    }
+}
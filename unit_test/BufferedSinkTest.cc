@@ -0,0 +1,115 @@
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <qcc/BufferedSink.h>
+#include <qcc/Stream.h>
+#include <Status.h>
+
+using namespace qcc;
+
+namespace {
+
+/* Records what the BufferedSink pushes and whether it is corked */
+class RecordingSink : public Sink {
+  public:
+    RecordingSink() : corks(0), uncorks(0) { }
+
+    QStatus PushBytes(const void* buf, size_t numBytes, size_t& numSent)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(buf);
+        data.insert(data.end(), bytes, bytes + numBytes);
+        pushes.push_back(numBytes);
+        numSent = numBytes;
+        return ER_OK;
+    }
+
+    QStatus Cork() { ++corks; return ER_OK; }
+    QStatus Uncork() { ++uncorks; return ER_OK; }
+
+    std::vector<uint8_t> data;
+    std::vector<size_t> pushes;
+    int corks;
+    int uncorks;
+};
+
+const size_t CHUNK = 16;
+
+/*
+ * Push prefill bytes and then numBytes more, flush, and check that every
+ * push but the last was a full chunk and that everything arrived in order.
+ */
+void PushAndCheck(size_t prefill, size_t numBytes)
+{
+    std::vector<uint8_t> out(prefill + numBytes);
+    for (size_t i = 0; i < out.size(); ++i) {
+        out[i] = static_cast<uint8_t>(i * 7 + 1);
+    }
+
+    RecordingSink recorder;
+    {
+        BufferedSink sink(recorder, CHUNK);
+        sink.EnableWriteBuffer();
+        size_t sent;
+        if (prefill > 0) {
+            ASSERT_EQ(ER_OK, sink.PushBytes(&out[0], prefill, sent));
+            EXPECT_EQ(prefill, sent);
+        }
+        ASSERT_EQ(ER_OK, sink.PushBytes(&out[prefill], numBytes, sent));
+        EXPECT_EQ(numBytes, sent);
+        EXPECT_EQ((prefill + numBytes) / CHUNK, recorder.pushes.size());
+        for (size_t i = 0; i < recorder.pushes.size(); ++i) {
+            EXPECT_EQ(CHUNK, recorder.pushes[i]);
+        }
+        ASSERT_EQ(ER_OK, sink.Flush());
+    }
+    ASSERT_EQ(out.size(), recorder.data.size());
+    EXPECT_TRUE(out == recorder.data);
+}
+
+}
+
+TEST(BufferedSinkTest, exact_multiple_of_chunk) {
+    for (size_t k = 1; k <= 4; ++k) {
+        PushAndCheck(0, k * CHUNK);
+    }
+}
+
+TEST(BufferedSinkTest, exact_multiple_after_partial_chunk) {
+    for (size_t k = 1; k <= 4; ++k) {
+        /* k full chunks pushed onto a partly filled buffer */
+        PushAndCheck(5, k * CHUNK);
+        /* Exactly k full chunks left once the buffered bytes went out */
+        PushAndCheck(5, (CHUNK - 5) + k * CHUNK);
+    }
+}
+
+TEST(BufferedSinkTest, destructor_uncorks) {
+    RecordingSink recorder;
+    {
+        BufferedSink sink(recorder, CHUNK);
+        sink.EnableWriteBuffer();
+        uint8_t out[3 * CHUNK + 3] = { 0 };
+        size_t sent;
+        ASSERT_EQ(ER_OK, sink.PushBytes(out, sizeof(out), sent));
+        EXPECT_EQ(1, recorder.corks);
+        EXPECT_EQ(0, recorder.uncorks);
+    }
+    /* The sink is not left holding back the chunks already pushed */
+    EXPECT_EQ(1, recorder.uncorks);
+}
@@ -0,0 +1,127 @@
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <qcc/Epoch.h>
+#include <qcc/Mutex.h>
+#include <qcc/Thread.h>
+#include <qcc/atomic.h>
+#include <Status.h>
+
+using namespace qcc;
+
+/*
+ * A version of some shared data.  The destructor scribbles over it so that a
+ * reader using a deleted version is likely to notice.
+ */
+struct Version {
+    Version(uint32_t value) : value(value), check(~value) { }
+    ~Version() { check = value; Deleted().FetchAdd(1); }
+    bool Valid() const { return check == ~value; }
+    static Atomic<int32_t>& Deleted() { static Atomic<int32_t> deleted(0); return deleted; }
+    volatile uint32_t value;
+    volatile uint32_t check;
+};
+
+TEST(EpochTest, Retire) {
+    Epoch::Synchronize();
+    int32_t deleted = Version::Deleted().Load();
+
+    /* Nothing is deleted while a reader that might see it is active */
+    uint32_t outer = Epoch::Enter();
+    {
+        ScopedEpoch inner;
+        Epoch::Retire(new Version(1));
+    }
+    for (int i = 0; i < 5; ++i) {
+        Epoch::Reclaim();
+    }
+    EXPECT_EQ(deleted, Version::Deleted().Load());
+    EXPECT_LE(1U, Epoch::Pending());
+
+    Epoch::Exit(outer);
+    Epoch::Synchronize();
+    EXPECT_EQ(deleted + 1, Version::Deleted().Load());
+}
+
+class ReaderThread : public Thread {
+  public:
+    ReaderThread(RcuPtr<Version>& data, volatile bool& done)
+        : Thread("ReaderThread"), reads(0), errors(0), data(data), done(done) { }
+    uint32_t reads;
+    uint32_t errors;
+  protected:
+    ThreadReturn STDCALL Run(void* arg)
+    {
+        while (!done) {
+            ScopedEpoch epoch;
+            const Version* version = data.Get();
+            uint32_t last = version->value;
+            for (int i = 0; i < 100; ++i) {
+                if (!version->Valid() || version->value != last) {
+                    ++errors;
+                }
+            }
+            ++reads;
+        }
+        return 0;
+    }
+  private:
+    RcuPtr<Version>& data;
+    volatile bool& done;
+};
+
+TEST(EpochTest, ReadCopyUpdate) {
+    const uint32_t numReaders = 4;
+    const uint32_t numUpdates = 20000;
+    Epoch::Synchronize();
+    int32_t deleted = Version::Deleted().Load();
+
+    RcuPtr<Version>* data = new RcuPtr<Version>(new Version(0));
+    volatile bool done = false;
+    std::vector<ReaderThread*> readers;
+    for (uint32_t i = 0; i < numReaders; ++i) {
+        readers.push_back(new ReaderThread(*data, done));
+        readers.back()->Start();
+    }
+
+    /* The writer replaces the data while the readers look at it */
+    Mutex writeLock;
+    for (uint32_t i = 1; i <= numUpdates; ++i) {
+        writeLock.Lock(MUTEX_CONTEXT);
+        data->Publish(new Version(i));
+        writeLock.Unlock(MUTEX_CONTEXT);
+        if ((i % 1000) == 0) {
+            qcc::Sleep(1);
+        }
+    }
+    done = true;
+
+    for (uint32_t i = 0; i < numReaders; ++i) {
+        readers[i]->Join();
+        EXPECT_EQ(0U, readers[i]->errors);
+        EXPECT_LT(0U, readers[i]->reads);
+        delete readers[i];
+    }
+
+    /* Every replaced version gets deleted, and the last one with the RcuPtr */
+    Epoch::Synchronize();
+    EXPECT_EQ(deleted + static_cast<int32_t>(numUpdates), Version::Deleted().Load());
+    delete data;
+    EXPECT_EQ(deleted + static_cast<int32_t>(numUpdates) + 1, Version::Deleted().Load());
+}
@@ -0,0 +1,102 @@
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <qcc/InternedString.h>
+#include <qcc/String.h>
+#include <qcc/StringUtil.h>
+#include <qcc/Thread.h>
+#include <Status.h>
+
+using namespace qcc;
+
+TEST(InternedStringTest, Identity) {
+    InternedString a("org.alljoyn.Bus");
+    InternedString b(String("org.alljoyn.Bus"));
+    InternedString c(StringRef("org.alljoyn.Bus.Peer", 15));
+    InternedString d("org.alljoyn.Daemon");
+
+    EXPECT_TRUE(a == b);
+    EXPECT_TRUE(a == c);
+    EXPECT_TRUE(a != d);
+    EXPECT_EQ(a.c_str(), c.c_str());
+    EXPECT_STREQ("org.alljoyn.Bus", a.c_str());
+    EXPECT_EQ(15U, a.size());
+    EXPECT_EQ(StringRef("org.alljoyn.Bus").hash(), a.hash());
+    EXPECT_TRUE(a < d);
+    EXPECT_FALSE(d < a);
+    EXPECT_FALSE(a < b);
+
+    InternedString empty;
+    EXPECT_TRUE(empty.empty());
+    EXPECT_TRUE(empty == InternedString(""));
+    EXPECT_TRUE(empty.str().empty());
+
+    EXPECT_TRUE(InternedString::Lookup("org.alljoyn.Bus") == a);
+    EXPECT_TRUE(InternedString::Lookup("org.alljoyn.NeverInterned").empty());
+}
+
+TEST(InternedStringTest, Growth) {
+    /* Enough strings to make every shard grow several times */
+    std::vector<InternedString> handles;
+    for (uint32_t i = 0; i < 5000; ++i) {
+        handles.push_back(InternedString("InternedStringTest.Growth." + U32ToString(i)));
+    }
+    EXPECT_LE(5000U, InternedString::Count());
+    for (uint32_t i = 0; i < 5000; ++i) {
+        String name = "InternedStringTest.Growth." + U32ToString(i);
+        EXPECT_TRUE(handles[i] == InternedString::Lookup(name));
+        EXPECT_EQ(name, handles[i].str());
+    }
+}
+
+class InternThread : public Thread {
+  public:
+    InternThread() : Thread("InternThread") { }
+    std::vector<InternedString> handles;
+  protected:
+    ThreadReturn STDCALL Run(void* arg)
+    {
+        for (uint32_t i = 0; i < 2000; ++i) {
+            handles.push_back(InternedString("InternedStringTest.Concurrent." + U32ToString(i)));
+        }
+        return 0;
+    }
+};
+
+TEST(InternedStringTest, Concurrent) {
+    const size_t numThreads = 4;
+    std::vector<InternThread*> threads;
+    for (size_t t = 0; t < numThreads; ++t) {
+        threads.push_back(new InternThread());
+        threads.back()->Start();
+    }
+    for (size_t t = 0; t < numThreads; ++t) {
+        threads[t]->Join();
+    }
+    /* Every thread got the same handle for the same string */
+    for (size_t t = 1; t < numThreads; ++t) {
+        ASSERT_EQ(threads[0]->handles.size(), threads[t]->handles.size());
+        for (size_t i = 0; i < threads[0]->handles.size(); ++i) {
+            EXPECT_TRUE(threads[0]->handles[i] == threads[t]->handles[i]);
+        }
+    }
+    for (size_t t = 0; t < numThreads; ++t) {
+        delete threads[t];
+    }
+}
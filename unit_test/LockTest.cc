@@ -0,0 +1,231 @@
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <gtest/gtest.h>
+
+#include <stdio.h>
+#include <vector>
+
+#include <qcc/FastMutex.h>
+#include <qcc/LockProfiler.h>
+#include <qcc/Mutex.h>
+#include <qcc/RWLock.h>
+#include <qcc/Thread.h>
+#include <qcc/atomic.h>
+#include <qcc/time.h>
+#include <Status.h>
+
+using namespace qcc;
+
+/*
+ * Adapters so the same contention loop can drive every lock type.
+ */
+struct MutexLocker {
+    Mutex lock;
+    void Lock() { lock.Lock(); }
+    void Unlock() { lock.Unlock(); }
+};
+
+struct FastMutexLocker {
+    FastMutex lock;
+    void Lock() { lock.Lock(); }
+    void Unlock() { lock.Unlock(); }
+};
+
+struct WriteLocker {
+    RWLock lock;
+    void Lock() { lock.WriteLock(); }
+    void Unlock() { lock.WriteUnlock(); }
+};
+
+struct ReadLocker {
+    RWLock lock;
+    void Lock() { lock.ReadLock(); }
+    void Unlock() { lock.ReadUnlock(); }
+};
+
+template <typename Locker>
+class ContendingThread : public Thread {
+  public:
+    ContendingThread(Locker& locker, volatile uint32_t& counter, uint32_t iterations)
+        : Thread("ContendingThread"), locker(locker), counter(counter), iterations(iterations) { }
+  protected:
+    ThreadReturn STDCALL Run(void* arg)
+    {
+        for (uint32_t i = 0; i < iterations; ++i) {
+            locker.Lock();
+            counter = counter + 1;
+            locker.Unlock();
+        }
+        return 0;
+    }
+  private:
+    Locker& locker;
+    volatile uint32_t& counter;
+    uint32_t iterations;
+};
+
+/*
+ * Run numThreads threads doing iterations lock/increment/unlock cycles each.
+ * Returns the elapsed time in milliseconds.
+ */
+template <typename Locker>
+static uint64_t Contend(Locker& locker, volatile uint32_t& counter, uint32_t numThreads, uint32_t iterations)
+{
+    std::vector<ContendingThread<Locker>*> threads;
+    for (uint32_t i = 0; i < numThreads; ++i) {
+        threads.push_back(new ContendingThread<Locker>(locker, counter, iterations));
+    }
+    uint64_t startTime = GetTimestamp64();
+    for (uint32_t i = 0; i < numThreads; ++i) {
+        threads[i]->Start();
+    }
+    for (uint32_t i = 0; i < numThreads; ++i) {
+        threads[i]->Join();
+        delete threads[i];
+    }
+    return GetTimestamp64() - startTime;
+}
+
+TEST(LockTest, FastMutex) {
+    FastMutexLocker locker;
+    volatile uint32_t counter = 0;
+    Contend(locker, counter, 8, 20000);
+    EXPECT_EQ(8U * 20000U, counter);
+
+    EXPECT_TRUE(locker.lock.TryLock());
+    EXPECT_FALSE(locker.lock.TryLock());
+    EXPECT_EQ(ER_OK, locker.lock.Unlock());
+    {
+        ScopedFastMutexLock guard(locker.lock);
+        EXPECT_FALSE(locker.lock.TryLock());
+    }
+    EXPECT_TRUE(locker.lock.TryLock());
+    locker.lock.Unlock();
+}
+
+TEST(LockTest, RWLock) {
+    WriteLocker locker;
+    volatile uint32_t counter = 0;
+    Contend(locker, counter, 8, 20000);
+    EXPECT_EQ(8U * 20000U, counter);
+
+    RWLock& lock = locker.lock;
+    {
+        /* Readers share the lock and keep writers out */
+        ScopedReadLock guard(lock);
+        EXPECT_TRUE(lock.TryReadLock());
+        EXPECT_FALSE(lock.TryWriteLock());
+        lock.ReadUnlock();
+    }
+    {
+        /* A writer keeps everybody out */
+        ScopedWriteLock guard(lock);
+        EXPECT_FALSE(lock.TryReadLock());
+        EXPECT_FALSE(lock.TryWriteLock());
+    }
+    EXPECT_TRUE(lock.TryWriteLock());
+    lock.WriteUnlock();
+}
+
+/*
+ * Not run by default.  Use --gtest_also_run_disabled_tests to compare the
+ * lock types under increasing contention on the machine at hand.
+ */
+TEST(LockTest, DISABLED_Benchmark) {
+    const uint32_t iterations = 200000;
+    printf("threads    Mutex  FastMutex  RWLock(w)  RWLock(r)   (ns per lock/unlock)\n");
+    for (uint32_t numThreads = 1; numThreads <= 32; numThreads *= 2) {
+        double total = static_cast<double>(numThreads) * iterations;
+        volatile uint32_t counter = 0;
+
+        MutexLocker mutex;
+        uint64_t mutexMs = Contend(mutex, counter, numThreads, iterations);
+        FastMutexLocker fastMutex;
+        uint64_t fastMs = Contend(fastMutex, counter, numThreads, iterations);
+        WriteLocker writer;
+        uint64_t writeMs = Contend(writer, counter, numThreads, iterations);
+        /* Readers race on the counter here; only the timing matters */
+        ReadLocker reader;
+        uint64_t readMs = Contend(reader, counter, numThreads, iterations);
+
+        printf("%7u %8.1f %10.1f %10.1f %10.1f\n", numThreads,
+               mutexMs * 1e6 / total, fastMs * 1e6 / total, writeMs * 1e6 / total, readMs * 1e6 / total);
+    }
+}
+
+class HoldingThread : public Thread {
+  public:
+    HoldingThread(Mutex& lock) : Thread("HoldingThread"), holding(false), lock(lock) { }
+    volatile bool holding;
+  protected:
+    ThreadReturn STDCALL Run(void* arg)
+    {
+        lock.Lock(MUTEX_CONTEXT);
+        holding = true;
+        qcc::Sleep(50);
+        lock.Unlock(MUTEX_CONTEXT);
+        return 0;
+    }
+  private:
+    Mutex& lock;
+};
+
+TEST(LockTest, LockProfiler) {
+    Mutex lock;
+    LockProfiler::Reset();
+    LockProfiler::Enable(true);
+
+    HoldingThread holder(lock);
+    holder.Start();
+    while (!holder.holding) {
+        qcc::Sleep(1);
+    }
+    /* This has to wait for the holder */
+    lock.Lock(MUTEX_CONTEXT);
+    uint32_t waitLine = __LINE__ - 1;
+    lock.Unlock(MUTEX_CONTEXT);
+    holder.Join();
+
+    LockProfiler::Enable(false);
+    lock.Lock(MUTEX_CONTEXT);
+    lock.Unlock(MUTEX_CONTEXT);
+
+    std::vector<LockProfiler::SiteStats> stats;
+    LockProfiler::GetStats(stats);
+    ASSERT_FALSE(stats.empty());
+
+    /* The waiting call site is the hottest one */
+    EXPECT_EQ(waitLine, stats[0].line);
+    EXPECT_EQ(1U, stats[0].acquisitions);
+    EXPECT_EQ(1U, stats[0].contentions);
+    EXPECT_GT(stats[0].totalWaitNs, 10000000U);
+    uint64_t waits = 0;
+    for (uint32_t i = 0; i < LockProfiler::WAIT_BUCKETS; ++i) {
+        waits += stats[0].waitHistogram[i];
+    }
+    EXPECT_EQ(1U, waits);
+
+    /* The holder's call site was charged for holding the lock */
+    bool foundHolder = false;
+    for (size_t i = 0; i < stats.size(); ++i) {
+        if (stats[i].contentions == 0 && stats[i].totalHoldNs >= 40000000U) {
+            foundHolder = true;
+        }
+    }
+    EXPECT_TRUE(foundHolder);
+    EXPECT_TRUE(LockProfiler::Dump().find("LockTest.cc") != String::npos);
+    LockProfiler::Reset();
+}
@@ -16,7 +16,14 @@
  ******************************************************************************/
 
 #include <gtest/gtest.h>
+#include <stdio.h>
+#include <string>
+#include <utility>
+
 #include <qcc/ManagedObj.h>
+#include <qcc/Ptr.h>
+#include <qcc/Thread.h>
+#include <qcc/time.h>
 
 using namespace qcc;
 
@@ -54,4 +61,242 @@ TEST(ManagedObjTest, ManagedObj) {
     EXPECT_EQ(0, foo0->GetValue());
     EXPECT_EQ(0, foo1->GetValue());
 
-}
\ No newline at end of file
+}
+#if defined(QCC_HAS_VARIADIC_TEMPLATES)
+/* Counts how its string argument was passed */
+struct Forwarded {
+    Forwarded(const std::string& s, int n) : str(s), num(n), moved(false) { }
+    Forwarded(std::string&& s, int n) : str(std::move(s)), num(n), moved(true) { }
+    std::string str;
+    int num;
+    bool moved;
+};
+
+TEST(ManagedObjTest, Forwarding) {
+    std::string name("alarm");
+    ManagedObj<Forwarded> copied(name, 1);
+    EXPECT_FALSE(copied->moved);
+    EXPECT_EQ(std::string("alarm"), name);
+
+    /* Temporaries and moved arguments no longer need a named copy */
+    ManagedObj<Forwarded> fromTemp(std::string("temp"), 2);
+    EXPECT_TRUE(fromTemp->moved);
+    ManagedObj<Forwarded> moved(std::move(name), 3);
+    EXPECT_TRUE(moved->moved);
+    EXPECT_EQ(std::string("alarm"), moved->str);
+
+    ManagedObj<Forwarded> made = MakeManaged<Forwarded>(std::string("made"), 4);
+    EXPECT_TRUE(made->moved);
+    EXPECT_EQ(4, made->num);
+    EXPECT_EQ(1, made.GetRefCount());
+
+    ManagedObj<Managed> plain = MakeManaged<Managed>();
+    EXPECT_EQ(0, plain->GetValue());
+
+    /* Copies still copy, including from a non-const lvalue */
+    ManagedObj<Forwarded> copy(made);
+    EXPECT_EQ(2, made.GetRefCount());
+    ManagedObj<Forwarded> deep(made, true);
+    EXPECT_EQ(1, deep.GetRefCount());
+    EXPECT_FALSE(deep.iden(made));
+}
+#endif
+
+#if defined(QCC_HAS_RVALUE_REFERENCES)
+TEST(ManagedObjTest, Move) {
+    ManagedObj<Managed> foo;
+    foo->SetValue(7);
+    ManagedObj<Managed> other(foo);
+    EXPECT_EQ(2, foo.GetRefCount());
+
+    /* Moving takes over the reference without changing the count */
+    ManagedObj<Managed> moved(std::move(foo));
+    EXPECT_EQ(0, foo.GetRefCount());
+    EXPECT_EQ(2, moved.GetRefCount());
+    EXPECT_EQ(7, moved->GetValue());
+
+    ManagedObj<Managed> target;
+    target = std::move(moved);
+    EXPECT_EQ(0, moved.GetRefCount());
+    EXPECT_EQ(2, target.GetRefCount());
+    EXPECT_TRUE(target.iden(other));
+
+    /* A moved-from object can be assigned to again */
+    foo = other;
+    EXPECT_EQ(3, other.GetRefCount());
+    EXPECT_EQ(7, foo->GetValue());
+}
+#endif
+
+struct Observed {
+    Observed(int* destroyed) : destroyed(destroyed) { }
+    ~Observed() { ++*destroyed; }
+    int* destroyed;
+};
+
+TEST(ManagedObjTest, Weak) {
+    int destroyed = 0;
+    ManagedObjWeak<Observed> weak;
+    EXPECT_TRUE(weak.expired());
+    EXPECT_TRUE(weak.lock().unwrap() == NULL);
+    {
+        ManagedObj<Observed> strong(&destroyed);
+        weak = strong;
+        ManagedObjWeak<Observed> other(weak);
+        EXPECT_FALSE(other.expired());
+        EXPECT_EQ(1, strong.GetRefCount());
+
+        ManagedObj<Observed> locked = weak.lock();
+        EXPECT_TRUE(locked.iden(strong));
+        EXPECT_EQ(2, strong.GetRefCount());
+    }
+    /* T goes away with the last strong reference, not the last weak one */
+    EXPECT_EQ(1, destroyed);
+    EXPECT_TRUE(weak.expired());
+    ManagedObj<Observed> gone = weak.lock();
+    EXPECT_TRUE(gone.unwrap() == NULL);
+    EXPECT_EQ(0, gone.GetRefCount());
+
+    /* The context is freed with the last weak reference */
+    int32_t live = ManagedObj<Observed>::GetStats().GetLiveObjects();
+    weak.reset();
+    EXPECT_EQ(live - 1, ManagedObj<Observed>::GetStats().GetLiveObjects());
+
+    /* Single threaded references support weak references too */
+    ManagedObj<Observed, SingleThreadRefCount> local(&destroyed);
+    ManagedObjWeak<Observed, SingleThreadRefCount> localWeak(local);
+    EXPECT_EQ(2, localWeak.lock().GetRefCount());
+    local = ManagedObj<Observed, SingleThreadRefCount>(&destroyed);
+    EXPECT_EQ(2, destroyed);
+    EXPECT_TRUE(localWeak.expired());
+}
+
+static ThreadReturn STDCALL LockRepeatedly(void* arg)
+{
+    ManagedObjWeak<Observed>* weak = reinterpret_cast<ManagedObjWeak<Observed>*>(arg);
+    uint32_t locked = 0;
+    while (true) {
+        ManagedObj<Observed> strong = weak->lock();
+        if (!strong.unwrap()) {
+            break;
+        }
+        ++locked;
+    }
+    return reinterpret_cast<ThreadReturn>(static_cast<uintptr_t>(locked));
+}
+
+TEST(ManagedObjTest, WeakThreads) {
+    int destroyed = 0;
+    ManagedObj<Observed>* strong = new ManagedObj<Observed>(&destroyed);
+    ManagedObjWeak<Observed> weak(*strong);
+    Thread t1("LockRepeatedly", LockRepeatedly);
+    Thread t2("LockRepeatedly", LockRepeatedly);
+    t1.Start(&weak);
+    t2.Start(&weak);
+    qcc::Sleep(20);
+    delete strong;
+    t1.Join();
+    t2.Join();
+    EXPECT_EQ(1, destroyed);
+    EXPECT_TRUE(weak.expired());
+}
+
+typedef ManagedObj<Managed, SingleThreadRefCount> LocalManaged;
+
+struct LocalCounted : public SingleThreadRefCountBase {
+    LocalCounted(int* destroyed) : destroyed(destroyed) { }
+    ~LocalCounted() { ++*destroyed; }
+    int* destroyed;
+};
+
+TEST(ManagedObjTest, SingleThread) {
+    LocalManaged foo;
+    foo->SetValue(3);
+    {
+        LocalManaged bar = foo;
+        LocalManaged baz(foo, false);
+        EXPECT_EQ(3, foo.GetRefCount());
+        EXPECT_EQ(3, LocalManaged::wrap(bar.unwrap())->GetValue());
+    }
+    EXPECT_EQ(1, foo.GetRefCount());
+
+    LocalManaged clone(foo, true);
+    EXPECT_FALSE(clone.iden(foo));
+    EXPECT_EQ(3, clone->GetValue());
+
+    int destroyed = 0;
+    {
+        Ptr<LocalCounted> p(new LocalCounted(&destroyed));
+        Ptr<LocalCounted> q = p;
+        q = Ptr<LocalCounted>();
+    }
+    EXPECT_EQ(1, destroyed);
+}
+
+#if !defined(NDEBUG)
+static ThreadReturn STDCALL CopyOnOtherThread(void* arg)
+{
+    LocalManaged copy = *reinterpret_cast<LocalManaged*>(arg);
+    return 0;
+}
+
+TEST(ManagedObjTest, SingleThreadOwner) {
+    ::testing::FLAGS_gtest_death_test_style = "threadsafe";
+    LocalManaged foo;
+    EXPECT_DEATH({
+                     Thread t("CopyOnOtherThread", CopyOnOtherThread);
+                     t.Start(&foo);
+                     t.Join();
+                 }, "another thread");
+}
+#endif
+
+/*
+ * Compare the cost of copying and releasing references with the atomic and
+ * the single threaded reference counts.
+ */
+struct SharedCounted : public RefCountBase {
+};
+
+struct UnsharedCounted : public SingleThreadRefCountBase {
+};
+
+/*
+ * Each copy is handed to a function the optimizer cannot see into, so the
+ * reference count changes cannot be hoisted out of the loop or dropped.
+ */
+static void KeepNothing(const void* copy)
+{
+}
+
+static void (*volatile keep)(const void* copy) = KeepNothing;
+
+template <typename T>
+static double NsPerCopy(const T& obj, uint32_t iterations)
+{
+    uint64_t start = GetTimestamp64();
+    for (uint32_t i = 0; i < iterations; ++i) {
+        T copy = obj;
+        keep(&copy);
+    }
+    return (GetTimestamp64() - start) * 1e6 / iterations;
+}
+
+TEST(ManagedObjTest, DISABLED_Benchmark) {
+    const uint32_t iterations = 20000000;
+
+    SharedCounted* raw = new SharedCounted();
+    double baseline = NsPerCopy(raw, iterations);
+    delete raw;
+
+    ManagedObj<Managed> shared;
+    LocalManaged local;
+    Ptr<SharedCounted> sharedPtr(new SharedCounted());
+    Ptr<UnsharedCounted> localPtr(new UnsharedCounted());
+
+    printf("Raw pointer (baseline):   %.2f ns per copy\n", baseline);
+    printf("ManagedObj atomic:        %.2f ns per copy\n", NsPerCopy(shared, iterations));
+    printf("ManagedObj single thread: %.2f ns per copy\n", NsPerCopy(local, iterations));
+    printf("Ptr atomic:               %.2f ns per copy\n", NsPerCopy(sharedPtr, iterations));
+    printf("Ptr single thread:        %.2f ns per copy\n", NsPerCopy(localPtr, iterations));
+}
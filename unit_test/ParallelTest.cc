@@ -0,0 +1,199 @@
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <gtest/gtest.h>
+
+#include <stdio.h>
+#include <vector>
+
+#include <qcc/Parallel.h>
+#include <qcc/atomic.h>
+#include <qcc/time.h>
+#include <Status.h>
+
+using namespace qcc;
+
+class MarkIndex {
+  public:
+    MarkIndex(std::vector<int32_t>& marks) : marks(marks) { }
+    void operator()(size_t i) { IncrementAndFetch(&marks[i]); }
+  private:
+    std::vector<int32_t>& marks;
+};
+
+static uint64_t Square(size_t i)
+{
+    return static_cast<uint64_t>(i) * i;
+}
+
+static uint64_t Add(uint64_t a, uint64_t b)
+{
+    return a + b;
+}
+
+static bool IsMultipleOf97(size_t i)
+{
+    return (i % 97) == 96;
+}
+
+static bool NotMultipleOf97(size_t i)
+{
+    return !IsMultipleOf97(i);
+}
+
+static bool Or(bool a, bool b)
+{
+    return a || b;
+}
+
+static bool And(bool a, bool b)
+{
+    return a && b;
+}
+
+TEST(ParallelTest, ParallelFor) {
+    ThreadPool pool("ParallelTest", 4, 16);
+    std::vector<int32_t> marks(10007, 0);
+
+    /* Every index is visited exactly once, with and without an explicit grain */
+    ParallelFor(pool, 0, marks.size(), 0, MarkIndex(marks));
+    ParallelFor(pool, 0, marks.size(), 100, MarkIndex(marks));
+    ParallelFor(pool, 5, 6, 0, MarkIndex(marks));
+    ParallelFor(pool, 7, 7, 0, MarkIndex(marks));
+    for (size_t i = 0; i < marks.size(); ++i) {
+        ASSERT_EQ((i == 5) ? 3 : 2, marks[i]) << "index " << i;
+    }
+
+    pool.Stop();
+    pool.Join();
+}
+
+TEST(ParallelTest, ParallelReduce) {
+    ThreadPool pool("ParallelTest", 4, 16);
+    const size_t n = 100000;
+    uint64_t expected = 0;
+    for (size_t i = 0; i < n; ++i) {
+        expected += Square(i);
+    }
+
+    EXPECT_EQ(expected, ParallelReduce(pool, 0, n, 0, static_cast<uint64_t>(0), Square, Add));
+    EXPECT_EQ(expected, ParallelReduce(pool, 0, n, 1, static_cast<uint64_t>(0), Square, Add));
+    EXPECT_EQ(static_cast<uint64_t>(9), ParallelReduce(pool, 3, 3, 0, static_cast<uint64_t>(9), Square, Add));
+
+    /* Neighbouring bool results must not share a word; a lost write drops the one odd chunk */
+    for (size_t first = 0; first < 97; ++first) {
+        EXPECT_TRUE(ParallelReduce(pool, first, first + 97, 1, false, IsMultipleOf97, Or)) << "first " << first;
+        EXPECT_FALSE(ParallelReduce(pool, first, first + 97, 1, true, NotMultipleOf97, And)) << "first " << first;
+    }
+
+    pool.Stop();
+    pool.Join();
+}
+
+class NestedLoop : public Runnable {
+  public:
+    NestedLoop(ThreadPool* pool, std::vector<int32_t>* marks) : pool(pool), marks(marks) { }
+    void Run(void)
+    {
+        ParallelFor(*pool, 0, marks->size(), 1, MarkIndex(*marks));
+        IncrementAndFetch(&nestedDone);
+    }
+    static volatile int32_t nestedDone;
+  private:
+    ThreadPool* pool;
+    std::vector<int32_t>* marks;
+};
+
+volatile int32_t NestedLoop::nestedDone = 0;
+
+TEST(ParallelTest, BusyPool) {
+    /* Loops started from pool threads complete even when no helper can be queued */
+    ThreadPool pool("ParallelTest", 2, 1);
+    NestedLoop::nestedDone = 0;
+    std::vector<int32_t> marks1(1000, 0);
+    std::vector<int32_t> marks2(1000, 0);
+    Ptr<NestedLoop> loop1 = NewPtr<NestedLoop>(&pool, &marks1);
+    Ptr<NestedLoop> loop2 = NewPtr<NestedLoop>(&pool, &marks2);
+    EXPECT_EQ(ER_OK, pool.ExecuteBlocking(loop1));
+    EXPECT_EQ(ER_OK, pool.ExecuteBlocking(loop2));
+
+    /* And so does one started here while the pool is busy with those */
+    std::vector<int32_t> marks3(1000, 0);
+    ParallelFor(pool, 0, marks3.size(), 1, MarkIndex(marks3));
+
+    uint64_t startTime = GetTimestamp64();
+    while ((NestedLoop::nestedDone < 2) && (GetTimestamp64() < (startTime + 10000))) {
+        qcc::Sleep(5);
+    }
+    EXPECT_EQ(2, NestedLoop::nestedDone);
+    pool.Stop();
+    pool.Join();
+    for (size_t i = 0; i < 1000; ++i) {
+        ASSERT_EQ(1, marks1[i]);
+        ASSERT_EQ(1, marks2[i]);
+        ASSERT_EQ(1, marks3[i]);
+    }
+}
+
+/*
+ * A CPU bound per-index workload: a few rounds of FNV-1a over a small block.
+ */
+static uint64_t HashIndex(size_t i)
+{
+    uint64_t h = 14695981039346656037ULL;
+    for (uint32_t round = 0; round < 64; ++round) {
+        for (uint32_t b = 0; b < 16; ++b) {
+            h ^= static_cast<uint8_t>((i >> (b & 7)) + round + b);
+            h *= 1099511628211ULL;
+        }
+    }
+    return h;
+}
+
+static uint64_t Xor(uint64_t a, uint64_t b)
+{
+    return a ^ b;
+}
+
+/*
+ * Not run by default.  Use --gtest_also_run_disabled_tests to compare the
+ * parallel primitives against a serial loop on the machine at hand.
+ */
+TEST(ParallelTest, DISABLED_Benchmark) {
+    const size_t n = 1 << 20;
+    const uint32_t threadCounts[] = { 1, 2, 4, 8, 16 };
+
+    uint64_t startTime = GetTimestamp64();
+    uint64_t expected = 0;
+    for (size_t i = 0; i < n; ++i) {
+        expected ^= HashIndex(i);
+    }
+    uint64_t serialMs = GetTimestamp64() - startTime;
+    printf("serial loop:            %6u ms\n", static_cast<uint32_t>(serialMs));
+
+    for (size_t t = 0; t < sizeof(threadCounts) / sizeof(threadCounts[0]); ++t) {
+        ThreadPool pool("ParallelBench", threadCounts[t], 64);
+        const size_t grains[] = { 0, 64, 4096 };
+        for (size_t g = 0; g < sizeof(grains) / sizeof(grains[0]); ++g) {
+            startTime = GetTimestamp64();
+            uint64_t result = ParallelReduce(pool, 0, n, grains[g], static_cast<uint64_t>(0), HashIndex, Xor);
+            uint64_t parallelMs = GetTimestamp64() - startTime;
+            EXPECT_EQ(expected, result);
+            printf("%2u threads, grain %4u: %6u ms\n", threadCounts[t], static_cast<uint32_t>(grains[g]), static_cast<uint32_t>(parallelMs));
+        }
+        pool.Stop();
+        pool.Join();
+    }
+}
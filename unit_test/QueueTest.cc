@@ -0,0 +1,260 @@
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <gtest/gtest.h>
+
+#include <stdio.h>
+#include <deque>
+#include <vector>
+
+#include <qcc/Event.h>
+#include <qcc/Mutex.h>
+#include <qcc/MpmcQueue.h>
+#include <qcc/SpscRing.h>
+#include <qcc/Thread.h>
+#include <qcc/time.h>
+#include <Status.h>
+
+using namespace qcc;
+
+/*
+ * A Mutex and Event guarded std::deque, the way hand-offs are built elsewhere
+ * in this library.  Used as the baseline in the benchmark.
+ */
+template <typename T>
+class LockedQueue {
+  public:
+    LockedQueue(size_t capacity) : capacity(capacity) { }
+    QStatus Push(const T& item)
+    {
+        lock.Lock();
+        while (items.size() >= capacity) {
+            lock.Unlock();
+            Event::Wait(notFull, Event::WAIT_FOREVER);
+            lock.Lock();
+        }
+        items.push_back(item);
+        notFull.ResetEvent();
+        notEmpty.SetEvent();
+        lock.Unlock();
+        return ER_OK;
+    }
+    QStatus Pop(T& item)
+    {
+        lock.Lock();
+        while (items.empty()) {
+            lock.Unlock();
+            Event::Wait(notEmpty, Event::WAIT_FOREVER);
+            lock.Lock();
+        }
+        item = items.front();
+        items.pop_front();
+        if (items.empty()) {
+            notEmpty.ResetEvent();
+        }
+        notFull.SetEvent();
+        lock.Unlock();
+        return ER_OK;
+    }
+  private:
+    size_t capacity;
+    Mutex lock;
+    Event notEmpty;
+    Event notFull;
+    std::deque<T> items;
+};
+
+/*
+ * Producers push the values [first, first + count), consumers pop count values
+ * and add them up.
+ */
+template <typename Queue>
+class Producer : public Thread {
+  public:
+    Producer(Queue& queue, uint32_t first, uint32_t count) : Thread("Producer"), queue(queue), first(first), count(count) { }
+  protected:
+    ThreadReturn STDCALL Run(void* arg)
+    {
+        for (uint32_t i = 0; i < count; ++i) {
+            queue.Push(first + i);
+        }
+        return 0;
+    }
+  private:
+    Queue& queue;
+    uint32_t first;
+    uint32_t count;
+};
+
+template <typename Queue>
+class Consumer : public Thread {
+  public:
+    Consumer(Queue& queue, uint32_t count) : Thread("Consumer"), sum(0), inOrder(true), queue(queue), count(count) { }
+    uint64_t sum;
+    bool inOrder;
+  protected:
+    ThreadReturn STDCALL Run(void* arg)
+    {
+        uint32_t last = 0;
+        for (uint32_t i = 0; i < count; ++i) {
+            uint32_t value = 0;
+            queue.Pop(value);
+            sum += value;
+            if (i > 0 && value <= last) {
+                inOrder = false;
+            }
+            last = value;
+        }
+        return 0;
+    }
+  private:
+    Queue& queue;
+    uint32_t count;
+};
+
+/*
+ * Run numProducers producers and numConsumers consumers moving total values
+ * through the queue.  Returns the elapsed time in milliseconds.
+ */
+template <typename Queue>
+static uint64_t Transfer(Queue& queue, uint32_t numProducers, uint32_t numConsumers, uint32_t total, uint64_t& sum, bool& inOrder)
+{
+    std::vector<Producer<Queue>*> producers;
+    std::vector<Consumer<Queue>*> consumers;
+    uint32_t perProducer = total / numProducers;
+    uint32_t perConsumer = total / numConsumers;
+    for (uint32_t i = 0; i < numProducers; ++i) {
+        producers.push_back(new Producer<Queue>(queue, 1 + i * perProducer, perProducer));
+    }
+    for (uint32_t i = 0; i < numConsumers; ++i) {
+        consumers.push_back(new Consumer<Queue>(queue, perConsumer));
+    }
+    uint64_t startTime = GetTimestamp64();
+    for (uint32_t i = 0; i < numConsumers; ++i) {
+        consumers[i]->Start();
+    }
+    for (uint32_t i = 0; i < numProducers; ++i) {
+        producers[i]->Start();
+    }
+    for (uint32_t i = 0; i < numProducers; ++i) {
+        producers[i]->Join();
+        delete producers[i];
+    }
+    sum = 0;
+    inOrder = true;
+    for (uint32_t i = 0; i < numConsumers; ++i) {
+        consumers[i]->Join();
+        sum += consumers[i]->sum;
+        inOrder = inOrder && consumers[i]->inOrder;
+        delete consumers[i];
+    }
+    return GetTimestamp64() - startTime;
+}
+
+static uint64_t SumTo(uint64_t n)
+{
+    return n * (n + 1) / 2;
+}
+
+TEST(QueueTest, MpmcQueue) {
+    MpmcQueue<uint32_t> queue(5);
+    EXPECT_EQ(8U, queue.Capacity());
+
+    uint32_t value = 0;
+    EXPECT_FALSE(queue.TryPop(value));
+    EXPECT_EQ(ER_TIMEOUT, queue.Pop(value, 20));
+    for (uint32_t i = 0; i < 8; ++i) {
+        EXPECT_TRUE(queue.TryPush(i));
+    }
+    EXPECT_FALSE(queue.TryPush(8));
+    EXPECT_EQ(ER_TIMEOUT, queue.Push(8, 20));
+    EXPECT_EQ(8U, queue.Size());
+    for (uint32_t i = 0; i < 8; ++i) {
+        EXPECT_TRUE(queue.TryPop(value));
+        EXPECT_EQ(i, value);
+    }
+    EXPECT_EQ(0U, queue.Size());
+}
+
+TEST(QueueTest, MpmcQueueStress) {
+    /* A small queue keeps producers and consumers sleeping and waking each other */
+    const uint32_t total = 400000;
+    MpmcQueue<uint32_t> queue(16);
+    uint64_t sum;
+    bool inOrder;
+    Transfer(queue, 4, 4, total, sum, inOrder);
+    EXPECT_EQ(SumTo(total), sum);
+    EXPECT_EQ(0U, queue.Size());
+
+    /* A single producer and consumer see FIFO order */
+    Transfer(queue, 1, 1, total, sum, inOrder);
+    EXPECT_EQ(SumTo(total), sum);
+    EXPECT_TRUE(inOrder);
+}
+
+TEST(QueueTest, SpscRing) {
+    SpscRing<uint32_t> ring(3);
+    EXPECT_EQ(4U, ring.Capacity());
+
+    uint32_t value = 0;
+    EXPECT_FALSE(ring.TryPop(value));
+    EXPECT_EQ(ER_TIMEOUT, ring.Pop(value, 20));
+    for (uint32_t i = 0; i < 4; ++i) {
+        EXPECT_TRUE(ring.TryPush(i));
+    }
+    EXPECT_FALSE(ring.TryPush(4));
+    EXPECT_EQ(ER_TIMEOUT, ring.Push(4, 20));
+    for (uint32_t i = 0; i < 4; ++i) {
+        EXPECT_TRUE(ring.TryPop(value));
+        EXPECT_EQ(i, value);
+    }
+    EXPECT_EQ(0U, ring.Size());
+}
+
+TEST(QueueTest, SpscRingStress) {
+    const uint32_t total = 1000000;
+    SpscRing<uint32_t> ring(16);
+    uint64_t sum;
+    bool inOrder;
+    Transfer(ring, 1, 1, total, sum, inOrder);
+    EXPECT_EQ(SumTo(total), sum);
+    EXPECT_TRUE(inOrder);
+}
+
+/*
+ * Not run by default.  Use --gtest_also_run_disabled_tests to compare the
+ * queues against a locked std::deque on the machine at hand.
+ */
+TEST(QueueTest, DISABLED_Benchmark) {
+    const uint32_t total = 2000000;
+    const uint32_t capacity = 1024;
+    uint64_t sum;
+    bool inOrder;
+
+    printf("producers/consumers  LockedQueue  MpmcQueue  SpscRing   (ns per item)\n");
+    for (uint32_t n = 1; n <= 8; n *= 2) {
+        LockedQueue<uint32_t> locked(capacity);
+        uint64_t lockedMs = Transfer(locked, n, n, total, sum, inOrder);
+        MpmcQueue<uint32_t> mpmc(capacity);
+        uint64_t mpmcMs = Transfer(mpmc, n, n, total, sum, inOrder);
+        if (n == 1) {
+            SpscRing<uint32_t> spsc(capacity);
+            uint64_t spscMs = Transfer(spsc, n, n, total, sum, inOrder);
+            printf("%10u/%-8u %12.1f %10.1f %9.1f\n", n, n, lockedMs * 1e6 / total, mpmcMs * 1e6 / total, spscMs * 1e6 / total);
+        } else {
+            printf("%10u/%-8u %12.1f %10.1f %9s\n", n, n, lockedMs * 1e6 / total, mpmcMs * 1e6 / total, "-");
+        }
+    }
+}
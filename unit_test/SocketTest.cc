@@ -20,7 +20,12 @@
 #include <qcc/Util.h>
 #include <qcc/StringUtil.h>
 
+#include <qcc/BufferedSink.h>
+#include <qcc/ListenerGroup.h>
 #include <qcc/Socket.h>
+#include <qcc/SocketStream.h>
+#include <qcc/Thread.h>
+#include <qcc/time.h>
 
 using namespace qcc;
 
@@ -375,3 +380,740 @@ TEST(SocketTest, send_and_receive_with_dummy_fds) {
                "\n\t      Status (socket pair creation) was %s.", QCC_StatusText(status));
     }
 }
+
+/*
+ * Open a UDP socket bound to an ephemeral port on the loopback address.
+ */
+static QStatus OpenLoopbackUdp(SocketFd& sockfd, uint16_t& port)
+{
+    IPAddress loopback("127.0.0.1");
+    QStatus status = Socket(QCC_AF_INET, QCC_SOCK_DGRAM, sockfd);
+    if (ER_OK == status) {
+        status = Bind(sockfd, loopback, 0);
+    }
+    if (ER_OK == status) {
+        status = GetLocalAddress(sockfd, loopback, port);
+    }
+    return status;
+}
+
+TEST(SocketTest, send_to_batch_and_recv_from_batch) {
+    SocketFd talker, listener;
+    uint16_t talkerPort, listenerPort;
+    ASSERT_EQ(ER_OK, OpenLoopbackUdp(talker, talkerPort));
+    ASSERT_EQ(ER_OK, OpenLoopbackUdp(listener, listenerPort));
+
+    const size_t numDatagrams = 70;
+    uint8_t out[numDatagrams][64];
+    Datagram send[numDatagrams];
+    for (size_t i = 0; i < numDatagrams; ++i) {
+        memset(out[i], static_cast<int>(i), sizeof(out[i]));
+        send[i].buf = out[i];
+        send[i].len = 1 + i % sizeof(out[i]);
+        send[i].addr = IPAddress("127.0.0.1");
+        send[i].port = listenerPort;
+    }
+    size_t sent = 0;
+    ASSERT_EQ(ER_OK, SendToBatch(talker, send, numDatagrams, sent));
+    EXPECT_EQ(numDatagrams, sent);
+
+    uint8_t in[numDatagrams][128];
+    Datagram recv[numDatagrams];
+    for (size_t i = 0; i < numDatagrams; ++i) {
+        recv[i].buf = in[i];
+        recv[i].size = sizeof(in[i]);
+    }
+    size_t total = 0;
+    while (total < numDatagrams) {
+        size_t received = 0;
+        ASSERT_EQ(ER_OK, RecvFromBatch(listener, recv + total, numDatagrams - total, received));
+        ASSERT_LT(0U, received);
+        total += received;
+    }
+    for (size_t i = 0; i < numDatagrams; ++i) {
+        EXPECT_EQ(send[i].len, recv[i].len);
+        EXPECT_EQ(0, memcmp(out[i], in[i], recv[i].len));
+        EXPECT_EQ(IPAddress("127.0.0.1"), recv[i].addr);
+        EXPECT_EQ(talkerPort, recv[i].port);
+        EXPECT_EQ(0, recv[i].segmentSize);
+    }
+
+    /* Nothing left to receive */
+    ASSERT_EQ(ER_OK, SetBlocking(listener, false));
+    size_t received = 0;
+    EXPECT_EQ(ER_WOULDBLOCK, RecvFromBatch(listener, recv, 1, received));
+    EXPECT_EQ(0U, received);
+
+    Close(talker);
+    Close(listener);
+}
+
+TEST(SocketTest, send_to_batch_segmented) {
+    SocketFd talker, listener;
+    uint16_t talkerPort, listenerPort;
+    ASSERT_EQ(ER_OK, OpenLoopbackUdp(talker, talkerPort));
+    ASSERT_EQ(ER_OK, OpenLoopbackUdp(listener, listenerPort));
+
+    /* Ten datagrams of 100 octets and one of 50 in a single buffer */
+    uint8_t out[1050];
+    for (size_t i = 0; i < sizeof(out); ++i) {
+        out[i] = static_cast<uint8_t>(i / 100);
+    }
+    Datagram send;
+    send.buf = out;
+    send.len = sizeof(out);
+    send.addr = IPAddress("127.0.0.1");
+    send.port = listenerPort;
+    send.segmentSize = 100;
+    size_t sent = 0;
+    ASSERT_EQ(ER_OK, SendToBatch(talker, &send, 1, sent));
+    EXPECT_EQ(1U, sent);
+
+    uint8_t in[11][128];
+    Datagram recv[11];
+    for (size_t i = 0; i < 11; ++i) {
+        recv[i].buf = in[i];
+        recv[i].size = sizeof(in[i]);
+    }
+    size_t total = 0;
+    while (total < 11) {
+        size_t received = 0;
+        ASSERT_EQ(ER_OK, RecvFromBatch(listener, recv + total, 11 - total, received));
+        total += received;
+    }
+    for (size_t i = 0; i < 11; ++i) {
+        ASSERT_EQ((i < 10) ? 100U : 50U, recv[i].len);
+        EXPECT_EQ(i, in[i][0]);
+        EXPECT_EQ(i, in[i][recv[i].len - 1]);
+    }
+
+    Close(talker);
+    Close(listener);
+}
+
+TEST(SocketTest, recv_from_batch_gro) {
+    SocketFd talker, listener;
+    uint16_t talkerPort, listenerPort;
+    ASSERT_EQ(ER_OK, OpenLoopbackUdp(talker, talkerPort));
+    ASSERT_EQ(ER_OK, OpenLoopbackUdp(listener, listenerPort));
+    if (ER_OK != SetUdpGro(listener, true)) {
+        printf("UDP_GRO is not supported, skipping\n");
+        Close(talker);
+        Close(listener);
+        return;
+    }
+
+    uint8_t out[800];
+    memset(out, 'g', sizeof(out));
+    Datagram send;
+    send.buf = out;
+    send.len = sizeof(out);
+    send.addr = IPAddress("127.0.0.1");
+    send.port = listenerPort;
+    send.segmentSize = 200;
+    size_t sent = 0;
+    ASSERT_EQ(ER_OK, SendToBatch(talker, &send, 1, sent));
+
+    /* The kernel may or may not coalesce the segments, but nothing is lost */
+    uint8_t in[4][1024];
+    Datagram recv[4];
+    for (size_t i = 0; i < 4; ++i) {
+        recv[i].buf = in[i];
+        recv[i].size = sizeof(in[i]);
+    }
+    size_t total = 0;
+    size_t datagrams = 0;
+    while (total < sizeof(out)) {
+        size_t received = 0;
+        ASSERT_EQ(ER_OK, RecvFromBatch(listener, recv + datagrams, 4 - datagrams, received));
+        for (size_t i = datagrams; i < datagrams + received; ++i) {
+            if (recv[i].len > 200) {
+                EXPECT_EQ(200, recv[i].segmentSize);
+            }
+            total += recv[i].len;
+        }
+        datagrams += received;
+    }
+    EXPECT_EQ(sizeof(out), total);
+
+    Close(talker);
+    Close(listener);
+}
+
+/*
+ * Compare the datagram rate of SendTo/RecvFrom with the batch functions on
+ * the loopback interface.
+ */
+TEST(SocketTest, DISABLED_batch_benchmark) {
+    const size_t batch = 32;
+    const size_t rounds = 20000;
+    SocketFd talker, listener;
+    uint16_t talkerPort, listenerPort;
+    ASSERT_EQ(ER_OK, OpenLoopbackUdp(talker, talkerPort));
+    ASSERT_EQ(ER_OK, OpenLoopbackUdp(listener, listenerPort));
+    IPAddress loopback("127.0.0.1");
+
+    uint8_t out[batch][64];
+    uint8_t in[batch][64];
+    Datagram send[batch];
+    Datagram recv[batch];
+    for (size_t i = 0; i < batch; ++i) {
+        memset(out[i], static_cast<int>(i), sizeof(out[i]));
+        send[i].buf = out[i];
+        send[i].len = sizeof(out[i]);
+        send[i].addr = loopback;
+        send[i].port = listenerPort;
+        recv[i].buf = in[i];
+        recv[i].size = sizeof(in[i]);
+    }
+
+    uint64_t start = GetTimestamp64();
+    for (size_t r = 0; r < rounds; ++r) {
+        size_t n;
+        for (size_t i = 0; i < batch; ++i) {
+            SendTo(talker, loopback, listenerPort, out[i], sizeof(out[i]), n);
+        }
+        for (size_t i = 0; i < batch; ++i) {
+            IPAddress from;
+            uint16_t fromPort;
+            RecvFrom(listener, from, fromPort, in[i], sizeof(in[i]), n);
+        }
+    }
+    uint64_t singleTime = GetTimestamp64() - start;
+
+    start = GetTimestamp64();
+    for (size_t r = 0; r < rounds; ++r) {
+        size_t sent, received, total = 0;
+        SendToBatch(talker, send, batch, sent);
+        while (total < sent) {
+            RecvFromBatch(listener, recv + total, sent - total, received);
+            total += received;
+        }
+    }
+    uint64_t batchTime = GetTimestamp64() - start;
+
+    printf("SendTo/RecvFrom:           %.0f datagrams per second\n", (rounds * batch) * 1000.0 / singleTime);
+    printf("SendToBatch/RecvFromBatch: %.0f datagrams per second\n", (rounds * batch) * 1000.0 / batchTime);
+
+    Close(talker);
+    Close(listener);
+}
+
+TEST(SocketTest, accept_many) {
+    const size_t numClients = 5;
+    IPAddress loopback("127.0.0.1");
+    SocketFd listener;
+    uint16_t listenerPort;
+    ASSERT_EQ(ER_OK, Socket(QCC_AF_INET, QCC_SOCK_STREAM, listener));
+    ASSERT_EQ(ER_OK, Bind(listener, loopback, 0));
+    ASSERT_EQ(ER_OK, GetLocalAddress(listener, loopback, listenerPort));
+    ASSERT_EQ(ER_OK, Listen(listener, numClients));
+    ASSERT_EQ(ER_OK, SetBlocking(listener, false));
+
+    AcceptedSocket results[numClients + 1];
+    size_t accepted = 1;
+    EXPECT_EQ(ER_WOULDBLOCK, AcceptMany(listener, numClients + 1, results, accepted));
+    EXPECT_EQ(0U, accepted);
+
+    SocketFd clients[numClients];
+    uint16_t clientPorts[numClients];
+    for (size_t i = 0; i < numClients; ++i) {
+        IPAddress addr;
+        ASSERT_EQ(ER_OK, Socket(QCC_AF_INET, QCC_SOCK_STREAM, clients[i]));
+        ASSERT_EQ(ER_OK, Connect(clients[i], loopback, listenerPort));
+        ASSERT_EQ(ER_OK, GetLocalAddress(clients[i], addr, clientPorts[i]));
+    }
+
+    /* The handshakes complete on their own, give them a moment to be queued */
+    size_t total = 0;
+    for (int tries = 0; (total < numClients) && (tries < 100); ++tries) {
+        if (AcceptMany(listener, 2 - (total & 1), results + total, accepted) == ER_OK) {
+            EXPECT_GE(2U, accepted);
+            total += accepted;
+        } else {
+            qcc::Sleep(10);
+        }
+    }
+    ASSERT_EQ(numClients, total);
+    EXPECT_EQ(ER_WOULDBLOCK, AcceptMany(listener, numClients + 1, results + total, accepted));
+    EXPECT_EQ(0U, accepted);
+
+    for (size_t i = 0; i < numClients; ++i) {
+        EXPECT_EQ(loopback, results[i].addr);
+        bool found = false;
+        for (size_t j = 0; j < numClients; ++j) {
+            found |= (results[i].port == clientPorts[j]);
+        }
+        EXPECT_TRUE(found);
+
+        /* Accepted sockets are non-blocking */
+        uint8_t buf[4];
+        size_t received;
+        EXPECT_EQ(ER_WOULDBLOCK, Recv(results[i].sockfd, buf, sizeof(buf), received));
+        Close(results[i].sockfd);
+        Close(clients[i]);
+    }
+    Close(listener);
+}
+
+/*
+ * Connect clients to a listener group and accept them from every listener,
+ * returning the number of listeners that got at least one.
+ */
+static size_t ConnectToGroup(ListenerGroup& group, size_t numClients)
+{
+    IPAddress loopback("127.0.0.1");
+    std::vector<SocketFd> clients(numClients);
+    for (size_t i = 0; i < numClients; ++i) {
+        EXPECT_EQ(ER_OK, Socket(QCC_AF_INET, QCC_SOCK_STREAM, clients[i]));
+        EXPECT_EQ(ER_OK, Connect(clients[i], loopback, group.GetPort()));
+    }
+
+    std::vector<size_t> perListener(group.GetCount());
+    size_t total = 0;
+    for (int tries = 0; (total < numClients) && (tries < 100); ++tries) {
+        for (size_t i = 0; i < group.GetCount(); ++i) {
+            AcceptedSocket results[8];
+            size_t accepted;
+            if (AcceptMany(group.GetListener(i).GetSocketFd(), ArraySize(results), results, accepted) == ER_OK) {
+                for (size_t j = 0; j < accepted; ++j) {
+                    Close(results[j].sockfd);
+                }
+                perListener[i] += accepted;
+                total += accepted;
+            }
+        }
+        if (total < numClients) {
+            qcc::Sleep(10);
+        }
+    }
+    EXPECT_EQ(numClients, total);
+
+    for (size_t i = 0; i < numClients; ++i) {
+        Close(clients[i]);
+    }
+    size_t used = 0;
+    for (size_t i = 0; i < group.GetCount(); ++i) {
+        used += perListener[i] ? 1 : 0;
+    }
+    return used;
+}
+
+TEST(SocketTest, listener_group) {
+    ListenerGroup group;
+    IPAddress loopback("127.0.0.1");
+    EXPECT_EQ(ER_BAD_ARG_4, group.Listen(QCC_AF_INET, loopback, 0, 0, 8));
+    ASSERT_EQ(ER_OK, group.Listen(QCC_AF_INET, loopback, 0, 4, 32));
+    EXPECT_EQ(4U, group.GetCount());
+    EXPECT_NE(0, group.GetPort());
+    EXPECT_EQ(ER_FAIL, group.Listen(QCC_AF_INET, loopback, 0, 4, 32));
+
+    /* Connections are hashed by address so 32 of them land on more than one listener */
+    size_t used = ConnectToGroup(group, 32);
+#if defined(QCC_OS_LINUX)
+    EXPECT_LT(1U, used);
+#endif
+    group.Close();
+    EXPECT_EQ(0U, group.GetCount());
+
+    /* Steered by CPU every connection still lands on some listener */
+    ASSERT_EQ(ER_OK, group.Listen(QCC_AF_INET, loopback, 0, 4, 32, true));
+    used = ConnectToGroup(group, 16);
+    EXPECT_LE(1U, used);
+}
+
+TEST(SocketTest, socket_options_and_cork) {
+    IPAddress loopback("127.0.0.1");
+    SocketFd listener;
+    uint16_t listenerPort;
+    ASSERT_EQ(ER_OK, Socket(QCC_AF_INET, QCC_SOCK_STREAM, listener));
+    ASSERT_EQ(ER_OK, Bind(listener, loopback, 0));
+    ASSERT_EQ(ER_OK, GetLocalAddress(listener, loopback, listenerPort));
+    ASSERT_EQ(ER_OK, Listen(listener, 1));
+
+    SocketOptions options;
+    options.sendBufferSize = 64 * 1024;
+    options.receiveBufferSize = 64 * 1024;
+    options.noDelay = true;
+    options.keepAliveIdle = 30;
+    options.keepAliveInterval = 5;
+    options.keepAliveCount = 3;
+    options.notSentLowat = 16 * 1024;
+    options.corkBufferedWrites = true;
+
+    SocketStream client(QCC_AF_INET, QCC_SOCK_STREAM, options);
+    String host = "127.0.0.1";
+    ASSERT_EQ(ER_OK, client.Connect(host, listenerPort));
+    EXPECT_EQ(ER_OK, SetSocketOptions(client.GetSocketFd(), options));
+
+    SocketFd serverFd;
+    ASSERT_EQ(ER_OK, Accept(listener, serverFd));
+    SocketStream server(serverFd, SocketOptions());
+    EXPECT_EQ(ER_NOT_IMPLEMENTED, server.Cork());
+    EXPECT_EQ(ER_OK, server.Uncork());
+
+    /* A message spanning several chunks arrives whole once flushed */
+    uint8_t out[5000];
+    for (size_t i = 0; i < sizeof(out); ++i) {
+        out[i] = static_cast<uint8_t>(i * 7);
+    }
+    BufferedSink sink(client, 1024);
+    sink.EnableWriteBuffer();
+    size_t sent;
+    ASSERT_EQ(ER_OK, sink.PushBytes(out, sizeof(out), sent));
+    EXPECT_EQ(sizeof(out), sent);
+    ASSERT_EQ(ER_OK, sink.Flush());
+
+    uint8_t in[sizeof(out)];
+    size_t total = 0;
+    while (total < sizeof(in)) {
+        size_t received;
+        ASSERT_EQ(ER_OK, server.PullBytes(in + total, sizeof(in) - total, received, 1000));
+        total += received;
+    }
+    EXPECT_EQ(0, memcmp(out, in, sizeof(out)));
+
+    Close(listener);
+}
+
+namespace {
+
+class ReleaseCounter : public ZeroCopyListener {
+  public:
+    ReleaseCounter() : buffers(0), octets(0), copied(0) { }
+    void BufferReleased(const void* buf, size_t len, bool wasCopied)
+    {
+        ++buffers;
+        octets += len;
+        copied += wasCopied ? 1 : 0;
+    }
+    size_t buffers;
+    size_t octets;
+    size_t copied;
+};
+
+/*
+ * Connect a pair of SocketStreams over the loopback interface.
+ */
+QStatus ConnectLoopbackStreams(SocketStream*& client, SocketStream*& server)
+{
+    IPAddress loopback("127.0.0.1");
+    SocketFd listener, serverFd;
+    uint16_t listenerPort;
+    QStatus status = Socket(QCC_AF_INET, QCC_SOCK_STREAM, listener);
+    if (status != ER_OK) {
+        return status;
+    }
+    status = Bind(listener, loopback, 0);
+    if (status == ER_OK) {
+        status = GetLocalAddress(listener, loopback, listenerPort);
+    }
+    if (status == ER_OK) {
+        status = Listen(listener, 1);
+    }
+    if (status == ER_OK) {
+        String host = "127.0.0.1";
+        client = new SocketStream(QCC_AF_INET, QCC_SOCK_STREAM);
+        status = client->Connect(host, listenerPort);
+    }
+    if (status == ER_OK) {
+        status = Accept(listener, serverFd);
+    }
+    if (status == ER_OK) {
+        server = new SocketStream(serverFd);
+    }
+    Close(listener);
+    return status;
+}
+
+/*
+ * Push a buffer repeatedly on one thread while pulling it on this one.
+ */
+struct PushArgs {
+    SocketStream* stream;
+    const uint8_t* buf;
+    size_t len;
+    size_t count;
+};
+
+ThreadReturn STDCALL PushRepeatedly(void* arg)
+{
+    PushArgs* args = static_cast<PushArgs*>(arg);
+    args->stream->SetSendTimeout(Event::WAIT_FOREVER);
+    for (size_t i = 0; i < args->count; ++i) {
+        size_t offset = 0;
+        while (offset < args->len) {
+            size_t sent;
+            if (args->stream->PushBytes(args->buf + offset, args->len - offset, sent) != ER_OK) {
+                return reinterpret_cast<ThreadReturn>(1);
+            }
+            offset += sent;
+        }
+    }
+    return 0;
+}
+
+size_t PullAll(SocketStream& stream, size_t total)
+{
+    static uint8_t in[256 * 1024];
+    size_t pulled = 0;
+    while (pulled < total) {
+        size_t received;
+        if (stream.PullBytes(in, sizeof(in), received, 5000) != ER_OK) {
+            break;
+        }
+        pulled += received;
+    }
+    return pulled;
+}
+
+/*
+ * Pull a number of octets on another thread.
+ */
+struct PullArgs {
+    SocketStream* stream;
+    size_t total;
+    size_t pulled;
+};
+
+ThreadReturn STDCALL PullInBackground(void* arg)
+{
+    PullArgs* args = static_cast<PullArgs*>(arg);
+    args->pulled = PullAll(*args->stream, args->total);
+    return 0;
+}
+
+}
+
+TEST(SocketTest, zero_copy_push) {
+    SocketStream* client = NULL;
+    SocketStream* server = NULL;
+    ASSERT_EQ(ER_OK, ConnectLoopbackStreams(client, server));
+
+    ReleaseCounter counter;
+    QStatus status = client->EnableZeroCopy(64 * 1024, &counter);
+    if (status == ER_NOT_IMPLEMENTED) {
+        printf("Zero copy sends are not supported here\n");
+        delete client;
+        delete server;
+        return;
+    }
+    ASSERT_EQ(ER_OK, status);
+    EXPECT_EQ(ER_FAIL, client->EnableZeroCopy(64 * 1024, &counter));
+
+    /* Small pushes are copied, large ones are released once sent */
+    static uint8_t big[256 * 1024];
+    uint8_t small[1000];
+    memset(small, 1, sizeof(small));
+    memset(big, 2, sizeof(big));
+    PushArgs smallArgs = { client, small, sizeof(small), 10 };
+    EXPECT_TRUE(PushRepeatedly(&smallArgs) == 0);
+    EXPECT_EQ(0U, client->GetZeroCopyPending());
+
+    Thread pusher("ZeroCopyPush", PushRepeatedly);
+    PushArgs bigArgs = { client, big, sizeof(big), 8 };
+    ASSERT_EQ(ER_OK, pusher.Start(&bigArgs));
+    EXPECT_EQ(sizeof(small) * 10 + sizeof(big) * 8, PullAll(*server, sizeof(small) * 10 + sizeof(big) * 8));
+    pusher.Join();
+    EXPECT_TRUE(pusher.GetExitValue() == 0);
+
+    for (int tries = 0; (counter.octets < sizeof(big) * 8) && (tries < 100); ++tries) {
+        EXPECT_EQ(ER_OK, client->ProcessZeroCopyCompletions());
+        if (counter.octets < sizeof(big) * 8) {
+            qcc::Sleep(10);
+        }
+    }
+    EXPECT_EQ(sizeof(big) * 8, counter.octets);
+    EXPECT_EQ(0U, client->GetZeroCopyPending());
+    EXPECT_LE(8U, counter.buffers);
+
+    delete client;
+    delete server;
+}
+
+TEST(SocketTest, zero_copy_destroy_in_flight) {
+    SocketStream* client = NULL;
+    SocketStream* server = NULL;
+    ASSERT_EQ(ER_OK, ConnectLoopbackStreams(client, server));
+
+    ReleaseCounter counter;
+    QStatus status = client->EnableZeroCopy(64 * 1024, &counter);
+    if (status == ER_NOT_IMPLEMENTED) {
+        printf("Zero copy sends are not supported here\n");
+        delete client;
+        delete server;
+        return;
+    }
+    ASSERT_EQ(ER_OK, status);
+
+    /* Destroy the stream straight after pushing, while the peer is still reading */
+    static uint8_t big[256 * 1024];
+    PullArgs pullArgs = { server, sizeof(big) * 4, 0 };
+    Thread puller("ZeroCopyPull", PullInBackground);
+    ASSERT_EQ(ER_OK, puller.Start(&pullArgs));
+    PushArgs pushArgs = { client, big, sizeof(big), 4 };
+    EXPECT_TRUE(PushRepeatedly(&pushArgs) == 0);
+    delete client;
+
+    /* Every buffer came back from a completion before the socket was closed */
+    EXPECT_EQ(sizeof(big) * 4, counter.octets);
+    EXPECT_EQ(counter.buffers, counter.copied);
+    puller.Join();
+    EXPECT_EQ(sizeof(big) * 4, pullArgs.pulled);
+    delete server;
+}
+
+TEST(SocketTest, zero_copy_destroy_unacknowledged) {
+    SocketStream* client = NULL;
+    SocketStream* server = NULL;
+    ASSERT_EQ(ER_OK, ConnectLoopbackStreams(client, server));
+
+    ReleaseCounter counter;
+    QStatus status = client->EnableZeroCopy(1024, &counter, 100);
+    if (status == ER_NOT_IMPLEMENTED) {
+        printf("Zero copy sends are not supported here\n");
+        delete client;
+        delete server;
+        return;
+    }
+    ASSERT_EQ(ER_OK, status);
+
+    /* The peer never reads, so push until the send buffer is full */
+    static uint8_t big[64 * 1024];
+    size_t pushed = 0;
+    client->SetSendTimeout(100);
+    while (true) {
+        size_t sent;
+        if (client->PushBytes(big, sizeof(big), sent) != ER_OK) {
+            break;
+        }
+        pushed += sent;
+    }
+    ASSERT_LT(0U, client->GetZeroCopyPending());
+
+    /* Sends stuck in the send buffer at the time limit are not released */
+    uint64_t start = GetTimestamp64();
+    delete client;
+    EXPECT_GT(pushed, counter.octets);
+    EXPECT_LE(GetTimestamp64() - start, 2000U);
+    delete server;
+}
+
+TEST(SocketTest, zero_copy_destroy_after_peer_closed) {
+    SocketStream* client = NULL;
+    SocketStream* server = NULL;
+    ASSERT_EQ(ER_OK, ConnectLoopbackStreams(client, server));
+
+    ReleaseCounter counter;
+    QStatus status = client->EnableZeroCopy(1024, &counter, 2000);
+    if (status == ER_NOT_IMPLEMENTED) {
+        printf("Zero copy sends are not supported here\n");
+        delete client;
+        delete server;
+        return;
+    }
+    ASSERT_EQ(ER_OK, status);
+
+    static uint8_t big[64 * 1024];
+    client->SetSendTimeout(100);
+    while (true) {
+        size_t sent;
+        if (client->PushBytes(big, sizeof(big), sent) != ER_OK) {
+            break;
+        }
+    }
+    ASSERT_LT(0U, client->GetZeroCopyPending());
+
+    /* Closing with unread data resets the connection */
+    delete server;
+
+    /* The reset and the hangup end the wait instead of spinning until the time limit */
+    uint64_t start = GetTimestamp64();
+    delete client;
+    EXPECT_GT(1000U, GetTimestamp64() - start);
+}
+
+TEST(SocketTest, zero_copy_refused_under_buffered_sink) {
+    SocketStream* client = NULL;
+    SocketStream* server = NULL;
+    ASSERT_EQ(ER_OK, ConnectLoopbackStreams(client, server));
+
+    /* BufferedSink refills the chunk it pushed as soon as the push returns */
+    ReleaseCounter counter;
+    {
+        BufferedSink sink(*client, 128 * 1024);
+        EXPECT_EQ(ER_FAIL, client->EnableZeroCopy(64 * 1024, &counter));
+    }
+    QStatus status = client->EnableZeroCopy(64 * 1024, &counter);
+    if (status == ER_NOT_IMPLEMENTED) {
+        printf("Zero copy sends are not supported here\n");
+        delete client;
+        delete server;
+        return;
+    }
+    ASSERT_EQ(ER_OK, status);
+
+    /* Wrapping a stream that already has zero copy enabled copies the chunks */
+    static uint8_t big[256 * 1024];
+    PullArgs pullArgs = { server, sizeof(big), 0 };
+    Thread puller("ZeroCopyPull", PullInBackground);
+    ASSERT_EQ(ER_OK, puller.Start(&pullArgs));
+    {
+        BufferedSink sink(*client, 128 * 1024);
+        sink.EnableWriteBuffer();
+        size_t sent;
+        EXPECT_EQ(ER_OK, sink.PushBytes(big, sizeof(big), sent));
+        EXPECT_EQ(sizeof(big), sent);
+        EXPECT_EQ(ER_OK, sink.Flush());
+        EXPECT_EQ(0U, client->GetZeroCopyPending());
+    }
+    puller.Join();
+    EXPECT_EQ(sizeof(big), pullArgs.pulled);
+    EXPECT_EQ(0U, counter.buffers);
+
+    delete client;
+    delete server;
+}
+
+/*
+ * Compare pushing with and without zero copy for a range of sizes to find the
+ * crossover.  On loopback and veth the kernel copies zero copy sends anyway, so
+ * they only show the cost of the completions; run it over a real device to see
+ * the saving.
+ */
+TEST(SocketTest, DISABLED_zero_copy_benchmark) {
+    const size_t sizes[] = { 4 * 1024, 16 * 1024, 64 * 1024, 256 * 1024, 1024 * 1024 };
+    const size_t totalBytes = 512 * 1024 * 1024;
+    static uint8_t buf[1024 * 1024];
+
+    for (size_t i = 0; i < ArraySize(sizes); ++i) {
+        double rates[2] = { 0, 0 };
+        for (int zero = 0; zero < 2; ++zero) {
+            SocketStream* client = NULL;
+            SocketStream* server = NULL;
+            ASSERT_EQ(ER_OK, ConnectLoopbackStreams(client, server));
+            ReleaseCounter counter;
+            if (zero && (client->EnableZeroCopy(0, &counter) != ER_OK)) {
+                printf("Zero copy sends are not supported here\n");
+                delete client;
+                delete server;
+                return;
+            }
+            Thread pusher("ZeroCopyBench", PushRepeatedly);
+            PushArgs args = { client, buf, sizes[i], totalBytes / sizes[i] };
+            uint64_t start = GetTimestamp64();
+            ASSERT_EQ(ER_OK, pusher.Start(&args));
+            PullAll(*server, args.len * args.count);
+            pusher.Join();
+            uint64_t elapsed = GetTimestamp64() - start;
+            rates[zero] = (args.len * args.count) / (elapsed * 1000.0);
+            if (zero) {
+                printf("%7lu bytes: copy %6.0f MB/s  zero copy %6.0f MB/s  (%lu of %lu completions copied)\n",
+                       static_cast<unsigned long>(sizes[i]), rates[0], rates[1],
+                       static_cast<unsigned long>(counter.copied), static_cast<unsigned long>(counter.buffers));
+            }
+            delete client;
+            delete server;
+        }
+    }
+}
@@ -0,0 +1,159 @@
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <gtest/gtest.h>
+
+#include <stdio.h>
+
+#include <qcc/String.h>
+#include <qcc/StringBuilder.h>
+#include <qcc/StringSource.h>
+#include <qcc/StringUtil.h>
+#include <qcc/XmlElement.h>
+#include <qcc/time.h>
+#include <Status.h>
+
+using namespace qcc;
+
+TEST(StringBuilderTest, Append) {
+    StringBuilder sb;
+    EXPECT_TRUE(sb.empty());
+    EXPECT_TRUE(sb.ToString().empty());
+
+    sb.append("org.").append(String("alljoyn")).append('.').append(3, 'x');
+    sb.insert(0, "<", 1).append('>');
+    EXPECT_EQ(17U, sb.size());
+    EXPECT_EQ(String("<org.alljoyn.xxx>"), sb.ToString());
+    EXPECT_TRUE(sb.empty());
+
+    sb.append("abc").padTo(6, '.').padTo(2);
+    EXPECT_EQ(String("abc..."), sb.ToString());
+
+    sb.appendf("%s=%d", "count", 42);
+    EXPECT_EQ(String("count=42"), sb.ToString());
+}
+
+TEST(StringBuilderTest, Numbers) {
+    StringBuilder sb;
+    sb.appendU32(0).append(' ');
+    sb.appendU32(1234, 10, 6, '0').append(' ');
+    sb.appendU32(0xBEEF, 16).append(' ');
+    sb.appendI32(-5, 10, 4, '0').append(' ');
+    sb.appendI32(-2147483647 - 1).append(' ');
+    sb.appendU64(18446744073709551615ULL).append(' ');
+    sb.appendI64(-9223372036854775807LL - 1);
+    EXPECT_EQ(String("0 001234 BEEF -005 -2147483648 18446744073709551615 -9223372036854775808"), sb.ToString());
+
+    const uint8_t bytes[] = { 0x00, 0x7f, 0xa5, 0xff };
+    sb.appendHex(bytes, sizeof(bytes)).append(' ').appendHex(bytes, sizeof(bytes), true, ':');
+    EXPECT_EQ(String("007FA5FF 00:7f:a5:ff"), sb.ToString());
+
+    /* The StringUtil conversions produce the same strings */
+    EXPECT_EQ(String("   42"), U32ToString(42, 10, 5));
+    EXPECT_EQ(String("-0042"), I32ToString(-42, 10, 5, '0'));
+    EXPECT_EQ(String("777"), U64ToString(511, 8));
+    EXPECT_EQ(String("-FF"), I64ToString(-255, 16));
+    EXPECT_EQ(String("00-7F-A5-FF"), BytesToHexString(bytes, sizeof(bytes), false, '-'));
+    EXPECT_TRUE(BytesToHexString(bytes, 0).empty());
+}
+
+TEST(StringBuilderTest, Growth) {
+    /* Cross the inline buffer with every kind of append */
+    String expect;
+    StringBuilder sb;
+    for (uint32_t i = 0; i < 1000; ++i) {
+        expect.append(U32ToString(i, 16, 4, '0'));
+        expect.push_back(',');
+        if (i % 3) {
+            sb.appendU32(i, 16, 4, '0').append(',');
+        } else {
+            sb.appendf("%04X", i).append(",");
+        }
+    }
+    EXPECT_EQ(expect.size(), sb.size());
+    const char* storage = sb.data();
+    String str = sb.ToString();
+    EXPECT_EQ(expect, str);
+    /* The heap storage was handed over, not copied */
+    EXPECT_EQ(storage, str.c_str());
+
+    /* A long formatted append that does not fit where it starts */
+    sb.append(StringBuilder::StackCapacity - 1, 'a');
+    sb.appendf("%s", expect.c_str());
+    EXPECT_EQ(String(StringBuilder::StackCapacity - 1, 'a') + expect, sb.ToString());
+
+    /* Appending to a String */
+    String dest("prefix:");
+    sb.append("suffix");
+    sb.AppendTo(dest);
+    EXPECT_EQ(String("prefix:suffix"), dest);
+    EXPECT_TRUE(sb.empty());
+}
+
+TEST(StringBuilderTest, XmlGenerate) {
+    StringSource source("<node name=\"/a\"><interface name=\"b\"><method name=\"m\"/></interface><annotation>x &amp; y</annotation></node>");
+    XmlParseContext ctx(source);
+    ASSERT_EQ(ER_OK, XmlElement::Parse(ctx));
+    const XmlElement* root = ctx.GetRoot();
+    ASSERT_TRUE(root != NULL);
+
+    String expect("\n<node name=\"/a\">\n<interface name=\"b\">\n<method name=\"m\"/>\n</interface>\n<annotation>x &amp; y</annotation>\n</node>");
+    EXPECT_EQ(expect, root->Generate());
+    String out("<?xml?>");
+    EXPECT_EQ(String("<?xml?>") + expect, root->Generate(&out));
+    EXPECT_EQ(String("<?xml?>") + expect, out);
+}
+
+/*
+ * Compare building a debug style line with String appends and temporary
+ * number strings against the builder.
+ */
+TEST(StringBuilderTest, DISABLED_Benchmark) {
+    const uint32_t iterations = 1000000;
+    volatile size_t sink = 0;
+
+    uint64_t start = GetTimestamp64();
+    for (uint32_t i = 0; i < iterations; ++i) {
+        String s;
+        s.append(U32ToString(i % 10000, 10, 4, ' '));
+        s.push_back('.');
+        s.append(U32ToString(i % 1000, 10, 3, '0'));
+        s.append(" DEBUG ");
+        s.append("ALLJOYN");
+        s.append(" ... ");
+        s.append(I32ToString(-static_cast<int32_t>(i)));
+        s.append(" | message");
+        sink += s.size();
+    }
+    uint64_t strTime = GetTimestamp64() - start;
+
+    start = GetTimestamp64();
+    for (uint32_t i = 0; i < iterations; ++i) {
+        StringBuilder sb;
+        sb.appendU32(i % 10000, 10, 4, ' ');
+        sb.append('.');
+        sb.appendU32(i % 1000, 10, 3, '0');
+        sb.append(" DEBUG ");
+        sb.append("ALLJOYN");
+        sb.append(" ... ");
+        sb.appendI32(-static_cast<int32_t>(i));
+        sb.append(" | message");
+        sink += sb.ToString().size();
+    }
+    uint64_t sbTime = GetTimestamp64() - start;
+
+    printf("String appends: %.1f ns per line\n", strTime * 1e6 / iterations);
+    printf("StringBuilder:  %.1f ns per line\n", sbTime * 1e6 / iterations);
+}
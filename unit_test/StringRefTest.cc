@@ -0,0 +1,139 @@
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <gtest/gtest.h>
+
+#include <map>
+
+#include <qcc/String.h>
+#include <qcc/StringMapKey.h>
+#include <qcc/StringRef.h>
+#include <qcc/StringUtil.h>
+#include <qcc/Util.h>
+#include <qcc/XmlElement.h>
+
+using namespace qcc;
+
+TEST(StringRefTest, basics) {
+    StringRef empty;
+    EXPECT_TRUE(empty.empty());
+    EXPECT_EQ(0U, StringRef(NULL).size());
+
+    String s("hello world");
+    StringRef ref(s);
+    EXPECT_EQ(s.data(), ref.data());
+    EXPECT_EQ(11U, ref.size());
+    EXPECT_EQ('w', ref[6]);
+    EXPECT_TRUE(ref == "hello world");
+    EXPECT_TRUE(ref != "hello");
+    EXPECT_TRUE(ref.starts_with("hello"));
+    EXPECT_STREQ("world", ref.substr(6).ToString().c_str());
+    EXPECT_STREQ("lo", ref.substr(3, 2).ToString().c_str());
+    EXPECT_TRUE(ref.substr(20).empty());
+    EXPECT_TRUE(StringRef().ToString().empty());
+}
+
+TEST(StringRefTest, compare) {
+    EXPECT_EQ(0, StringRef("abc").compare("abc"));
+    EXPECT_GT(0, StringRef("ab").compare("abc"));
+    EXPECT_LT(0, StringRef("abd").compare("abc"));
+    EXPECT_TRUE(StringRef("ab") < StringRef("abc"));
+    EXPECT_FALSE(StringRef("abc") < StringRef("abc"));
+
+    /* A reference to part of a longer string compares by its own length */
+    const char* text = "abcdef";
+    EXPECT_TRUE(StringRef(text, 3) == "abc");
+    EXPECT_TRUE(StringRef(text, 3) < StringRef(text));
+}
+
+TEST(StringRefTest, find) {
+    StringRef ref("a/b/cc/dd@attr");
+    EXPECT_EQ(1U, ref.find('/'));
+    EXPECT_EQ(3U, ref.find('/', 2));
+    EXPECT_TRUE(ref.find('x') == StringRef::npos);
+    EXPECT_TRUE(ref.find('a', 100) == StringRef::npos);
+    EXPECT_EQ(4U, ref.find("cc"));
+    EXPECT_EQ(10U, ref.find("attr"));
+    EXPECT_TRUE(ref.find("attrs") == StringRef::npos);
+    EXPECT_TRUE(ref.find("cd") == StringRef::npos);
+    EXPECT_EQ(2U, ref.find("", 2));
+
+    /* The match must lie within the reference */
+    EXPECT_TRUE(StringRef("abcdef", 4).find("ef") == StringRef::npos);
+}
+
+TEST(StringRefTest, hash) {
+    EXPECT_EQ(hash_string("module"), StringRef("module").hash());
+    EXPECT_EQ(StringRef("module").hash(), StringRef("module_name", 6).hash());
+}
+
+TEST(StringRefTest, StringMapKey) {
+    std::map<StringMapKey, int> m;
+    m[String("ALLJOYN")] = 1;
+    m[String("ALLJOYN_OBJ")] = 2;
+    m[String("NETWORK")] = 3;
+
+    EXPECT_EQ(1, m.find(StringMapKey("ALLJOYN"))->second);
+    EXPECT_EQ(2, m.find(StringMapKey(StringRef("ALLJOYN_OBJ_XYZ", 11)))->second);
+    EXPECT_EQ(1, m.find(StringMapKey(StringRef("ALLJOYN_OBJ", 7)))->second);
+    EXPECT_TRUE(m.find(StringMapKey(StringRef("NETWORKS", 8))) == m.end());
+    EXPECT_EQ(7U, StringMapKey(StringRef("ALLJOYN_OBJ", 7)).size());
+}
+
+TEST(StringRefTest, StringToNumber) {
+    /* None of these are nul terminated where the reference ends */
+    const char* text = "1234 0x1f -17 2.5e2";
+    EXPECT_EQ(12U, StringToU32(StringRef(text, 2)));
+    EXPECT_EQ(31U, StringToU32(StringRef(text + 5, 4)));
+    EXPECT_EQ(1U, StringToU32(StringRef(text + 5, 3), 16));
+    EXPECT_EQ(0U, StringToU32(StringRef(text + 5, 1)));
+    EXPECT_EQ(-1, StringToI32(StringRef(text + 10, 2)));
+    EXPECT_EQ(-17, StringToI64(StringRef(text + 10, 3)));
+    EXPECT_EQ(2.5, StringToDouble(StringRef(text + 14, 3)));
+    EXPECT_EQ(250.0, StringToDouble(StringRef(text + 14, 5)));
+    EXPECT_EQ(99U, StringToU32(StringRef(text, 0), 0, 99));
+    EXPECT_EQ(99U, StringToU32(StringRef(text, 0), 16, 99));
+
+    uint8_t bytes[2];
+    EXPECT_EQ(1U, HexStringToBytes(StringRef("abcd", 3), bytes, sizeof(bytes)));
+    EXPECT_EQ(0xab, bytes[0]);
+}
+
+TEST(StringRefTest, XmlElement) {
+    XmlElement root("root");
+    XmlElement& foo = root.CreateChild("foo");
+    XmlElement& bar = foo.CreateChild("bar");
+    bar.CreateChild("value").AddAttribute("first", "hello");
+    bar.CreateChild("value").AddAttribute("second", "world");
+    bar.CreateChild("other");
+
+    EXPECT_EQ(&foo, root.GetChild("foo"));
+    EXPECT_EQ(&foo, root.GetChild(StringRef("foo/bar", 3)));
+    EXPECT_TRUE(root.GetChild("fo") == NULL);
+    EXPECT_EQ(2U, bar.GetChildren("value").size());
+
+    const XmlElement* value = bar.GetChild("value");
+    EXPECT_STREQ("hello", value->GetAttribute("first").c_str());
+    EXPECT_STREQ("hello", value->GetAttribute(String("first")).c_str());
+    EXPECT_STREQ("hello", value->GetAttribute(StringRef("firstly", 5)).c_str());
+    EXPECT_TRUE(value->GetAttribute("second").empty());
+    EXPECT_TRUE(value->GetAttribute("fir").empty());
+
+    EXPECT_EQ(2U, root.GetPath("foo/bar/value").size());
+    std::vector<const XmlElement*> matches = root.GetPath("foo/bar/value@second");
+    ASSERT_EQ(1U, matches.size());
+    EXPECT_STREQ("world", matches[0]->GetAttribute("second").c_str());
+    EXPECT_EQ(0U, root.GetPath("foo/baz/value").size());
+}
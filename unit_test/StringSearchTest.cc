@@ -0,0 +1,240 @@
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <gtest/gtest.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include <qcc/String.h>
+#include <qcc/StringSearch.h>
+#include <qcc/time.h>
+
+using namespace qcc;
+
+/* Straightforward versions of the searches to check the results against */
+
+static size_t RefFind(const char* str, size_t len, const char* pat, size_t patLen)
+{
+    for (size_t i = 0; i + patLen <= len; ++i) {
+        if (memcmp(str + i, pat, patLen) == 0) {
+            return i;
+        }
+    }
+    return len;
+}
+
+static bool InSet(char c, const char* set, size_t setLen)
+{
+    return memchr(set, c, setLen) != NULL;
+}
+
+static size_t RefFindFirstOf(const char* str, size_t len, const char* set, size_t setLen, bool inSet)
+{
+    for (size_t i = 0; i < len; ++i) {
+        if (InSet(str[i], set, setLen) == inSet) {
+            return i;
+        }
+    }
+    return len;
+}
+
+static size_t RefFindLastOf(const char* str, size_t len, const char* set, size_t setLen, bool inSet)
+{
+    for (size_t i = len; i-- > 0;) {
+        if (InSet(str[i], set, setLen) == inSet) {
+            return i;
+        }
+    }
+    return len;
+}
+
+/*
+ * Restores the automatically selected level when a test finishes.
+ */
+class StringSearchTest : public testing::Test {
+  protected:
+    virtual void SetUp() { level = StringSearch::GetLevel(); }
+    virtual void TearDown() { StringSearch::SetLevel(level); }
+    StringSearch::Level level;
+};
+
+TEST_F(StringSearchTest, MatchesReference) {
+    /* A small alphabet makes partial matches and set hits common */
+    const char alphabet[] = "ab<>/ \x80\xff";
+    srand(1);
+    for (int lvl = StringSearch::SCALAR; lvl <= StringSearch::AVX2; ++lvl) {
+        StringSearch::SetLevel(static_cast<StringSearch::Level>(lvl));
+        for (size_t len = 0; len < 100; ++len) {
+            /* Exactly sized so reading past the end is caught by memory checkers */
+            std::vector<char> buf(len + 1);
+            char* str = &buf[0];
+            for (size_t i = 0; i < len; ++i) {
+                str[i] = alphabet[rand() % (sizeof(alphabet) - 1)];
+            }
+            char pat[8];
+            for (size_t patLen = 0; patLen < sizeof(pat); ++patLen) {
+                size_t start = len ? rand() % len : 0;
+                for (size_t i = 0; i < patLen; ++i) {
+                    pat[i] = (start + i < len) ? str[start + i] : 'a';
+                }
+                const char* p = StringSearch::Find(str, len, pat, patLen);
+                ASSERT_EQ(RefFind(str, len, pat, patLen), p ? static_cast<size_t>(p - str) : len);
+            }
+            for (size_t setLen = 0; setLen < 20; ++setLen) {
+                char set[20];
+                for (size_t i = 0; i < setLen; ++i) {
+                    set[i] = alphabet[rand() % (sizeof(alphabet) - 1)];
+                }
+                ASSERT_EQ(RefFindFirstOf(str, len, set, setLen, true), StringSearch::FindFirstOf(str, len, set, setLen, true));
+                ASSERT_EQ(RefFindFirstOf(str, len, set, setLen, false), StringSearch::FindFirstOf(str, len, set, setLen, false));
+                ASSERT_EQ(RefFindLastOf(str, len, set, setLen, true), StringSearch::FindLastOf(str, len, set, setLen, true));
+                ASSERT_EQ(RefFindLastOf(str, len, set, setLen, false), StringSearch::FindLastOf(str, len, set, setLen, false));
+            }
+            std::vector<char> other(buf);
+            ASSERT_TRUE(StringSearch::Equal(str, &other[0], len));
+            if (len) {
+                size_t diff = rand() % len;
+                other[diff] = str[diff] ^ 0x80;
+                ASSERT_EQ(diff, StringSearch::Mismatch(str, &other[0], len));
+                ASSERT_EQ((static_cast<uint8_t>(str[diff]) < static_cast<uint8_t>(other[diff])), StringSearch::Compare(str, &other[0], len) < 0);
+            }
+        }
+    }
+}
+
+TEST_F(StringSearchTest, StringMethods) {
+    for (int lvl = StringSearch::SCALAR; lvl <= StringSearch::AVX2; ++lvl) {
+        StringSearch::SetLevel(static_cast<StringSearch::Level>(lvl));
+        String xml("  <node name=\"/org/alljoyn/Bus\"><interface name=\"org.alljoyn.Bus\"/></node>  \t");
+        EXPECT_EQ(32U, xml.find("<interface"));
+        EXPECT_EQ(32U, xml.find(String("<interface")));
+        EXPECT_TRUE(xml.find("<interface", 33) == String::npos);
+        EXPECT_TRUE(xml.find("x", 1000) == String::npos);
+        EXPECT_EQ(2U, xml.find_first_of("<>"));
+        EXPECT_EQ(7U, xml.find_first_of(" =", 3));
+        EXPECT_EQ(2U, xml.find_first_not_of(" \t"));
+        EXPECT_EQ(73U, xml.find_last_not_of(" \t"));
+        EXPECT_EQ(67U, xml.find_last_of('<'));
+        EXPECT_EQ(xml.size(), xml.find_first_of('\0'));
+        EXPECT_TRUE(xml.find_first_of('#') == String::npos);
+        EXPECT_TRUE(String("   ").find_first_not_of(" ") == String::npos);
+
+        /* The C library searches stop at an embedded nul */
+        String embedded("ab\0cd<e", 7);
+        EXPECT_EQ(5U, embedded.find_first_of("<"));
+        EXPECT_EQ(5U, embedded.find_first_of("<", 3));
+        EXPECT_TRUE(embedded.find_first_of("#") == String::npos);
+        EXPECT_EQ(2U, embedded.find_first_not_of("ab"));
+        EXPECT_TRUE(String("ab\0", 3).find_first_of("x") == String::npos);
+        EXPECT_TRUE(String("ab", 2).find_first_of("x") == String::npos);
+
+        String a("org.alljoyn.Bus.Peer.Authentication");
+        String b("org.alljoyn.Bus.Peer.Authenticatioo");
+        EXPECT_FALSE(a == b);
+        EXPECT_TRUE(a < b);
+        EXPECT_GT(0, a.compare(b));
+        EXPECT_EQ(0, a.compare(0, 20, b, 0, 20));
+        EXPECT_TRUE(a == String(a.c_str()));
+    }
+}
+
+/*
+ * Time an operation on strings of typical sizes at each level, and the same
+ * operation done with the C library where it has one.  The sizes are those of
+ * an interface or member name and of XML lines and documents.  Each string is
+ * compared against a copy that differs in the last character.
+ */
+typedef size_t (*StringOp)(const String& s, const String& other);
+
+static double Time(StringOp op, const String& s, const String& other)
+{
+    const uint32_t iterations = 1 + 1000000000 / (s.size() + 64);
+    volatile size_t sink = 0;
+    uint64_t start = GetTimestamp64();
+    for (uint32_t i = 0; i < iterations; ++i) {
+        sink += op(s, other);
+    }
+    return (GetTimestamp64() - start) * 1e6 / iterations;
+}
+
+static void Time(const char* label, const std::vector<String>& strings, const std::vector<String>& others, StringOp op, StringOp libcOp)
+{
+    printf("%-20s", label);
+    for (size_t n = 0; n < strings.size(); ++n) {
+        for (int lvl = StringSearch::SCALAR; lvl <= StringSearch::AVX2; ++lvl) {
+            if (StringSearch::SetLevel(static_cast<StringSearch::Level>(lvl)) != lvl) {
+                printf(" %7s", "-");
+            } else {
+                printf(" %7.1f", Time(op, strings[n], others[n]));
+            }
+        }
+        if (libcOp) {
+            printf(" %7.1f |", Time(libcOp, strings[n], others[n]));
+        } else {
+            printf(" %7s |", "-");
+        }
+    }
+    printf("\n");
+}
+
+static size_t FindTag(const String& s, const String& other) { return s.find("</signal>"); }
+static size_t FindName(const String& s, const String& other) { return s.find("org.alljoyn.Bus.Peer"); }
+static size_t FindMarkup(const String& s, const String& other) { return s.find_first_of("<>&\"'"); }
+static size_t SkipSpace(const String& s, const String& other) { return s.find_first_not_of(" \t\r\n", 4); }
+static size_t TrimRight(const String& s, const String& other) { return s.find_last_not_of(" \t\r\n"); }
+static size_t Equals(const String& s, const String& other) { return s == other; }
+static size_t Less(const String& s, const String& other) { return s < other; }
+
+#if defined(QCC_OS_GROUP_POSIX)
+static size_t MemmemTag(const String& s, const String& other) { return reinterpret_cast<size_t>(memmem(s.data(), s.size(), "</signal>", 9)); }
+static size_t MemmemName(const String& s, const String& other) { return reinterpret_cast<size_t>(memmem(s.data(), s.size(), "org.alljoyn.Bus.Peer", 20)); }
+#else
+#define MemmemTag NULL
+#define MemmemName NULL
+#endif
+static size_t StrcspnMarkup(const String& s, const String& other) { return strcspn(s.c_str(), "<>&\"'"); }
+static size_t StrspnSpace(const String& s, const String& other) { return strspn(s.c_str() + 4, " \t\r\n"); }
+static size_t MemcmpEquals(const String& s, const String& other) { return (s.size() == other.size()) && (memcmp(s.data(), other.data(), s.size()) == 0); }
+static size_t MemcmpLess(const String& s, const String& other) { return memcmp(s.c_str(), other.c_str(), ((s.size() < other.size()) ? s.size() : other.size()) + 1) < 0; }
+
+TEST_F(StringSearchTest, DISABLED_Benchmark) {
+    size_t sizes[] = { 16, 40, 256, 4096 };
+    std::vector<String> strings;
+    std::vector<String> others;
+    for (size_t n = 0; n < sizeof(sizes) / sizeof(sizes[0]); ++n) {
+        /* Plain name characters with no match until the very end */
+        String s("    ");
+        while (s.size() < sizes[n] - 9) {
+            s.append("org.alljoyn.Bus.");
+        }
+        s.resize(sizes[n] - 9);
+        s.append("</signal>");
+        strings.push_back(s);
+        s[s.size() - 1] = '}';
+        others.push_back(s);
+    }
+    printf("ns per call, columns are scalar/sse2/avx2/libc for %u, %u, %u and %u byte strings\n",
+           (unsigned)sizes[0], (unsigned)sizes[1], (unsigned)sizes[2], (unsigned)sizes[3]);
+    Time("find (rare start)", strings, others, FindTag, MemmemTag);
+    Time("find (common start)", strings, others, FindName, MemmemName);
+    Time("find_first_of", strings, others, FindMarkup, StrcspnMarkup);
+    Time("find_first_not_of", strings, others, SkipSpace, StrspnSpace);
+    Time("find_last_not_of", strings, others, TrimRight, NULL);
+    Time("operator==", strings, others, Equals, MemcmpEquals);
+    Time("operator<", strings, others, Less, MemcmpLess);
+}
@@ -15,7 +15,13 @@
  *    limitations under the License.
  ******************************************************************************/
 #include <gtest/gtest.h>
+
+#include <stdio.h>
+#include <utility>
+#include <vector>
+
 #include <qcc/String.h>
+#include <qcc/time.h>
 
 TEST(StringTest, constructor) {
     const char* testStr = "abcdefgdijk";
@@ -82,8 +88,13 @@ TEST(StringTest, copyConstructor) {
     /* test copy constructor */
     qcc::String s2 = "abcdefg";
     qcc::String t2 = s2;
-    ASSERT_EQ(s2.c_str(), t2.c_str());
     ASSERT_TRUE(t2 == "abcdefg");
+
+    /* Strings too long for the inline buffer share storage */
+    qcc::String s3 = "abcdefghijklmnopqrstuvwxyz";
+    qcc::String t3 = s3;
+    ASSERT_EQ(s3.c_str(), t3.c_str());
+    ASSERT_TRUE(t3 == "abcdefghijklmnopqrstuvwxyz");
 }
 
 TEST(StringTest, append) {
@@ -251,3 +262,105 @@ TEST(StringTest, plusEqualsOperator) {
     s.resize(s.size() + 3, 'x');
     ASSERT_TRUE(s == "foofooxxx");
 }
+
+TEST(StringTest, inlineStorage) {
+    /* Strings up to InlineCapacity chars live inside the String */
+    qcc::String shortStr(qcc::String::InlineCapacity, 's');
+    qcc::String longStr(qcc::String::InlineCapacity + 1, 'l');
+    ASSERT_EQ(qcc::String::InlineCapacity, shortStr.capacity());
+    ASSERT_LT(qcc::String::InlineCapacity, longStr.capacity());
+
+    /* Copies of short strings are independent */
+    qcc::String copy(shortStr);
+    ASSERT_NE(shortStr.c_str(), copy.c_str());
+    copy[0] = 'x';
+    ASSERT_EQ('s', shortStr[0]);
+    ASSERT_EQ(0U, copy.secure_clear());
+
+    /* Copies of long strings share storage until one is modified */
+    qcc::String longCopy;
+    longCopy = longStr;
+    ASSERT_EQ(longStr.c_str(), longCopy.c_str());
+    longCopy.append('l');
+    ASSERT_NE(longStr.c_str(), longCopy.c_str());
+    ASSERT_EQ(qcc::String::InlineCapacity + 1, longStr.size());
+
+    /* Growing out of and shrinking back into the inline buffer */
+    qcc::String s("abc");
+    s.append(qcc::String(30, 'd'));
+    ASSERT_EQ(33U, s.size());
+    s.erase(3);
+    s.reserve(3);
+    ASSERT_EQ(qcc::String::InlineCapacity, s.capacity());
+    ASSERT_TRUE(s == "abc");
+    s.assign("0123456789012345678");
+    ASSERT_STREQ("0123456789012345678", s.c_str());
+}
+
+#if defined(QCC_HAS_RVALUE_REFERENCES)
+TEST(StringTest, move) {
+    qcc::String longStr(40, 'l');
+    const char* storage = longStr.c_str();
+
+    /* Moving a long string hands over its storage */
+    qcc::String moved(std::move(longStr));
+    ASSERT_EQ(storage, moved.c_str());
+    ASSERT_TRUE(longStr.empty());
+
+    qcc::String target("target");
+    target = std::move(moved);
+    ASSERT_EQ(storage, target.c_str());
+    ASSERT_TRUE(moved.empty());
+
+    qcc::String shortStr("short");
+    target = std::move(shortStr);
+    ASSERT_TRUE(target == "short");
+    ASSERT_TRUE(shortStr.empty());
+}
+#endif
+
+/*
+ * Not run by default.  Use --gtest_also_run_disabled_tests to time common
+ * String operations on the machine at hand.
+ */
+TEST(StringTest, DISABLED_Benchmark) {
+    const uint32_t iterations = 2000000;
+    const char* lengths[] = { "org.alljoyn", "org.alljoyn.Bus.Peer.Authentication" };
+
+    for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); ++l) {
+        qcc::String source(lengths[l]);
+        volatile size_t sink = 0;
+
+        uint64_t start = qcc::GetTimestamp64();
+        for (uint32_t i = 0; i < iterations; ++i) {
+            qcc::String s(lengths[l]);
+            sink += s.size();
+        }
+        uint64_t constructMs = qcc::GetTimestamp64() - start;
+
+        start = qcc::GetTimestamp64();
+        for (uint32_t i = 0; i < iterations; ++i) {
+            qcc::String s(source);
+            sink += s.size();
+        }
+        uint64_t copyMs = qcc::GetTimestamp64() - start;
+
+        start = qcc::GetTimestamp64();
+        for (uint32_t i = 0; i < iterations; ++i) {
+            qcc::String s = source + ".x";
+            sink += s.size();
+        }
+        uint64_t concatMs = qcc::GetTimestamp64() - start;
+
+        start = qcc::GetTimestamp64();
+        std::vector<qcc::String> v;
+        for (uint32_t i = 0; i < iterations / 10; ++i) {
+            v.push_back(source);
+        }
+        uint64_t pushMs = qcc::GetTimestamp64() - start;
+
+        printf("%2u chars: construct %5.1f ns, copy %5.1f ns, concatenate %5.1f ns, vector push_back %5.1f ns\n",
+               static_cast<uint32_t>(source.size()), constructMs * 1e6 / iterations, copyMs * 1e6 / iterations,
+               concatMs * 1e6 / iterations, pushMs * 1e7 / iterations);
+    }
+}
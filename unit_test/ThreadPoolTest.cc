@@ -0,0 +1,247 @@
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <gtest/gtest.h>
+
+#include <qcc/ThreadPool.h>
+#include <qcc/atomic.h>
+#include <qcc/time.h>
+#include <Status.h>
+
+using namespace qcc;
+
+static volatile int32_t runCount = 0;
+
+class CountingRunnable : public Runnable {
+  public:
+    CountingRunnable(uint32_t delay = 0) : delay(delay) { }
+    void Run(void)
+    {
+        if (delay) {
+            qcc::Sleep(delay);
+        }
+        IncrementAndFetch(&runCount);
+    }
+  private:
+    uint32_t delay;
+};
+
+static bool WaitForRunCount(int32_t expected)
+{
+    uint64_t startTime = GetTimestamp64();
+    while ((runCount < expected) && (GetTimestamp64() < (startTime + 10000))) {
+        qcc::Sleep(5);
+    }
+    return runCount == expected;
+}
+
+TEST(ThreadPoolTest, Execute) {
+    runCount = 0;
+    ThreadPool pool("ThreadPoolTest", 4, 64);
+    EXPECT_EQ(4U, pool.GetConcurrency());
+    EXPECT_EQ(64U, pool.GetBacklog());
+
+    for (uint32_t i = 0; i < 64; ++i) {
+        EXPECT_EQ(ER_OK, pool.Execute(NewPtr<CountingRunnable>()));
+    }
+    EXPECT_TRUE(WaitForRunCount(64));
+    pool.Stop();
+    pool.Join();
+}
+
+TEST(ThreadPoolTest, Backpressure) {
+    runCount = 0;
+    ThreadPool pool("ThreadPoolTest", 1, 2);
+
+    /* One task occupies the only worker, two more fill the queue */
+    EXPECT_EQ(ER_OK, pool.Execute(NewPtr<CountingRunnable>(200)));
+    qcc::Sleep(50);
+    EXPECT_EQ(ER_OK, pool.Execute(NewPtr<CountingRunnable>(10)));
+    EXPECT_EQ(ER_OK, pool.Execute(NewPtr<CountingRunnable>(10)));
+    EXPECT_EQ(3U, pool.GetN());
+    EXPECT_EQ(ER_THREADPOOL_EXHAUSTED, pool.Execute(NewPtr<CountingRunnable>()));
+    EXPECT_EQ(ER_TIMEOUT, pool.ExecuteBlocking(NewPtr<CountingRunnable>(), 10));
+
+    /* A blocking submit waits until a worker frees up a slot */
+    EXPECT_EQ(ER_OK, pool.ExecuteBlocking(NewPtr<CountingRunnable>()));
+    EXPECT_EQ(ER_OK, pool.WaitForAvailableThread());
+    EXPECT_TRUE(WaitForRunCount(4));
+
+    pool.Stop();
+    EXPECT_EQ(ER_THREADPOOL_STOPPING, pool.Execute(NewPtr<CountingRunnable>()));
+    EXPECT_EQ(ER_THREADPOOL_STOPPING, pool.ExecuteBlocking(NewPtr<CountingRunnable>()));
+    pool.Join();
+}
+
+class FanOutRunnable : public Runnable {
+  public:
+    FanOutRunnable(ThreadPool* pool, uint32_t depth) : pool(pool), depth(depth) { }
+    void Run(void)
+    {
+        if (depth) {
+            pool->Spawn(NewPtr<FanOutRunnable>(pool, depth - 1));
+            pool->Spawn(NewPtr<FanOutRunnable>(pool, depth - 1));
+        }
+        IncrementAndFetch(&runCount);
+    }
+  private:
+    ThreadPool* pool;
+    uint32_t depth;
+};
+
+TEST(ThreadPoolTest, WorkStealing) {
+    runCount = 0;
+    ThreadPool pool("ThreadPoolTest", 4, 16, true);
+    EXPECT_TRUE(pool.IsWorkStealing());
+
+    /* A binary tree of depth 10 spawned entirely from pool threads */
+    EXPECT_EQ(ER_OK, pool.Execute(NewPtr<FanOutRunnable>(&pool, 10)));
+    EXPECT_TRUE(WaitForRunCount((1 << 11) - 1));
+    pool.Stop();
+    pool.Join();
+}
+
+TEST(ThreadPoolTest, SpawnWithoutRoom) {
+    runCount = 0;
+    ThreadPool pool("ThreadPoolTest", 2, 1);
+
+    /* Subtasks that find the shared queue full run on the spawning thread */
+    EXPECT_EQ(ER_OK, pool.Execute(NewPtr<FanOutRunnable>(&pool, 6)));
+    EXPECT_TRUE(WaitForRunCount((1 << 7) - 1));
+    pool.Stop();
+    pool.Join();
+}
+
+class SquareCallable : public Callable<uint32_t> {
+  public:
+    SquareCallable(uint32_t n) : n(n) { }
+    QStatus Call(uint32_t& result)
+    {
+        if (n == 0) {
+            return ER_BAD_ARG_1;
+        }
+        result = n * n;
+        return ER_OK;
+    }
+  private:
+    uint32_t n;
+};
+
+TEST(ThreadPoolTest, Futures) {
+    ThreadPool pool("ThreadPoolTest", 4, 8);
+
+    std::vector<Ptr<Runnable> > batch;
+    std::vector<Future<uint32_t> > futures;
+    for (uint32_t i = 1; i <= 32; ++i) {
+        Ptr<SquareCallable> callable = NewPtr<SquareCallable>(i);
+        futures.push_back(callable->GetFuture());
+        batch.push_back(callable);
+    }
+    Future<std::vector<uint32_t> > all = WhenAll(futures);
+
+    /* The batch is larger than the backlog so this has to wait for room */
+    uint32_t queued = 0;
+    EXPECT_EQ(ER_OK, pool.ExecuteBatch(batch, Event::WAIT_FOREVER, &queued));
+    EXPECT_EQ(32U, queued);
+    EXPECT_EQ(ER_OK, WaitAll(futures, 10000));
+
+    uint32_t value = 0;
+    EXPECT_EQ(ER_OK, futures[6].Get(value));
+    EXPECT_EQ(49U, value);
+
+    std::vector<uint32_t> values;
+    EXPECT_EQ(ER_OK, all.Get(values, 10000));
+    ASSERT_EQ(32U, values.size());
+    for (uint32_t i = 0; i < 32; ++i) {
+        EXPECT_EQ((i + 1) * (i + 1), values[i]);
+    }
+
+    /* Errors propagate through both the Future and WhenAll */
+    Ptr<SquareCallable> bad = NewPtr<SquareCallable>(0);
+    futures.push_back(bad->GetFuture());
+    all = WhenAll(futures);
+    EXPECT_EQ(ER_OK, pool.Execute(bad));
+    EXPECT_EQ(ER_BAD_ARG_1, futures.back().Wait(10000));
+    EXPECT_EQ(ER_BAD_ARG_1, all.Wait(10000));
+
+    pool.Stop();
+    pool.Join();
+}
+
+TEST(ThreadPoolTest, Promise) {
+    Promise<int> promise;
+    Future<int> future = promise.GetFuture();
+    EXPECT_FALSE(future.IsReady());
+    EXPECT_EQ(ER_TIMEOUT, future.Wait(10));
+    EXPECT_TRUE(promise.SetValue(42));
+    EXPECT_FALSE(promise.SetError(ER_FAIL));
+
+    int value = 0;
+    EXPECT_TRUE(future.IsReady());
+    EXPECT_EQ(ER_OK, future.Get(value));
+    EXPECT_EQ(42, value);
+
+    /* A Callable that is never run fails its Future when it is released */
+    Future<uint32_t> orphan;
+    {
+        Ptr<SquareCallable> callable = NewPtr<SquareCallable>(3);
+        orphan = callable->GetFuture();
+    }
+    EXPECT_EQ(ER_THREADPOOL_STOPPING, orphan.Wait(0));
+}
+
+/* Counts the copies alive so a leaked Future state shows up as a nonzero count */
+static volatile int32_t liveTracked = 0;
+
+struct Tracked {
+    Tracked() { IncrementAndFetch(&liveTracked); }
+    Tracked(const Tracked& other) { IncrementAndFetch(&liveTracked); }
+    ~Tracked() { DecrementAndFetch(&liveTracked); }
+};
+
+TEST(ThreadPoolTest, WhenAllReleasesStates) {
+    Future<std::vector<Tracked> > all;
+    {
+        std::vector<Promise<Tracked> > promises(3);
+        std::vector<Future<Tracked> > futures;
+        for (size_t i = 0; i < promises.size(); ++i) {
+            futures.push_back(promises[i].GetFuture());
+        }
+        all = WhenAll(futures);
+        for (size_t i = 0; i < promises.size(); ++i) {
+            EXPECT_TRUE(promises[i].SetValue(Tracked()));
+        }
+    }
+    /* Only the combined result is left, the constituent results are freed */
+    EXPECT_TRUE(all.IsReady());
+    EXPECT_EQ(3, liveTracked);
+    all = Future<std::vector<Tracked> >();
+    EXPECT_EQ(0, liveTracked);
+
+    /* The WhenAll is dropped while its constituents are outstanding */
+    {
+        std::vector<Promise<Tracked> > promises(2);
+        std::vector<Future<Tracked> > futures;
+        for (size_t i = 0; i < promises.size(); ++i) {
+            futures.push_back(promises[i].GetFuture());
+        }
+        WhenAll(futures);
+        futures.clear();
+        for (size_t i = 0; i < promises.size(); ++i) {
+            EXPECT_TRUE(promises[i].SetValue(Tracked()));
+        }
+    }
+    EXPECT_EQ(0, liveTracked);
+}
@@ -0,0 +1,116 @@
+/******************************************************************************
+ * Copyright 2013, Qualcomm Innovation Center, Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ ******************************************************************************/
+#include <gtest/gtest.h>
+
+#include <string.h>
+
+#include <qcc/Thread.h>
+#include <Status.h>
+
+using namespace qcc;
+
+class SelfThread : public Thread {
+  public:
+    SelfThread() : Thread("SelfThread"), self(NULL), name(NULL) { }
+    Thread* self;
+    const char* name;
+  protected:
+    ThreadReturn STDCALL Run(void* arg)
+    {
+        self = GetThread();
+        name = GetThreadName();
+        return 0;
+    }
+};
+
+TEST(ThreadTest, GetThread) {
+    SelfThread thread;
+    EXPECT_EQ(ER_OK, thread.Start());
+    EXPECT_EQ(ER_OK, thread.Join());
+    EXPECT_EQ(&thread, thread.self);
+    EXPECT_STREQ("SelfThread", thread.name);
+}
+
+TEST(ThreadTest, ExternalThread) {
+    /* This thread was not started by qcc::Thread so it gets a wrapper, created once */
+    const char* name = Thread::GetThreadName();
+    Thread* first = Thread::GetThread();
+    Thread* second = Thread::GetThread();
+    EXPECT_STREQ("external", name);
+    EXPECT_EQ(first, second);
+    EXPECT_STREQ("external", Thread::GetThreadName());
+
+    /* Cleaning up external wrappers invalidates the cached one */
+    Thread::CleanExternalThreads();
+    Thread* third = Thread::GetThread();
+    EXPECT_TRUE(third != NULL);
+    EXPECT_EQ(third, Thread::GetThread());
+    Thread::CleanExternalThreads();
+}
+
+#if defined(QCC_OS_LINUX)
+#include <sched.h>
+
+class AffinityThread : public Thread {
+  public:
+    AffinityThread() : Thread("AffinityThread"), cpuCount(0), stackOk(false) { name[0] = '\0'; }
+    int cpuCount;
+    bool stackOk;
+    char name[16];
+  protected:
+    ThreadReturn STDCALL Run(void* arg)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            cpuCount = CPU_COUNT(&set);
+        }
+        pthread_getname_np(pthread_self(), name, sizeof(name));
+
+        /* Touch a buffer larger than the default stack */
+        volatile char buffer[256 * 1024];
+        buffer[0] = 1;
+        buffer[sizeof(buffer) - 1] = 1;
+        stackOk = true;
+        return 0;
+    }
+};
+
+TEST(ThreadTest, Attributes) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    ASSERT_EQ(0, sched_getaffinity(0, sizeof(set), &set));
+    uint32_t cpu = 0;
+    while (!CPU_ISSET(cpu, &set)) {
+        ++cpu;
+    }
+
+    AffinityThread thread;
+    ThreadAttributes attributes;
+    attributes.stackSize = 1024 * 1024;
+    attributes.cpus.push_back(cpu);
+    EXPECT_EQ(ER_OK, thread.SetAttributes(attributes));
+    EXPECT_EQ(1024U * 1024U, thread.GetAttributes().stackSize);
+    EXPECT_EQ(ER_OK, thread.Start());
+    EXPECT_EQ(ER_OK, thread.Join());
+    EXPECT_EQ(1, thread.cpuCount);
+    EXPECT_TRUE(thread.stackOk);
+    EXPECT_STREQ("AffinityThread", thread.name);
+
+    /* External threads cannot take attributes */
+    EXPECT_EQ(ER_EXTERNAL_THREAD, Thread::GetThread()->SetAttributes(attributes));
+}
+#endif